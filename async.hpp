@@ -0,0 +1,459 @@
+#ifndef LAL_ASYNC_HPP
+#define LAL_ASYNC_HPP
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "async.hpp requires C++20 coroutines"
+#endif
+
+#include "thread_pool.hpp"
+#include "matrix.hpp"
+
+#include <condition_variable>
+#include <system_error>
+#include <type_traits>
+#include <stop_token>
+#include <coroutine>
+#include <exception>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <atomic>
+#include <vector>
+#include <tuple>
+#include <mutex>
+
+// Awaitable matrix operations for C++20 coroutines, e.g.
+//
+//   lal::async::task<lal::matrix<float, 256, 256>> step(const auto& a, const auto& b, const auto& c)
+//   {
+//       const auto ab = co_await lal::async::multiply(a, b);
+//       co_return co_await lal::async::multiply(ab, c);
+//   }
+//
+// An operation runs on a thread pool (the shared default_thread_pool unless given
+// another) and the awaiting coroutine carries on from the worker which finished it,
+// so a chain of dependent operations never blocks a thread.  when_all runs
+// independent tasks together and sync_wait blocks an ordinary function until a task
+// is done.  With a pool of one, operations run on the thread which awaits them.
+//
+// Tasks are lazy, nothing runs until they're awaited.  Operands are taken by
+// reference and have to outlive the task, which they do when it's awaited in the
+// same expression.  A stop_token cancels operations which haven't started yet, they
+// throw a std::system_error of std::errc::operation_canceled when awaited instead; an
+// operation which has started runs to the end.
+namespace lal::async
+{
+    template <typename T = void>
+    class task;
+
+    namespace detail
+    {
+        // Carries on with whatever awaited a task, on the thread which finished it
+        struct task_final_awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(const std::coroutine_handle<Promise> handle) const noexcept
+            {
+                return handle.promise().continuation();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        class task_promise_base
+        {
+        public:
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            task_final_awaiter final_suspend() const noexcept { return {}; }
+
+            void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+            std::coroutine_handle<> continuation() const noexcept { return continuation_; }
+            void set_continuation(const std::coroutine_handle<> continuation) noexcept { continuation_ = continuation; }
+
+        protected:
+            void rethrow_if_failed() const
+            {
+                if (error_)
+                    std::rethrow_exception(error_);
+            }
+
+        private:
+            std::coroutine_handle<> continuation_{ std::noop_coroutine() };
+            std::exception_ptr error_{};
+        };
+
+        template <typename T>
+        class task_promise : public task_promise_base
+        {
+        public:
+            task<T> get_return_object() noexcept;
+
+            template <typename Value>
+            void return_value(Value&& value)
+            {
+                value_.emplace(std::forward<Value>(value));
+            }
+
+            T result()
+            {
+                rethrow_if_failed();
+                return std::move(*value_);
+            }
+
+        private:
+            std::optional<T> value_{};
+        };
+
+        template <>
+        class task_promise<void> : public task_promise_base
+        {
+        public:
+            task<void> get_return_object() noexcept;
+
+            void return_void() const noexcept {}
+
+            void result() const { rethrow_if_failed(); }
+        };
+    }
+
+    template <typename T>
+    class [[nodiscard]] task
+    {
+    public:
+        using promise_type = detail::task_promise<T>;
+        using value_type = T;
+
+        task() noexcept = default;
+
+        explicit task(const std::coroutine_handle<promise_type> handle) noexcept : handle_{ handle } {}
+
+        task(task&& other) noexcept : handle_{ std::exchange(other.handle_, {}) } {}
+
+        task& operator=(task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_)
+                    handle_.destroy();
+
+                handle_ = std::exchange(other.handle_, {});
+            }
+
+            return *this;
+        }
+
+        ~task()
+        {
+            if (handle_)
+                handle_.destroy();
+        }
+
+        // Starts the task, the awaiting coroutine resumes once it's done
+        auto operator co_await() && noexcept
+        {
+            struct awaiter
+            {
+                bool await_ready() const noexcept { return handle.done(); }
+
+                std::coroutine_handle<> await_suspend(const std::coroutine_handle<> continuation) const noexcept
+                {
+                    handle.promise().set_continuation(continuation);
+                    return handle;
+                }
+
+                T await_resume() const { return handle.promise().result(); }
+
+                std::coroutine_handle<promise_type> handle;
+            };
+
+            return awaiter{ handle_ };
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle_{};
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        task<T> task_promise<T>::get_return_object() noexcept
+        {
+            return task<T>{ std::coroutine_handle<task_promise<T>>::from_promise(*this) };
+        }
+
+        inline task<void> task_promise<void>::get_return_object() noexcept
+        {
+            return task<void>{ std::coroutine_handle<task_promise<void>>::from_promise(*this) };
+        }
+
+        // A coroutine which starts straight away and frees itself at the end, for
+        // driving tasks from code which isn't a coroutine
+        struct detached
+        {
+            struct promise_type
+            {
+                detached get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+        };
+
+        template <typename T>
+        struct sync_wait_state
+        {
+            std::mutex mutex{};
+            std::condition_variable done{};
+            bool finished{ false };
+            std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value{};
+            std::exception_ptr error{};
+        };
+
+        template <typename T>
+        detached sync_wait_driver(task<T>& work, sync_wait_state<T>& state)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await std::move(work);
+                    state.value.emplace(true);
+                }
+                else
+                {
+                    state.value.emplace(co_await std::move(work));
+                }
+            }
+            catch (...)
+            {
+                state.error = std::current_exception();
+            }
+
+            // Notified under the lock as the waiting thread frees the state once it
+            // sees finished
+            const std::lock_guard<std::mutex> lock{ state.mutex };
+            state.finished = true;
+            state.done.notify_one();
+        }
+
+        // when_all starts one of these per task, the last to finish resumes the
+        // coroutine awaiting all of them
+        struct when_all_counter
+        {
+            explicit when_all_counter(const std::size_t tasks) noexcept : remaining{ tasks + 1u } {}
+
+            std::atomic<std::size_t> remaining;
+            std::coroutine_handle<> awaiting{};
+        };
+
+        class when_all_child
+        {
+        public:
+            struct promise_type
+            {
+                when_all_child get_return_object() noexcept
+                {
+                    return when_all_child{ std::coroutine_handle<promise_type>::from_promise(*this) };
+                }
+
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+
+                auto final_suspend() const noexcept
+                {
+                    struct awaiter
+                    {
+                        bool await_ready() const noexcept { return false; }
+
+                        std::coroutine_handle<> await_suspend(const std::coroutine_handle<promise_type> handle) const noexcept
+                        {
+                            when_all_counter& counter = *handle.promise().counter;
+                            if (counter.remaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+                                return counter.awaiting;
+
+                            return std::noop_coroutine();
+                        }
+
+                        void await_resume() const noexcept {}
+                    };
+
+                    return awaiter{};
+                }
+
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+
+                when_all_counter* counter{ nullptr };
+            };
+
+            explicit when_all_child(const std::coroutine_handle<promise_type> handle) noexcept : handle_{ handle } {}
+
+            when_all_child(when_all_child&& other) noexcept : handle_{ std::exchange(other.handle_, {}) } {}
+
+            when_all_child& operator=(when_all_child&&) = delete;
+
+            ~when_all_child()
+            {
+                if (handle_)
+                    handle_.destroy();
+            }
+
+            void start(when_all_counter& counter) const
+            {
+                handle_.promise().counter = &counter;
+                handle_.resume();
+            }
+
+        private:
+            std::coroutine_handle<promise_type> handle_;
+        };
+
+        template <typename T>
+        when_all_child when_all_run(task<T>& work, std::optional<T>& value, std::exception_ptr& error)
+        {
+            try
+            {
+                value.emplace(co_await std::move(work));
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        }
+
+        // Starts every child and suspends unless they all finished while starting
+        template <typename Children>
+        struct when_all_awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(const std::coroutine_handle<> awaiting) const
+            {
+                counter.awaiting = awaiting;
+                for (const when_all_child& child : children)
+                    child.start(counter);
+
+                return counter.remaining.fetch_sub(1u, std::memory_order_acq_rel) != 1u;
+            }
+
+            void await_resume() const noexcept {}
+
+            Children& children;
+            when_all_counter& counter;
+        };
+
+        template <typename... Ts, std::size_t... Is>
+        task<std::tuple<Ts...>> when_all(std::index_sequence<Is...>, task<Ts>... tasks)
+        {
+            std::tuple<std::optional<Ts>...> values{};
+            std::exception_ptr errors[sizeof...(Ts)]{};
+            when_all_counter counter{ sizeof...(Ts) };
+            const when_all_child children[] = { when_all_run(tasks, std::get<Is>(values), errors[Is])... };
+            co_await when_all_awaiter<const when_all_child[sizeof...(Ts)]>{ children, counter };
+            for (const std::exception_ptr& error : errors)
+                if (error)
+                    std::rethrow_exception(error);
+
+            co_return std::tuple<Ts...>{ std::move(*std::get<Is>(values))... };
+        }
+
+        inline void throw_if_cancelled(const std::stop_token& stop)
+        {
+            if (stop.stop_requested())
+                throw std::system_error(std::make_error_code(std::errc::operation_canceled), "lal::async operation cancelled");
+        }
+    }
+
+    // co_await schedule(pool) carries on on one of the pool's workers
+    inline auto schedule(thread_pool& pool = default_thread_pool()) noexcept
+    {
+        struct awaiter
+        {
+            bool await_ready() const noexcept { return pool.size() == 1u; }
+
+            void await_suspend(const std::coroutine_handle<> handle) const
+            {
+                pool.post([handle]() { handle.resume(); });
+            }
+
+            void await_resume() const noexcept {}
+
+            thread_pool& pool;
+        };
+
+        return awaiter{ pool };
+    }
+
+    // function() on the pool, unless stop has been requested by the time it would start
+    template <typename Function>
+    task<std::invoke_result_t<Function&>> run(Function function, const std::stop_token stop = {}, thread_pool& pool = default_thread_pool())
+    {
+        co_await schedule(pool);
+        detail::throw_if_cancelled(stop);
+        co_return function();
+    }
+
+    template <typename T, std::size_t I, std::size_t J, std::size_t K>
+    task<matrix<T, I, K>> multiply(const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs, const std::stop_token stop = {},
+                                   thread_pool& pool = default_thread_pool())
+    {
+        return run([&lhs, &rhs]() { return lhs * rhs; }, stop, pool);
+    }
+
+    // The results of all the tasks, run at the same time.  If any of them throw, the
+    // first of those exceptions (in argument order) is rethrown once they're all done.
+    template <typename... Ts>
+    task<std::tuple<Ts...>> when_all(task<Ts>... tasks)
+    {
+        static_assert((!std::is_void_v<Ts> && ...), "when_all requires tasks with results");
+        return detail::when_all(std::index_sequence_for<Ts...>{}, std::move(tasks)...);
+    }
+
+    template <typename T>
+    task<std::vector<T>> when_all(std::vector<task<T>> tasks)
+    {
+        static_assert(!std::is_void_v<T>, "when_all requires tasks with results");
+        std::vector<std::optional<T>> values(tasks.size());
+        std::vector<std::exception_ptr> errors(tasks.size());
+        detail::when_all_counter counter{ tasks.size() };
+        std::vector<detail::when_all_child> children;
+        children.reserve(tasks.size());
+        for (std::size_t i = 0u; i < tasks.size(); ++i)
+            children.push_back(detail::when_all_run(tasks[i], values[i], errors[i]));
+
+        co_await detail::when_all_awaiter<const std::vector<detail::when_all_child>>{ children, counter };
+        for (const std::exception_ptr& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+
+        std::vector<T> results;
+        results.reserve(values.size());
+        for (std::optional<T>& value : values)
+            results.push_back(std::move(*value));
+
+        co_return results;
+    }
+
+    // Blocks until the task is done and returns its result
+    template <typename T>
+    T sync_wait(task<T> work)
+    {
+        detail::sync_wait_state<T> state{};
+        detail::sync_wait_driver(work, state);
+        {
+            std::unique_lock<std::mutex> lock{ state.mutex };
+            state.done.wait(lock, [&state]() { return state.finished; });
+        }
+
+        if (state.error)
+            std::rethrow_exception(state.error);
+
+        if constexpr (!std::is_void_v<T>)
+            return std::move(*state.value);
+    }
+}
+
+#endif
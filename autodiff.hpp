@@ -0,0 +1,462 @@
+#ifndef LAL_AUTODIFF_HPP
+#define LAL_AUTODIFF_HPP
+
+#include "reductions.hpp"
+#include "matrix.hpp"
+#include "blas.hpp"
+
+#include <initializer_list>
+#include <type_traits>
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <cmath>
+
+// Reverse mode automatic differentiation.  Operations on vars are recorded on a
+// tape and tape.backward(output) then runs their backward kernels in reverse order,
+// leaving d output / d x in x.gradient() for every variable x.
+//
+//     lal::autodiff::tape t;
+//     const auto w = t.variable(weights);
+//     const auto h = map(affine(w, t.constant(input), t.variable(bias)), lal::autodiff::activation::relu{});
+//     t.backward(sum(h));
+//     w.gradient();
+//
+// Every value and gradient the tape creates lives in an arena allocated up front,
+// so recording allocates nothing (and throws std::length_error if the arena fills).
+// clear() forgets everything recorded, which invalidates the vars, and keeps the arena
+// for the next pass.  Variables and constants refer to the matrices they are made from
+// rather than copying them, so those must outlive the recording.
+//
+// Backward kernels accumulate straight into the gradients, products through gemm with
+// transposed operands (gemv and ger for column vectors) and elementwise ones as a
+// single pass, and affine(w, x, b) does w * x + b as one operation.
+namespace lal
+{
+    namespace autodiff
+    {
+        template <typename Matrix>
+        class var;
+
+        class tape;
+
+        namespace detail
+        {
+            struct node
+            {
+                void (*backward)(const node&);
+                const void* value;
+                void* gradient;
+                const node* inputs[3];
+                const node* previous;
+            };
+
+            template <typename Matrix>
+            const Matrix& value_of(const node& n) noexcept
+            {
+                return *static_cast<const Matrix*>(n.value);
+            }
+
+            template <typename Matrix>
+            Matrix* gradient_of(const node& n) noexcept
+            {
+                return static_cast<Matrix*>(n.gradient);
+            }
+
+            struct recorder;
+        }
+
+        // Elementwise functions for map, the derivative is given both the input and the output
+        namespace activation
+        {
+            struct relu
+            {
+                template <typename T>
+                static constexpr T value(const T x) noexcept { return x > T{} ? x : T{}; }
+
+                template <typename T>
+                static constexpr T derivative(const T x, T) noexcept { return x > T{} ? T{ 1 } : T{}; }
+            };
+
+            struct sigmoid
+            {
+                template <typename T>
+                static T value(const T x) noexcept { return T{ 1 } / (T{ 1 } + std::exp(-x)); }
+
+                template <typename T>
+                static constexpr T derivative(T, const T y) noexcept { return y * (T{ 1 } - y); }
+            };
+
+            struct tanh
+            {
+                template <typename T>
+                static T value(const T x) noexcept { return std::tanh(x); }
+
+                template <typename T>
+                static constexpr T derivative(T, const T y) noexcept { return T{ 1 } - y * y; }
+            };
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        class var<matrix<T, Rows, Columns>>
+        {
+        public:
+            using matrix_type = matrix<T, Rows, Columns>;
+
+            const matrix_type& value() const noexcept { return detail::value_of<matrix_type>(*node_); }
+
+            // Zero for anything backward's output doesn't depend on
+            const matrix_type& gradient() const
+            {
+                if (!node_->gradient)
+                    throw std::logic_error("Constants and values computed only from constants have no gradient");
+
+                return *detail::gradient_of<matrix_type>(*node_);
+            }
+
+            bool requires_gradient() const noexcept { return node_->gradient != nullptr; }
+
+            autodiff::tape& tape() const noexcept { return *tape_; }
+
+        private:
+            friend class autodiff::tape;
+            friend struct detail::recorder;
+
+            var(autodiff::tape& t, const detail::node& n) noexcept : tape_{ &t }, node_{ &n } {}
+
+            autodiff::tape* tape_;
+            const detail::node* node_;
+        };
+
+        class tape
+        {
+        public:
+            static constexpr std::size_t default_arena_bytes = 1u << 20u;
+
+            explicit tape(const std::size_t arena_bytes = default_arena_bytes)
+                : arena_{ std::make_unique<std::byte[]>(arena_bytes) }, capacity_{ arena_bytes }
+            {
+            }
+
+            tape(const tape&) = delete;
+            tape& operator=(const tape&) = delete;
+
+            // A matrix whose gradient is wanted
+            template <typename T, std::size_t Rows, std::size_t Columns>
+            var<matrix<T, Rows, Columns>> variable(const matrix<T, Rows, Columns>& value)
+            {
+                return var<matrix<T, Rows, Columns>>{ *this, push(nullptr, &value, make_matrix<matrix<T, Rows, Columns>>(), {}) };
+            }
+
+            template <typename T, std::size_t Rows, std::size_t Columns>
+            var<matrix<T, Rows, Columns>> constant(const matrix<T, Rows, Columns>& value)
+            {
+                return var<matrix<T, Rows, Columns>>{ *this, push(nullptr, &value, nullptr, {}) };
+            }
+
+            // Runs the backward pass from a scalar output, once per recording
+            template <typename T>
+            void backward(const var<matrix<T, 1, 1>>& output)
+            {
+                if (&output.tape() != this)
+                    throw std::invalid_argument("backward requires an output recorded on this tape");
+                if (!output.requires_gradient())
+                    throw std::logic_error("backward requires an output which depends on a variable");
+
+                (*detail::gradient_of<matrix<T, 1, 1>>(*output.node_))[0][0] = T{ 1 };
+                for (const detail::node* n = output.node_; n; n = n->previous)
+                    if (n->backward && n->gradient)
+                        n->backward(*n);
+            }
+
+            void clear() noexcept
+            {
+                used_ = 0u;
+                last_ = nullptr;
+            }
+
+            std::size_t capacity() const noexcept { return capacity_; }
+            std::size_t used() const noexcept { return used_; }
+
+        private:
+            friend struct detail::recorder;
+
+            void* allocate(const std::size_t size, const std::size_t alignment)
+            {
+                void* p = arena_.get() + used_;
+                std::size_t space = capacity_ - used_;
+                if (!std::align(alignment, size, p, space))
+                    throw std::length_error("Autodiff tape arena is full");
+
+                used_ = capacity_ - space + size;
+                return p;
+            }
+
+            template <typename Matrix>
+            Matrix* make_matrix()
+            {
+                static_assert(std::is_trivially_destructible_v<Matrix>, "Tape values are never destroyed");
+                return new (allocate(sizeof(Matrix), std::max(alignof(Matrix), lal::detail::arena_alignment))) Matrix{};
+            }
+
+            const detail::node& push(void (*const backward)(const detail::node&), const void* const value, void* const gradient,
+                                     std::initializer_list<const detail::node*> inputs)
+            {
+                detail::node* const n = new (allocate(sizeof(detail::node), alignof(detail::node))) detail::node{};
+                n->backward = backward;
+                n->value = value;
+                n->gradient = gradient;
+                std::size_t i = 0u;
+                for (const detail::node* const input : inputs)
+                    n->inputs[i++] = input;
+
+                n->previous = last_;
+                last_ = n;
+                return *n;
+            }
+
+            std::unique_ptr<std::byte[]> arena_;
+            std::size_t capacity_;
+            std::size_t used_{ 0u };
+            const detail::node* last_{ nullptr };
+        };
+
+        namespace detail
+        {
+            template <typename Var>
+            using matrix_t = typename Var::matrix_type;
+
+            struct recorder
+            {
+                template <typename T>
+                static const node& node_of(const var<T>& v) noexcept { return *v.node_; }
+
+                // Records an operation on inputs from one tape, forward fills in its value
+                template <typename Result, typename Forward, typename... Vars>
+                static var<Result> record(void (*const backward)(const node&), const Forward& forward, const Vars&... inputs)
+                {
+                    autodiff::tape& t = first_tape(inputs...);
+                    if (((&inputs.tape() != &t) || ...))
+                        throw std::invalid_argument("Autodiff operations require their operands to be on the same tape");
+
+                    Result* const value = t.make_matrix<Result>();
+                    forward(*value);
+                    Result* const gradient = (inputs.requires_gradient() || ...) ? t.make_matrix<Result>() : nullptr;
+                    return var<Result>{ t, t.push(backward, value, gradient, { inputs.node_... }) };
+                }
+
+            private:
+                template <typename Var, typename... Vars>
+                static autodiff::tape& first_tape(const Var& v, const Vars&...) noexcept { return v.tape(); }
+            };
+
+            // Backward kernels, each adds its contribution to the gradients of whichever
+            // inputs have one
+            // C = A * B, through gemv when B is a column vector
+            template <typename T, std::size_t I, std::size_t J, std::size_t K>
+            void multiply_forward(const matrix<T, I, J>& a, const matrix<T, J, K>& b, const T beta, matrix<T, I, K>& c) noexcept
+            {
+                if constexpr (K == 1u)
+                    gemv(T{ 1 }, a, b, beta, c);
+                else
+                    gemm(T{ 1 }, a, b, beta, c);
+            }
+
+            // dA += dC * B^T and dB += A^T * dC, as an outer product and gemv when B is a column vector
+            template <typename T, std::size_t I, std::size_t J, std::size_t K>
+            void multiply_backward(const node& n)
+            {
+                const auto& dc = *gradient_of<matrix<T, I, K>>(n);
+                const auto& a = value_of<matrix<T, I, J>>(*n.inputs[0]);
+                const auto& b = value_of<matrix<T, J, K>>(*n.inputs[1]);
+                if (auto* const da = gradient_of<matrix<T, I, J>>(*n.inputs[0]))
+                {
+                    if constexpr (K == 1u)
+                        ger(T{ 1 }, dc, b, *da);
+                    else
+                        gemm<transposition::none, transposition::transpose>(T{ 1 }, dc, b, T{ 1 }, *da);
+                }
+                if (auto* const db = gradient_of<matrix<T, J, K>>(*n.inputs[1]))
+                {
+                    if constexpr (K == 1u)
+                        gemv<transposition::transpose>(T{ 1 }, a, dc, T{ 1 }, *db);
+                    else
+                        gemm<transposition::transpose, transposition::none>(T{ 1 }, a, dc, T{ 1 }, *db);
+                }
+            }
+
+            template <typename T, std::size_t Rows, std::size_t Columns, int Sign>
+            void add_backward(const node& n)
+            {
+                using matrix_type = matrix<T, Rows, Columns>;
+                const auto& dc = *gradient_of<matrix_type>(n);
+                if (auto* const da = gradient_of<matrix_type>(*n.inputs[0]))
+                    *da += dc;
+                if (auto* const db = gradient_of<matrix_type>(*n.inputs[1]))
+                {
+                    if constexpr (Sign > 0)
+                        *db += dc;
+                    else
+                        *db -= dc;
+                }
+            }
+
+            template <typename T, std::size_t Rows, std::size_t Columns>
+            void hadamard_backward(const node& n)
+            {
+                using matrix_type = matrix<T, Rows, Columns>;
+                const auto& dc = *gradient_of<matrix_type>(n);
+                const auto& a = value_of<matrix_type>(*n.inputs[0]);
+                const auto& b = value_of<matrix_type>(*n.inputs[1]);
+                if (auto* const da = gradient_of<matrix_type>(*n.inputs[0]))
+                    for (std::size_t row = 0u; row < Rows; ++row)
+                        for (std::size_t column = 0u; column < Columns; ++column)
+                            (*da)[row][column] += dc[row][column] * b[row][column];
+                if (auto* const db = gradient_of<matrix_type>(*n.inputs[1]))
+                    for (std::size_t row = 0u; row < Rows; ++row)
+                        for (std::size_t column = 0u; column < Columns; ++column)
+                            (*db)[row][column] += dc[row][column] * a[row][column];
+            }
+
+            template <typename T, std::size_t Rows, std::size_t Columns>
+            void transpose_backward(const node& n)
+            {
+                const auto& dc = *gradient_of<matrix<T, Columns, Rows>>(n);
+                auto& da = *gradient_of<matrix<T, Rows, Columns>>(*n.inputs[0]);
+                for (std::size_t row = 0u; row < Rows; ++row)
+                    for (std::size_t column = 0u; column < Columns; ++column)
+                        da[row][column] += dc[column][row];
+            }
+
+            template <typename Activation, typename T, std::size_t Rows, std::size_t Columns>
+            void map_backward(const node& n)
+            {
+                using matrix_type = matrix<T, Rows, Columns>;
+                const auto& dy = *gradient_of<matrix_type>(n);
+                const auto& y = value_of<matrix_type>(n);
+                const auto& x = value_of<matrix_type>(*n.inputs[0]);
+                auto& dx = *gradient_of<matrix_type>(*n.inputs[0]);
+                for (std::size_t row = 0u; row < Rows; ++row)
+                    for (std::size_t column = 0u; column < Columns; ++column)
+                        dx[row][column] += dy[row][column] * Activation::derivative(x[row][column], y[row][column]);
+            }
+
+            // y = w * x + b, the product's part is as for multiplication and db += dy
+            template <typename T, std::size_t M, std::size_t K, std::size_t N>
+            void affine_backward(const node& n)
+            {
+                multiply_backward<T, M, K, N>(n);
+                if (auto* const db = gradient_of<matrix<T, M, N>>(*n.inputs[2]))
+                    *db += *gradient_of<matrix<T, M, N>>(n);
+            }
+
+            template <typename T, std::size_t Rows, std::size_t Columns>
+            void sum_backward(const node& n)
+            {
+                const T dy = (*gradient_of<matrix<T, 1, 1>>(n))[0][0];
+                auto& dx = *gradient_of<matrix<T, Rows, Columns>>(*n.inputs[0]);
+                for (std::size_t row = 0u; row < Rows; ++row)
+                    for (std::size_t column = 0u; column < Columns; ++column)
+                        dx[row][column] += dy;
+            }
+
+            template <typename T, std::size_t Rows, std::size_t Columns>
+            void dot_backward(const node& n)
+            {
+                using matrix_type = matrix<T, Rows, Columns>;
+                const T dc = (*gradient_of<matrix<T, 1, 1>>(n))[0][0];
+                if (auto* const da = gradient_of<matrix_type>(*n.inputs[0]))
+                    axpy(dc, value_of<matrix_type>(*n.inputs[1]), *da);
+                if (auto* const db = gradient_of<matrix_type>(*n.inputs[1]))
+                    axpy(dc, value_of<matrix_type>(*n.inputs[0]), *db);
+            }
+        }
+
+        // Operations
+        template <typename T, std::size_t I, std::size_t J, std::size_t K>
+        var<matrix<T, I, K>> operator*(const var<matrix<T, I, J>>& lhs, const var<matrix<T, J, K>>& rhs)
+        {
+            return detail::recorder::record<matrix<T, I, K>>(&detail::multiply_backward<T, I, J, K>, [&](matrix<T, I, K>& c) {
+                detail::multiply_forward(lhs.value(), rhs.value(), T{}, c);
+            }, lhs, rhs);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        var<matrix<T, Rows, Columns>> operator+(const var<matrix<T, Rows, Columns>>& lhs, const var<matrix<T, Rows, Columns>>& rhs)
+        {
+            return detail::recorder::record<matrix<T, Rows, Columns>>(&detail::add_backward<T, Rows, Columns, 1>, [&](matrix<T, Rows, Columns>& c) {
+                c = lhs.value();
+                c += rhs.value();
+            }, lhs, rhs);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        var<matrix<T, Rows, Columns>> operator-(const var<matrix<T, Rows, Columns>>& lhs, const var<matrix<T, Rows, Columns>>& rhs)
+        {
+            return detail::recorder::record<matrix<T, Rows, Columns>>(&detail::add_backward<T, Rows, Columns, -1>, [&](matrix<T, Rows, Columns>& c) {
+                c = lhs.value();
+                c -= rhs.value();
+            }, lhs, rhs);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        var<matrix<T, Rows, Columns>> operator%(const var<matrix<T, Rows, Columns>>& lhs, const var<matrix<T, Rows, Columns>>& rhs)
+        {
+            return detail::recorder::record<matrix<T, Rows, Columns>>(&detail::hadamard_backward<T, Rows, Columns>, [&](matrix<T, Rows, Columns>& c) {
+                c = lhs.value();
+                c %= rhs.value();
+            }, lhs, rhs);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        var<matrix<T, Columns, Rows>> transpose(const var<matrix<T, Rows, Columns>>& m)
+        {
+            return detail::recorder::record<matrix<T, Columns, Rows>>(&detail::transpose_backward<T, Rows, Columns>, [&](matrix<T, Columns, Rows>& c) {
+                for (std::size_t row = 0u; row < Rows; ++row)
+                    for (std::size_t column = 0u; column < Columns; ++column)
+                        c[column][row] = m.value()[row][column];
+            }, m);
+        }
+
+        template <typename Activation, typename T, std::size_t Rows, std::size_t Columns>
+        var<matrix<T, Rows, Columns>> map(const var<matrix<T, Rows, Columns>>& m, Activation)
+        {
+            return detail::recorder::record<matrix<T, Rows, Columns>>(&detail::map_backward<Activation, T, Rows, Columns>, [&](matrix<T, Rows, Columns>& c) {
+                for (std::size_t row = 0u; row < Rows; ++row)
+                    for (std::size_t column = 0u; column < Columns; ++column)
+                        c[row][column] = Activation::value(m.value()[row][column]);
+            }, m);
+        }
+
+        // w * x + b as a single operation
+        template <typename T, std::size_t M, std::size_t K, std::size_t N>
+        var<matrix<T, M, N>> affine(const var<matrix<T, M, K>>& w, const var<matrix<T, K, N>>& x, const var<matrix<T, M, N>>& b)
+        {
+            return detail::recorder::record<matrix<T, M, N>>(&detail::affine_backward<T, M, K, N>, [&](matrix<T, M, N>& y) {
+                y = b.value();
+                detail::multiply_forward(w.value(), x.value(), T{ 1 }, y);
+            }, w, x, b);
+        }
+
+        // Reductions
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        var<matrix<T, 1, 1>> sum(const var<matrix<T, Rows, Columns>>& m)
+        {
+            return detail::recorder::record<matrix<T, 1, 1>>(&detail::sum_backward<T, Rows, Columns>, [&](matrix<T, 1, 1>& c) {
+                c[0][0] = static_cast<T>(lal::sum(m.value()));
+            }, m);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        var<matrix<T, 1, 1>> dot(const var<matrix<T, Rows, Columns>>& lhs, const var<matrix<T, Rows, Columns>>& rhs)
+        {
+            return detail::recorder::record<matrix<T, 1, 1>>(&detail::dot_backward<T, Rows, Columns>, [&](matrix<T, 1, 1>& c) {
+                c[0][0] = static_cast<T>(lal::dot(lhs.value(), rhs.value()));
+            }, lhs, rhs);
+        }
+    }
+}
+
+#endif
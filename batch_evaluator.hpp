@@ -0,0 +1,189 @@
+#ifndef LAL_BATCH_EVALUATOR_HPP
+#define LAL_BATCH_EVALUATOR_HPP
+
+#include "matrix.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+// Evaluates a model for many callers at once.  Each caller submits one input column
+// vector and gets a future of its output, the submitted columns are packed into an
+// Inputs x Batch matrix and the model runs once over the whole batch, so the matrix
+// vector products each request would have made become a single matrix product which
+// reads the weights once.  The model is given the batch and its Outputs x Batch
+// result to fill in, column j of the result belongs to column j of the batch.
+//
+// A batch runs as soon as it's full, or when its first request has waited
+// max_latency, or on flush().  Partial batches are padded with zero columns.  The
+// model runs on a thread owned by the evaluator, one batch at a time, while the next
+// batch fills up, a caller which finds that batch full too waits for space.  An
+// exception thrown by the model is passed to every request in its batch.
+namespace lal
+{
+    template <typename T, std::size_t Inputs, std::size_t Outputs, std::size_t Batch>
+    class batch_evaluator
+    {
+        static_assert(Batch > 0u, "batches must hold at least one request");
+
+    public:
+        using input_type = column_vector<T, Inputs>;
+        using output_type = column_vector<T, Outputs>;
+        using input_batch = matrix<T, Inputs, Batch>;
+        using output_batch = matrix<T, Outputs, Batch>;
+        using model_type = std::function<void(const input_batch&, output_batch&)>;
+
+        explicit batch_evaluator(model_type model, const std::chrono::microseconds max_latency = std::chrono::microseconds{ 100 })
+            : model_{ std::move(model) }, max_latency_{ max_latency }
+        {
+            filling_.reserve(Batch);
+            running_.reserve(Batch);
+            dispatcher_ = std::thread{ [this]() { dispatch(); } };
+        }
+
+        // Requests still waiting are evaluated first
+        ~batch_evaluator()
+        {
+            {
+                const std::lock_guard<std::mutex> lock{ mutex_ };
+                stopping_ = true;
+            }
+
+            ready_.notify_one();
+            dispatcher_.join();
+        }
+
+        batch_evaluator(const batch_evaluator&) = delete;
+        batch_evaluator& operator=(const batch_evaluator&) = delete;
+
+        std::future<output_type> submit(const input_type& x)
+        {
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            space_.wait(lock, [this]() { return filling_.size() < Batch; });
+
+            const std::size_t column = filling_.size();
+            for (std::size_t row = 0u; row < Inputs; ++row)
+                (*inputs_)[row][column] = x[row][0];
+
+            filling_.emplace_back();
+            std::future<output_type> result = filling_.back().get_future();
+            if (column == 0u)
+                deadline_ = std::chrono::steady_clock::now() + max_latency_;
+
+            // The dispatcher only needs waking to start timing a batch or to run a full one
+            if (column == 0u || column + 1u == Batch)
+            {
+                lock.unlock();
+                ready_.notify_one();
+            }
+
+            return result;
+        }
+
+        output_type evaluate(const input_type& x) { return submit(x).get(); }
+
+        // Runs the requests waiting so far without waiting for more
+        void flush()
+        {
+            {
+                const std::lock_guard<std::mutex> lock{ mutex_ };
+                if (filling_.empty())
+                    return;
+
+                flushing_ = true;
+            }
+
+            ready_.notify_one();
+        }
+
+        // The number of times the model has run
+        std::size_t batches() const
+        {
+            const std::lock_guard<std::mutex> lock{ mutex_ };
+            return batches_;
+        }
+
+    private:
+        void dispatch()
+        {
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            for (;;)
+            {
+                ready_.wait(lock, [this]() { return stopping_ || !filling_.empty(); });
+                if (filling_.empty())
+                    return;
+
+                ready_.wait_until(lock, deadline_, [this]() { return stopping_ || flushing_ || filling_.size() == Batch; });
+
+                // The filled batch swaps with the one which just ran so submissions can
+                // carry on into it while the model runs
+                std::swap(inputs_, running_inputs_);
+                std::swap(filling_, running_);
+                flushing_ = false;
+                ++batches_;
+                lock.unlock();
+                space_.notify_all();
+
+                run();
+                running_.clear();
+                lock.lock();
+            }
+        }
+
+        void run() noexcept
+        {
+            const std::size_t requests = running_.size();
+            for (std::size_t row = 0u; row < Inputs; ++row)
+                std::fill((*running_inputs_)[row] + requests, (*running_inputs_)[row] + Batch, T{});
+
+            try
+            {
+                model_(*running_inputs_, *outputs_);
+            }
+            catch (...)
+            {
+                const std::exception_ptr error = std::current_exception();
+                for (std::promise<output_type>& request : running_)
+                    request.set_exception(error);
+
+                return;
+            }
+
+            for (std::size_t column = 0u; column < requests; ++column)
+            {
+                output_type y;
+                for (std::size_t row = 0u; row < Outputs; ++row)
+                    y[row][0] = (*outputs_)[row][column];
+
+                running_[column].set_value(y);
+            }
+        }
+
+        model_type model_;
+        std::chrono::microseconds max_latency_;
+        std::unique_ptr<input_batch> inputs_{ std::make_unique<input_batch>() };
+        std::unique_ptr<input_batch> running_inputs_{ std::make_unique<input_batch>() };
+        std::unique_ptr<output_batch> outputs_{ std::make_unique<output_batch>() };
+        std::vector<std::promise<output_type>> filling_{};
+        std::vector<std::promise<output_type>> running_{};
+        mutable std::mutex mutex_{};
+        std::condition_variable ready_{};
+        std::condition_variable space_{};
+        std::chrono::steady_clock::time_point deadline_{};
+        std::size_t batches_{ 0u };
+        bool flushing_{ false };
+        bool stopping_{ false };
+        std::thread dispatcher_{};
+    };
+}
+
+#endif
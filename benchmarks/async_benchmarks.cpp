@@ -0,0 +1,94 @@
+#include "bench_common.hpp"
+
+#include "matrix.hpp"
+#include "async.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Eight independent 128x128 products one after the other on the calling thread,
+// against awaiting all of them at once on pools of 1 to 8 threads, plus the cost of
+// a chain of dependent products through co_await
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    constexpr std::size_t n = 128u;
+    constexpr std::size_t products = 8u;
+    constexpr double product_flops = 2.0 * n * n * n;
+
+    using square = lal::matrix<float, n, n>;
+
+    std::vector<std::unique_ptr<square>> make_operands()
+    {
+        std::vector<std::unique_ptr<square>> operands;
+        for (std::size_t i = 0u; i < products + 1u; ++i)
+            operands.push_back(make_random<float, n, n>());
+
+        return operands;
+    }
+
+    void BM_products_serial(benchmark::State& state)
+    {
+        const auto operands = make_operands();
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0u; i < products; ++i)
+            {
+                const square p = *operands[i] * *operands[i + 1u];
+                benchmark::DoNotOptimize(p.data());
+            }
+
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, products * product_flops, 0.0);
+    }
+
+    void BM_products_when_all(benchmark::State& state)
+    {
+        const auto operands = make_operands();
+        lal::thread_pool pool{ static_cast<std::size_t>(state.range(0)) };
+        for (auto _ : state)
+        {
+            std::vector<lal::async::task<square>> tasks;
+            for (std::size_t i = 0u; i < products; ++i)
+                tasks.push_back(lal::async::multiply(*operands[i], *operands[i + 1u], {}, pool));
+
+            const auto results = lal::async::sync_wait(lal::async::when_all(std::move(tasks)));
+            benchmark::DoNotOptimize(results.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, products * product_flops, 0.0);
+    }
+
+    lal::async::task<square> chain(const std::vector<std::unique_ptr<square>>& operands, lal::thread_pool& pool)
+    {
+        square p = *operands[0];
+        for (std::size_t i = 1u; i <= products; ++i)
+            p = co_await lal::async::multiply(p, *operands[i], {}, pool);
+
+        co_return p;
+    }
+
+    void BM_products_chained(benchmark::State& state)
+    {
+        const auto operands = make_operands();
+        lal::thread_pool pool{ static_cast<std::size_t>(state.range(0)) };
+        for (auto _ : state)
+        {
+            const square p = lal::async::sync_wait(chain(operands, pool));
+            benchmark::DoNotOptimize(p.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, products * product_flops, 0.0);
+    }
+}
+
+BENCHMARK(BM_products_serial);
+BENCHMARK(BM_products_when_all)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+BENCHMARK(BM_products_chained)->Arg(1)->Arg(2)->UseRealTime();
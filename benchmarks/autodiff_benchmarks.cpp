@@ -0,0 +1,122 @@
+#include "bench_common.hpp"
+
+#include "autodiff.hpp"
+#include "matrix.hpp"
+#include "blas.hpp"
+
+#include <cstddef>
+#include <memory>
+
+// Forward and backward passes of a small MLP (Input -> Hidden -> 32 -> 1 with ReLU
+// and a squared error loss) taped with autodiff against the same gradients written
+// out by hand with gemv and ger
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <std::size_t Input, std::size_t Hidden>
+    struct mlp
+    {
+        lal::matrix<float, Hidden, Input> w1{};
+        lal::matrix<float, Hidden, 1> b1{};
+        lal::matrix<float, 32, Hidden> w2{};
+        lal::matrix<float, 32, 1> b2{};
+        lal::matrix<float, 1, 32> w3{};
+        lal::matrix<float, 1, 1> b3{};
+    };
+
+    template <std::size_t Input, std::size_t Hidden>
+    std::unique_ptr<mlp<Input, Hidden>> make_mlp()
+    {
+        auto network = std::make_unique<mlp<Input, Hidden>>();
+        network->w1 = *make_random<float, Hidden, Input>();
+        network->w2 = *make_random<float, 32, Hidden>();
+        network->w3 = *make_random<float, 1, 32>();
+        network->w1 *= 0.05f;
+        network->w2 *= 0.1f;
+        network->w3 *= 0.1f;
+        return network;
+    }
+
+    // Multiply-adds in the forward pass, the backward pass does twice as many
+    template <std::size_t Input, std::size_t Hidden>
+    constexpr double mlp_flops = 3.0 * 2.0 * (Hidden * Input + 32.0 * Hidden + 32.0);
+
+    template <std::size_t Input, std::size_t Hidden>
+    void BM_mlp_autodiff(benchmark::State& state)
+    {
+        namespace ad = lal::autodiff;
+        const auto network = make_mlp<Input, Hidden>();
+        const auto input = make_random<float, Input, 1>();
+        const lal::matrix<float, 1, 1> target{ { 0.5f } };
+        ad::tape t;
+        for (auto _ : state)
+        {
+            t.clear();
+            const auto w1 = t.variable(network->w1);
+            const auto w2 = t.variable(network->w2);
+            const auto w3 = t.variable(network->w3);
+            const auto h1 = map(affine(w1, t.constant(*input), t.variable(network->b1)), ad::activation::relu{});
+            const auto h2 = map(affine(w2, h1, t.variable(network->b2)), ad::activation::relu{});
+            const auto error = affine(w3, h2, t.variable(network->b3)) - t.constant(target);
+            t.backward(dot(error, error));
+            benchmark::DoNotOptimize(w1.gradient().data());
+        }
+
+        set_throughput(state, mlp_flops<Input, Hidden>, 0.0);
+    }
+
+    template <std::size_t Input, std::size_t Hidden>
+    void BM_mlp_hand_written(benchmark::State& state)
+    {
+        const auto network = make_mlp<Input, Hidden>();
+        const auto gradients = std::make_unique<mlp<Input, Hidden>>();
+        const auto input = make_random<float, Input, 1>();
+        const float target = 0.5f;
+
+        lal::matrix<float, Hidden, 1> h1{};
+        lal::matrix<float, 32, 1> h2{};
+        lal::matrix<float, 1, 1> y{};
+        lal::matrix<float, 32, 1> d2{};
+        lal::matrix<float, Hidden, 1> d1{};
+        for (auto _ : state)
+        {
+            gradients->w1.fill(0.0f);
+            gradients->w2.fill(0.0f);
+            gradients->w3.fill(0.0f);
+
+            h1 = network->b1;
+            lal::gemv(1.0f, network->w1, *input, 1.0f, h1);
+            for (float& x : h1)
+                x = x > 0.0f ? x : 0.0f;
+            h2 = network->b2;
+            lal::gemv(1.0f, network->w2, h1, 1.0f, h2);
+            for (float& x : h2)
+                x = x > 0.0f ? x : 0.0f;
+            y = network->b3;
+            lal::gemv(1.0f, network->w3, h2, 1.0f, y);
+
+            gradients->b3[0][0] = 2.0f * (y[0][0] - target);
+            lal::ger(1.0f, gradients->b3, h2, gradients->w3);
+            lal::gemv<lal::transposition::transpose>(1.0f, network->w3, gradients->b3, 0.0f, d2);
+            for (std::size_t i = 0u; i < 32u; ++i)
+                d2[i][0] = h2[i][0] > 0.0f ? d2[i][0] : 0.0f;
+            gradients->b2 = d2;
+            lal::ger(1.0f, d2, h1, gradients->w2);
+            lal::gemv<lal::transposition::transpose>(1.0f, network->w2, d2, 0.0f, d1);
+            for (std::size_t i = 0u; i < Hidden; ++i)
+                d1[i][0] = h1[i][0] > 0.0f ? d1[i][0] : 0.0f;
+            gradients->b1 = d1;
+            lal::ger(1.0f, d1, *input, gradients->w1);
+            benchmark::DoNotOptimize(gradients->w1.data());
+        }
+
+        set_throughput(state, mlp_flops<Input, Hidden>, 0.0);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_mlp_autodiff, 200, 64);
+BENCHMARK_TEMPLATE(BM_mlp_hand_written, 200, 64);
+BENCHMARK_TEMPLATE(BM_mlp_autodiff, 200, 256);
+BENCHMARK_TEMPLATE(BM_mlp_hand_written, 200, 256);
@@ -0,0 +1,136 @@
+#include "bench_common.hpp"
+
+#include "batch_evaluator.hpp"
+#include "matrix.hpp"
+
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Scoring the 64 candidate placements of a search node with a small value network
+// (a 20x10 board, 128 hidden ReLU units, one score), one matrix vector product per
+// placement against packing them into batches, directly and through a
+// batch_evaluator fed from one or several threads
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    constexpr std::size_t placements = 64u;
+    constexpr std::size_t cells = 200u;
+    constexpr std::size_t hidden = 128u;
+    constexpr double score_flops = 2.0 * placements * (cells * hidden + hidden);
+
+    struct network
+    {
+        std::unique_ptr<lal::matrix<float, hidden, cells>> w1{ make_random<float, hidden, cells>() };
+        std::unique_ptr<lal::matrix<float, 1, hidden>> w2{ make_random<float, 1, hidden>() };
+
+        template <std::size_t Columns>
+        void operator()(const lal::matrix<float, cells, Columns>& boards, lal::matrix<float, 1, Columns>& scores) const
+        {
+            const auto h = lal::map(*w1 * boards, [](const float x) { return std::max(x, 0.0f); });
+            scores = *w2 * h;
+        }
+    };
+
+    template <std::size_t Batch>
+    using evaluator = lal::batch_evaluator<float, cells, 1, Batch>;
+
+    std::vector<lal::column_vector<float, cells>> make_boards()
+    {
+        std::vector<lal::column_vector<float, cells>> boards(placements);
+        for (auto& board : boards)
+            board = *make_random<float, cells, 1>();
+
+        return boards;
+    }
+
+    void BM_score_gemv(benchmark::State& state)
+    {
+        const network model{};
+        const auto boards = make_boards();
+        lal::matrix<float, 1, 1> score{};
+        for (auto _ : state)
+        {
+            for (const auto& board : boards)
+            {
+                model(board, score);
+                benchmark::DoNotOptimize(score.data());
+            }
+
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, score_flops, 0.0);
+    }
+
+    // The model run straight on a packed matrix, what the evaluator costs on top of
+    void BM_score_gemm(benchmark::State& state)
+    {
+        const network model{};
+        const auto boards = make_boards();
+        auto packed = std::make_unique<lal::matrix<float, cells, placements>>();
+        for (std::size_t column = 0u; column < placements; ++column)
+            for (std::size_t row = 0u; row < cells; ++row)
+                (*packed)[row][column] = boards[column][row][0];
+
+        lal::matrix<float, 1, placements> scores{};
+        for (auto _ : state)
+        {
+            model(*packed, scores);
+            benchmark::DoNotOptimize(scores.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, score_flops, 0.0);
+    }
+
+    // Every placement submitted before waiting on any of them, as a search expanding
+    // a node would
+    template <std::size_t Batch>
+    void BM_score_batch_evaluator(benchmark::State& state)
+    {
+        const network model{};
+        const auto boards = make_boards();
+        evaluator<Batch> batches{ std::cref(model) };
+        std::vector<std::future<lal::column_vector<float, 1>>> scores;
+        scores.reserve(placements);
+        for (auto _ : state)
+        {
+            for (const auto& board : boards)
+                scores.push_back(batches.submit(board));
+
+            batches.flush();
+            for (auto& score : scores)
+                benchmark::DoNotOptimize(score.get());
+
+            scores.clear();
+        }
+
+        set_throughput(state, score_flops, 0.0);
+    }
+
+    // Searches on several threads each waiting on one placement at a time, so batches
+    // only fill with one request per thread before the deadline
+    void BM_score_batch_evaluator_callers(benchmark::State& state)
+    {
+        static const network model{};
+        static evaluator<8> batches{ std::cref(model), std::chrono::microseconds{ 50 } };
+        const auto boards = make_boards();
+        for (auto _ : state)
+            for (const auto& board : boards)
+                benchmark::DoNotOptimize(batches.evaluate(board));
+
+        set_throughput(state, score_flops, 0.0);
+    }
+}
+
+BENCHMARK(BM_score_gemv);
+BENCHMARK(BM_score_gemm);
+BENCHMARK_TEMPLATE(BM_score_batch_evaluator, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_score_batch_evaluator, 64)->UseRealTime();
+BENCHMARK(BM_score_batch_evaluator_callers)->Threads(1)->Threads(4)->UseRealTime();
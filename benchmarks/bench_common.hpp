@@ -0,0 +1,61 @@
+#ifndef LAL_BENCH_COMMON_HPP
+#define LAL_BENCH_COMMON_HPP
+
+#include <benchmark/benchmark.h>
+
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <cstddef>
+#include <memory>
+#include <random>
+
+namespace lal_bench
+{
+    // Matrices above a few hundred KB would overflow the stack so every benchmark
+    // allocates its operands on the heap
+    template <typename T, std::size_t Rows, std::size_t Columns = Rows>
+    std::unique_ptr<lal::matrix<T, Rows, Columns>> make_random()
+    {
+        auto m = std::make_unique<lal::matrix<T, Rows, Columns>>();
+        std::mt19937 generator{ 42u };
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            std::uniform_real_distribution<T> distribution{ T{ -1 }, T{ 1 } };
+            for (T& element : *m)
+                element = distribution(generator);
+        }
+        else
+        {
+            std::uniform_int_distribution<T> distribution{ T{ -100 }, T{ 100 } };
+            for (T& element : *m)
+                element = distribution(generator);
+        }
+
+        return m;
+    }
+
+    // Reports GFLOP/s and GB/s (when non-zero) in the console and JSON output, bytes are
+    // the compulsory traffic (each operand read once and the result written once)
+    inline void set_throughput(benchmark::State& state, const double flops_per_iteration, const double bytes_per_iteration)
+    {
+        const double iterations = static_cast<double>(state.iterations());
+        if (flops_per_iteration > 0.0)
+            state.counters["GFLOP/s"] = benchmark::Counter(flops_per_iteration * iterations / 1e9, benchmark::Counter::kIsRate);
+        if (bytes_per_iteration > 0.0)
+            state.counters["GB/s"] = benchmark::Counter(bytes_per_iteration * iterations / 1e9, benchmark::Counter::kIsRate);
+    }
+}
+
+// Sizes for operations which return matrices by value and so need their result on the stack
+#define LAL_BENCH_STACK_SIZES(function, T)                                                                         \
+    BENCHMARK_TEMPLATE(function, T, 2); BENCHMARK_TEMPLATE(function, T, 4); BENCHMARK_TEMPLATE(function, T, 8);    \
+    BENCHMARK_TEMPLATE(function, T, 16); BENCHMARK_TEMPLATE(function, T, 32); BENCHMARK_TEMPLATE(function, T, 64); \
+    BENCHMARK_TEMPLATE(function, T, 128)
+
+// Sizes for operations which work in place on heap allocated matrices
+#define LAL_BENCH_HEAP_SIZES(function, T)                                                                          \
+    LAL_BENCH_STACK_SIZES(function, T); BENCHMARK_TEMPLATE(function, T, 256); BENCHMARK_TEMPLATE(function, T, 512); \
+    BENCHMARK_TEMPLATE(function, T, 1024); BENCHMARK_TEMPLATE(function, T, 2048); BENCHMARK_TEMPLATE(function, T, 4096)
+
+#endif
@@ -0,0 +1,177 @@
+#include "bench_common.hpp"
+
+#include "blas.hpp"
+
+#ifdef LAL_BENCH_CBLAS
+#include <cblas.h>
+#endif
+
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <typename T, std::size_t N>
+    constexpr double matrix_bytes = static_cast<double>(N * N * sizeof(T));
+
+    template <typename T, std::size_t N, lal::transposition TransB = lal::transposition::none>
+    void BM_gemm(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        auto c = make_random<T, N>();
+        for (auto _ : state)
+        {
+            lal::gemm<lal::transposition::none, TransB>(T{ 1 }, *a, *b, T{ 1 }, *c);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, 4.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_gemm_transposed_b(benchmark::State& state)
+    {
+        BM_gemm<T, N, lal::transposition::transpose>(state);
+    }
+
+#ifdef LAL_BENCH_CBLAS
+    // The same product through CBLAS directly, for comparison with the built-in kernel
+    template <typename T, std::size_t N>
+    void BM_cblas_gemm(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        auto c = make_random<T, N>();
+        constexpr int n = static_cast<int>(N);
+        for (auto _ : state)
+        {
+            if constexpr (std::is_same_v<T, float>)
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0f, a->data(), n, b->data(), n, 1.0f, c->data(), n);
+            else
+                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0, a->data(), n, b->data(), n, 1.0, c->data(), n);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, 4.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_cblas_gemv(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto x = make_random<T, N, 1>();
+        auto y = make_random<T, N, 1>();
+        constexpr int n = static_cast<int>(N);
+        for (auto _ : state)
+        {
+            if constexpr (std::is_same_v<T, float>)
+                cblas_sgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0f, a->data(), n, x->data(), 1, 1.0f, y->data(), 1);
+            else
+                cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, a->data(), n, x->data(), 1, 1.0, y->data(), 1);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N, matrix_bytes<T, N>);
+    }
+#endif
+
+    template <typename T, std::size_t N>
+    void BM_gemv(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto x = make_random<T, N, 1>();
+        auto y = make_random<T, N, 1>();
+        for (auto _ : state)
+        {
+            lal::gemv(T{ 1 }, *a, *x, T{ 1 }, *y);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N, matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_axpy(benchmark::State& state)
+    {
+        const auto x = make_random<T, N>();
+        auto y = make_random<T, N>();
+        for (auto _ : state)
+        {
+            lal::axpy(T{ 1 }, *x, *y);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_ger(benchmark::State& state)
+    {
+        const auto x = make_random<T, N, 1>();
+        const auto y = make_random<T, 1, N>();
+        auto a = make_random<T, N>();
+        for (auto _ : state)
+        {
+            lal::ger(T{ 1 }, *x, *y, *a);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_syrk(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        auto c = make_random<T, N>();
+        for (auto _ : state)
+        {
+            lal::syrk(T{ 1 }, *a, T{ 1 }, *c);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 1.0 * N * N * (N + 1), 2.0 * matrix_bytes<T, N>);
+    }
+}
+
+LAL_BENCH_STACK_SIZES(BM_gemm, float);
+BENCHMARK_TEMPLATE(BM_gemm, float, 256);
+BENCHMARK_TEMPLATE(BM_gemm, float, 512);
+BENCHMARK_TEMPLATE(BM_gemm, float, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_gemm, float, 2048)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_gemm, float, 4096)->Unit(benchmark::kMillisecond);
+LAL_BENCH_STACK_SIZES(BM_gemm, double);
+BENCHMARK_TEMPLATE(BM_gemm, double, 256);
+BENCHMARK_TEMPLATE(BM_gemm, double, 512);
+BENCHMARK_TEMPLATE(BM_gemm, double, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_gemm, double, 2048)->Unit(benchmark::kMillisecond);
+LAL_BENCH_STACK_SIZES(BM_gemm_transposed_b, float);
+BENCHMARK_TEMPLATE(BM_gemm_transposed_b, float, 256);
+BENCHMARK_TEMPLATE(BM_gemm_transposed_b, float, 1024)->Unit(benchmark::kMillisecond);
+
+#ifdef LAL_BENCH_CBLAS
+LAL_BENCH_STACK_SIZES(BM_cblas_gemm, float);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, float, 256);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, float, 512);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, float, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, float, 2048)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, float, 4096)->Unit(benchmark::kMillisecond);
+LAL_BENCH_STACK_SIZES(BM_cblas_gemm, double);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, double, 256);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, double, 512);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, double, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_cblas_gemm, double, 2048)->Unit(benchmark::kMillisecond);
+LAL_BENCH_HEAP_SIZES(BM_cblas_gemv, float);
+LAL_BENCH_HEAP_SIZES(BM_cblas_gemv, double);
+#endif
+
+LAL_BENCH_HEAP_SIZES(BM_gemv, float);
+LAL_BENCH_HEAP_SIZES(BM_gemv, double);
+LAL_BENCH_HEAP_SIZES(BM_axpy, float);
+LAL_BENCH_HEAP_SIZES(BM_axpy, double);
+LAL_BENCH_HEAP_SIZES(BM_ger, float);
+LAL_BENCH_HEAP_SIZES(BM_ger, double);
+LAL_BENCH_STACK_SIZES(BM_syrk, float);
+BENCHMARK_TEMPLATE(BM_syrk, float, 256);
+BENCHMARK_TEMPLATE(BM_syrk, float, 1024)->Unit(benchmark::kMillisecond);
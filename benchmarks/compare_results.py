@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Compares two lal_bench JSON result files and flags regressions.
+
+Usage:
+    lal_bench --benchmark_out=before.json --benchmark_out_format=json
+    lal_bench --benchmark_out=after.json --benchmark_out_format=json
+    compare_results.py before.json after.json [--threshold 5] [--filter REGEX]
+
+Exits with status 1 if any benchmark present in both files got slower by more
+than the threshold (in percent) in real or CPU time, or if a lal_copy_bench
+benchmark now copies more than it did.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+COPY_COUNTERS = ("copies", "bytes_copied")
+
+
+def load_results(path):
+    with open(path, encoding="utf-8") as file:
+        document = json.load(file)
+
+    results = {}
+    for run in document.get("benchmarks", []):
+        # With --benchmark_repetitions only the aggregates are compared
+        if run.get("run_type") == "aggregate" and run.get("aggregate_name") != "mean":
+            continue
+        if run.get("run_type") == "iteration" and "repetitions" in run and run["repetitions"] > 1:
+            continue
+
+        scale = TIME_UNITS[run.get("time_unit", "ns")]
+        results[run.get("run_name", run["name"])] = {
+            "real_time": run["real_time"] * scale,
+            "cpu_time": run["cpu_time"] * scale,
+            "gflops": run.get("GFLOP/s", 0.0),
+            "gbytes": run.get("GB/s", 0.0),
+            "copies": {counter: run[counter] for counter in COPY_COUNTERS if counter in run},
+        }
+
+    return results
+
+
+def format_time(nanoseconds):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if nanoseconds >= scale:
+            return f"{nanoseconds / scale:.3f} {unit}"
+    return f"{nanoseconds:.1f} ns"
+
+
+def change(before, after):
+    return (after - before) / before * 100.0 if before else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="JSON output of the reference run")
+    parser.add_argument("contender", help="JSON output of the run being checked")
+    parser.add_argument("--threshold", type=float, default=5.0, help="regression threshold in percent (default 5)")
+    parser.add_argument("--filter", default=None, help="only compare benchmarks whose name matches this regex")
+    arguments = parser.parse_args()
+
+    baseline = load_results(arguments.baseline)
+    contender = load_results(arguments.contender)
+    pattern = re.compile(arguments.filter) if arguments.filter else None
+
+    names = [name for name in baseline if name in contender and (pattern is None or pattern.search(name))]
+    if not names:
+        print("No benchmarks in common")
+        return 0
+
+    width = max(len(name) for name in names)
+    header = f"{'Benchmark':<{width}}  {'Real before':>12}  {'Real after':>12}  {'Real':>8}  {'CPU':>8}  {'GFLOP/s':>16}  {'GB/s':>16}"
+    print(header)
+    print("-" * len(header))
+
+    regressions = []
+    for name in names:
+        before = baseline[name]
+        after = contender[name]
+        real = change(before["real_time"], after["real_time"])
+        cpu = change(before["cpu_time"], after["cpu_time"])
+        gflops = f"{before['gflops']:.2f}->{after['gflops']:.2f}" if before["gflops"] or after["gflops"] else ""
+        gbytes = f"{before['gbytes']:.2f}->{after['gbytes']:.2f}" if before["gbytes"] or after["gbytes"] else ""
+
+        # Copy counts are exact so any increase at all is a regression
+        copied_more = [counter for counter in COPY_COUNTERS
+                       if after["copies"].get(counter, 0.0) > before["copies"].get(counter, 0.0)]
+        regressed = real > arguments.threshold or cpu > arguments.threshold or bool(copied_more)
+        if regressed:
+            regressions.append(name)
+
+        print(f"{name:<{width}}  {format_time(before['real_time']):>12}  {format_time(after['real_time']):>12}  "
+              f"{real:>+7.1f}%  {cpu:>+7.1f}%  {gflops:>16}  {gbytes:>16}{'  REGRESSION' if regressed else ''}")
+        for counter in copied_more:
+            print(f"    {counter} per iteration went from {before['copies'].get(counter, 0.0):g} to {after['copies'][counter]:g}")
+
+    for name in sorted(set(baseline) - set(contender)):
+        print(f"Only in baseline: {name}")
+    for name in sorted(set(contender) - set(baseline)):
+        print(f"Only in contender: {name}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) regressed")
+        return 1
+
+    print(f"\nNo regressions above {arguments.threshold}%")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,115 @@
+#include "bench_common.hpp"
+
+#include "copy_tracking.hpp"
+#include "matrix.hpp"
+
+// Built with LAL_ENABLE_COPY_TRACKING into lal_copy_bench, each benchmark reports the
+// copies, moves and bytes copied per call for one operator so that compare_results.py
+// flags any operator which starts copying more than it used to
+using lal_bench::make_random;
+
+namespace
+{
+    template <typename T, std::size_t N, typename Operation>
+    void count_copies(benchmark::State& state, Operation operation)
+    {
+        auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        const lal::copy_tracking_scope scope;
+        for (auto _ : state)
+        {
+            operation(*a, *b);
+            benchmark::ClobberMemory();
+        }
+
+        const auto counts = scope.counts<T, N, N>();
+        state.counters["copies"] = benchmark::Counter(static_cast<double>(counts.copies), benchmark::Counter::kAvgIterations);
+        state.counters["moves"] = benchmark::Counter(static_cast<double>(counts.moves), benchmark::Counter::kAvgIterations);
+        state.counters["bytes_copied"] = benchmark::Counter(static_cast<double>(counts.bytes_copied), benchmark::Counter::kAvgIterations);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_addition_assignment(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { a += b; });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_subtraction_assignment(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { a -= b; });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_hadamard_assignment(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { a %= b; });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_multiplication_assignment(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { a *= b; });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_scalar_assignment(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto&) { a *= T{ 1 }; a /= T{ 1 }; });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_addition(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { benchmark::DoNotOptimize(a + b); });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_subtraction(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { benchmark::DoNotOptimize(a - b); });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_hadamard(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { benchmark::DoNotOptimize(a % b); });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_multiplication(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { benchmark::DoNotOptimize(a * b); });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_scalar(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto&) { benchmark::DoNotOptimize(T{ 2 } * a / T{ 2 }); });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_unary_minus(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto&) { benchmark::DoNotOptimize(-a); });
+    }
+
+    template <typename T, std::size_t N>
+    void BM_copies_expression(benchmark::State& state)
+    {
+        count_copies<T, N>(state, [](auto& a, const auto& b) { benchmark::DoNotOptimize((a + b) * a - b); });
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_copies_addition_assignment, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_subtraction_assignment, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_hadamard_assignment, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_multiplication_assignment, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_scalar_assignment, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_addition, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_subtraction, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_hadamard, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_multiplication, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_scalar, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_unary_minus, float, 64);
+BENCHMARK_TEMPLATE(BM_copies_expression, float, 64);
@@ -0,0 +1,90 @@
+#include "bench_common.hpp"
+
+#include "half.hpp"
+#include "blas.hpp"
+
+// float, bfloat16 and half storage with float accumulation.  GB/s counts the bytes
+// actually stored, so at equal GB/s a 16-bit type does twice the work, and
+// "storage_bytes" reports the memory held by the operands.
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <typename Storage, std::size_t Rows, std::size_t Columns = Rows>
+    std::unique_ptr<lal::matrix<Storage, Rows, Columns>> make_random_as()
+    {
+        const auto m = make_random<float, Rows, Columns>();
+        auto ret = std::make_unique<lal::matrix<Storage, Rows, Columns>>();
+        lal::convert(*m, *ret);
+        return ret;
+    }
+
+    // y = A * x with A and x stored as Storage and y as float, the memory bound case
+    template <typename Storage, std::size_t N>
+    void BM_mixed_gemv(benchmark::State& state)
+    {
+        const auto a = make_random_as<Storage, N>();
+        const auto x = make_random_as<Storage, N, 1>();
+        auto y = std::make_unique<lal::column_vector<float, N>>();
+        for (auto _ : state)
+        {
+            lal::gemv(1.0f, *a, *x, 0.0f, *y);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N, static_cast<double>((N * N + N) * sizeof(Storage) + 2u * N * sizeof(float)));
+        state.counters["storage_bytes"] = static_cast<double>((N * N + N) * sizeof(Storage));
+    }
+
+    // C = A * B^T with A and B stored as Storage and C as float, so every element is a contiguous dot product
+    template <typename Storage, std::size_t N>
+    void BM_mixed_gemm(benchmark::State& state)
+    {
+        const auto a = make_random_as<Storage, N>();
+        const auto b = make_random_as<Storage, N>();
+        auto c = std::make_unique<lal::square_matrix<float, N>>();
+        for (auto _ : state)
+        {
+            lal::gemm<lal::transposition::none, lal::transposition::transpose>(1.0f, *a, *b, 0.0f, *c);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, static_cast<double>(2u * N * N * sizeof(Storage) + 2u * N * N * sizeof(float)));
+        state.counters["storage_bytes"] = static_cast<double>(2u * N * N * sizeof(Storage));
+    }
+
+    template <typename Storage, std::size_t N>
+    void BM_convert_from_float(benchmark::State& state)
+    {
+        const auto from = make_random<float, N>();
+        auto to = std::make_unique<lal::square_matrix<Storage, N>>();
+        for (auto _ : state)
+        {
+            lal::convert(*from, *to);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, static_cast<double>(N * N * (sizeof(float) + sizeof(Storage))));
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_mixed_gemv, float, 256);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, lal::bfloat16, 256);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, lal::half, 256);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, float, 1024);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, lal::bfloat16, 1024);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, lal::half, 1024);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, float, 4096);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, lal::bfloat16, 4096);
+BENCHMARK_TEMPLATE(BM_mixed_gemv, lal::half, 4096);
+
+BENCHMARK_TEMPLATE(BM_mixed_gemm, float, 64);
+BENCHMARK_TEMPLATE(BM_mixed_gemm, lal::bfloat16, 64);
+BENCHMARK_TEMPLATE(BM_mixed_gemm, lal::half, 64);
+BENCHMARK_TEMPLATE(BM_mixed_gemm, float, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_mixed_gemm, lal::bfloat16, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_mixed_gemm, lal::half, 256)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_convert_from_float, lal::bfloat16, 1024);
+BENCHMARK_TEMPLATE(BM_convert_from_float, lal::half, 1024);
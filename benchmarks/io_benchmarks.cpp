@@ -0,0 +1,290 @@
+#include "bench_common.hpp"
+
+#include "serialization.hpp"
+#include "text_io.hpp"
+#include "npy.hpp"
+
+#include <string_view>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    // Writes a file once per process for the load benchmarks and removes it at exit
+    class temporary_file
+    {
+    public:
+        template <typename Writer>
+        temporary_file(const std::string& name, Writer write)
+            : path_{ std::filesystem::temp_directory_path() / name }
+        {
+            write(path_);
+        }
+
+        ~temporary_file()
+        {
+            std::error_code error;
+            std::filesystem::remove(path_, error);
+        }
+
+        const std::filesystem::path& path() const noexcept { return path_; }
+        std::uintmax_t size() const { return std::filesystem::file_size(path_); }
+
+    private:
+        std::filesystem::path path_;
+    };
+
+    template <typename T, std::size_t N>
+    constexpr double matrix_bytes = static_cast<double>(N * N * sizeof(T));
+
+    template <std::size_t N>
+    const temporary_file& record_file()
+    {
+        static const temporary_file file{ "lal_bench_" + std::to_string(N) + ".lalm", [](const std::filesystem::path& path) {
+            lal::save(path, *make_random<float, N>());
+        } };
+        return file;
+    }
+
+    template <std::size_t N>
+    const temporary_file& npy_file()
+    {
+        static const temporary_file file{ "lal_bench_" + std::to_string(N) + ".npy", [](const std::filesystem::path& path) {
+            lal::save_npy(path, *make_random<double, N>());
+        } };
+        return file;
+    }
+
+    template <std::size_t N>
+    const std::string& csv_text()
+    {
+        static const std::string text = [] {
+            const auto m = make_random<double, N>();
+            std::ostringstream out;
+            out.precision(17);
+            for (std::size_t row = 0u; row < N; ++row)
+                for (std::size_t column = 0u; column < N; ++column)
+                    out << (*m)[row][column] << (column + 1u == N ? '\n' : ',');
+            return out.str();
+        }();
+        return text;
+    }
+
+    template <std::size_t N>
+    const std::string& matrix_market_text()
+    {
+        static const std::string text = [] {
+            const auto m = make_random<double, N>();
+            std::ostringstream out;
+            out.precision(17);
+            out << "%%MatrixMarket matrix array real general\n" << N << ' ' << N << '\n';
+            for (std::size_t column = 0u; column < N; ++column)
+                for (std::size_t row = 0u; row < N; ++row)
+                    out << (*m)[row][column] << '\n';
+            return out.str();
+        }();
+        return text;
+    }
+
+    // Binary records
+    template <std::size_t N>
+    void BM_save(benchmark::State& state)
+    {
+        const auto m = make_random<float, N>();
+        const auto path = std::filesystem::temp_directory_path() / "lal_bench_save.lalm";
+        for (auto _ : state)
+            lal::save(path, *m);
+
+        std::filesystem::remove(path);
+        set_throughput(state, 0.0, matrix_bytes<float, N>);
+    }
+
+    template <std::size_t N>
+    void BM_load(benchmark::State& state)
+    {
+        const temporary_file& file = record_file<N>();
+        auto m = make_random<float, N>();
+        for (auto _ : state)
+        {
+            lal::load(file.path(), *m);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, matrix_bytes<float, N>);
+    }
+
+    // What checkpointing did before binary records, one element at a time through iostreams
+    template <std::size_t N>
+    void BM_load_iostream_elements(benchmark::State& state)
+    {
+        const temporary_file& file = record_file<N>();
+        auto m = make_random<float, N>();
+        for (auto _ : state)
+        {
+            std::ifstream in{ file.path(), std::ios::binary };
+            in.ignore(64);
+            for (float& element : *m)
+                in.read(reinterpret_cast<char*>(&element), sizeof(float));
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, matrix_bytes<float, N>);
+    }
+
+    template <std::size_t N>
+    void BM_map_matrix(benchmark::State& state)
+    {
+        const temporary_file& file = record_file<N>();
+        for (auto _ : state)
+        {
+            const lal::mapped_file mapping{ file.path() };
+            benchmark::DoNotOptimize(lal::map_matrix<float, N, N>(mapping).front());
+        }
+
+        set_throughput(state, 0.0, matrix_bytes<float, N>);
+    }
+
+    // Startup cost alone, i.e. mapping without verifying the checksum
+    template <std::size_t N>
+    void BM_map_matrix_unverified(benchmark::State& state)
+    {
+        const temporary_file& file = record_file<N>();
+        for (auto _ : state)
+        {
+            const lal::mapped_file mapping{ file.path() };
+            benchmark::DoNotOptimize(lal::map_matrix<float, N, N>(mapping, false).front());
+        }
+    }
+
+    // NumPy files against parsing the same values as text
+    template <std::size_t N>
+    void BM_load_npy(benchmark::State& state)
+    {
+        const temporary_file& file = npy_file<N>();
+        auto m = make_random<double, N>();
+        for (auto _ : state)
+        {
+            lal::load_npy(file.path(), *m);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, matrix_bytes<double, N>);
+    }
+
+    template <std::size_t N>
+    void BM_map_npy(benchmark::State& state)
+    {
+        const temporary_file& file = npy_file<N>();
+        for (auto _ : state)
+        {
+            const lal::mapped_file mapping{ file.path() };
+            benchmark::DoNotOptimize(lal::map_npy<double, N, N>(mapping).front());
+        }
+
+        set_throughput(state, 0.0, matrix_bytes<double, N>);
+    }
+
+    // Text parsing, GB/s here is of text consumed
+    template <std::size_t N>
+    void BM_parse_csv(benchmark::State& state)
+    {
+        const std::string& text = csv_text<N>();
+        auto m = make_random<double, N>();
+        for (auto _ : state)
+        {
+            lal::parse_csv(text, *m);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, static_cast<double>(text.size()));
+    }
+
+    template <std::size_t N>
+    void BM_parse_csv_iostream(benchmark::State& state)
+    {
+        const std::string& text = csv_text<N>();
+        auto m = make_random<double, N>();
+        for (auto _ : state)
+        {
+            std::istringstream in{ text };
+            std::string line;
+            for (std::size_t row = 0u; std::getline(in, line); ++row)
+            {
+                std::istringstream fields{ line };
+                std::string field;
+                for (std::size_t column = 0u; std::getline(fields, field, ','); ++column)
+                    (*m)[row][column] = std::stod(field);
+            }
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, static_cast<double>(text.size()));
+    }
+
+    template <std::size_t N>
+    void BM_parse_matrix_market(benchmark::State& state)
+    {
+        const std::string& text = matrix_market_text<N>();
+        auto m = make_random<double, N>();
+        for (auto _ : state)
+        {
+            lal::parse_matrix_market(text, *m);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, static_cast<double>(text.size()));
+    }
+
+    template <std::size_t N>
+    void BM_parse_matrix_market_iostream(benchmark::State& state)
+    {
+        const std::string& text = matrix_market_text<N>();
+        auto m = make_random<double, N>();
+        for (auto _ : state)
+        {
+            std::istringstream in{ text };
+            std::string banner;
+            std::getline(in, banner);
+            std::size_t rows = 0u;
+            std::size_t columns = 0u;
+            in >> rows >> columns;
+            for (std::size_t column = 0u; column < columns; ++column)
+                for (std::size_t row = 0u; row < rows; ++row)
+                    in >> (*m)[row][column];
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, static_cast<double>(text.size()));
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_save, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_save, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_load, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_load, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_load, 8192)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_load_iostream_elements, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_load_iostream_elements, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_map_matrix, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_map_matrix, 4096)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_map_matrix, 8192)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_map_matrix_unverified, 1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_map_matrix_unverified, 8192)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_load_npy, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_load_npy, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_map_npy, 1024)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_parse_csv, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_parse_csv, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_parse_csv_iostream, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_parse_csv_iostream, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_parse_matrix_market, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_parse_matrix_market, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_parse_matrix_market_iostream, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_parse_matrix_market_iostream, 1024)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,113 @@
+#include "bench_common.hpp"
+
+#include "kronecker.hpp"
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <memory>
+
+// Outer products against the column by row product, and (A kron B) * x for N x N
+// factors three ways: against A kron B stored ahead of time, building it on every
+// call, and with the lazy product which never forms it
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <std::size_t N>
+    void BM_outer(benchmark::State& state)
+    {
+        const auto u = make_random<float, N, 1>();
+        const auto v = make_random<float, 1, N>();
+        for (auto _ : state)
+        {
+            const auto uv = lal::outer(*u, *v);
+            benchmark::DoNotOptimize(uv.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, static_cast<double>(N * N), sizeof(float) * (2.0 * N + N * N));
+    }
+
+    template <std::size_t N>
+    void BM_outer_as_product(benchmark::State& state)
+    {
+        const auto u = make_random<float, N, 1>();
+        const auto v = make_random<float, 1, N>();
+        for (auto _ : state)
+        {
+            const auto uv = *u * *v;
+            benchmark::DoNotOptimize(uv.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, static_cast<double>(N * N), sizeof(float) * (2.0 * N + N * N));
+    }
+
+    template <std::size_t N>
+    void BM_kron_vector_stored(benchmark::State& state)
+    {
+        const auto a = make_random<float, N, N>();
+        const auto b = make_random<float, N, N>();
+        const auto x = make_random<float, N * N, 1>();
+        auto ab = std::make_unique<lal::matrix<float, N * N, N * N>>();
+        lal::kron(*a, *b, *ab);
+        for (auto _ : state)
+        {
+            const auto y = *ab * *x;
+            benchmark::DoNotOptimize(y.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N * N, sizeof(float) * N * N * (N * N + 2.0));
+    }
+
+    template <std::size_t N>
+    void BM_kron_vector_materialized(benchmark::State& state)
+    {
+        const auto a = make_random<float, N, N>();
+        const auto b = make_random<float, N, N>();
+        const auto x = make_random<float, N * N, 1>();
+        auto ab = std::make_unique<lal::matrix<float, N * N, N * N>>();
+        for (auto _ : state)
+        {
+            lal::kron(*a, *b, *ab);
+            const auto y = *ab * *x;
+            benchmark::DoNotOptimize(y.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 3.0 * N * N * N * N, sizeof(float) * N * N * (3.0 * N * N + 2.0));
+    }
+
+    template <std::size_t N>
+    void BM_kron_vector_lazy(benchmark::State& state)
+    {
+        const auto a = make_random<float, N, N>();
+        const auto b = make_random<float, N, N>();
+        const auto x = make_random<float, N * N, 1>();
+        const auto ab = lal::kronecker(*a, *b);
+        for (auto _ : state)
+        {
+            const auto y = ab * *x;
+            benchmark::DoNotOptimize(y.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 4.0 * N * N * N, sizeof(float) * (2.0 * N * N + 2.0 * N * N));
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_outer, 64);
+BENCHMARK_TEMPLATE(BM_outer, 128);
+BENCHMARK_TEMPLATE(BM_outer_as_product, 64);
+BENCHMARK_TEMPLATE(BM_outer_as_product, 128);
+BENCHMARK_TEMPLATE(BM_kron_vector_stored, 8);
+BENCHMARK_TEMPLATE(BM_kron_vector_stored, 16);
+BENCHMARK_TEMPLATE(BM_kron_vector_stored, 32);
+BENCHMARK_TEMPLATE(BM_kron_vector_materialized, 8);
+BENCHMARK_TEMPLATE(BM_kron_vector_materialized, 16);
+BENCHMARK_TEMPLATE(BM_kron_vector_materialized, 32);
+BENCHMARK_TEMPLATE(BM_kron_vector_lazy, 8);
+BENCHMARK_TEMPLATE(BM_kron_vector_lazy, 16);
+BENCHMARK_TEMPLATE(BM_kron_vector_lazy, 32);
@@ -0,0 +1,323 @@
+#include "bench_common.hpp"
+
+#include "matrix.hpp"
+
+#include <cmath>
+
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <typename T, std::size_t N>
+    constexpr double matrix_bytes = static_cast<double>(N * N * sizeof(T));
+
+    // Construction and assignment
+    template <typename T, std::size_t N>
+    void BM_copy_assignment(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *b = *a;
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_fill(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        for (auto _ : state)
+        {
+            a->fill(T{ 3 });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_swap(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            a->swap(*b);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, 4.0 * matrix_bytes<T, N>);
+    }
+
+    // Elementwise operators returning new matrices
+    template <typename T, std::size_t N>
+    void BM_addition(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*a + *b);
+
+        set_throughput(state, N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_subtraction(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*a - *b);
+
+        set_throughput(state, N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_hadamard(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*a % *b);
+
+        set_throughput(state, N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_scalar_multiplication(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(T{ 3 } * *a);
+
+        set_throughput(state, N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_scalar_division(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*a / T{ 3 });
+
+        set_throughput(state, N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_unary_minus(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(-*a);
+
+        set_throughput(state, N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    // Compound assignment operators
+    template <typename T, std::size_t N>
+    void BM_addition_assignment(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *a += *b;
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_subtraction_assignment(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *a -= *b;
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_hadamard_assignment(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *a %= *b;
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_scalar_multiplication_assignment(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *a *= T{ 1 };
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_scalar_division_assignment(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *a /= T{ 1 };
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    // Matrix products
+    template <typename T, std::size_t N>
+    void BM_multiplication(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*a * *b);
+
+        set_throughput(state, 2.0 * N * N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_multiplication_assignment(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *a *= *b;
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, 3.0 * matrix_bytes<T, N>);
+    }
+
+    // Comparison
+    template <typename T, std::size_t N>
+    void BM_equality(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = std::make_unique<lal::matrix<T, N, N>>(*a);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*a == *b);
+
+        set_throughput(state, N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    // Common matrix operations
+    template <typename T, std::size_t N>
+    void BM_transpose(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::transpose(*a));
+
+        set_throughput(state, 0.0, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_magnitude(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::magnitude(*a));
+
+        set_throughput(state, 2.0 * N * N, matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_map(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::map(*a, [](const T x) { return std::tanh(x); }));
+
+        set_throughput(state, N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T>
+    void BM_make_diagonal(benchmark::State& state)
+    {
+        T x = T{ 1 };
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(lal::make_diagonal(x, x, x, x));
+        }
+    }
+}
+
+LAL_BENCH_HEAP_SIZES(BM_copy_assignment, float);
+LAL_BENCH_HEAP_SIZES(BM_copy_assignment, double);
+LAL_BENCH_HEAP_SIZES(BM_fill, float);
+LAL_BENCH_HEAP_SIZES(BM_fill, double);
+LAL_BENCH_HEAP_SIZES(BM_swap, float);
+LAL_BENCH_HEAP_SIZES(BM_swap, double);
+
+LAL_BENCH_STACK_SIZES(BM_addition, float);
+LAL_BENCH_STACK_SIZES(BM_addition, double);
+LAL_BENCH_STACK_SIZES(BM_addition, int);
+LAL_BENCH_STACK_SIZES(BM_subtraction, float);
+LAL_BENCH_STACK_SIZES(BM_subtraction, double);
+LAL_BENCH_STACK_SIZES(BM_hadamard, float);
+LAL_BENCH_STACK_SIZES(BM_hadamard, double);
+LAL_BENCH_STACK_SIZES(BM_hadamard, int);
+LAL_BENCH_STACK_SIZES(BM_scalar_multiplication, float);
+LAL_BENCH_STACK_SIZES(BM_scalar_multiplication, double);
+LAL_BENCH_STACK_SIZES(BM_scalar_division, float);
+LAL_BENCH_STACK_SIZES(BM_scalar_division, double);
+LAL_BENCH_STACK_SIZES(BM_unary_minus, float);
+LAL_BENCH_STACK_SIZES(BM_unary_minus, double);
+
+LAL_BENCH_HEAP_SIZES(BM_addition_assignment, float);
+LAL_BENCH_HEAP_SIZES(BM_addition_assignment, double);
+LAL_BENCH_HEAP_SIZES(BM_subtraction_assignment, float);
+LAL_BENCH_HEAP_SIZES(BM_subtraction_assignment, double);
+LAL_BENCH_HEAP_SIZES(BM_hadamard_assignment, float);
+LAL_BENCH_HEAP_SIZES(BM_hadamard_assignment, double);
+LAL_BENCH_HEAP_SIZES(BM_scalar_multiplication_assignment, float);
+LAL_BENCH_HEAP_SIZES(BM_scalar_multiplication_assignment, double);
+LAL_BENCH_HEAP_SIZES(BM_scalar_division_assignment, float);
+LAL_BENCH_HEAP_SIZES(BM_scalar_division_assignment, double);
+
+LAL_BENCH_STACK_SIZES(BM_multiplication, float);
+LAL_BENCH_STACK_SIZES(BM_multiplication, double);
+LAL_BENCH_STACK_SIZES(BM_multiplication, int);
+LAL_BENCH_STACK_SIZES(BM_multiplication_assignment, float);
+LAL_BENCH_STACK_SIZES(BM_multiplication_assignment, double);
+BENCHMARK_TEMPLATE(BM_multiplication_assignment, float, 256);
+BENCHMARK_TEMPLATE(BM_multiplication_assignment, float, 512);
+BENCHMARK_TEMPLATE(BM_multiplication_assignment, float, 1024)->Unit(benchmark::kMillisecond);
+
+LAL_BENCH_HEAP_SIZES(BM_equality, float);
+LAL_BENCH_HEAP_SIZES(BM_equality, double);
+
+LAL_BENCH_STACK_SIZES(BM_transpose, float);
+LAL_BENCH_STACK_SIZES(BM_transpose, double);
+LAL_BENCH_STACK_SIZES(BM_magnitude, float);
+LAL_BENCH_STACK_SIZES(BM_magnitude, double);
+LAL_BENCH_STACK_SIZES(BM_map, float);
+LAL_BENCH_STACK_SIZES(BM_map, double);
+BENCHMARK_TEMPLATE(BM_make_diagonal, float);
+BENCHMARK_TEMPLATE(BM_make_diagonal, double);
@@ -0,0 +1,192 @@
+#include "bench_common.hpp"
+
+#include "matrix.hpp"
+#include "nn.hpp"
+
+#include <cstddef>
+#include <memory>
+
+// Each layer at the sizes of a Tetris network, a batch of 32 boards of 20x10 cells,
+// with the convolutions also run as plain nested loops for comparison
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    constexpr std::size_t batch = 32u;
+
+    template <std::size_t Channels>
+    using board = lal::nn::shape<Channels, 20, 10>;
+
+    template <std::size_t Channels, std::size_t Filters>
+    using conv = lal::nn::conv2d<float, board<Channels>, Filters, 3>;
+
+    template <std::size_t Channels, std::size_t Filters>
+    constexpr double conv_flops = 2.0 * batch * Filters * Channels * 9.0 * 200.0;
+
+    template <std::size_t Channels, std::size_t Filters>
+    std::unique_ptr<conv<Channels, Filters>> make_conv()
+    {
+        auto layer = std::make_unique<conv<Channels, Filters>>();
+        layer->weights() = *make_random<float, Filters, Channels * 9>();
+        return layer;
+    }
+
+    template <std::size_t Channels, std::size_t Filters>
+    void BM_conv_direct(benchmark::State& state)
+    {
+        const auto layer = make_conv<Channels, Filters>();
+        const auto x = make_random<float, batch, board<Channels>::size>();
+        const auto y = std::make_unique<lal::nn::batch<float, batch, board<Filters>>>();
+        const auto& w = layer->weights();
+        for (auto _ : state)
+        {
+            for (std::size_t sample = 0u; sample < batch; ++sample)
+            {
+                for (std::size_t filter = 0u; filter < Filters; ++filter)
+                {
+                    for (std::size_t oy = 0u; oy < 20u; ++oy)
+                    {
+                        for (std::size_t ox = 0u; ox < 10u; ++ox)
+                        {
+                            float sum = layer->bias()[filter][0];
+                            for (std::size_t channel = 0u; channel < Channels; ++channel)
+                                for (std::size_t ki = 0u; ki < 3u; ++ki)
+                                    for (std::size_t kj = 0u; kj < 3u; ++kj)
+                                        if (oy + ki >= 1u && oy + ki <= 20u && ox + kj >= 1u && ox + kj <= 10u)
+                                            sum += w[filter][(channel * 3u + ki) * 3u + kj] *
+                                                   (*x)[sample][(channel * 20u + oy + ki - 1u) * 10u + ox + kj - 1u];
+
+                            (*y)[sample][(filter * 20u + oy) * 10u + ox] = sum;
+                        }
+                    }
+                }
+            }
+
+            benchmark::DoNotOptimize(y->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, conv_flops<Channels, Filters>, 0.0);
+    }
+
+    template <std::size_t Channels, std::size_t Filters, lal::nn::convolution Algorithm>
+    void BM_conv_forward(benchmark::State& state)
+    {
+        const auto layer = make_conv<Channels, Filters>();
+        const auto x = make_random<float, batch, board<Channels>::size>();
+        const auto y = std::make_unique<lal::nn::batch<float, batch, board<Filters>>>();
+        for (auto _ : state)
+        {
+            layer->template forward<Algorithm>(*x, *y);
+            benchmark::DoNotOptimize(y->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, conv_flops<Channels, Filters>, 0.0);
+    }
+
+    template <std::size_t Channels, std::size_t Filters>
+    void BM_conv_backward(benchmark::State& state)
+    {
+        const auto layer = make_conv<Channels, Filters>();
+        const auto x = make_random<float, batch, board<Channels>::size>();
+        const auto dy = make_random<float, batch, board<Filters>::size>();
+        const auto dx = std::make_unique<lal::nn::batch<float, batch, board<Channels>>>();
+        for (auto _ : state)
+        {
+            layer->backward(*x, *dy, *dx);
+            benchmark::DoNotOptimize(dx->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * conv_flops<Channels, Filters>, 0.0);
+    }
+
+    template <std::size_t Inputs, std::size_t Outputs>
+    void BM_dense_forward(benchmark::State& state)
+    {
+        const auto layer = std::make_unique<lal::nn::dense<float, Inputs, Outputs>>();
+        layer->weights() = *make_random<float, Inputs, Outputs>();
+        const auto x = make_random<float, batch, Inputs>();
+        const auto y = std::make_unique<lal::matrix<float, batch, Outputs>>();
+        for (auto _ : state)
+        {
+            layer->forward(*x, *y);
+            benchmark::DoNotOptimize(y->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * batch * Inputs * Outputs, 0.0);
+    }
+
+    template <std::size_t Inputs, std::size_t Outputs>
+    void BM_dense_backward(benchmark::State& state)
+    {
+        const auto layer = std::make_unique<lal::nn::dense<float, Inputs, Outputs>>();
+        layer->weights() = *make_random<float, Inputs, Outputs>();
+        const auto x = make_random<float, batch, Inputs>();
+        const auto dy = make_random<float, batch, Outputs>();
+        const auto dx = std::make_unique<lal::matrix<float, batch, Inputs>>();
+        for (auto _ : state)
+        {
+            layer->backward(*x, *dy, *dx);
+            benchmark::DoNotOptimize(dx->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 4.0 * batch * Inputs * Outputs, 0.0);
+    }
+
+    template <typename Pool>
+    void BM_pool_forward(benchmark::State& state)
+    {
+        const Pool pool{};
+        const auto x = make_random<float, batch, Pool::input_shape::size>();
+        const auto y = std::make_unique<lal::nn::batch<float, batch, typename Pool::output_shape>>();
+        for (auto _ : state)
+        {
+            pool.forward(*x, *y);
+            benchmark::DoNotOptimize(y->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, sizeof(float) * batch * (Pool::input_shape::size + Pool::output_shape::size));
+    }
+
+    template <std::size_t Classes>
+    void BM_softmax_cross_entropy(benchmark::State& state)
+    {
+        const auto logits = make_random<float, batch, Classes>();
+        lal::matrix<float, batch, Classes> targets{};
+        for (std::size_t sample = 0u; sample < batch; ++sample)
+            targets[sample][sample % Classes] = 1.0f;
+
+        lal::matrix<float, batch, Classes> probabilities{};
+        lal::matrix<float, batch, Classes> dlogits{};
+        for (auto _ : state)
+        {
+            lal::nn::softmax(*logits, probabilities);
+            benchmark::DoNotOptimize(lal::nn::cross_entropy(probabilities, targets));
+            lal::nn::softmax_cross_entropy_backward(probabilities, targets, dlogits);
+            benchmark::DoNotOptimize(dlogits.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, 3.0 * sizeof(float) * batch * Classes);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_conv_direct, 1, 16);
+BENCHMARK_TEMPLATE(BM_conv_forward, 1, 16, lal::nn::convolution::im2col);
+BENCHMARK_TEMPLATE(BM_conv_forward, 1, 16, lal::nn::convolution::winograd);
+BENCHMARK_TEMPLATE(BM_conv_backward, 1, 16);
+BENCHMARK_TEMPLATE(BM_conv_direct, 16, 32);
+BENCHMARK_TEMPLATE(BM_conv_forward, 16, 32, lal::nn::convolution::im2col);
+BENCHMARK_TEMPLATE(BM_conv_forward, 16, 32, lal::nn::convolution::winograd);
+BENCHMARK_TEMPLATE(BM_conv_backward, 16, 32);
+BENCHMARK_TEMPLATE(BM_dense_forward, 200, 256);
+BENCHMARK_TEMPLATE(BM_dense_backward, 200, 256);
+BENCHMARK_TEMPLATE(BM_pool_forward, lal::nn::max_pool2d<float, board<16>, 2>);
+BENCHMARK_TEMPLATE(BM_pool_forward, lal::nn::avg_pool2d<float, board<16>, 2>);
+BENCHMARK_TEMPLATE(BM_softmax_cross_entropy, 40);
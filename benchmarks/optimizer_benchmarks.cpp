@@ -0,0 +1,194 @@
+#include "bench_common.hpp"
+
+#include "optimizer.hpp"
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <cmath>
+
+// One optimizer step over every parameter of the Tetris network (two 3x3
+// convolutions and three dense layers, about 140k parameters), composed from the
+// elementwise operators as the training loop used to do it and fused
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <std::size_t Rows, std::size_t Columns>
+    struct parameter
+    {
+        parameter() : w{ *make_random<float, Rows, Columns>() }, g{ *make_random<float, Rows, Columns>() } {}
+
+        lal::matrix<float, Rows, Columns> w;
+        lal::matrix<float, Rows, Columns> g;
+        lal::matrix<float, Rows, Columns> m{};
+        lal::matrix<float, Rows, Columns> v{};
+    };
+
+    class model
+    {
+    public:
+        template <typename Function>
+        void for_each(const Function& f)
+        {
+            std::apply([&f](const auto&... p) { (f(*p), ...); }, parameters_);
+        }
+
+        lal::gradient_clipping<float> clip_by_norm(const float max_norm) const
+        {
+            return std::apply([max_norm](const auto&... p) { return lal::clip_by_norm(max_norm, p->g...); }, parameters_);
+        }
+
+        static constexpr double size = 16.0 * 10.0 + 32.0 * 145.0 + 201.0 * 256.0 + 257.0 * 256.0 + 257.0 * 40.0;
+
+    private:
+        std::tuple<std::unique_ptr<parameter<16, 9>>, std::unique_ptr<parameter<16, 1>>, std::unique_ptr<parameter<32, 144>>,
+                   std::unique_ptr<parameter<32, 1>>, std::unique_ptr<parameter<200, 256>>, std::unique_ptr<parameter<1, 256>>,
+                   std::unique_ptr<parameter<256, 256>>, std::unique_ptr<parameter<1, 256>>, std::unique_ptr<parameter<256, 40>>,
+                   std::unique_ptr<parameter<1, 40>>>
+            parameters_{ std::make_unique<parameter<16, 9>>(),    std::make_unique<parameter<16, 1>>(),
+                         std::make_unique<parameter<32, 144>>(),  std::make_unique<parameter<32, 1>>(),
+                         std::make_unique<parameter<200, 256>>(), std::make_unique<parameter<1, 256>>(),
+                         std::make_unique<parameter<256, 256>>(), std::make_unique<parameter<1, 256>>(),
+                         std::make_unique<parameter<256, 40>>(),  std::make_unique<parameter<1, 40>>() };
+    };
+
+    // Reads weights, gradients and each state matrix and writes back all but the gradients
+    constexpr double update_bytes(const std::size_t state) { return sizeof(float) * model::size * (3.0 + 2.0 * state); }
+
+    void BM_sgd_momentum_composed(benchmark::State& state)
+    {
+        model network;
+        const lal::sgd_momentum<float> sgd{};
+        for (auto _ : state)
+        {
+            network.for_each([&sgd](auto& p) {
+                p.m = p.m * sgd.momentum + p.g;
+                p.w -= p.m * sgd.learning_rate;
+            });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(1u));
+    }
+
+    void BM_sgd_momentum_fused(benchmark::State& state)
+    {
+        model network;
+        const lal::sgd_momentum<float> sgd{};
+        for (auto _ : state)
+        {
+            network.for_each([&sgd](auto& p) { sgd.update(p.w, p.g, p.m); });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(1u));
+    }
+
+    void BM_adam_composed(benchmark::State& state)
+    {
+        model network;
+        lal::adam<float> adam{};
+        for (auto _ : state)
+        {
+            adam.next_step();
+            const float t = static_cast<float>(adam.step);
+            const float c1 = 1.0f - std::pow(adam.beta1, t);
+            const float c2 = 1.0f - std::pow(adam.beta2, t);
+            network.for_each([&adam, c1, c2](auto& p) {
+                p.m = p.m * adam.beta1 + p.g * (1.0f - adam.beta1);
+                p.v = p.v * adam.beta2 + (p.g % p.g) * (1.0f - adam.beta2);
+                const auto denominator = lal::map(p.v, [c2, e = adam.epsilon](const float x) { return 1.0f / (std::sqrt(x / c2) + e); });
+                p.w -= (p.m * (adam.learning_rate / c1)) % denominator;
+            });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(2u));
+    }
+
+    void BM_adam_fused(benchmark::State& state)
+    {
+        model network;
+        lal::adam<float> adam{};
+        for (auto _ : state)
+        {
+            adam.next_step();
+            network.for_each([&adam](auto& p) { adam.update(p.w, p.g, p.m, p.v); });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(2u));
+    }
+
+    void BM_adam_fused_parallel(benchmark::State& state)
+    {
+        model network;
+        lal::adam<float> adam{};
+        for (auto _ : state)
+        {
+            adam.next_step();
+            network.for_each([&adam](auto& p) { adam.update(lal::par, p.w, p.g, p.m, p.v); });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(2u));
+    }
+
+    // Clipping by norm costs a read of every gradient first
+    void BM_adam_fused_clipped(benchmark::State& state)
+    {
+        model network;
+        lal::adam<float> adam{};
+        for (auto _ : state)
+        {
+            adam.next_step();
+            const auto clipping = network.clip_by_norm(1.0f);
+            network.for_each([&adam, &clipping](auto& p) { adam.update(p.w, p.g, p.m, p.v, clipping); });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(2u) + sizeof(float) * model::size);
+    }
+
+    void BM_rmsprop_composed(benchmark::State& state)
+    {
+        model network;
+        const lal::rmsprop<float> rmsprop{};
+        for (auto _ : state)
+        {
+            network.for_each([&rmsprop](auto& p) {
+                p.m = p.m * rmsprop.decay + (p.g % p.g) * (1.0f - rmsprop.decay);
+                const auto denominator = lal::map(p.m, [e = rmsprop.epsilon](const float x) { return 1.0f / (std::sqrt(x) + e); });
+                p.w -= (p.g * rmsprop.learning_rate) % denominator;
+            });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(1u));
+    }
+
+    void BM_rmsprop_fused(benchmark::State& state)
+    {
+        model network;
+        const lal::rmsprop<float> rmsprop{};
+        for (auto _ : state)
+        {
+            network.for_each([&rmsprop](auto& p) { rmsprop.update(p.w, p.g, p.m); });
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, update_bytes(1u));
+    }
+}
+
+BENCHMARK(BM_sgd_momentum_composed);
+BENCHMARK(BM_sgd_momentum_fused);
+BENCHMARK(BM_adam_composed);
+BENCHMARK(BM_adam_fused);
+BENCHMARK(BM_adam_fused_parallel)->UseRealTime();
+BENCHMARK(BM_adam_fused_clipped);
+BENCHMARK(BM_rmsprop_composed);
+BENCHMARK(BM_rmsprop_fused);
@@ -0,0 +1,146 @@
+#include "bench_common.hpp"
+
+#include "parallel.hpp"
+#include "matrix.hpp"
+
+#include <execution>
+#include <numeric>
+#include <cstddef>
+#include <cmath>
+
+// Scaling of the parallel overloads with the number of threads in the pool, the
+// argument is the thread count and 0 runs the sequential operation for comparison.
+// map stays at 512 as the sequential map returns its result on the stack
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <std::size_t N>
+    constexpr double matrix_bytes = static_cast<double>(N * N * sizeof(float));
+
+    template <std::size_t N>
+    void BM_parallel_add(benchmark::State& state)
+    {
+        const std::size_t threads = static_cast<std::size_t>(state.range(0));
+        lal::thread_pool pool{ threads };
+        auto a = make_random<float, N>();
+        const auto b = make_random<float, N>();
+        for (auto _ : state)
+        {
+            if (threads == 0u)
+                *a += *b;
+            else
+                lal::add_assign(lal::par.on(pool), *a, *b);
+            benchmark::DoNotOptimize(a->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, static_cast<double>(N * N), 3.0 * matrix_bytes<N>);
+    }
+
+    template <std::size_t N>
+    void BM_parallel_map(benchmark::State& state)
+    {
+        const std::size_t threads = static_cast<std::size_t>(state.range(0));
+        lal::thread_pool pool{ threads };
+        const auto a = make_random<float, N>();
+        auto out = make_random<float, N>();
+        const auto f = [](const float x) { return std::exp(x); };
+        for (auto _ : state)
+        {
+            if (threads == 0u)
+                *out = lal::map(*a, f);
+            else
+                lal::map(lal::par.on(pool), *a, f, *out);
+            benchmark::DoNotOptimize(out->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, 2.0 * matrix_bytes<N>);
+    }
+
+    template <std::size_t N>
+    void BM_parallel_sum(benchmark::State& state)
+    {
+        const std::size_t threads = static_cast<std::size_t>(state.range(0));
+        lal::thread_pool pool{ threads };
+        const auto a = make_random<float, N>();
+        for (auto _ : state)
+        {
+            if (threads == 0u)
+                benchmark::DoNotOptimize(lal::sum(*a));
+            else
+                benchmark::DoNotOptimize(lal::sum(lal::par.on(pool), *a));
+        }
+
+        set_throughput(state, static_cast<double>(N * N), matrix_bytes<N>);
+    }
+
+    template <std::size_t N>
+    void BM_parallel_magnitude(benchmark::State& state)
+    {
+        const std::size_t threads = static_cast<std::size_t>(state.range(0));
+        lal::thread_pool pool{ threads };
+        const auto a = make_random<float, N>();
+        for (auto _ : state)
+        {
+            if (threads == 0u)
+                benchmark::DoNotOptimize(lal::magnitude(*a));
+            else
+                benchmark::DoNotOptimize(lal::magnitude(lal::par.on(pool), *a));
+        }
+
+        set_throughput(state, 2.0 * N * N, matrix_bytes<N>);
+    }
+
+    // The C++17 parallel algorithms straight on matrix iterators (run by TBB under
+    // libstdc++) against the sequential std::accumulate
+    template <std::size_t N>
+    void BM_accumulate(benchmark::State& state)
+    {
+        const auto a = make_random<float, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::accumulate(a->begin(), a->end(), 0.0f));
+
+        set_throughput(state, static_cast<double>(N * N), matrix_bytes<N>);
+    }
+
+    template <std::size_t N>
+    void BM_reduce_par_unseq(benchmark::State& state)
+    {
+        const auto a = make_random<float, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::reduce(std::execution::par_unseq, a->begin(), a->end()));
+
+        set_throughput(state, static_cast<double>(N * N), matrix_bytes<N>);
+    }
+
+    template <std::size_t N>
+    void BM_reduce_par_unseq_reverse(benchmark::State& state)
+    {
+        const auto a = make_random<float, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::reduce(std::execution::par_unseq, a->crbegin(), a->crend()));
+
+        set_throughput(state, static_cast<double>(N * N), matrix_bytes<N>);
+    }
+}
+
+#define LAL_BENCH_THREADS(function, N) \
+    BENCHMARK_TEMPLATE(function, N)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()
+
+LAL_BENCH_THREADS(BM_parallel_add, 1024);
+LAL_BENCH_THREADS(BM_parallel_add, 2048);
+LAL_BENCH_THREADS(BM_parallel_map, 512);
+LAL_BENCH_THREADS(BM_parallel_sum, 1024);
+LAL_BENCH_THREADS(BM_parallel_sum, 2048);
+LAL_BENCH_THREADS(BM_parallel_magnitude, 1024);
+LAL_BENCH_THREADS(BM_parallel_magnitude, 2048);
+
+BENCHMARK_TEMPLATE(BM_accumulate, 1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_accumulate, 2048)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_reduce_par_unseq, 1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_reduce_par_unseq, 2048)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_reduce_par_unseq_reverse, 1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_reduce_par_unseq_reverse, 2048)->UseRealTime();
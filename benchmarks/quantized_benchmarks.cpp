@@ -0,0 +1,92 @@
+#include "bench_common.hpp"
+
+#include "quantized.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// int8 qgemm against float operator* for the same product, A * B^T.  Each quantized
+// benchmark reports "relative_error", the largest difference from the float product
+// relative to its largest element.
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <std::size_t N>
+    double relative_error(const lal::square_matrix<float, N>& expected, const lal::square_matrix<float, N>& actual)
+    {
+        double largest = 0.0;
+        double difference = 0.0;
+        for (std::size_t i = 0u; i < expected.size(); ++i)
+        {
+            largest = std::max(largest, static_cast<double>(std::abs(expected.data()[i])));
+            difference = std::max(difference, static_cast<double>(std::abs(expected.data()[i] - actual.data()[i])));
+        }
+
+        return largest > 0.0 ? difference / largest : 0.0;
+    }
+
+    template <std::size_t N>
+    void BM_float_product(benchmark::State& state)
+    {
+        const auto a = make_random<float, N>();
+        const auto bt = std::make_unique<lal::square_matrix<float, N>>(lal::transpose(*make_random<float, N>()));
+        auto c = std::make_unique<lal::square_matrix<float, N>>();
+        for (auto _ : state)
+        {
+            *c = *a * *bt;
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, 3.0 * N * N * sizeof(float));
+    }
+
+    template <lal::quantization Scheme, std::size_t N>
+    void BM_qgemm(benchmark::State& state)
+    {
+        const auto a = make_random<float, N>();
+        const auto b = make_random<float, N>();
+        auto qa = std::make_unique<lal::quantized_matrix<std::int8_t, N, N, Scheme>>();
+        auto qb = std::make_unique<lal::quantized_matrix<std::int8_t, N, N, Scheme>>();
+        lal::quantize(*a, *qa);
+        lal::quantize(*b, *qb);
+        auto c = std::make_unique<lal::square_matrix<float, N>>();
+        for (auto _ : state)
+        {
+            lal::qgemm(*qa, *qb, *c);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, 2.0 * N * N + N * N * sizeof(float));
+        const auto expected = std::make_unique<lal::square_matrix<float, N>>(*a * lal::transpose(*b));
+        state.counters["relative_error"] = relative_error(*expected, *c);
+    }
+
+    template <lal::quantization Scheme, std::size_t N>
+    void BM_quantize(benchmark::State& state)
+    {
+        const auto a = make_random<float, N>();
+        auto q = std::make_unique<lal::quantized_matrix<std::int8_t, N, N, Scheme>>();
+        for (auto _ : state)
+        {
+            lal::quantize(*a, *q);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, static_cast<double>(N * N * (sizeof(float) + 1u)));
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_float_product, 64);
+BENCHMARK_TEMPLATE(BM_qgemm, lal::quantization::symmetric, 64);
+BENCHMARK_TEMPLATE(BM_qgemm, lal::quantization::asymmetric, 64);
+BENCHMARK_TEMPLATE(BM_float_product, 128);
+BENCHMARK_TEMPLATE(BM_qgemm, lal::quantization::symmetric, 128);
+BENCHMARK_TEMPLATE(BM_qgemm, lal::quantization::asymmetric, 128);
+BENCHMARK_TEMPLATE(BM_float_product, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_qgemm, lal::quantization::symmetric, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_qgemm, lal::quantization::asymmetric, 256)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_quantize, lal::quantization::symmetric, 256);
+BENCHMARK_TEMPLATE(BM_quantize, lal::quantization::asymmetric, 256);
@@ -0,0 +1,130 @@
+#include "bench_common.hpp"
+
+#include "reductions.hpp"
+#include "matrix.hpp"
+
+#include <cmath>
+
+// Reductions against magnitude and a plain sequential loop, float sums also report
+// "relative_error" against the same sum taken in double
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <typename T, std::size_t N>
+    constexpr double matrix_bytes = static_cast<double>(N * N * sizeof(T));
+
+    template <typename T, std::size_t N>
+    double relative_error(const lal::square_matrix<T, N>& m, const T sum)
+    {
+        double exact = 0.0;
+        for (const T element : m)
+            exact += static_cast<double>(element);
+
+        return exact != 0.0 ? std::abs((static_cast<double>(sum) - exact) / exact) : 0.0;
+    }
+
+    template <typename T, std::size_t N>
+    void BM_sequential_sum(benchmark::State& state)
+    {
+        const auto m = make_random<T, N>();
+        T sum{};
+        for (auto _ : state)
+        {
+            sum = T{};
+            for (const T element : *m)
+                sum += element;
+            benchmark::DoNotOptimize(sum);
+        }
+
+        set_throughput(state, static_cast<double>(N * N), matrix_bytes<T, N>);
+        state.counters["relative_error"] = relative_error(*m, sum);
+    }
+
+    template <typename T, std::size_t N, lal::summation Mode>
+    void BM_sum(benchmark::State& state)
+    {
+        const auto m = make_random<T, N>();
+        T sum{};
+        for (auto _ : state)
+        {
+            sum = lal::sum<Mode>(*m);
+            benchmark::DoNotOptimize(sum);
+        }
+
+        set_throughput(state, static_cast<double>(N * N), matrix_bytes<T, N>);
+        state.counters["relative_error"] = relative_error(*m, sum);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_dot(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::dot(*a, *b));
+
+        set_throughput(state, 2.0 * N * N, 2.0 * matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_reduction_magnitude(benchmark::State& state)
+    {
+        const auto m = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::magnitude(*m));
+
+        set_throughput(state, 2.0 * N * N, matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_norm2(benchmark::State& state)
+    {
+        const auto m = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::norm2(*m));
+
+        set_throughput(state, 2.0 * N * N, matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_norm_inf(benchmark::State& state)
+    {
+        const auto m = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::norm_inf(*m));
+
+        set_throughput(state, 0.0, matrix_bytes<T, N>);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_argmax(benchmark::State& state)
+    {
+        const auto m = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::argmax(*m));
+
+        set_throughput(state, 0.0, matrix_bytes<T, N>);
+    }
+}
+
+#define LAL_BENCH_REDUCTION_SIZES(function, T) \
+    BENCHMARK_TEMPLATE(function, T, 64); BENCHMARK_TEMPLATE(function, T, 256); BENCHMARK_TEMPLATE(function, T, 1024)
+
+BENCHMARK_TEMPLATE(BM_sequential_sum, float, 64);
+BENCHMARK_TEMPLATE(BM_sequential_sum, float, 256);
+BENCHMARK_TEMPLATE(BM_sequential_sum, float, 1024);
+BENCHMARK_TEMPLATE(BM_sum, float, 64, lal::summation::pairwise);
+BENCHMARK_TEMPLATE(BM_sum, float, 256, lal::summation::pairwise);
+BENCHMARK_TEMPLATE(BM_sum, float, 1024, lal::summation::pairwise);
+BENCHMARK_TEMPLATE(BM_sum, float, 64, lal::summation::compensated);
+BENCHMARK_TEMPLATE(BM_sum, float, 256, lal::summation::compensated);
+BENCHMARK_TEMPLATE(BM_sum, float, 1024, lal::summation::compensated);
+LAL_BENCH_REDUCTION_SIZES(BM_dot, float);
+LAL_BENCH_REDUCTION_SIZES(BM_reduction_magnitude, float);
+LAL_BENCH_REDUCTION_SIZES(BM_norm2, float);
+LAL_BENCH_REDUCTION_SIZES(BM_reduction_magnitude, double);
+LAL_BENCH_REDUCTION_SIZES(BM_norm2, double);
+LAL_BENCH_REDUCTION_SIZES(BM_norm_inf, float);
+LAL_BENCH_REDUCTION_SIZES(BM_argmax, float);
@@ -0,0 +1,137 @@
+#include "bench_common.hpp"
+
+#include "matrix.hpp"
+
+// Fully unrolled kernels against the loops used for larger sizes, at every size
+// which is unrolled.  Timings are per operation so the console output reads as ns/op.
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    template <typename T, std::size_t N>
+    void BM_small_multiplication(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(*a * *b);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, 0.0);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_small_multiplication_looped(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            lal::square_matrix<T, N> c{};
+            lal::detail::looped_product(c, *a, *b);
+            benchmark::DoNotOptimize(c);
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 2.0 * N * N * N, 0.0);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_small_transpose(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(lal::transpose(*a));
+            benchmark::ClobberMemory();
+        }
+    }
+
+    template <typename T, std::size_t N>
+    void BM_small_transpose_looped(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        for (auto _ : state)
+        {
+            lal::square_matrix<T, N> c{};
+            for (std::size_t row = 0u; row < N; ++row)
+                for (std::size_t column = 0u; column < N; ++column)
+                    c[column][row] = (*a)[row][column];
+            benchmark::DoNotOptimize(c);
+            benchmark::ClobberMemory();
+        }
+    }
+
+    template <typename T, std::size_t N>
+    void BM_small_addition_assignment(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            *a += *b;
+            benchmark::ClobberMemory();
+        }
+    }
+
+    template <typename T, std::size_t N>
+    void BM_small_addition_assignment_looped(benchmark::State& state)
+    {
+        auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            auto r = b->begin();
+            for (auto l = a->begin(); l != a->end(); ++l, ++r)
+                *l += *r;
+            benchmark::ClobberMemory();
+        }
+    }
+
+    template <typename T, std::size_t N>
+    void BM_small_dot(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+            benchmark::DoNotOptimize(lal::dot(*a, *b));
+
+        set_throughput(state, 2.0 * N * N, 0.0);
+    }
+
+    template <typename T, std::size_t N>
+    void BM_small_dot_looped(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        for (auto _ : state)
+        {
+            T sum{};
+            for (std::size_t row = 0u; row < N; ++row)
+                for (std::size_t column = 0u; column < N; ++column)
+                    sum += (*a)[row][column] * (*b)[row][column];
+            benchmark::DoNotOptimize(sum);
+        }
+
+        set_throughput(state, 2.0 * N * N, 0.0);
+    }
+}
+
+#define LAL_BENCH_SMALL_SIZES(function, T)                                                                      \
+    BENCHMARK_TEMPLATE(function, T, 2); BENCHMARK_TEMPLATE(function, T, 3); BENCHMARK_TEMPLATE(function, T, 4); \
+    BENCHMARK_TEMPLATE(function, T, 5); BENCHMARK_TEMPLATE(function, T, 6); BENCHMARK_TEMPLATE(function, T, 7); \
+    BENCHMARK_TEMPLATE(function, T, 8)
+
+LAL_BENCH_SMALL_SIZES(BM_small_multiplication, float);
+LAL_BENCH_SMALL_SIZES(BM_small_multiplication_looped, float);
+LAL_BENCH_SMALL_SIZES(BM_small_multiplication, double);
+LAL_BENCH_SMALL_SIZES(BM_small_multiplication_looped, double);
+LAL_BENCH_SMALL_SIZES(BM_small_transpose, float);
+LAL_BENCH_SMALL_SIZES(BM_small_transpose_looped, float);
+LAL_BENCH_SMALL_SIZES(BM_small_addition_assignment, float);
+LAL_BENCH_SMALL_SIZES(BM_small_addition_assignment_looped, float);
+LAL_BENCH_SMALL_SIZES(BM_small_dot, float);
+LAL_BENCH_SMALL_SIZES(BM_small_dot_looped, float);
@@ -0,0 +1,98 @@
+#include "bench_common.hpp"
+
+#include "softmax.hpp"
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <numeric>
+#include <cmath>
+
+// Softmax over batches of 32 sets of logits (40 is about the number of placements a
+// Tetris piece has) against composing it from map, a sum and a divide, which is how
+// the policy head used to do it
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    constexpr std::size_t batch = 32u;
+
+    template <std::size_t N>
+    void BM_softmax_composition(benchmark::State& state)
+    {
+        const auto logits = make_random<float, batch, N>();
+        lal::matrix<float, batch, N> p{};
+        for (auto _ : state)
+        {
+            p = lal::map(*logits, [](const float x) { return std::exp(x); });
+            for (std::size_t row = 0u; row < batch; ++row)
+            {
+                const float sum = std::accumulate(p[row], p[row] + N, 0.0f);
+                for (std::size_t column = 0u; column < N; ++column)
+                    p[row][column] /= sum;
+            }
+
+            benchmark::DoNotOptimize(p.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, 2.0 * sizeof(float) * batch * N);
+    }
+
+    template <std::size_t N, lal::axis Axis>
+    void BM_softmax(benchmark::State& state)
+    {
+        constexpr std::size_t rows = Axis == lal::axis::rows ? batch : N;
+        constexpr std::size_t columns = Axis == lal::axis::rows ? N : batch;
+        const auto logits = make_random<float, rows, columns>();
+        lal::matrix<float, rows, columns> p{};
+        for (auto _ : state)
+        {
+            lal::softmax<Axis>(*logits, p);
+            benchmark::DoNotOptimize(p.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, 2.0 * sizeof(float) * batch * N);
+    }
+
+    template <std::size_t N>
+    void BM_log_softmax(benchmark::State& state)
+    {
+        const auto logits = make_random<float, batch, N>();
+        lal::matrix<float, batch, N> p{};
+        for (auto _ : state)
+        {
+            lal::log_softmax(*logits, p);
+            benchmark::DoNotOptimize(p.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, 2.0 * sizeof(float) * batch * N);
+    }
+
+    template <std::size_t N>
+    void BM_logsumexp(benchmark::State& state)
+    {
+        const auto logits = make_random<float, batch, N>();
+        for (auto _ : state)
+        {
+            const auto lse = lal::logsumexp(*logits);
+            benchmark::DoNotOptimize(lse.data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, 0.0, sizeof(float) * batch * N);
+    }
+}
+
+#define LAL_BENCH_SOFTMAX_SIZE(N)                                    \
+    BENCHMARK_TEMPLATE(BM_softmax_composition, N);                   \
+    BENCHMARK_TEMPLATE(BM_softmax, N, lal::axis::rows);              \
+    BENCHMARK_TEMPLATE(BM_softmax, N, lal::axis::columns);           \
+    BENCHMARK_TEMPLATE(BM_log_softmax, N);                           \
+    BENCHMARK_TEMPLATE(BM_logsumexp, N)
+
+LAL_BENCH_SOFTMAX_SIZE(40);
+LAL_BENCH_SOFTMAX_SIZE(256);
+LAL_BENCH_SOFTMAX_SIZE(1024);
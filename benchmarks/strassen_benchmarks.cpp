@@ -0,0 +1,62 @@
+#include "bench_common.hpp"
+
+#include "strassen.hpp"
+#include "blas.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    // Largest difference from the classic product relative to its largest element
+    template <typename T, std::size_t N>
+    double relative_error(const lal::square_matrix<T, N>& a, const lal::square_matrix<T, N>& b, const lal::square_matrix<T, N>& c)
+    {
+        auto expected = std::make_unique<lal::square_matrix<T, N>>();
+        lal::gemm(T{ 1 }, a, b, T{}, *expected);
+
+        double largest = 0.0;
+        double difference = 0.0;
+        for (std::size_t i = 0u; i < c.size(); ++i)
+        {
+            largest = std::max(largest, static_cast<double>(std::abs(expected->data()[i])));
+            difference = std::max(difference, static_cast<double>(std::abs(expected->data()[i] - c.data()[i])));
+        }
+
+        return largest > 0.0 ? difference / largest : 0.0;
+    }
+
+    // The cutoff is the benchmark argument, comparing timings across cutoffs and
+    // against BM_gemm at the same size gives the crossover
+    template <typename T, std::size_t N>
+    void BM_strassen(benchmark::State& state)
+    {
+        const auto a = make_random<T, N>();
+        const auto b = make_random<T, N>();
+        auto c = make_random<T, N>();
+        lal::strassen_workspace<T, N> workspace;
+        const auto cutoff = static_cast<std::size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            lal::strassen_multiply(*a, *b, *c, workspace, cutoff);
+            benchmark::ClobberMemory();
+        }
+
+        // Classic FLOPs so the rate compares directly with BM_gemm
+        set_throughput(state, 2.0 * N * N * N, 3.0 * N * N * sizeof(T));
+        state.counters["relative_error"] = relative_error(*a, *b, *c);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_strassen, float, 128)->Arg(32)->Arg(64)->Arg(128)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, float, 256)->Arg(32)->Arg(64)->Arg(128)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, float, 512)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, float, 1024)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, float, 2048)->Arg(64)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, float, 4096)->Arg(64)->Arg(128)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, double, 256)->Arg(64)->Arg(128)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, double, 1024)->Arg(64)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_strassen, double, 2048)->Arg(64)->Arg(128)->Unit(benchmark::kMillisecond);
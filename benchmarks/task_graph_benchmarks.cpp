@@ -0,0 +1,133 @@
+#include "bench_common.hpp"
+
+#include "task_graph.hpp"
+#include "thread_pool.hpp"
+#include "parallel.hpp"
+#include "matrix.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <array>
+
+// A frame of a Tetris network's pipeline: four heads over the same batch of 32
+// boards, each a 200->128 layer with ReLU and a 128->64 layer, merged pairwise.
+// Written out as plain statements against the same fifteen operations as a task
+// graph, run serially and on pools of two and four threads.
+using lal_bench::make_random;
+using lal_bench::set_throughput;
+
+namespace
+{
+    constexpr std::size_t batch = 32u;
+    constexpr std::size_t cells = 200u;
+    constexpr std::size_t hidden = 128u;
+    constexpr std::size_t features = 64u;
+    constexpr std::size_t heads = 4u;
+    constexpr double frame_flops = 2.0 * heads * batch * (cells * hidden + hidden * features);
+
+    using boards = lal::matrix<float, batch, cells>;
+    using activations = lal::matrix<float, batch, hidden>;
+    using outputs = lal::matrix<float, batch, features>;
+
+    struct pipeline
+    {
+        std::unique_ptr<boards> x{ make_random<float, batch, cells>() };
+        std::array<std::unique_ptr<lal::matrix<float, cells, hidden>>, heads> w{ make_random<float, cells, hidden>(),
+                                                                                 make_random<float, cells, hidden>(),
+                                                                                 make_random<float, cells, hidden>(),
+                                                                                 make_random<float, cells, hidden>() };
+        std::array<std::unique_ptr<lal::matrix<float, hidden, features>>, heads> v{ make_random<float, hidden, features>(),
+                                                                                    make_random<float, hidden, features>(),
+                                                                                    make_random<float, hidden, features>(),
+                                                                                    make_random<float, hidden, features>() };
+        std::unique_ptr<outputs> y{ std::make_unique<outputs>() };
+    };
+
+    void relu(activations& h)
+    {
+        for (float& element : h)
+            element = std::max(element, 0.0f);
+    }
+
+    void build(lal::task_graph& graph, pipeline& p)
+    {
+        const auto product = [](const auto& a, const auto& b, auto& c) { c = a * b; };
+        const auto x = graph.bind(*p.x);
+        std::array<lal::graph_buffer<outputs>, heads> z{ graph.temporary<float, batch, features>(), graph.temporary<float, batch, features>(),
+                                                         graph.temporary<float, batch, features>(), graph.temporary<float, batch, features>() };
+        for (std::size_t head = 0u; head < heads; ++head)
+        {
+            const auto h = graph.temporary<float, batch, hidden>();
+            graph.add(product, x.read(), graph.bind(std::as_const(*p.w[head])).read(), h.write());
+            graph.add(relu, h.update());
+            graph.add(product, h.read(), graph.bind(std::as_const(*p.v[head])).read(), z[head].write());
+        }
+
+        const auto sum = [](const auto& a, const auto& b, auto& c) { c = a + b; };
+        const auto left = graph.temporary<float, batch, features>();
+        graph.add(sum, z[0].read(), z[1].read(), left.write());
+        graph.add([](auto& a, const auto& b) { a += b; }, z[2].update(), z[3].read());
+        graph.add(sum, left.read(), z[2].read(), graph.bind(*p.y).write());
+    }
+
+    void BM_pipeline_statements(benchmark::State& state)
+    {
+        pipeline p;
+        for (auto _ : state)
+        {
+            std::array<outputs, heads> z;
+            for (std::size_t head = 0u; head < heads; ++head)
+            {
+                activations h = *p.x * *p.w[head];
+                relu(h);
+                z[head] = h * *p.v[head];
+            }
+
+            const outputs left = z[0] + z[1];
+            z[2] += z[3];
+            *p.y = left + z[2];
+            benchmark::DoNotOptimize(p.y->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, frame_flops, 0.0);
+    }
+
+    void BM_pipeline_graph(benchmark::State& state)
+    {
+        pipeline p;
+        lal::task_graph graph;
+        build(graph, p);
+        for (auto _ : state)
+        {
+            graph.run();
+            benchmark::DoNotOptimize(p.y->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, frame_flops, 0.0);
+        state.counters["temporary KiB"] = static_cast<double>(graph.temporary_bytes()) / 1024.0;
+    }
+
+    void BM_pipeline_graph_parallel(benchmark::State& state)
+    {
+        pipeline p;
+        lal::task_graph graph;
+        build(graph, p);
+        lal::thread_pool pool{ static_cast<std::size_t>(state.range(0)) };
+        for (auto _ : state)
+        {
+            graph.run(lal::par.on(pool));
+            benchmark::DoNotOptimize(p.y->data());
+            benchmark::ClobberMemory();
+        }
+
+        set_throughput(state, frame_flops, 0.0);
+    }
+}
+
+BENCHMARK(BM_pipeline_statements);
+BENCHMARK(BM_pipeline_graph);
+BENCHMARK(BM_pipeline_graph_parallel)->Arg(2)->Arg(4)->UseRealTime();
@@ -0,0 +1,427 @@
+#ifndef LAL_BLAS_HPP
+#define LAL_BLAS_HPP
+
+#include "instrumentation.hpp"
+#include "cblas_backend.hpp"
+#include "matrix_view.hpp"
+#include "half.hpp"
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+// BLAS style routines which accumulate into an existing matrix (or view) rather
+// than returning a new one, naming and argument order follow the reference BLAS
+namespace lal
+{
+    enum class transposition { none, transpose };
+    enum class triangle { upper, lower };
+
+    namespace detail
+    {
+        template <typename Matrix>
+        using element_t = typename view_t<std::remove_reference_t<Matrix>>::value_type;
+
+        template <typename T>
+        inline constexpr bool is_nothrow_multiply_add_v = noexcept(std::declval<T&>() += T{} * T{}) &&
+                                                          noexcept(std::declval<T&>() *= T{}) &&
+                                                          std::is_nothrow_assignable_v<T&, T>;
+
+        template <transposition Trans, typename View>
+        inline constexpr std::size_t op_rows_v = Trans == transposition::none ? View::row_count : View::column_count;
+
+        template <transposition Trans, typename View>
+        inline constexpr std::size_t op_columns_v = Trans == transposition::none ? View::column_count : View::row_count;
+
+        template <transposition Trans, typename View>
+        constexpr auto& op_element(const View& v, const std::size_t row, const std::size_t column) noexcept
+        {
+            if constexpr (Trans == transposition::none)
+                return v[row][column];
+            else
+                return v[column][row];
+        }
+
+        template <typename View>
+        inline constexpr bool is_vector_v = View::row_count == 1u || View::column_count == 1u;
+
+        template <typename View>
+        inline constexpr std::size_t vector_size_v = View::row_count * View::column_count;
+
+        template <typename View>
+        constexpr std::size_t vector_increment(const View& v) noexcept
+        {
+            return View::row_count == 1u ? 1u : v.stride();
+        }
+
+        template <typename T, typename... Views>
+        inline constexpr bool all_value_types_are_v = std::conjunction_v<std::is_same<T, typename Views::value_type>...>;
+
+        template <typename View>
+        constexpr auto& vector_element(const View& v, const std::size_t i) noexcept
+        {
+            if constexpr (View::row_count == 1u)
+                return v[0][i];
+            else
+                return v[i][0];
+        }
+
+        // Applies the beta scaling BLAS style, i.e. when beta is zero the
+        // destination is overwritten so that NaNs in it are not propagated
+        template <typename View, typename T>
+        constexpr void scale(const View& v, const T& beta) noexcept(is_nothrow_multiply_add_v<T>)
+        {
+            if (beta == T{ 1 })
+                return;
+
+            for (std::size_t row = 0u; row < View::row_count; ++row)
+                for (std::size_t column = 0u; column < View::column_count; ++column)
+                    if (beta == T{})
+                        v[row][column] = T{};
+                    else
+                        v[row][column] *= beta;
+        }
+
+        // Panel sizes for the blocked gemm loop, chosen so that a panel of B stays in L2
+        inline constexpr std::size_t gemm_depth_block = 256u;
+        inline constexpr std::size_t gemm_column_block = 512u;
+
+        constexpr std::size_t min(const std::size_t a, const std::size_t b) noexcept { return a < b ? a : b; }
+
+        // Dot product of two contiguous runs summed in Accumulator, 16-bit runs go to
+        // the SIMD widening kernels in half.hpp
+        template <typename Accumulator, typename A, typename B>
+        constexpr Accumulator contiguous_dot(const A* const a, const B* const b, const std::size_t n)
+            noexcept(is_nothrow_multiply_add_v<Accumulator>)
+        {
+            if constexpr (std::is_same_v<A, B> && is_reduced_precision_v<A> && std::is_same_v<Accumulator, float>)
+            {
+                if (!is_constant_evaluated())
+                    return widening_dot(a, b, n);
+            }
+
+            Accumulator sum{};
+            for (std::size_t i = 0u; i < n; ++i)
+                sum += a[i] * b[i];
+
+            return sum;
+        }
+    }
+
+    // y = alpha * x + y
+    template <typename MatrixX, typename MatrixY,
+              std::enable_if_t<is_viewable_v<MatrixX> && is_viewable_v<MatrixY>, bool> = true>
+    constexpr void axpy(const detail::element_t<MatrixY> alpha, const MatrixX& x, MatrixY&& y)
+        noexcept(detail::is_nothrow_multiply_add_v<detail::element_t<MatrixY>>)
+    {
+        using view_x = view_t<const std::remove_reference_t<MatrixX>>;
+        using view_y = view_t<std::remove_reference_t<MatrixY>>;
+        static_assert(view_x::row_count == view_y::row_count && view_x::column_count == view_y::column_count,
+                      "axpy requires x and y to have the same dimensions");
+
+        LAL_OPERATION_BEGIN();
+        const view_x vx = make_view(x);
+        const view_y vy = make_view(y);
+        for (std::size_t row = 0u; row < view_y::row_count; ++row)
+            for (std::size_t column = 0u; column < view_y::column_count; ++column)
+                vy[row][column] += alpha * vx[row][column];
+
+        LAL_OPERATION_END(axpy, typename view_y::value_type, view_y::row_count, view_y::column_count, 0u);
+    }
+
+    // C = alpha * op(A) * op(B) + beta * C
+    template <transposition TransA = transposition::none, transposition TransB = transposition::none,
+              typename MatrixA, typename MatrixB, typename MatrixC,
+              std::enable_if_t<is_viewable_v<MatrixA> && is_viewable_v<MatrixB> && is_viewable_v<MatrixC>, bool> = true>
+    constexpr void gemm(const detail::element_t<MatrixC> alpha, const MatrixA& a, const MatrixB& b,
+                        const detail::element_t<MatrixC> beta, MatrixC&& c)
+        noexcept(detail::is_nothrow_multiply_add_v<detail::element_t<MatrixC>>)
+    {
+        using T = detail::element_t<MatrixC>;
+        using view_a = view_t<const std::remove_reference_t<MatrixA>>;
+        using view_b = view_t<const std::remove_reference_t<MatrixB>>;
+        using view_c = view_t<std::remove_reference_t<MatrixC>>;
+
+        constexpr std::size_t M = view_c::row_count;
+        constexpr std::size_t N = view_c::column_count;
+        constexpr std::size_t K = detail::op_columns_v<TransA, view_a>;
+        static_assert(detail::op_rows_v<TransA, view_a> == M, "gemm requires op(A) to have as many rows as C");
+        static_assert(detail::op_columns_v<TransB, view_b> == N, "gemm requires op(B) to have as many columns as C");
+        static_assert(detail::op_rows_v<TransB, view_b> == K, "gemm requires op(A) and op(B) to be conformable");
+
+        LAL_OPERATION_BEGIN();
+        const view_a va = make_view(a);
+        const view_b vb = make_view(b);
+        const view_c vc = make_view(c);
+
+#ifdef LAL_USE_CBLAS
+        if constexpr (detail::use_cblas_v<T, M, N, K> && detail::all_value_types_are_v<T, view_a, view_b>)
+        {
+            if (!detail::is_constant_evaluated())
+            {
+                detail::cblas_gemm(TransA == transposition::transpose, TransB == transposition::transpose, M, N, K,
+                                   alpha, va.data(), va.stride(), vb.data(), vb.stride(), beta, vc.data(), vc.stride());
+                LAL_OPERATION_END(gemm, T, M, N, K);
+                return;
+            }
+        }
+#endif
+
+        detail::scale(vc, beta);
+        if (alpha == T{})
+        {
+            LAL_OPERATION_END(gemm, T, M, N, K);
+            return;
+        }
+
+        if constexpr (TransB == transposition::none && !std::is_same_v<detail::accumulator_t<T>, T>)
+        {
+            // A reduced precision C is accumulated a block of a row at a time in float
+            // and only rounded once every product has been added
+            using accumulator = detail::accumulator_t<T>;
+            for (std::size_t jj = 0u; jj < N; jj += detail::gemm_column_block)
+            {
+                const std::size_t j_end = detail::min(jj + detail::gemm_column_block, N);
+                for (std::size_t i = 0u; i < M; ++i)
+                {
+                    accumulator sums[detail::gemm_column_block]{};
+                    for (std::size_t p = 0u; p < K; ++p)
+                    {
+                        const accumulator scaled_a = alpha * detail::op_element<TransA>(va, i, p);
+                        const auto b_row = vb[p];
+                        for (std::size_t j = jj; j < j_end; ++j)
+                            sums[j - jj] += scaled_a * b_row[j];
+                    }
+
+                    const auto c_row = vc[i];
+                    for (std::size_t j = jj; j < j_end; ++j)
+                        c_row[j] += sums[j - jj];
+                }
+            }
+        }
+        else if constexpr (TransB == transposition::none)
+        {
+            // i-p-j ordering so that the innermost loop runs along rows of B and C
+            for (std::size_t jj = 0u; jj < N; jj += detail::gemm_column_block)
+            {
+                const std::size_t j_end = detail::min(jj + detail::gemm_column_block, N);
+                for (std::size_t pp = 0u; pp < K; pp += detail::gemm_depth_block)
+                {
+                    const std::size_t p_end = detail::min(pp + detail::gemm_depth_block, K);
+                    for (std::size_t i = 0u; i < M; ++i)
+                    {
+                        const auto c_row = vc[i];
+                        for (std::size_t p = pp; p < p_end; ++p)
+                        {
+                            const T scaled_a = alpha * detail::op_element<TransA>(va, i, p);
+                            const auto b_row = vb[p];
+                            for (std::size_t j = jj; j < j_end; ++j)
+                                c_row[j] += scaled_a * b_row[j];
+                        }
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Rows of B are columns of op(B) so each element of C is a contiguous dot product
+            for (std::size_t i = 0u; i < M; ++i)
+            {
+                for (std::size_t j = 0u; j < N; ++j)
+                {
+                    const auto b_row = vb[j];
+                    detail::accumulator_t<T> sum{};
+                    if constexpr (TransA == transposition::none)
+                    {
+                        sum = detail::contiguous_dot<detail::accumulator_t<T>>(va[i], b_row, K);
+                    }
+                    else
+                    {
+                        for (std::size_t p = 0u; p < K; ++p)
+                            sum += detail::op_element<TransA>(va, i, p) * b_row[p];
+                    }
+
+                    vc[i][j] += alpha * sum;
+                }
+            }
+        }
+
+        LAL_OPERATION_END(gemm, T, M, N, K);
+    }
+
+    // y = alpha * op(A) * x + beta * y, where x and y may be row or column vectors
+    template <transposition TransA = transposition::none, typename MatrixA, typename VectorX, typename VectorY,
+              std::enable_if_t<is_viewable_v<MatrixA> && is_viewable_v<VectorX> && is_viewable_v<VectorY>, bool> = true>
+    constexpr void gemv(const detail::element_t<VectorY> alpha, const MatrixA& a, const VectorX& x,
+                        const detail::element_t<VectorY> beta, VectorY&& y)
+        noexcept(detail::is_nothrow_multiply_add_v<detail::element_t<VectorY>>)
+    {
+        using T = detail::element_t<VectorY>;
+        using view_a = view_t<const std::remove_reference_t<MatrixA>>;
+        using view_x = view_t<const std::remove_reference_t<VectorX>>;
+        using view_y = view_t<std::remove_reference_t<VectorY>>;
+
+        constexpr std::size_t M = detail::op_rows_v<TransA, view_a>;
+        constexpr std::size_t N = detail::op_columns_v<TransA, view_a>;
+        static_assert(detail::is_vector_v<view_x> && detail::is_vector_v<view_y>, "gemv requires x and y to be vectors");
+        static_assert(detail::vector_size_v<view_x> == N, "gemv requires x to have as many elements as op(A) has columns");
+        static_assert(detail::vector_size_v<view_y> == M, "gemv requires y to have as many elements as op(A) has rows");
+
+        LAL_OPERATION_BEGIN();
+        const view_a va = make_view(a);
+        const view_x vx = make_view(x);
+        const view_y vy = make_view(y);
+
+#ifdef LAL_USE_CBLAS
+        if constexpr (detail::use_cblas_v<T, M, N, 1u> && detail::all_value_types_are_v<T, view_a, view_x>)
+        {
+            if (!detail::is_constant_evaluated())
+            {
+                detail::cblas_gemv(TransA == transposition::transpose, view_a::row_count, view_a::column_count,
+                                   alpha, va.data(), va.stride(), vx.data(), detail::vector_increment(vx),
+                                   beta, vy.data(), detail::vector_increment(vy));
+                LAL_OPERATION_END(gemv, T, M, N, 0u);
+                return;
+            }
+        }
+#endif
+
+        detail::scale(vy, beta);
+        if (alpha == T{})
+        {
+            LAL_OPERATION_END(gemv, T, M, N, 0u);
+            return;
+        }
+
+        if constexpr (TransA == transposition::none)
+        {
+            for (std::size_t i = 0u; i < M; ++i)
+            {
+                const auto a_row = va[i];
+                detail::accumulator_t<T> sum{};
+                if (detail::vector_increment(vx) == 1u)
+                {
+                    sum = detail::contiguous_dot<detail::accumulator_t<T>>(a_row, &detail::vector_element(vx, 0u), N);
+                }
+                else
+                {
+                    for (std::size_t j = 0u; j < N; ++j)
+                        sum += a_row[j] * detail::vector_element(vx, j);
+                }
+
+                detail::vector_element(vy, i) += alpha * sum;
+            }
+        }
+        else
+        {
+            // Accumulate scaled rows of A so that A is still read contiguously, a reduced
+            // precision y is accumulated a block at a time in float
+            using accumulator = detail::accumulator_t<T>;
+            constexpr std::size_t block = std::is_same_v<accumulator, T> ? M : detail::min(M, detail::gemm_column_block);
+            for (std::size_t ii = 0u; ii < M; ii += block)
+            {
+                const std::size_t i_end = detail::min(ii + block, M);
+                if constexpr (std::is_same_v<accumulator, T>)
+                {
+                    for (std::size_t j = 0u; j < N; ++j)
+                    {
+                        const auto a_row = va[j];
+                        const T scaled_x = alpha * detail::vector_element(vx, j);
+                        for (std::size_t i = ii; i < i_end; ++i)
+                            detail::vector_element(vy, i) += scaled_x * a_row[i];
+                    }
+                }
+                else
+                {
+                    accumulator sums[block]{};
+                    for (std::size_t j = 0u; j < N; ++j)
+                    {
+                        const auto a_row = va[j];
+                        const accumulator scaled_x = alpha * detail::vector_element(vx, j);
+                        for (std::size_t i = ii; i < i_end; ++i)
+                            sums[i - ii] += scaled_x * a_row[i];
+                    }
+
+                    for (std::size_t i = ii; i < i_end; ++i)
+                        detail::vector_element(vy, i) += sums[i - ii];
+                }
+            }
+        }
+
+        LAL_OPERATION_END(gemv, T, M, N, 0u);
+    }
+
+    // A = alpha * x * transpose(y) + A
+    template <typename VectorX, typename VectorY, typename MatrixA,
+              std::enable_if_t<is_viewable_v<VectorX> && is_viewable_v<VectorY> && is_viewable_v<MatrixA>, bool> = true>
+    constexpr void ger(const detail::element_t<MatrixA> alpha, const VectorX& x, const VectorY& y, MatrixA&& a)
+        noexcept(detail::is_nothrow_multiply_add_v<detail::element_t<MatrixA>>)
+    {
+        using T = detail::element_t<MatrixA>;
+        using view_x = view_t<const std::remove_reference_t<VectorX>>;
+        using view_y = view_t<const std::remove_reference_t<VectorY>>;
+        using view_a = view_t<std::remove_reference_t<MatrixA>>;
+
+        static_assert(detail::is_vector_v<view_x> && detail::is_vector_v<view_y>, "ger requires x and y to be vectors");
+        static_assert(detail::vector_size_v<view_x> == view_a::row_count, "ger requires x to have as many elements as A has rows");
+        static_assert(detail::vector_size_v<view_y> == view_a::column_count, "ger requires y to have as many elements as A has columns");
+
+        LAL_OPERATION_BEGIN();
+        const view_x vx = make_view(x);
+        const view_y vy = make_view(y);
+        const view_a va = make_view(a);
+        for (std::size_t i = 0u; i < view_a::row_count; ++i)
+        {
+            const T scaled_x = alpha * detail::vector_element(vx, i);
+            const auto a_row = va[i];
+            for (std::size_t j = 0u; j < view_a::column_count; ++j)
+                a_row[j] += scaled_x * detail::vector_element(vy, j);
+        }
+
+        LAL_OPERATION_END(ger, T, view_a::row_count, view_a::column_count, 0u);
+    }
+
+    // C = alpha * op(A) * transpose(op(A)) + beta * C, as in the reference BLAS only
+    // the selected triangle of C is referenced and updated
+    template <triangle Uplo = triangle::upper, transposition Trans = transposition::none, typename MatrixA, typename MatrixC,
+              std::enable_if_t<is_viewable_v<MatrixA> && is_viewable_v<MatrixC>, bool> = true>
+    constexpr void syrk(const detail::element_t<MatrixC> alpha, const MatrixA& a,
+                        const detail::element_t<MatrixC> beta, MatrixC&& c)
+        noexcept(detail::is_nothrow_multiply_add_v<detail::element_t<MatrixC>>)
+    {
+        using T = detail::element_t<MatrixC>;
+        using view_a = view_t<const std::remove_reference_t<MatrixA>>;
+        using view_c = view_t<std::remove_reference_t<MatrixC>>;
+
+        constexpr std::size_t N = view_c::row_count;
+        constexpr std::size_t K = detail::op_columns_v<Trans, view_a>;
+        static_assert(view_c::row_count == view_c::column_count, "syrk requires C to be square");
+        static_assert(detail::op_rows_v<Trans, view_a> == N, "syrk requires op(A) to have as many rows as C");
+
+        LAL_OPERATION_BEGIN();
+        const view_a va = make_view(a);
+        const view_c vc = make_view(c);
+        for (std::size_t i = 0u; i < N; ++i)
+        {
+            const std::size_t j_begin = Uplo == triangle::upper ? i : 0u;
+            const std::size_t j_end = Uplo == triangle::upper ? N : i + 1u;
+            for (std::size_t j = j_begin; j < j_end; ++j)
+            {
+                T sum{};
+                if (alpha != T{})
+                    for (std::size_t p = 0u; p < K; ++p)
+                        sum += detail::op_element<Trans>(va, i, p) * detail::op_element<Trans>(va, j, p);
+
+                if (beta == T{})
+                    vc[i][j] = alpha * sum;
+                else
+                    vc[i][j] = alpha * sum + beta * vc[i][j];
+            }
+        }
+
+        LAL_OPERATION_END(syrk, T, N, N, K);
+    }
+}
+
+#endif
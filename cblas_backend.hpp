@@ -0,0 +1,79 @@
+#ifndef LAL_CBLAS_BACKEND_HPP
+#define LAL_CBLAS_BACKEND_HPP
+
+#include <type_traits>
+#include <cstddef>
+
+// Defining LAL_USE_CBLAS forwards float and double products whose number of
+// multiply-adds is at least LAL_CBLAS_THRESHOLD to an installed CBLAS (e.g.
+// OpenBLAS), smaller products stay on the built-in constexpr kernels.  As the
+// dimensions are template parameters the choice is made at compile time, and
+// constant evaluation always takes the built-in kernels.
+#ifdef LAL_USE_CBLAS
+#include <cblas.h>
+#endif
+
+#ifndef LAL_CBLAS_THRESHOLD
+#define LAL_CBLAS_THRESHOLD (64u * 64u * 64u)
+#endif
+
+namespace lal::detail
+{
+    template <typename T>
+    inline constexpr bool is_cblas_type_v = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+#ifdef LAL_USE_CBLAS
+    inline constexpr bool cblas_enabled = true;
+#else
+    inline constexpr bool cblas_enabled = false;
+#endif
+
+    template <typename T, std::size_t M, std::size_t N, std::size_t K>
+    inline constexpr bool use_cblas_v = cblas_enabled && is_cblas_type_v<T> &&
+                                        M * N * K >= static_cast<std::size_t>(LAL_CBLAS_THRESHOLD);
+
+#ifdef LAL_USE_CBLAS
+    // Thin overloads over the row-major CBLAS interface, strides are in elements
+    inline void cblas_gemm(const bool trans_a, const bool trans_b,
+                           const std::size_t m, const std::size_t n, const std::size_t k,
+                           const float alpha, const float* const a, const std::size_t lda,
+                           const float* const b, const std::size_t ldb,
+                           const float beta, float* const c, const std::size_t ldc) noexcept
+    {
+        cblas_sgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans, trans_b ? CblasTrans : CblasNoTrans,
+                    static_cast<int>(m), static_cast<int>(n), static_cast<int>(k),
+                    alpha, a, static_cast<int>(lda), b, static_cast<int>(ldb), beta, c, static_cast<int>(ldc));
+    }
+
+    inline void cblas_gemm(const bool trans_a, const bool trans_b,
+                           const std::size_t m, const std::size_t n, const std::size_t k,
+                           const double alpha, const double* const a, const std::size_t lda,
+                           const double* const b, const std::size_t ldb,
+                           const double beta, double* const c, const std::size_t ldc) noexcept
+    {
+        cblas_dgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans, trans_b ? CblasTrans : CblasNoTrans,
+                    static_cast<int>(m), static_cast<int>(n), static_cast<int>(k),
+                    alpha, a, static_cast<int>(lda), b, static_cast<int>(ldb), beta, c, static_cast<int>(ldc));
+    }
+
+    inline void cblas_gemv(const bool trans_a, const std::size_t m, const std::size_t n,
+                           const float alpha, const float* const a, const std::size_t lda,
+                           const float* const x, const std::size_t incx,
+                           const float beta, float* const y, const std::size_t incy) noexcept
+    {
+        cblas_sgemv(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans, static_cast<int>(m), static_cast<int>(n),
+                    alpha, a, static_cast<int>(lda), x, static_cast<int>(incx), beta, y, static_cast<int>(incy));
+    }
+
+    inline void cblas_gemv(const bool trans_a, const std::size_t m, const std::size_t n,
+                           const double alpha, const double* const a, const std::size_t lda,
+                           const double* const x, const std::size_t incx,
+                           const double beta, double* const y, const std::size_t incy) noexcept
+    {
+        cblas_dgemv(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans, static_cast<int>(m), static_cast<int>(n),
+                    alpha, a, static_cast<int>(lda), x, static_cast<int>(incx), beta, y, static_cast<int>(incy));
+    }
+#endif
+}
+
+#endif
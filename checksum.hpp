@@ -0,0 +1,57 @@
+#ifndef LAL_CHECKSUM_HPP
+#define LAL_CHECKSUM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace lal
+{
+    namespace detail
+    {
+        // Tables for slicing-by-8 CRC-32 (reflected IEEE polynomial, as used by zip and png)
+        constexpr std::array<std::array<std::uint32_t, 256>, 8> make_crc32_tables() noexcept
+        {
+            std::array<std::array<std::uint32_t, 256>, 8> tables{};
+            for (std::uint32_t i = 0u; i < 256u; ++i)
+            {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                    crc = (crc & 1u) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+
+                tables[0][i] = crc;
+            }
+
+            for (std::size_t table = 1u; table < tables.size(); ++table)
+                for (std::size_t i = 0u; i < 256u; ++i)
+                    tables[table][i] = (tables[table - 1u][i] >> 8) ^ tables[0][tables[table - 1u][i] & 0xFFu];
+
+            return tables;
+        }
+
+        inline constexpr auto crc32_tables = make_crc32_tables();
+    }
+
+    // Incremental CRC-32, pass the previous result as crc to continue a running checksum
+    inline std::uint32_t crc32(const void* const data, std::size_t size, std::uint32_t crc = 0u) noexcept
+    {
+        const auto& t = detail::crc32_tables;
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+
+        for (; size >= 8u; size -= 8u, bytes += 8)
+        {
+            const std::uint32_t low = crc ^ (static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8 |
+                                             static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24);
+            crc = t[7][low & 0xFFu] ^ t[6][(low >> 8) & 0xFFu] ^ t[5][(low >> 16) & 0xFFu] ^ t[4][low >> 24] ^
+                  t[3][bytes[4]] ^ t[2][bytes[5]] ^ t[1][bytes[6]] ^ t[0][bytes[7]];
+        }
+
+        for (; size > 0u; --size, ++bytes)
+            crc = (crc >> 8) ^ t[0][(crc ^ *bytes) & 0xFFu];
+
+        return ~crc;
+    }
+}
+
+#endif
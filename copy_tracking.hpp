@@ -0,0 +1,186 @@
+#ifndef LAL_COPY_TRACKING_HPP
+#define LAL_COPY_TRACKING_HPP
+
+#include "instrumentation.hpp"
+
+#include <string_view>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <atomic>
+#include <vector>
+
+// Counts how often each matrix type is constructed, copied and moved, filled in when
+// LAL_ENABLE_COPY_TRACKING is defined (otherwise they are all zero).  As matrices
+// store their elements inline a move copies as many bytes as a copy does for
+// trivially copyable element types, so both are reported.  Counts are global, a
+// copy_tracking_scope reports the difference since it was created, including any
+// work done on other threads in the meantime.
+namespace lal
+{
+    struct matrix_copy_counts
+    {
+        std::string_view type{};
+        std::size_t rows{};
+        std::size_t columns{};
+        std::uint64_t constructions{};  // Every constructor other than copy and move
+        std::uint64_t copies{};         // Copy constructions and assignments
+        std::uint64_t moves{};          // Move constructions and assignments
+        std::uint64_t bytes_copied{};
+        std::uint64_t bytes_moved{};
+    };
+
+    namespace detail
+    {
+        enum class matrix_event { construction, copy, move };
+
+        struct copy_entry;
+
+        inline std::atomic<copy_entry*> copy_entries{ nullptr };
+
+        struct copy_entry
+        {
+            copy_entry(const std::string_view type, const std::size_t rows, const std::size_t columns, const std::size_t bytes) noexcept
+                : type{ type }, rows{ rows }, columns{ columns }, bytes{ bytes }, next{ copy_entries.load(std::memory_order_relaxed) }
+            {
+                while (!copy_entries.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed))
+                    ;
+            }
+
+            matrix_copy_counts read() const noexcept
+            {
+                const std::uint64_t copy_count = copies.load(std::memory_order_relaxed);
+                const std::uint64_t move_count = moves.load(std::memory_order_relaxed);
+                return { type, rows, columns, constructions.load(std::memory_order_relaxed), copy_count, move_count,
+                         copy_count * bytes, move_count * bytes };
+            }
+
+            const std::string_view type;
+            const std::size_t rows;
+            const std::size_t columns;
+            const std::size_t bytes;
+            std::atomic<std::uint64_t> constructions{};
+            std::atomic<std::uint64_t> copies{};
+            std::atomic<std::uint64_t> moves{};
+            copy_entry* next;
+        };
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        copy_entry& copy_entry_for() noexcept
+        {
+            static copy_entry entry{ type_name_v<std::remove_cv_t<T>>, Rows, Columns, sizeof(T) * Rows * Columns };
+            return entry;
+        }
+
+        template <matrix_event Event, typename T, std::size_t Rows, std::size_t Columns>
+        constexpr void track_matrix() noexcept
+        {
+            if (is_constant_evaluated())
+                return;
+
+            copy_entry& entry = copy_entry_for<T, Rows, Columns>();
+            if constexpr (Event == matrix_event::construction)
+                entry.constructions.fetch_add(1u, std::memory_order_relaxed);
+            else if constexpr (Event == matrix_event::copy)
+                entry.copies.fetch_add(1u, std::memory_order_relaxed);
+            else
+                entry.moves.fetch_add(1u, std::memory_order_relaxed);
+        }
+
+        // Entries are told apart by address, the type name is only for printing and is
+        // "other" for every type without one
+        struct copy_snapshot
+        {
+            const copy_entry* entry;
+            matrix_copy_counts counts;
+        };
+
+        inline std::vector<copy_snapshot> read_copy_counts()
+        {
+            std::vector<copy_snapshot> ret;
+            for (auto entry = copy_entries.load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+                ret.push_back({ entry, entry->read() });
+
+            return ret;
+        }
+    }
+
+    class copy_tracking_scope
+    {
+    public:
+        copy_tracking_scope() : start_{ detail::read_copy_counts() } {}
+
+        // Counts for every matrix type used since the scope began, most bytes copied first
+        std::vector<matrix_copy_counts> report() const
+        {
+            std::vector<matrix_copy_counts> ret;
+            for (const detail::copy_snapshot& now : detail::read_copy_counts())
+            {
+                const matrix_copy_counts difference = since_start(now);
+                if (difference.constructions != 0u || difference.copies != 0u || difference.moves != 0u)
+                    ret.push_back(difference);
+            }
+
+            std::sort(ret.begin(), ret.end(), [](const matrix_copy_counts& lhs, const matrix_copy_counts& rhs) {
+                return lhs.bytes_copied + lhs.bytes_moved > rhs.bytes_copied + rhs.bytes_moved;
+            });
+            return ret;
+        }
+
+        // Counts for a single matrix type
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        matrix_copy_counts counts() const
+        {
+            const detail::copy_entry& entry = detail::copy_entry_for<T, Rows, Columns>();
+            return since_start({ &entry, entry.read() });
+        }
+
+        // Counts summed over every matrix type
+        matrix_copy_counts totals() const
+        {
+            matrix_copy_counts ret{};
+            for (const matrix_copy_counts& c : report())
+            {
+                ret.constructions += c.constructions;
+                ret.copies += c.copies;
+                ret.moves += c.moves;
+                ret.bytes_copied += c.bytes_copied;
+                ret.bytes_moved += c.bytes_moved;
+            }
+
+            return ret;
+        }
+
+        void write(std::ostream& out) const
+        {
+            for (const matrix_copy_counts& c : report())
+                out << "matrix<" << c.type << ", " << c.rows << ", " << c.columns << ">: " << c.constructions
+                    << " constructed, " << c.copies << " copied (" << c.bytes_copied << " bytes), " << c.moves
+                    << " moved (" << c.bytes_moved << " bytes)\n";
+        }
+
+    private:
+        matrix_copy_counts since_start(const detail::copy_snapshot& now) const
+        {
+            matrix_copy_counts ret = now.counts;
+            const auto before = std::find_if(start_.begin(), start_.end(), [&now](const detail::copy_snapshot& s) {
+                return s.entry == now.entry;
+            });
+            if (before != start_.end())
+            {
+                ret.constructions -= before->counts.constructions;
+                ret.copies -= before->counts.copies;
+                ret.moves -= before->counts.moves;
+                ret.bytes_copied -= before->counts.bytes_copied;
+                ret.bytes_moved -= before->counts.bytes_moved;
+            }
+
+            return ret;
+        }
+
+        std::vector<detail::copy_snapshot> start_;
+    };
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef LAL_COUNTERS_HPP
+#define LAL_COUNTERS_HPP
+
+#include "instrumentation.hpp"
+
+#include <string_view>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// Counters for each distinct operation, element type and shape, filled in when
+// LAL_ENABLE_COUNTERS is defined (otherwise they are all empty).  Every counter is
+// a relaxed atomic so operations can run on any thread, and each set of counters is
+// found through a function local static so recording never takes a lock.
+namespace lal
+{
+    struct operation_counters
+    {
+        operation op{};
+        std::string_view type{};
+        std::size_t rows{};
+        std::size_t columns{};
+        std::size_t depth{};
+        std::uint64_t calls{};
+        std::uint64_t flops{};
+        std::uint64_t bytes{};
+        std::chrono::nanoseconds time{};
+
+        double seconds() const noexcept { return std::chrono::duration<double>(time).count(); }
+
+        double gflops_per_second() const noexcept
+        {
+            return time.count() > 0 ? static_cast<double>(flops) / static_cast<double>(time.count()) : 0.0;
+        }
+
+        double gbytes_per_second() const noexcept
+        {
+            return time.count() > 0 ? static_cast<double>(bytes) / static_cast<double>(time.count()) : 0.0;
+        }
+
+        // FLOPs per byte
+        double arithmetic_intensity() const noexcept
+        {
+            return bytes > 0u ? static_cast<double>(flops) / static_cast<double>(bytes) : 0.0;
+        }
+
+        // Achieved GFLOP/s as a fraction of what the roofline model allows at this
+        // arithmetic intensity, for operations without FLOPs the bandwidth is used
+        double roofline_efficiency(const double peak_gflops_per_second, const double peak_gbytes_per_second) const noexcept
+        {
+            if (flops == 0u)
+                return peak_gbytes_per_second > 0.0 ? gbytes_per_second() / peak_gbytes_per_second : 0.0;
+
+            const double attainable = std::min(peak_gflops_per_second, arithmetic_intensity() * peak_gbytes_per_second);
+            return attainable > 0.0 ? gflops_per_second() / attainable : 0.0;
+        }
+    };
+
+    namespace detail
+    {
+        struct counter_entry;
+
+        inline std::atomic<counter_entry*> counter_entries{ nullptr };
+
+        struct counter_entry
+        {
+            counter_entry(const operation op, const std::string_view type, const std::size_t rows,
+                          const std::size_t columns, const std::size_t depth) noexcept
+                : op{ op }, type{ type }, rows{ rows }, columns{ columns }, depth{ depth },
+                  next{ counter_entries.load(std::memory_order_relaxed) }
+            {
+                while (!counter_entries.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed))
+                    ;
+            }
+
+            const operation op;
+            const std::string_view type;
+            const std::size_t rows;
+            const std::size_t columns;
+            const std::size_t depth;
+            std::atomic<std::uint64_t> calls{};
+            std::atomic<std::uint64_t> flops{};
+            std::atomic<std::uint64_t> bytes{};
+            std::atomic<std::uint64_t> nanoseconds{};
+            counter_entry* next;
+        };
+
+        template <operation Op, typename T, std::size_t Rows, std::size_t Columns, std::size_t Depth>
+        counter_entry& counters_for() noexcept
+        {
+            static counter_entry entry{ Op, type_name_v<std::remove_cv_t<T>>, Rows, Columns, Depth };
+            return entry;
+        }
+
+        template <operation Op, typename T, std::size_t Rows, std::size_t Columns, std::size_t Depth>
+        constexpr void count_operation(const std::uint64_t start) noexcept
+        {
+            if (is_constant_evaluated())
+                return;
+
+            constexpr std::uint64_t flops = operation_flops(Op, Rows, Columns, Depth);
+            constexpr std::uint64_t bytes = operation_bytes(Op, sizeof(T), Rows, Columns, Depth);
+            counter_entry& entry = counters_for<Op, T, Rows, Columns, Depth>();
+            entry.calls.fetch_add(1u, std::memory_order_relaxed);
+            entry.flops.fetch_add(flops, std::memory_order_relaxed);
+            entry.bytes.fetch_add(bytes, std::memory_order_relaxed);
+            entry.nanoseconds.fetch_add(clock_nanoseconds() - start, std::memory_order_relaxed);
+        }
+    }
+
+    // A snapshot of every operation called at least once since the last reset, most time consuming first
+    inline std::vector<operation_counters> read_operation_counters()
+    {
+        std::vector<operation_counters> ret;
+        for (auto entry = detail::counter_entries.load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+        {
+            const std::uint64_t calls = entry->calls.load(std::memory_order_relaxed);
+            if (calls == 0u)
+                continue;
+
+            ret.push_back({ entry->op, entry->type, entry->rows, entry->columns, entry->depth, calls,
+                            entry->flops.load(std::memory_order_relaxed), entry->bytes.load(std::memory_order_relaxed),
+                            std::chrono::nanoseconds{ entry->nanoseconds.load(std::memory_order_relaxed) } });
+        }
+
+        std::sort(ret.begin(), ret.end(), [](const operation_counters& lhs, const operation_counters& rhs) {
+            return lhs.time > rhs.time;
+        });
+        return ret;
+    }
+
+    inline void reset_operation_counters() noexcept
+    {
+        for (auto entry = detail::counter_entries.load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+        {
+            entry->calls.store(0u, std::memory_order_relaxed);
+            entry->flops.store(0u, std::memory_order_relaxed);
+            entry->bytes.store(0u, std::memory_order_relaxed);
+            entry->nanoseconds.store(0u, std::memory_order_relaxed);
+        }
+    }
+
+    inline void write_operation_counters_json(std::ostream& out, const std::vector<operation_counters>& counters)
+    {
+        out << "{\n  \"operations\": [";
+        for (std::size_t i = 0u; i < counters.size(); ++i)
+        {
+            const operation_counters& c = counters[i];
+            out << (i == 0u ? "\n" : ",\n")
+                << "    { \"operation\": \"" << operation_name(c.op) << "\", \"type\": \"" << c.type << '"'
+                << ", \"rows\": " << c.rows << ", \"columns\": " << c.columns << ", \"depth\": " << c.depth
+                << ", \"calls\": " << c.calls << ", \"flops\": " << c.flops << ", \"bytes\": " << c.bytes
+                << ", \"seconds\": " << c.seconds() << ", \"gflops_per_second\": " << c.gflops_per_second()
+                << ", \"gbytes_per_second\": " << c.gbytes_per_second()
+                << ", \"arithmetic_intensity\": " << c.arithmetic_intensity() << " }";
+        }
+
+        out << (counters.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    }
+
+    inline void write_operation_counters_json(std::ostream& out)
+    {
+        write_operation_counters_json(out, read_operation_counters());
+    }
+}
+
+#endif
@@ -0,0 +1,346 @@
+#ifndef LAL_HALF_HPP
+#define LAL_HALF_HPP
+
+#include "instrumentation.hpp"
+#include "matrix_view.hpp"
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__F16C__) || defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// 16-bit floating point storage types.  half is IEEE 754 binary16 (5 exponent
+// bits, 10 mantissa bits) and bfloat16 is the upper half of a float (8 exponent
+// bits, 7 mantissa bits), so bfloat16 keeps the range of float at a lower
+// precision.  Both convert implicitly to float and all arithmetic happens in
+// float, a result is only rounded (to nearest, ties to even) when it's stored back.
+// Sums of products of either type accumulate in float, so matrix products, dot
+// products and the BLAS routines round once per result element rather than once
+// per multiply-add.
+//
+// Conversions use F16C for half and the inner loops use AVX-512 BF16 or AVX2/FMA
+// when the compiler targets them (e.g. -march=native, see LAL_NATIVE_ARCH), with
+// portable scalar code otherwise.
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define LAL_HAS_BUILTIN_BIT_CAST
+#endif
+#endif
+
+// Conversions are only constexpr where the compiler can bit cast in constant expressions
+#ifdef LAL_HAS_BUILTIN_BIT_CAST
+#define LAL_HALF_CONSTEXPR constexpr
+#else
+#define LAL_HALF_CONSTEXPR inline
+#endif
+
+namespace lal
+{
+    namespace detail
+    {
+        template <typename To, typename From>
+        LAL_HALF_CONSTEXPR To bit_cast(const From& from) noexcept
+        {
+            static_assert(sizeof(To) == sizeof(From), "bit_cast requires types of the same size");
+#ifdef LAL_HAS_BUILTIN_BIT_CAST
+            return __builtin_bit_cast(To, from);
+#else
+            To to;
+            std::memcpy(&to, &from, sizeof(To));
+            return to;
+#endif
+        }
+
+        LAL_HALF_CONSTEXPR std::uint16_t float_to_bfloat16_bits(const float f) noexcept
+        {
+            const auto bits = bit_cast<std::uint32_t>(f);
+            if ((bits & 0x7FFFFFFFu) > 0x7F800000u)
+                return static_cast<std::uint16_t>((bits >> 16u) | 0x0040u);  // Keep NaNs quiet rather than rounding to infinity
+
+            const std::uint32_t rounding = 0x7FFFu + ((bits >> 16u) & 1u);
+            return static_cast<std::uint16_t>((bits + rounding) >> 16u);
+        }
+
+        LAL_HALF_CONSTEXPR float bfloat16_bits_to_float(const std::uint16_t bits) noexcept
+        {
+            return bit_cast<float>(static_cast<std::uint32_t>(bits) << 16u);
+        }
+
+        LAL_HALF_CONSTEXPR std::uint16_t float_to_half_bits(const float f) noexcept
+        {
+#ifdef __F16C__
+            if (!is_constant_evaluated())
+                return static_cast<std::uint16_t>(_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT));
+#endif
+            std::uint32_t bits = bit_cast<std::uint32_t>(f);
+            const auto sign = static_cast<std::uint16_t>((bits >> 16u) & 0x8000u);
+            bits &= 0x7FFFFFFFu;
+
+            if (bits > 0x7F800000u)
+                return static_cast<std::uint16_t>(sign | 0x7E00u);
+            if (bits >= 0x477FF000u)                 // 65520 and above round to infinity
+                return static_cast<std::uint16_t>(sign | 0x7C00u);
+            if (bits < 0x33000000u)                  // Below half the smallest subnormal
+                return sign;
+
+            if (bits < 0x38800000u)
+            {
+                // Subnormal, in units of 2^-24 with the implicit bit made explicit
+                const std::uint32_t exponent = bits >> 23u;
+                const std::uint32_t mantissa = (bits & 0x7FFFFFu) | 0x800000u;
+                const std::uint32_t shift = 126u - exponent;
+                const std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+                const std::uint32_t halfway = 1u << (shift - 1u);
+                std::uint32_t ret = mantissa >> shift;
+                if (remainder > halfway || (remainder == halfway && (ret & 1u) != 0u))
+                    ++ret;
+
+                return static_cast<std::uint16_t>(sign | ret);
+            }
+
+            // Rebias the exponent and round, a carry out of the mantissa correctly bumps the exponent
+            bits += 0xC8000FFFu + ((bits >> 13u) & 1u);
+            return static_cast<std::uint16_t>(sign | (bits >> 13u));
+        }
+
+        LAL_HALF_CONSTEXPR float half_bits_to_float(const std::uint16_t bits) noexcept
+        {
+#ifdef __F16C__
+            if (!is_constant_evaluated())
+                return _cvtsh_ss(bits);
+#endif
+            const std::uint32_t sign = static_cast<std::uint32_t>(bits & 0x8000u) << 16u;
+            std::uint32_t exponent = (bits >> 10u) & 0x1Fu;
+            std::uint32_t mantissa = bits & 0x3FFu;
+
+            if (exponent == 0x1Fu)
+                return bit_cast<float>(sign | 0x7F800000u | (mantissa << 13u));
+            if (exponent == 0u)
+            {
+                if (mantissa == 0u)
+                    return bit_cast<float>(sign);
+
+                // Subnormal, normalise it as float has the range to represent it
+                exponent = 1u;
+                while ((mantissa & 0x400u) == 0u)
+                {
+                    mantissa <<= 1u;
+                    --exponent;
+                }
+
+                mantissa &= 0x3FFu;
+            }
+
+            return bit_cast<float>(sign | ((exponent + 112u) << 23u) | (mantissa << 13u));
+        }
+    }
+
+    class bfloat16
+    {
+    public:
+        constexpr bfloat16() noexcept = default;
+        explicit LAL_HALF_CONSTEXPR bfloat16(const float f) noexcept : bits_{ detail::float_to_bfloat16_bits(f) } {}
+
+        LAL_HALF_CONSTEXPR operator float() const noexcept { return detail::bfloat16_bits_to_float(bits_); }
+
+        static constexpr bfloat16 from_bits(const std::uint16_t bits) noexcept
+        {
+            bfloat16 ret{};
+            ret.bits_ = bits;
+            return ret;
+        }
+
+        constexpr std::uint16_t bits() const noexcept { return bits_; }
+
+        LAL_HALF_CONSTEXPR bfloat16& operator+=(const float rhs) noexcept { return *this = bfloat16{ float{ *this } + rhs }; }
+        LAL_HALF_CONSTEXPR bfloat16& operator-=(const float rhs) noexcept { return *this = bfloat16{ float{ *this } - rhs }; }
+        LAL_HALF_CONSTEXPR bfloat16& operator*=(const float rhs) noexcept { return *this = bfloat16{ float{ *this } * rhs }; }
+        LAL_HALF_CONSTEXPR bfloat16& operator/=(const float rhs) noexcept { return *this = bfloat16{ float{ *this } / rhs }; }
+
+        friend constexpr bfloat16 operator-(const bfloat16 x) noexcept { return from_bits(x.bits_ ^ 0x8000u); }
+
+    private:
+        std::uint16_t bits_{};
+    };
+
+    class half
+    {
+    public:
+        constexpr half() noexcept = default;
+        explicit LAL_HALF_CONSTEXPR half(const float f) noexcept : bits_{ detail::float_to_half_bits(f) } {}
+
+        LAL_HALF_CONSTEXPR operator float() const noexcept { return detail::half_bits_to_float(bits_); }
+
+        static constexpr half from_bits(const std::uint16_t bits) noexcept
+        {
+            half ret{};
+            ret.bits_ = bits;
+            return ret;
+        }
+
+        constexpr std::uint16_t bits() const noexcept { return bits_; }
+
+        LAL_HALF_CONSTEXPR half& operator+=(const float rhs) noexcept { return *this = half{ float{ *this } + rhs }; }
+        LAL_HALF_CONSTEXPR half& operator-=(const float rhs) noexcept { return *this = half{ float{ *this } - rhs }; }
+        LAL_HALF_CONSTEXPR half& operator*=(const float rhs) noexcept { return *this = half{ float{ *this } * rhs }; }
+        LAL_HALF_CONSTEXPR half& operator/=(const float rhs) noexcept { return *this = half{ float{ *this } / rhs }; }
+
+        friend constexpr half operator-(const half x) noexcept { return from_bits(x.bits_ ^ 0x8000u); }
+
+    private:
+        std::uint16_t bits_{};
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        inline constexpr bool is_reduced_precision_v = std::is_same_v<T, bfloat16> || std::is_same_v<T, half>;
+
+        template <>
+        struct accumulator<bfloat16>
+        {
+            using type = float;
+        };
+
+        template <>
+        struct accumulator<half>
+        {
+            using type = float;
+        };
+
+        template <> inline constexpr std::string_view type_name_v<bfloat16> = "bfloat16";
+        template <> inline constexpr std::string_view type_name_v<half> = "half";
+
+        // Dot product of two contiguous runs of 16-bit values, summed in float
+        inline float widening_dot(const bfloat16* const a, const bfloat16* const b, const std::size_t n) noexcept
+        {
+            std::size_t i = 0u;
+            float sum = 0.0f;
+#if defined(__AVX512BF16__) && defined(__AVX512F__)
+            // Each instruction multiplies 32 pairs and adds adjacent products into 16 floats
+            __m512 acc = _mm512_setzero_ps();
+            for (; i + 32u <= n; i += 32u)
+                acc = _mm512_dpbf16_ps(acc, reinterpret_cast<__m512bh>(_mm512_loadu_si512(a + i)),
+                                       reinterpret_cast<__m512bh>(_mm512_loadu_si512(b + i)));
+            sum = _mm512_reduce_add_ps(acc);
+#elif defined(__AVX2__) && defined(__FMA__)
+            // Widening is a 16 bit shift of each value into the top of a float
+            __m256 acc = _mm256_setzero_ps();
+            for (; i + 8u <= n; i += 8u)
+            {
+                const __m128i a16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                const __m128i b16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                const __m256 a32 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(a16), 16));
+                const __m256 b32 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(b16), 16));
+                acc = _mm256_fmadd_ps(a32, b32, acc);
+            }
+
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, acc);
+            for (const float lane : lanes)
+                sum += lane;
+#endif
+            for (; i < n; ++i)
+                sum += float{ a[i] } * float{ b[i] };
+
+            return sum;
+        }
+
+        inline float widening_dot(const half* const a, const half* const b, const std::size_t n) noexcept
+        {
+            std::size_t i = 0u;
+            float sum = 0.0f;
+#if defined(__F16C__) && defined(__FMA__)
+            __m256 acc = _mm256_setzero_ps();
+            for (; i + 8u <= n; i += 8u)
+            {
+                const __m256 a32 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+                const __m256 b32 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+                acc = _mm256_fmadd_ps(a32, b32, acc);
+            }
+
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, acc);
+            for (const float lane : lanes)
+                sum += lane;
+#endif
+            for (; i < n; ++i)
+                sum += float{ a[i] } * float{ b[i] };
+
+            return sum;
+        }
+
+        // Conversion of contiguous runs, the SIMD paths convert 16 (or 8) elements at once
+        inline void convert_run(const float* const from, bfloat16* const to, const std::size_t n) noexcept
+        {
+            std::size_t i = 0u;
+#if defined(__AVX512BF16__) && defined(__AVX512F__)
+            for (; i + 16u <= n; i += 16u)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i),
+                                    reinterpret_cast<__m256i>(_mm512_cvtneps_pbh(_mm512_loadu_ps(from + i))));
+#endif
+            for (; i < n; ++i)
+                to[i] = bfloat16{ from[i] };
+        }
+
+        inline void convert_run(const bfloat16* const from, float* const to, const std::size_t n) noexcept
+        {
+            for (std::size_t i = 0u; i < n; ++i)
+                to[i] = from[i];
+        }
+
+        inline void convert_run(const float* const from, half* const to, const std::size_t n) noexcept
+        {
+            std::size_t i = 0u;
+#ifdef __F16C__
+            for (; i + 8u <= n; i += 8u)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), _mm256_cvtps_ph(_mm256_loadu_ps(from + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+            for (; i < n; ++i)
+                to[i] = half{ from[i] };
+        }
+
+        inline void convert_run(const half* const from, float* const to, const std::size_t n) noexcept
+        {
+            std::size_t i = 0u;
+#ifdef __F16C__
+            for (; i + 8u <= n; i += 8u)
+                _mm256_storeu_ps(to + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i))));
+#endif
+            for (; i < n; ++i)
+                to[i] = from[i];
+        }
+
+        template <typename From, typename To>
+        void convert_run(const From* const from, To* const to, const std::size_t n)
+        {
+            for (std::size_t i = 0u; i < n; ++i)
+                to[i] = static_cast<To>(from[i]);
+        }
+    }
+
+    // Converts every element of a matrix (or view) into another of the same dimensions,
+    // e.g. float weights into bfloat16 storage
+    template <typename MatrixFrom, typename MatrixTo,
+              std::enable_if_t<is_viewable_v<MatrixFrom> && is_viewable_v<MatrixTo>, bool> = true>
+    void convert(const MatrixFrom& from, MatrixTo&& to)
+    {
+        using view_from = view_t<const std::remove_reference_t<MatrixFrom>>;
+        using view_to = view_t<std::remove_reference_t<MatrixTo>>;
+        static_assert(view_from::row_count == view_to::row_count && view_from::column_count == view_to::column_count,
+                      "convert requires matrices of the same dimensions");
+
+        const view_from vf = make_view(from);
+        const view_to vt = make_view(to);
+        for (std::size_t row = 0u; row < view_to::row_count; ++row)
+            detail::convert_run(vf[row], vt[row], view_to::column_count);
+    }
+}
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef LAL_INSTRUMENTATION_HPP
+#define LAL_INSTRUMENTATION_HPP
+
+#include <type_traits>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+// Hooks placed around every lal operation.  Defining LAL_ENABLE_COUNTERS makes each
+// operation accumulate its calls, FLOPs, bytes and wall time (see counters.hpp) and
+// LAL_ENABLE_TRACING records it on a timeline (see tracing.hpp), while
+// LAL_ENABLE_COPY_TRACKING counts matrix constructions, copies and moves (see
+// copy_tracking.hpp).  Without these the hooks expand to nothing.  Nothing is recorded while an operation
+// is being constant evaluated so constexpr and noexcept are unaffected either way.
+namespace lal
+{
+    enum class operation
+    {
+        addition,
+        subtraction,
+        multiplication,
+        scalar_multiplication,
+        hadamard_product,
+        scalar_division,
+        equality,
+        transpose,
+        magnitude,
+        map,
+        dot,
+        sum,
+        norm,
+        extremum,
+        axpy,
+        gemm,
+        gemv,
+        ger,
+        syrk,
+        quantized_gemm,
+        softmax,
+        logsumexp,
+        sgd_momentum,
+        adam,
+        rmsprop,
+        outer,
+        kronecker
+    };
+
+    constexpr std::string_view operation_name(const operation op) noexcept
+    {
+        switch (op)
+        {
+        case operation::addition: return "addition";
+        case operation::subtraction: return "subtraction";
+        case operation::multiplication: return "multiplication";
+        case operation::scalar_multiplication: return "scalar_multiplication";
+        case operation::hadamard_product: return "hadamard_product";
+        case operation::scalar_division: return "scalar_division";
+        case operation::equality: return "equality";
+        case operation::transpose: return "transpose";
+        case operation::magnitude: return "magnitude";
+        case operation::map: return "map";
+        case operation::dot: return "dot";
+        case operation::sum: return "sum";
+        case operation::norm: return "norm";
+        case operation::extremum: return "extremum";
+        case operation::axpy: return "axpy";
+        case operation::gemm: return "gemm";
+        case operation::gemv: return "gemv";
+        case operation::ger: return "ger";
+        case operation::syrk: return "syrk";
+        case operation::quantized_gemm: return "quantized_gemm";
+        case operation::softmax: return "softmax";
+        case operation::logsumexp: return "logsumexp";
+        case operation::sgd_momentum: return "sgd_momentum";
+        case operation::adam: return "adam";
+        case operation::rmsprop: return "rmsprop";
+        case operation::outer: return "outer";
+        case operation::kronecker: return "kronecker";
+        }
+
+        return "unknown";
+    }
+
+    namespace detail
+    {
+        constexpr bool is_constant_evaluated() noexcept
+        {
+#ifdef __cpp_lib_is_constant_evaluated
+            return std::is_constant_evaluated();
+#else
+            return __builtin_is_constant_evaluated();
+#endif
+        }
+
+        template <typename T> inline constexpr std::string_view type_name_v = "other";
+        template <> inline constexpr std::string_view type_name_v<bool> = "bool";
+        template <> inline constexpr std::string_view type_name_v<char> = "char";
+        template <> inline constexpr std::string_view type_name_v<signed char> = "signed char";
+        template <> inline constexpr std::string_view type_name_v<unsigned char> = "unsigned char";
+        template <> inline constexpr std::string_view type_name_v<short> = "short";
+        template <> inline constexpr std::string_view type_name_v<unsigned short> = "unsigned short";
+        template <> inline constexpr std::string_view type_name_v<int> = "int";
+        template <> inline constexpr std::string_view type_name_v<unsigned int> = "unsigned int";
+        template <> inline constexpr std::string_view type_name_v<long> = "long";
+        template <> inline constexpr std::string_view type_name_v<unsigned long> = "unsigned long";
+        template <> inline constexpr std::string_view type_name_v<long long> = "long long";
+        template <> inline constexpr std::string_view type_name_v<unsigned long long> = "unsigned long long";
+        template <> inline constexpr std::string_view type_name_v<float> = "float";
+        template <> inline constexpr std::string_view type_name_v<double> = "double";
+        template <> inline constexpr std::string_view type_name_v<long double> = "long double";
+
+        inline std::uint64_t clock_nanoseconds() noexcept
+        {
+            const auto now = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+        }
+
+        constexpr std::uint64_t operation_start() noexcept
+        {
+            return is_constant_evaluated() ? 0u : clock_nanoseconds();
+        }
+
+        // Shapes are rows and columns of the result, plus the inner dimension for
+        // products (zero otherwise).  Bytes are the compulsory traffic, each operand
+        // read once and each result written once.
+        constexpr std::uint64_t operation_flops(const operation op, const std::size_t rows, const std::size_t columns,
+                                                const std::size_t depth) noexcept
+        {
+            const std::uint64_t elements = static_cast<std::uint64_t>(rows) * columns;
+            switch (op)
+            {
+            case operation::multiplication:
+            case operation::gemm:
+            case operation::quantized_gemm:
+                return 2u * elements * depth;
+            case operation::magnitude:
+            case operation::dot:
+            case operation::norm:
+            case operation::axpy:
+            case operation::gemv:
+            case operation::ger:
+                return 2u * elements;
+            case operation::syrk:
+                return static_cast<std::uint64_t>(rows) * (rows + 1u) * depth;
+            case operation::sgd_momentum:
+                return 4u * elements;
+            case operation::rmsprop:
+                return 9u * elements;
+            case operation::adam:
+                return 12u * elements;
+            case operation::transpose:
+                return 0u;
+            default:
+                return elements;
+            }
+        }
+
+        constexpr std::uint64_t operation_bytes(const operation op, const std::size_t element_size, const std::size_t rows,
+                                                const std::size_t columns, const std::size_t depth) noexcept
+        {
+            const std::uint64_t elements = static_cast<std::uint64_t>(rows) * columns;
+            switch (op)
+            {
+            case operation::multiplication:
+                return element_size * (rows * depth + depth * columns + elements);
+            case operation::gemm:
+                return element_size * (rows * depth + depth * columns + 2u * elements);
+            case operation::gemv:
+                return element_size * (elements + columns + 2u * rows);
+            case operation::ger:
+                return element_size * (2u * elements + rows + columns);
+            case operation::syrk:
+                return element_size * (rows * depth + rows * (rows + 1u));
+            case operation::quantized_gemm:
+                return element_size * (rows * depth + depth * columns) + sizeof(float) * elements;
+            case operation::sgd_momentum:
+            case operation::rmsprop:
+                return 5u * element_size * elements;
+            case operation::adam:
+                return 7u * element_size * elements;
+            case operation::outer:
+                return element_size * (rows + columns + elements);
+            case operation::kronecker:
+                // The factors are small next to the result
+                return element_size * elements;
+            case operation::magnitude:
+            case operation::sum:
+            case operation::norm:
+            case operation::extremum:
+            case operation::logsumexp:
+                return element_size * elements;
+            case operation::transpose:
+            case operation::equality:
+            case operation::dot:
+            case operation::map:
+            case operation::scalar_multiplication:
+            case operation::scalar_division:
+            case operation::softmax:
+                return 2u * element_size * elements;
+            default:
+                return 3u * element_size * elements;
+            }
+        }
+    }
+}
+
+#ifdef LAL_ENABLE_COUNTERS
+#include "counters.hpp"
+#define LAL_COUNT_OPERATION(op, T, rows, columns, depth) \
+    ::lal::detail::count_operation<::lal::operation::op, T, rows, columns, depth>(lal_operation_start_)
+#else
+#define LAL_COUNT_OPERATION(op, T, rows, columns, depth) static_cast<void>(0)
+#endif
+
+#ifdef LAL_ENABLE_TRACING
+#include "tracing.hpp"
+#define LAL_TRACE_OPERATION(op, T, rows, columns, depth) \
+    ::lal::detail::trace_operation<::lal::operation::op, T, rows, columns, depth>(lal_operation_start_)
+#else
+#define LAL_TRACE_OPERATION(op, T, rows, columns, depth) static_cast<void>(0)
+#endif
+
+#ifdef LAL_ENABLE_COPY_TRACKING
+#include "copy_tracking.hpp"
+#define LAL_TRACK_MATRIX(event, T, rows, columns) \
+    ::lal::detail::track_matrix<::lal::detail::matrix_event::event, T, rows, columns>()
+#else
+#define LAL_TRACK_MATRIX(event, T, rows, columns) static_cast<void>(0)
+#endif
+
+#if defined(LAL_ENABLE_COUNTERS) || defined(LAL_ENABLE_TRACING)
+// The start time must not be const, otherwise initialising it could itself be
+// constant evaluated and always yield zero
+#define LAL_OPERATION_BEGIN() std::uint64_t lal_operation_start_ = ::lal::detail::operation_start()
+#define LAL_OPERATION_END(op, T, rows, columns, depth) \
+    (LAL_COUNT_OPERATION(op, T, rows, columns, depth), LAL_TRACE_OPERATION(op, T, rows, columns, depth))
+#else
+#define LAL_OPERATION_BEGIN() static_cast<void>(0)
+#define LAL_OPERATION_END(op, T, rows, columns, depth) static_cast<void>(0)
+#endif
+
+#endif
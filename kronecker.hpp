@@ -0,0 +1,151 @@
+#ifndef LAL_KRONECKER_HPP
+#define LAL_KRONECKER_HPP
+
+#include "instrumentation.hpp"
+#include "matrix_view.hpp"
+#include "matrix.hpp"
+#include "blas.hpp"
+
+#include <type_traits>
+#include <cstddef>
+
+// Outer and Kronecker products with the dimensions of the result deduced from the
+// operands.  outer(u, v) takes vectors of either orientation and kron(A, B) of an
+// M x N and a P x Q matrix is the MP x NQ block matrix whose (i, j) block is
+// A[i][j] * B.  Both fill each element of the result once instead of going through
+// a product.
+//
+// A Kronecker product is rarely worth storing, kronecker(A, B) only refers to its
+// factors and multiplies (A kron B) * x with the vec trick: each N*Q column of x is
+// read as an N x Q matrix X, and A * X * transpose(B) read back row by row is the
+// corresponding column of the product.  That is (N Q P + M N P) multiply-adds a
+// column rather than M N P Q, with no MP x NQ matrix in between.
+namespace lal
+{
+    // Outer product, u * transpose(v) for column vectors u and v
+    template <typename T, std::size_t R1, std::size_t C1, std::size_t R2, std::size_t C2>
+    constexpr matrix<T, R1 * C1, R2 * C2> outer(const matrix<T, R1, C1>& u, const matrix<T, R2, C2>& v)
+        noexcept(std::is_nothrow_default_constructible_v<matrix<T, R1 * C1, R2 * C2>> &&
+                 noexcept(std::declval<T&>() = T{} * T{}))
+    {
+        static_assert(R1 == 1u || C1 == 1u, "outer requires u to be a vector");
+        static_assert(R2 == 1u || C2 == 1u, "outer requires v to be a vector");
+
+        LAL_OPERATION_BEGIN();
+        matrix<T, R1 * C1, R2 * C2> ret{};
+        for (std::size_t i = 0u; i < R1 * C1; ++i)
+        {
+            const T x = u[i / C1][i % C1];
+            for (std::size_t j = 0u; j < R2 * C2; ++j)
+                ret[i][j] = x * v[j / C2][j % C2];
+        }
+
+        LAL_OPERATION_END(outer, T, R1 * C1, R2 * C2, 0u);
+        return ret;
+    }
+
+    // C = A kron B, C may be a view for products too large to return by value
+    template <typename MatrixA, typename MatrixB, typename MatrixC,
+              std::enable_if_t<is_viewable_v<MatrixA> && is_viewable_v<MatrixB> && is_viewable_v<MatrixC>, bool> = true>
+    constexpr void kron(const MatrixA& a, const MatrixB& b, MatrixC&& c)
+        noexcept(std::is_nothrow_assignable_v<detail::element_t<MatrixC>&, detail::element_t<MatrixC>>)
+    {
+        using T = detail::element_t<MatrixC>;
+        using view_a = view_t<const std::remove_reference_t<MatrixA>>;
+        using view_b = view_t<const std::remove_reference_t<MatrixB>>;
+        using view_c = view_t<std::remove_reference_t<MatrixC>>;
+        constexpr std::size_t P = view_b::row_count;
+        constexpr std::size_t Q = view_b::column_count;
+        static_assert(view_c::row_count == view_a::row_count * P && view_c::column_count == view_a::column_count * Q,
+                      "kron requires C to be (rows of A * rows of B) x (columns of A * columns of B)");
+
+        LAL_OPERATION_BEGIN();
+        const view_a va = make_view(a);
+        const view_b vb = make_view(b);
+        const view_c vc = make_view(c);
+        for (std::size_t i = 0u; i < view_a::row_count; ++i)
+        {
+            for (std::size_t k = 0u; k < P; ++k)
+            {
+                const auto c_row = vc[i * P + k];
+                const auto b_row = vb[k];
+                for (std::size_t j = 0u; j < view_a::column_count; ++j)
+                {
+                    const T scale = va[i][j];
+                    for (std::size_t l = 0u; l < Q; ++l)
+                        c_row[j * Q + l] = scale * b_row[l];
+                }
+            }
+        }
+
+        LAL_OPERATION_END(kronecker, T, view_c::row_count, view_c::column_count, 0u);
+    }
+
+    template <typename T, std::size_t M, std::size_t N, std::size_t P, std::size_t Q>
+    constexpr matrix<T, M * P, N * Q> kron(const matrix<T, M, N>& a, const matrix<T, P, Q>& b)
+        noexcept(std::is_nothrow_default_constructible_v<matrix<T, M * P, N * Q>> && std::is_nothrow_assignable_v<T&, T>)
+    {
+        matrix<T, M * P, N * Q> ret{};
+        kron(a, b, ret);
+        return ret;
+    }
+
+    // A kron B without its elements, holds views of A and B so both must outlive it
+    template <typename T, std::size_t M, std::size_t N, std::size_t P, std::size_t Q>
+    class kronecker_product
+    {
+    public:
+        static constexpr std::size_t row_count = M * P;
+        static constexpr std::size_t column_count = N * Q;
+
+        constexpr kronecker_product(const matrix_view<const T, M, N> a, const matrix_view<const T, P, Q> b) noexcept
+            : a_{ a }
+            , b_{ b }
+        {}
+
+        constexpr matrix_view<const T, M, N> lhs() const noexcept { return a_; }
+        constexpr matrix_view<const T, P, Q> rhs() const noexcept { return b_; }
+
+    private:
+        matrix_view<const T, M, N> a_;
+        matrix_view<const T, P, Q> b_;
+    };
+
+    template <typename MatrixA, typename MatrixB, std::enable_if_t<is_viewable_v<MatrixA> && is_viewable_v<MatrixB>, bool> = true>
+    constexpr auto kronecker(const MatrixA& a, const MatrixB& b) noexcept
+    {
+        using view_a = view_t<const std::remove_reference_t<MatrixA>>;
+        using view_b = view_t<const std::remove_reference_t<MatrixB>>;
+        using T = typename view_a::value_type;
+        static_assert(std::is_same_v<typename view_b::value_type, T>, "kronecker requires A and B to have the same element type");
+
+        return kronecker_product<T, view_a::row_count, view_a::column_count, view_b::row_count, view_b::column_count>{
+            make_view(a), make_view(b)
+        };
+    }
+
+    // (A kron B) * x, column by column with the vec trick.  Z holds X * transpose(B)
+    // for every column of x side by side, row j of Z being the P x K block B * X_j,
+    // so that the whole result is the single product A * Z
+    template <typename T, std::size_t M, std::size_t N, std::size_t P, std::size_t Q, std::size_t K>
+    constexpr matrix<T, M * P, K> operator*(const kronecker_product<T, M, N, P, Q>& lhs, const matrix<T, N * Q, K>& x)
+        noexcept(std::is_nothrow_default_constructible_v<matrix<T, M * P, K>> && detail::is_nothrow_multiply_add_v<T>)
+    {
+        matrix<T, N, P * K> z{};
+        if constexpr (K == 1u)
+        {
+            gemm<transposition::none, transposition::transpose>(T{ 1 }, matrix_view<const T, N, Q>{ x.data() }, lhs.rhs(), T{}, z);
+        }
+        else
+        {
+            for (std::size_t j = 0u; j < N; ++j)
+                gemm(T{ 1 }, lhs.rhs(), matrix_view<const T, Q, K>{ x[j * Q] }, T{}, matrix_view<T, P, K>{ z[j] });
+        }
+
+        matrix<T, M * P, K> ret{};
+        gemm(T{ 1 }, lhs.lhs(), z, T{}, matrix_view<T, M, P * K>{ ret.data() });
+        return ret;
+    }
+}
+
+#endif
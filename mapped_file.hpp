@@ -0,0 +1,175 @@
+#ifndef LAL_MAPPED_FILE_HPP
+#define LAL_MAPPED_FILE_HPP
+
+#include <system_error>
+#include <filesystem>
+#include <cstddef>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace lal
+{
+    // Read-only memory mapping of a whole file, the mapping is page aligned and
+    // stays valid for the lifetime of the object
+    class mapped_file
+    {
+    public:
+        // Construction and assignment
+        mapped_file() noexcept = default;
+
+        explicit mapped_file(const std::filesystem::path& path)
+        {
+#ifdef _WIN32
+            file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE)
+                throw_last_error("Unable to open file for mapping");
+
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(file_, &size))
+                throw_last_error("Unable to determine size of mapped file");
+
+            size_ = static_cast<std::size_t>(size.QuadPart);
+            if (size_ == 0u)
+                return;
+
+            mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ == nullptr)
+                throw_last_error("Unable to create file mapping");
+
+            data_ = static_cast<const std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            if (data_ == nullptr)
+                throw_last_error("Unable to map view of file");
+#else
+            file_ = ::open(path.c_str(), O_RDONLY);
+            if (file_ == -1)
+                throw_last_error("Unable to open file for mapping");
+
+            struct stat status{};
+            if (::fstat(file_, &status) == -1)
+                throw_last_error("Unable to determine size of mapped file");
+
+            size_ = static_cast<std::size_t>(status.st_size);
+            if (size_ == 0u)
+                return;
+
+            void* const address = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, file_, 0);
+            if (address == MAP_FAILED)
+                throw_last_error("Unable to map file");
+
+            data_ = static_cast<const std::byte*>(address);
+#endif
+        }
+
+        ~mapped_file() { close(); }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept
+            : data_{ std::exchange(other.data_, nullptr) }
+            , size_{ std::exchange(other.size_, 0u) }
+            , file_{ std::exchange(other.file_, invalid_file) }
+#ifdef _WIN32
+            , mapping_{ std::exchange(other.mapping_, nullptr) }
+#endif
+        {}
+
+        mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            if (this != &other)
+            {
+                close();
+                data_ = std::exchange(other.data_, nullptr);
+                size_ = std::exchange(other.size_, 0u);
+                file_ = std::exchange(other.file_, invalid_file);
+#ifdef _WIN32
+                mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+            }
+
+            return *this;
+        }
+
+        // Access
+        const std::byte* data() const noexcept { return data_; }
+
+        // Properties
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0u; }
+
+    private:
+#ifdef _WIN32
+        using file_handle = HANDLE;
+        static inline const file_handle invalid_file = INVALID_HANDLE_VALUE;
+
+        [[noreturn]] void throw_last_error(const char* const what)
+        {
+            const std::error_code error{ static_cast<int>(GetLastError()), std::system_category() };
+            close();
+            throw std::system_error(error, what);
+        }
+
+        void close() noexcept
+        {
+            if (data_ != nullptr)
+                UnmapViewOfFile(data_);
+            if (mapping_ != nullptr)
+                CloseHandle(mapping_);
+            if (file_ != invalid_file)
+                CloseHandle(file_);
+
+            data_ = nullptr;
+            mapping_ = nullptr;
+            file_ = invalid_file;
+            size_ = 0u;
+        }
+#else
+        using file_handle = int;
+        static constexpr file_handle invalid_file = -1;
+
+        [[noreturn]] void throw_last_error(const char* const what)
+        {
+            const std::error_code error{ errno, std::system_category() };
+            close();
+            throw std::system_error(error, what);
+        }
+
+        void close() noexcept
+        {
+            if (data_ != nullptr)
+                ::munmap(const_cast<std::byte*>(data_), size_);
+            if (file_ != invalid_file)
+                ::close(file_);
+
+            data_ = nullptr;
+            file_ = invalid_file;
+            size_ = 0u;
+        }
+#endif
+
+        const std::byte* data_ = nullptr;
+        std::size_t size_ = 0u;
+        file_handle file_ = invalid_file;
+#ifdef _WIN32
+        HANDLE mapping_ = nullptr;
+#endif
+    };
+}
+
+#endif
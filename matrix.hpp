@@ -10,18 +10,43 @@
 #include <tuple>
 #include <cmath>
 
+#include "instrumentation.hpp"
+#include "cblas_backend.hpp"
+#include "summation.hpp"
+
 namespace lal
 {
+    namespace detail
+    {
+        // Constructor tags for kernels that write every element of their result, so
+        // that it isn't zero filled first
+        struct from_elements_t {};
+        struct uninitialized_t {};
+
+        inline constexpr from_elements_t from_elements{};
+        inline constexpr uninitialized_t uninitialized{};
+
+        // Where the arenas of autodiff.hpp and task_graph.hpp place the matrices they
+        // construct.  matrix itself only needs alignof(T), the arenas choose 64-byte
+        // placement so that each matrix starts on a cache line of its own
+        inline constexpr std::size_t arena_alignment = 64u;
+    }
+
     template <typename T, std::size_t Rows, std::size_t Columns>
     class matrix
     {
+        // Random access like std::reverse_iterator, it holds the position one past the
+        // element it refers to so that rend() never points before the first element
         template <typename IteratorType, typename ValueType, typename Pointer, typename Reference>
         class reverse_iterator_base
         {
+            template <typename, typename, typename, typename>
+            friend class reverse_iterator_base;
+
         public:
             using iterator_type = IteratorType;
-            using iterator_category = std::bidirectional_iterator_tag;
-            using value_type = ValueType;
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::remove_cv_t<ValueType>;
             using difference_type = std::ptrdiff_t;
             using pointer = Pointer;
             using reference = Reference;
@@ -29,27 +54,26 @@ namespace lal
             // Construction and assignment
             constexpr reverse_iterator_base() = default;
 
-            constexpr explicit reverse_iterator_base(const iterator_type it) noexcept : it_{ it - 1 } {}
+            constexpr explicit reverse_iterator_base(const iterator_type it) noexcept : it_{ it } {}
 
-            constexpr explicit reverse_iterator_base(const reverse_iterator_base& rit) noexcept
+            // Reverse iterators convert to const reverse iterators
+            template <typename OtherIterator, typename OtherValueType, typename OtherPointer, typename OtherReference,
+                      std::enable_if_t<!std::is_same_v<OtherIterator, IteratorType> && std::is_convertible_v<OtherIterator, IteratorType>, bool> = true>
+            constexpr reverse_iterator_base(const reverse_iterator_base<OtherIterator, OtherValueType, OtherPointer, OtherReference>& rit) noexcept
                 : it_{ rit.it_ }
             {}
 
-            constexpr reverse_iterator_base& operator=(const reverse_iterator_base& rit) noexcept
-            {
-                it_ = rit.it_;
-                return it_;
-            }
+            constexpr reverse_iterator_base(const reverse_iterator_base& rit) noexcept = default;
+            constexpr reverse_iterator_base& operator=(const reverse_iterator_base& rit) noexcept = default;
 
-            constexpr iterator_type base() const noexcept { return it_ + 1; }
+            constexpr iterator_type base() const noexcept { return it_; }
 
             // Dereference
-            constexpr reference operator*() const noexcept { return *it_; }
-            constexpr pointer operator->() const noexcept { return it_; }
+            constexpr reference operator*() const noexcept { return *(it_ - 1); }
+            constexpr pointer operator->() const noexcept { return it_ - 1; }
 
             // Access
-            constexpr reference operator[](const difference_type n) noexcept { return *(it_ - n); }
-            constexpr const reference operator[](const difference_type n) const noexcept { return *(it_ - n); }
+            constexpr reference operator[](const difference_type n) const noexcept { return *(it_ - n - 1); }
 
             // Iterator arithmetic
             constexpr reverse_iterator_base& operator++() noexcept
@@ -80,12 +104,22 @@ namespace lal
 
             constexpr reverse_iterator_base operator+(const difference_type n) const noexcept
             {
-                return reverse_iterator_base{ it_ - n + 1 };
+                return reverse_iterator_base{ it_ - n };
+            }
+
+            friend constexpr reverse_iterator_base operator+(const difference_type n, const reverse_iterator_base& rit) noexcept
+            {
+                return rit + n;
             }
 
             constexpr reverse_iterator_base operator-(const difference_type n) const noexcept
             {
-                return reverse_iterator_base{ it_ + n + 1 };
+                return reverse_iterator_base{ it_ + n };
+            }
+
+            friend constexpr difference_type operator-(const reverse_iterator_base& lhs, const reverse_iterator_base& rhs) noexcept
+            {
+                return rhs.it_ - lhs.it_;
             }
 
             constexpr reverse_iterator_base& operator+=(const difference_type n) noexcept
@@ -100,15 +134,35 @@ namespace lal
                 return *this;
             }
 
-            // Comparison
-            constexpr bool operator==(const reverse_iterator_base& other) noexcept
+            // Comparison, as friends so a reverse iterator and a const one can be compared
+            friend constexpr bool operator==(const reverse_iterator_base& lhs, const reverse_iterator_base& rhs) noexcept
+            {
+                return lhs.it_ == rhs.it_;
+            }
+
+            friend constexpr bool operator!=(const reverse_iterator_base& lhs, const reverse_iterator_base& rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+
+            friend constexpr bool operator<(const reverse_iterator_base& lhs, const reverse_iterator_base& rhs) noexcept
+            {
+                return rhs.it_ < lhs.it_;
+            }
+
+            friend constexpr bool operator>(const reverse_iterator_base& lhs, const reverse_iterator_base& rhs) noexcept
             {
-                return it_ == other.it_;
+                return rhs < lhs;
             }
 
-            constexpr bool operator!=(const reverse_iterator_base& other) noexcept
+            friend constexpr bool operator<=(const reverse_iterator_base& lhs, const reverse_iterator_base& rhs) noexcept
             {
-                return !(*this == other);
+                return !(rhs < lhs);
+            }
+
+            friend constexpr bool operator>=(const reverse_iterator_base& lhs, const reverse_iterator_base& rhs) noexcept
+            {
+                return !(lhs < rhs);
             }
 
         private:
@@ -132,42 +186,72 @@ namespace lal
         using const_row_reference = const value_type(&)[Columns];
 
         // Construction and assignment
-        constexpr matrix() noexcept(std::is_nothrow_default_constructible_v<T>) {}
+        constexpr matrix() noexcept(std::is_nothrow_default_constructible_v<T>)
+            : data_{}
+        {
+            LAL_TRACK_MATRIX(construction, T, Rows, Columns);
+        }
         ~matrix() = default;
+
+        // Elements in row-major order
+        template <typename... Elements>
+        constexpr matrix(detail::from_elements_t, Elements&&... elements)
+            noexcept((std::is_nothrow_constructible_v<T, Elements&&> && ...))
+            : data_{ std::forward<Elements>(elements)... }
+        {
+            static_assert(sizeof...(Elements) == Rows * Columns, "Exactly one element is required for each position");
+            LAL_TRACK_MATRIX(construction, T, Rows, Columns);
+        }
+
+        // Leaves the elements default initialised, which cannot be constant evaluated
+        explicit matrix(detail::uninitialized_t) noexcept(std::is_nothrow_default_constructible_v<T>)
+        {
+            LAL_TRACK_MATRIX(construction, T, Rows, Columns);
+        }
         
         constexpr matrix(const matrix& other) noexcept(std::is_nothrow_copy_assignable_v<T>)
+            : data_{}
         {
-            auto o = other.begin();
-            for (auto t = begin(); t != end(); ++t, ++o)
-                *t = *o;
+            LAL_TRACK_MATRIX(copy, T, Rows, Columns);
+            for (std::size_t row = 0u; row < Rows; ++row)
+                for (std::size_t column = 0u; column < Columns; ++column)
+                    data_[row][column] = other.data_[row][column];
         }
 
         constexpr matrix& operator=(const matrix& other) noexcept(std::is_nothrow_copy_assignable_v<T>)
         {
-            auto o = other.begin();
-            for (auto t = begin(); t != end(); ++t, ++o)
-                *t = *o;
+            LAL_TRACK_MATRIX(copy, T, Rows, Columns);
+            for (std::size_t row = 0u; row < Rows; ++row)
+                for (std::size_t column = 0u; column < Columns; ++column)
+                    data_[row][column] = other.data_[row][column];
 
             return *this;
         }
 
         constexpr matrix(matrix&& other) noexcept(std::is_nothrow_move_assignable_v<T>)
+            : data_{}
         {
-            for (auto t = begin(), o = other.begin(); t != end(); ++t, ++o)
-                *t = std::move(*o);
+            LAL_TRACK_MATRIX(move, T, Rows, Columns);
+            for (std::size_t row = 0u; row < Rows; ++row)
+                for (std::size_t column = 0u; column < Columns; ++column)
+                    data_[row][column] = std::move(other.data_[row][column]);
         }
 
         constexpr matrix& operator=(matrix&& other) noexcept(std::is_nothrow_move_assignable_v<T>)
         {
-            for (auto t = begin(), o = other.begin(); t != end(); ++t, ++o)
-                *t = std::move(*o);
+            LAL_TRACK_MATRIX(move, T, Rows, Columns);
+            for (std::size_t row = 0u; row < Rows; ++row)
+                for (std::size_t column = 0u; column < Columns; ++column)
+                    data_[row][column] = std::move(other.data_[row][column]);
 
             return *this;
         }
 
         constexpr matrix(const T (&data)[Rows][Columns])
             noexcept(std::is_nothrow_default_constructible_v<T> && std::is_nothrow_assignable_v<T&, T>)
+            : data_{}
         {
+            LAL_TRACK_MATRIX(construction, T, Rows, Columns);
             for (std::size_t row = 0u; row < Rows; ++row)
                 for (std::size_t column = 0u; column < Columns; ++column)
                     data_[row][column] = data[row][column];
@@ -175,14 +259,18 @@ namespace lal
 
         constexpr matrix(T (&&data)[Rows][Columns])
             noexcept(std::is_nothrow_default_constructible_v<T> && std::is_nothrow_move_assignable_v<T>)
+            : data_{}
         {
+            LAL_TRACK_MATRIX(construction, T, Rows, Columns);
             for (std::size_t row = 0u; row < Rows; ++row)
                 for (std::size_t column = 0u; column < Columns; ++column)
                     data_[row][column] = std::move(data[row][column]);
         }
 
         constexpr matrix(std::initializer_list<T[Columns]>&& row_list)
+            : data_{}
         {
+            LAL_TRACK_MATRIX(construction, T, Rows, Columns);
             if (row_list.size() != Rows)
                 throw std::length_error("Too many elements used to initialise matrix class");
 
@@ -221,7 +309,8 @@ namespace lal
         constexpr row_reference operator[](const size_type pos) noexcept { return data_[pos]; }
         constexpr const_row_reference operator[](const size_type pos) const noexcept { return data_[pos]; }
 
-        // Iterators
+        // Iterators, the forward ones are pointers so they are contiguous and work with
+        // anything taking a pointer range
         constexpr iterator begin() noexcept { return &data_[0][0]; }
         constexpr const_iterator begin() const noexcept { return &data_[0][0]; }
         constexpr const_iterator cbegin() const noexcept { return &data_[0][0]; }
@@ -230,13 +319,13 @@ namespace lal
         constexpr const_iterator end() const noexcept { return begin() + size(); }
         constexpr const_iterator cend() const noexcept { return cbegin() + size(); }
 
-        constexpr reverse_iterator rbegin() { return reverse_iterator(end()); }
-        constexpr const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
-        constexpr const_reverse_iterator crbegin() const { return const_reverse_iterator(cend()); }
+        constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        constexpr const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
 
-        constexpr reverse_iterator rend() { return reverse_iterator(begin()); }
-        constexpr const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
-        constexpr const_reverse_iterator crend() const { return const_reverse_iterator(cbegin()); }
+        constexpr reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        constexpr const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
 
         // Properties
         constexpr bool empty() const noexcept { return size() != static_cast<size_type>(0); }
@@ -259,7 +348,7 @@ namespace lal
         }
 
     private:
-        T data_[Rows][Columns]{};
+        T data_[Rows][Columns];
     };
 
     // Matrix specialisation type definitions
@@ -288,15 +377,187 @@ namespace lal
     template <typename T, std::size_t Rows, std::size_t Columns>
     matrix(const T (&)[Rows][Columns]) -> matrix<T, Rows, Columns>;
 
+    // Small fixed size kernels
+    namespace detail
+    {
+        // Operations whose dimensions are all at most this are written out in full
+        // with fold expressions instead of loops, so that they compile to straight
+        // line code (and stay usable in constant expressions)
+        inline constexpr std::size_t unroll_limit = 8u;
+
+        // Type in which sums of products of T are formed, the reduced precision types
+        // in half.hpp specialise this so that they accumulate in float
+        template <typename T>
+        struct accumulator
+        {
+            using type = T;
+        };
+
+        template <typename T>
+        using accumulator_t = typename accumulator<T>::type;
+
+        template <std::size_t... Dimensions>
+        inline constexpr bool is_unrolled_v = ((Dimensions <= unroll_limit) && ...);
+
+        template <typename T>
+        inline constexpr bool is_nothrow_multiply_accumulate_v = noexcept(std::declval<T&>() += T{} * T{});
+
+        template <std::size_t Row, std::size_t Column, typename T, std::size_t I, std::size_t J, std::size_t K, std::size_t... Js>
+        constexpr T unrolled_product_element(const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs, std::index_sequence<Js...>)
+            noexcept(std::is_nothrow_default_constructible_v<T> && is_nothrow_multiply_accumulate_v<T>)
+        {
+            accumulator_t<T> sum{};
+            ((sum += lhs[Row][Js] * rhs[Js][Column]), ...);
+            return static_cast<T>(sum);
+        }
+
+        template <typename T, std::size_t I, std::size_t J, std::size_t K, std::size_t... Ns>
+        constexpr matrix<T, I, K> unrolled_product(const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs, std::index_sequence<Ns...>)
+            noexcept(std::is_nothrow_default_constructible_v<T> && is_nothrow_multiply_accumulate_v<T> && std::is_nothrow_move_constructible_v<T>)
+        {
+            return { from_elements, unrolled_product_element<Ns / K, Ns % K>(lhs, rhs, std::make_index_sequence<J>{})... };
+        }
+
+        template <typename T, std::size_t I, std::size_t J, std::size_t K>
+        constexpr void looped_product(matrix<T, I, K>& ret, const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs)
+            noexcept(is_nothrow_multiply_accumulate_v<T>)
+        {
+            if constexpr (std::is_same_v<accumulator_t<T>, T>)
+            {
+                for (std::size_t i = 0u; i < I; ++i)
+                    for (std::size_t j = 0u; j < J; ++j)
+                        for (std::size_t k = 0u; k < K; ++k)
+                            ret[i][k] += lhs[i][j] * rhs[j][k];
+            }
+            else
+            {
+                // Each element is summed in full before it's rounded to T
+                for (std::size_t i = 0u; i < I; ++i)
+                {
+                    for (std::size_t k = 0u; k < K; ++k)
+                    {
+                        accumulator_t<T> sum{};
+                        for (std::size_t j = 0u; j < J; ++j)
+                            sum += lhs[i][j] * rhs[j][k];
+
+                        ret[i][k] = static_cast<T>(sum);
+                    }
+                }
+            }
+        }
+
+        template <typename T, std::size_t I, std::size_t J, std::size_t K>
+        constexpr matrix<T, I, K> looped_product(const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs)
+            noexcept(std::is_nothrow_default_constructible_v<T> && is_nothrow_multiply_accumulate_v<T>)
+        {
+            matrix<T, I, K> ret{};
+            looped_product(ret, lhs, rhs);
+            return ret;
+        }
+
+#ifdef LAL_USE_CBLAS
+        // With a zero beta CBLAS overwrites the result without reading it
+        template <typename T, std::size_t I, std::size_t J, std::size_t K>
+        matrix<T, I, K> cblas_product(const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs) noexcept
+        {
+            matrix<T, I, K> ret{ uninitialized };
+            cblas_gemm(false, false, I, K, J, T{ 1 }, lhs.data(), J, rhs.data(), K, T{}, ret.data(), K);
+            return ret;
+        }
+#endif
+
+        // Every kernel returns its result as a prvalue so that it is constructed in place
+        template <typename T, std::size_t I, std::size_t J, std::size_t K>
+        constexpr matrix<T, I, K> product(const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs)
+            noexcept(std::is_nothrow_default_constructible_v<T> && is_nothrow_multiply_accumulate_v<T> && std::is_nothrow_move_constructible_v<T>)
+        {
+#ifdef LAL_USE_CBLAS
+            if constexpr (use_cblas_v<T, I, K, J>)
+            {
+                if (!is_constant_evaluated())
+                    return cblas_product(lhs, rhs);
+            }
+#endif
+            if constexpr (is_unrolled_v<I, J, K>)
+                return unrolled_product(lhs, rhs, std::make_index_sequence<I * K>{});
+            else
+                return looped_product(lhs, rhs);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns, std::size_t... Ns>
+        constexpr matrix<T, Columns, Rows> unrolled_transpose(const matrix<T, Rows, Columns>& m, std::index_sequence<Ns...>)
+            noexcept(std::is_nothrow_copy_constructible_v<T>)
+        {
+            return { from_elements, m[Ns % Rows][Ns / Rows]... };
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        constexpr matrix<T, Columns, Rows> looped_transpose(const matrix<T, Rows, Columns>& m)
+            noexcept(std::is_nothrow_default_constructible_v<T> && std::is_nothrow_assignable_v<T&, T>)
+        {
+            matrix<T, Columns, Rows> ret{};
+            for (std::size_t row = 0u; row < Rows; ++row)
+                for (std::size_t column = 0u; column < Columns; ++column)
+                    ret[column][row] = m[row][column];
+
+            return ret;
+        }
+
+        // Like product, both kernels return a prvalue so that the result is constructed in place
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        constexpr matrix<T, Columns, Rows> transposed(const matrix<T, Rows, Columns>& m)
+            noexcept(std::is_nothrow_default_constructible_v<T> && std::is_nothrow_copy_constructible_v<T> &&
+                     std::is_nothrow_assignable_v<T&, T>)
+        {
+            if constexpr (is_unrolled_v<Rows, Columns>)
+                return unrolled_transpose(m, std::make_index_sequence<Rows * Columns>{});
+            else
+                return looped_transpose(m);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns, std::size_t... Ns>
+        constexpr void unrolled_add(matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs, std::index_sequence<Ns...>)
+            noexcept(noexcept(std::declval<T&>() += T{}))
+        {
+            ((lhs[Ns / Columns][Ns % Columns] += rhs[Ns / Columns][Ns % Columns]), ...);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns, std::size_t... Ns>
+        constexpr void unrolled_subtract(matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs, std::index_sequence<Ns...>)
+            noexcept(noexcept(std::declval<T&>() -= T{}))
+        {
+            ((lhs[Ns / Columns][Ns % Columns] -= rhs[Ns / Columns][Ns % Columns]), ...);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns, std::size_t... Ns>
+        constexpr accumulator_t<T> unrolled_dot(const matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs,
+                                                std::index_sequence<Ns...>)
+            noexcept(std::is_nothrow_default_constructible_v<T> && is_nothrow_multiply_accumulate_v<T>)
+        {
+            accumulator_t<T> sum{};
+            ((sum += lhs[Ns / Columns][Ns % Columns] * rhs[Ns / Columns][Ns % Columns]), ...);
+            return sum;
+        }
+    }
+
     // Addition
     template <typename T, std::size_t Rows, std::size_t Columns>
-    constexpr matrix<T, Rows, Columns> operator+=(matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
+    constexpr matrix<T, Rows, Columns>& operator+=(matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
         noexcept(noexcept(std::declval<T&>() += T{}))
     {
-        auto r = rhs.begin();
-        for (auto l = lhs.begin(); l != lhs.end(); ++l, ++r)
-            *l += *r;
+        LAL_OPERATION_BEGIN();
+        if constexpr (detail::is_unrolled_v<Rows, Columns>)
+        {
+            detail::unrolled_add(lhs, rhs, std::make_index_sequence<Rows * Columns>{});
+        }
+        else
+        {
+            auto r = rhs.begin();
+            for (auto l = lhs.begin(); l != lhs.end(); ++l, ++r)
+                *l += *r;
+        }
 
+        LAL_OPERATION_END(addition, T, Rows, Columns, 0u);
         return lhs;
     }
 
@@ -313,10 +574,19 @@ namespace lal
     constexpr matrix<T, Rows, Columns>& operator-=(matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
         noexcept(noexcept(std::declval<T&>() -= T{}))
     {
-        auto r = rhs.begin();
-        for (auto l = lhs.begin(); l != lhs.end(); ++l, ++r)
-            *l -= *r;
+        LAL_OPERATION_BEGIN();
+        if constexpr (detail::is_unrolled_v<Rows, Columns>)
+        {
+            detail::unrolled_subtract(lhs, rhs, std::make_index_sequence<Rows * Columns>{});
+        }
+        else
+        {
+            auto r = rhs.begin();
+            for (auto l = lhs.begin(); l != lhs.end(); ++l, ++r)
+                *l -= *r;
+        }
 
+        LAL_OPERATION_END(subtraction, T, Rows, Columns, 0u);
         return lhs;
     }
 
@@ -333,12 +603,9 @@ namespace lal
     constexpr matrix<T, I, K> operator*(const matrix<T, I, J>& lhs, const matrix<T, J, K>& rhs)
         noexcept(std::is_nothrow_default_constructible_v<matrix<T, I, K>> && noexcept(std::declval<T&>() += T{} * T{}))
     {
-        matrix<T, I, K> ret{};
-        for (std::size_t i = 0u; i < I; ++i)
-            for (std::size_t j = 0u; j < J; ++j)
-                for (std::size_t k = 0u; k < K; ++k)
-                    ret[i][k] += lhs[i][j] * rhs[j][k];
-
+        LAL_OPERATION_BEGIN();
+        matrix<T, I, K> ret = detail::product(lhs, rhs);
+        LAL_OPERATION_END(multiplication, T, I, K, J);
         return ret;
     }
 
@@ -346,7 +613,31 @@ namespace lal
     constexpr matrix<T, Rows, Columns>& operator*=(matrix<T, Rows, Columns>& lhs, const square_matrix<T, Columns>& rhs)
         noexcept(noexcept(matrix<T, Rows, Columns>{} * square_matrix<T, Columns>{}))
     {
-        lhs = lhs * rhs;
+        // Squaring in place reads rows of rhs after they have been overwritten
+        if constexpr (Rows == Columns)
+        {
+            if (&lhs == &rhs)
+            {
+                lhs = lhs * rhs;
+                return lhs;
+            }
+        }
+
+        // Each row of the result only depends on the same row of lhs so a single
+        // row of scratch space is needed rather than a whole temporary matrix
+        LAL_OPERATION_BEGIN();
+        for (std::size_t i = 0u; i < Rows; ++i)
+        {
+            row_vector<detail::accumulator_t<T>, Columns> row{};
+            for (std::size_t j = 0u; j < Columns; ++j)
+                for (std::size_t k = 0u; k < Columns; ++k)
+                    row[0][k] += lhs[i][j] * rhs[j][k];
+
+            for (std::size_t k = 0u; k < Columns; ++k)
+                lhs[i][k] = static_cast<T>(std::move(row[0][k]));
+        }
+
+        LAL_OPERATION_END(multiplication, T, Rows, Columns, Columns);
         return lhs;
     }
 
@@ -354,9 +645,11 @@ namespace lal
     constexpr matrix<T, Rows, Columns>& operator*=(matrix<T, Rows, Columns>& m, const T scalar)
         noexcept(noexcept(std::declval<T&>() *= T{}))
     {
+        LAL_OPERATION_BEGIN();
         for (auto& element : m)
             element *= scalar;
 
+        LAL_OPERATION_END(scalar_multiplication, T, Rows, Columns, 0u);
         return m;
     }
 
@@ -386,10 +679,12 @@ namespace lal
     constexpr matrix<T, Rows, Columns>& operator%=(matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
         noexcept(noexcept(std::declval<T&>() *= T{}))
     {
+        LAL_OPERATION_BEGIN();
         auto r = rhs.begin();
         for (auto l = lhs.begin(); l != lhs.end(); ++l, ++r)
             *l *= *r;
 
+        LAL_OPERATION_END(hadamard_product, T, Rows, Columns, 0u);
         return lhs;
     }
 
@@ -405,9 +700,11 @@ namespace lal
     template <typename T, std::size_t Rows, std::size_t Columns>
     constexpr matrix<T, Rows, Columns>& operator/=(matrix<T, Rows, Columns>& m, const T scalar) noexcept(noexcept(std::declval<T&>() /= T{}))
     {
+        LAL_OPERATION_BEGIN();
         for (auto& element : m)
             element /= scalar;
 
+        LAL_OPERATION_END(scalar_division, T, Rows, Columns, 0u);
         return m;
     }
 
@@ -423,10 +720,20 @@ namespace lal
     template <typename T, std::size_t Rows, std::size_t Columns>
     constexpr bool operator==(const matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs) noexcept(noexcept(T{} == T{}))
     {
-        for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r)
-            if (*l != *r)
-                return false;
+        LAL_OPERATION_BEGIN();
+        for (std::size_t row = 0u; row < Rows; ++row)
+        {
+            for (std::size_t column = 0u; column < Columns; ++column)
+            {
+                if (lhs[row][column] != rhs[row][column])
+                {
+                    LAL_OPERATION_END(equality, T, Rows, Columns, 0u);
+                    return false;
+                }
+            }
+        }
 
+        LAL_OPERATION_END(equality, T, Rows, Columns, 0u);
         return true;
     }
 
@@ -453,23 +760,42 @@ namespace lal
     constexpr matrix<T, Columns, Rows> transpose(const matrix<T, Rows, Columns>& m)
         noexcept(std::is_nothrow_default_constructible_v<matrix<T, Columns, Rows>> && std::is_nothrow_assignable_v<T&, T>)
     {
-        matrix<T, Columns, Rows> ret{};
-        for (std::size_t row = 0u; row < Rows; ++row)
-            for (std::size_t column = 0u; column < Columns; ++column)
-                ret[column][row] = m[row][column];
+        LAL_OPERATION_BEGIN();
+        matrix<T, Columns, Rows> ret = detail::transposed(m);
+        LAL_OPERATION_END(transpose, T, Columns, Rows, 0u);
+        return ret;
+    }
+
+    // Sum of the products of corresponding elements, for vectors the usual dot product
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    constexpr detail::accumulator_t<T> dot(const matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
+        noexcept(std::is_nothrow_default_constructible_v<T> && detail::is_nothrow_multiply_accumulate_v<T>)
+    {
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        accumulator ret{};
+        if constexpr (Mode == summation::pairwise && detail::is_unrolled_v<Rows, Columns>)
+            ret = detail::unrolled_dot(lhs, rhs, std::make_index_sequence<Rows * Columns>{});
+        else
+            ret = detail::reduce_matrix<Mode, accumulator, Rows, Columns>([&lhs, &rhs](const std::size_t row, const std::size_t column) {
+                return static_cast<accumulator>(lhs[row][column] * rhs[row][column]);
+            });
 
+        LAL_OPERATION_END(dot, T, Rows, Columns, 0u);
         return ret;
     }
 
     template <typename T, std::size_t Rows, std::size_t Columns>
     constexpr auto magnitude(const matrix<T, Rows, Columns>& m)
     {
-        const matrix<T, Rows, Columns> m_squared = m % m;
-
-        T sum{};
-        for (auto element = m_squared.begin(); element != m_squared.end(); ++element)
-            sum += *element;
-
+        // Squares are summed as they are formed rather than through a temporary m % m,
+        // pairwise like magnitude(par, m)
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        const accumulator sum = detail::reduce_matrix<summation::pairwise, accumulator, Rows, Columns>(
+            [&m](const std::size_t row, const std::size_t column) { return static_cast<accumulator>(m[row][column] * m[row][column]); });
+
+        LAL_OPERATION_END(magnitude, T, Rows, Columns, 0u);
         if constexpr (std::is_floating_point_v<T>)
             return std::sqrt(sum);
         else
@@ -481,11 +807,13 @@ namespace lal
         noexcept(std::is_nothrow_default_constructible_v<matrix<decltype(f(T{})), Rows, Columns>> &&
                  noexcept(f(T{})) && std::is_nothrow_assignable_v<decltype(f(T{}))&, decltype(f(T{}))>)
     {
+        LAL_OPERATION_BEGIN();
         auto element = m.begin();
         matrix<decltype(f(T{})), Rows, Columns > ret{};
         for (auto r = ret.begin(); r != ret.end(); ++r, ++element)
             *r = f(*element);
 
+        LAL_OPERATION_END(map, T, Rows, Columns, 0u);
         return ret;
     }
 }
@@ -0,0 +1,155 @@
+#ifndef LAL_MATRIX_VIEW_HPP
+#define LAL_MATRIX_VIEW_HPP
+
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+
+namespace lal
+{
+    // Non-owning view of row-major storage with compile time dimensions, the row
+    // stride lets a view refer to a block inside a larger matrix
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    class matrix_view
+    {
+    public:
+        // Type definitions
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using pointer = T*;
+        using row_pointer = T*;
+
+        static constexpr size_type row_count = Rows;
+        static constexpr size_type column_count = Columns;
+
+        // Construction and assignment
+        constexpr matrix_view() noexcept = default;
+
+        constexpr explicit matrix_view(const pointer data, const size_type stride = Columns) noexcept
+            : data_{ data }
+            , stride_{ stride }
+        {}
+
+        template <typename U, std::enable_if_t<std::is_same_v<const U, T>, bool> = true>
+        constexpr matrix_view(const matrix_view<U, Rows, Columns>& other) noexcept
+            : data_{ other.data() }
+            , stride_{ other.stride() }
+        {}
+
+        constexpr matrix_view(matrix<value_type, Rows, Columns>& m) noexcept : data_{ m.data() } {}
+
+        template <typename U = T, std::enable_if_t<std::is_const_v<U>, bool> = true>
+        constexpr matrix_view(const matrix<value_type, Rows, Columns>& m) noexcept : data_{ m.data() } {}
+
+        // Access
+        constexpr row_pointer at(const size_type pos) const
+        {
+            if (pos >= Rows)
+                throw std::out_of_range("Subscript out of range");
+
+            return (*this)[pos];
+        }
+
+        constexpr reference front() const noexcept { return data_[0]; }
+        constexpr reference back() const noexcept { return (*this)[Rows - 1][Columns - 1]; }
+
+        constexpr pointer data() const noexcept { return data_; }
+
+        constexpr row_pointer operator[](const size_type pos) const noexcept { return data_ + pos * stride_; }
+
+        // Properties
+        constexpr size_type size() const noexcept { return Rows * Columns; }
+        constexpr size_type rows() const noexcept { return Rows; }
+        constexpr size_type columns() const noexcept { return Columns; }
+        constexpr size_type stride() const noexcept { return stride_; }
+        constexpr bool contiguous() const noexcept { return stride_ == Columns || Rows == 1u; }
+
+        // Algorithms
+        template <typename U = T, std::enable_if_t<!std::is_const_v<U>, bool> = true>
+        constexpr void fill(const value_type& value) const noexcept(std::is_nothrow_assignable_v<value_type&, value_type>)
+        {
+            for (size_type row = 0u; row < Rows; ++row)
+                for (size_type column = 0u; column < Columns; ++column)
+                    (*this)[row][column] = value;
+        }
+
+    private:
+        pointer data_ = nullptr;
+        size_type stride_ = Columns;
+    };
+
+    // Template deduction guides
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix_view(matrix<T, Rows, Columns>&) -> matrix_view<T, Rows, Columns>;
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix_view(const matrix<T, Rows, Columns>&) -> matrix_view<const T, Rows, Columns>;
+
+    // View creation
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr matrix_view<T, Rows, Columns> make_view(matrix<T, Rows, Columns>& m) noexcept
+    {
+        return matrix_view<T, Rows, Columns>{ m };
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr matrix_view<const T, Rows, Columns> make_view(const matrix<T, Rows, Columns>& m) noexcept
+    {
+        return matrix_view<const T, Rows, Columns>{ m };
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr matrix_view<T, Rows, Columns> make_view(const matrix_view<T, Rows, Columns> v) noexcept
+    {
+        return v;
+    }
+
+    template <typename Matrix>
+    using view_t = decltype(make_view(std::declval<Matrix&>()));
+
+    namespace detail
+    {
+        template <typename Matrix, typename = void>
+        struct is_viewable : std::false_type {};
+
+        template <typename Matrix>
+        struct is_viewable<Matrix, std::void_t<view_t<Matrix>>> : std::true_type {};
+    }
+
+    template <typename Matrix>
+    inline constexpr bool is_viewable_v = detail::is_viewable<std::remove_reference_t<Matrix>>::value;
+
+    template <std::size_t SubRows, std::size_t SubColumns, typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    constexpr auto submatrix(Matrix&& m, const std::size_t row, const std::size_t column)
+    {
+        using view = view_t<std::remove_reference_t<Matrix>>;
+        static_assert(SubRows <= view::row_count && SubColumns <= view::column_count, "Submatrix larger than matrix");
+
+        const view v = make_view(m);
+        if (row + SubRows > view::row_count || column + SubColumns > view::column_count)
+            throw std::out_of_range("Submatrix out of range");
+
+        return matrix_view<typename view::element_type, SubRows, SubColumns>{ v[row] + column, v.stride() };
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr matrix<std::remove_cv_t<T>, Rows, Columns> make_matrix(const matrix_view<T, Rows, Columns> v)
+        noexcept(std::is_nothrow_default_constructible_v<matrix<std::remove_cv_t<T>, Rows, Columns>> &&
+                 std::is_nothrow_copy_assignable_v<std::remove_cv_t<T>>)
+    {
+        matrix<std::remove_cv_t<T>, Rows, Columns> ret{};
+        for (std::size_t row = 0u; row < Rows; ++row)
+            for (std::size_t column = 0u; column < Columns; ++column)
+                ret[row][column] = v[row][column];
+
+        return ret;
+    }
+}
+
+#endif
@@ -0,0 +1,551 @@
+#ifndef LAL_NN_HPP
+#define LAL_NN_HPP
+
+#include "matrix_view.hpp"
+#include "softmax.hpp"
+#include "matrix.hpp"
+#include "blas.hpp"
+
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <cmath>
+
+// Neural network layers which work on a batch of samples at a time.  A batch is a
+// matrix with one sample per row, and a sample with a shape<Channels, Height, Width>
+// is stored channel by channel with each channel in row-major order.
+//
+// Layers have forward(x, y) and backward(x, dy, dx) (or backward(x, dy) when dx isn't
+// needed), backward adds the batch's parameter gradients to those held by the layer
+// until zero_gradients() is called.  Parameters are held in the layer object so large
+// layers should be allocated on the heap as large matrices are, any scratch space is
+// allocated once when the layer is constructed.
+//
+// Convolutions have a stride of one.  Their forward pass either expands each sample
+// into patch columns (im2col) and does a single gemm or, for 3x3 kernels, uses
+// Winograd's F(2x2, 3x3) minimal filtering which does 16 smaller gemms over 2x2 output
+// tiles for 2.25 times fewer multiplications.  The backward pass always uses im2col.
+namespace lal
+{
+    namespace nn
+    {
+        template <std::size_t Channels, std::size_t Height, std::size_t Width>
+        struct shape
+        {
+            static constexpr std::size_t channels = Channels;
+            static constexpr std::size_t height = Height;
+            static constexpr std::size_t width = Width;
+            static constexpr std::size_t size = Channels * Height * Width;
+        };
+
+        template <typename T, std::size_t Batch, typename Shape>
+        using batch = matrix<T, Batch, Shape::size>;
+
+        enum class convolution { im2col, winograd };
+
+        // Dense
+        template <typename T, std::size_t Inputs, std::size_t Outputs>
+        class dense
+        {
+        public:
+            using input_shape = shape<1, 1, Inputs>;
+            using output_shape = shape<1, 1, Outputs>;
+
+            matrix<T, Inputs, Outputs>& weights() noexcept { return weights_; }
+            const matrix<T, Inputs, Outputs>& weights() const noexcept { return weights_; }
+            row_vector<T, Outputs>& bias() noexcept { return bias_; }
+            const row_vector<T, Outputs>& bias() const noexcept { return bias_; }
+
+            const matrix<T, Inputs, Outputs>& weight_gradient() const noexcept { return weight_gradient_; }
+            const row_vector<T, Outputs>& bias_gradient() const noexcept { return bias_gradient_; }
+
+            void zero_gradients() noexcept
+            {
+                weight_gradient_.fill(T{});
+                bias_gradient_.fill(T{});
+            }
+
+            // y = x * weights + bias
+            template <std::size_t Batch>
+            void forward(const matrix<T, Batch, Inputs>& x, matrix<T, Batch, Outputs>& y) const noexcept
+            {
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                    for (std::size_t output = 0u; output < Outputs; ++output)
+                        y[sample][output] = bias_[0][output];
+
+                gemm(T{ 1 }, x, weights_, T{ 1 }, y);
+            }
+
+            template <std::size_t Batch>
+            void backward(const matrix<T, Batch, Inputs>& x, const matrix<T, Batch, Outputs>& dy) noexcept
+            {
+                gemm<transposition::transpose>(T{ 1 }, x, dy, T{ 1 }, weight_gradient_);
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                    for (std::size_t output = 0u; output < Outputs; ++output)
+                        bias_gradient_[0][output] += dy[sample][output];
+            }
+
+            template <std::size_t Batch>
+            void backward(const matrix<T, Batch, Inputs>& x, const matrix<T, Batch, Outputs>& dy, matrix<T, Batch, Inputs>& dx) noexcept
+            {
+                backward(x, dy);
+                gemm<transposition::none, transposition::transpose>(T{ 1 }, dy, weights_, T{}, dx);
+            }
+
+        private:
+            matrix<T, Inputs, Outputs> weights_{};
+            row_vector<T, Outputs> bias_{};
+            matrix<T, Inputs, Outputs> weight_gradient_{};
+            row_vector<T, Outputs> bias_gradient_{};
+        };
+
+        // 2D convolution (strictly cross-correlation, as is usual for neural networks)
+        template <typename T, typename Input, std::size_t Filters, std::size_t Kernel, std::size_t Padding = Kernel / 2u>
+        class conv2d
+        {
+            static_assert(Input::height + 2u * Padding >= Kernel && Input::width + 2u * Padding >= Kernel,
+                          "conv2d requires the kernel to fit inside the padded input");
+
+            static constexpr std::size_t channels = Input::channels;
+            static constexpr std::size_t height = Input::height;
+            static constexpr std::size_t width = Input::width;
+            static constexpr std::size_t out_height = height + 2u * Padding - Kernel + 1u;
+            static constexpr std::size_t out_width = width + 2u * Padding - Kernel + 1u;
+            static constexpr std::size_t pixels = out_height * out_width;
+            static constexpr std::size_t patch = channels * Kernel * Kernel;
+
+            // Winograd F(2x2, 3x3), each tile makes 2x2 outputs from 4x4 inputs
+            static constexpr bool winograd_possible = Kernel == 3u;
+            static constexpr std::size_t tile_rows = (out_height + 1u) / 2u;
+            static constexpr std::size_t tile_columns = (out_width + 1u) / 2u;
+            static constexpr std::size_t tiles = tile_rows * tile_columns;
+
+            static constexpr std::size_t columns_size = patch * pixels;
+            static constexpr std::size_t filters_size = winograd_possible ? 16u * Filters * channels : 0u;
+            static constexpr std::size_t inputs_size = winograd_possible ? 16u * channels * tiles : 0u;
+            static constexpr std::size_t products_size = winograd_possible ? 16u * Filters * tiles : 0u;
+
+        public:
+            using input_shape = Input;
+            using output_shape = shape<Filters, out_height, out_width>;
+
+            conv2d() : workspace_{ std::make_unique<T[]>(columns_size + filters_size + inputs_size + products_size) } {}
+
+            // Row f holds filter f, channel by channel with each in row-major order
+            matrix<T, Filters, patch>& weights() noexcept { return weights_; }
+            const matrix<T, Filters, patch>& weights() const noexcept { return weights_; }
+            column_vector<T, Filters>& bias() noexcept { return bias_; }
+            const column_vector<T, Filters>& bias() const noexcept { return bias_; }
+
+            const matrix<T, Filters, patch>& weight_gradient() const noexcept { return weight_gradient_; }
+            const column_vector<T, Filters>& bias_gradient() const noexcept { return bias_gradient_; }
+
+            void zero_gradients() noexcept
+            {
+                weight_gradient_.fill(T{});
+                bias_gradient_.fill(T{});
+            }
+
+            template <convolution Algorithm = convolution::im2col, std::size_t Batch>
+            void forward(const batch<T, Batch, Input>& x, batch<T, Batch, output_shape>& y) noexcept
+            {
+                static_assert(Algorithm == convolution::im2col || winograd_possible, "Winograd convolution requires a 3x3 kernel");
+
+                if constexpr (Algorithm == convolution::winograd)
+                    transform_filters();
+
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                {
+                    const matrix_view<T, Filters, pixels> out{ y[sample] };
+                    if constexpr (Algorithm == convolution::im2col)
+                    {
+                        for (std::size_t filter = 0u; filter < Filters; ++filter)
+                            for (std::size_t pixel = 0u; pixel < pixels; ++pixel)
+                                out[filter][pixel] = bias_[filter][0];
+
+                        im2col(x[sample]);
+                        gemm(T{ 1 }, weights_, columns(), T{ 1 }, out);
+                    }
+                    else
+                    {
+                        winograd(x[sample], out);
+                    }
+                }
+            }
+
+            template <std::size_t Batch>
+            void backward(const batch<T, Batch, Input>& x, const batch<T, Batch, output_shape>& dy) noexcept
+            {
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                    accumulate_gradients(x[sample], matrix_view<const T, Filters, pixels>{ dy[sample] });
+            }
+
+            template <std::size_t Batch>
+            void backward(const batch<T, Batch, Input>& x, const batch<T, Batch, output_shape>& dy, batch<T, Batch, Input>& dx) noexcept
+            {
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                {
+                    const matrix_view<const T, Filters, pixels> d{ dy[sample] };
+                    accumulate_gradients(x[sample], d);
+
+                    // The patch columns are finished with so they're reused for their gradient
+                    gemm<transposition::transpose>(T{ 1 }, weights_, d, T{}, columns());
+                    col2im(dx[sample]);
+                }
+            }
+
+        private:
+            matrix_view<T, patch, pixels> columns() noexcept { return matrix_view<T, patch, pixels>{ workspace_.get() }; }
+
+            // The U, V and M matrices for position xi of the 4x4 Winograd domain
+            matrix_view<T, Filters, channels> winograd_filters(const std::size_t xi) noexcept
+            {
+                return matrix_view<T, Filters, channels>{ workspace_.get() + columns_size + xi * Filters * channels };
+            }
+
+            matrix_view<T, channels, tiles> winograd_inputs(const std::size_t xi) noexcept
+            {
+                return matrix_view<T, channels, tiles>{ workspace_.get() + columns_size + filters_size + xi * channels * tiles };
+            }
+
+            matrix_view<T, Filters, tiles> winograd_products(const std::size_t xi) noexcept
+            {
+                return matrix_view<T, Filters, tiles>{ workspace_.get() + columns_size + filters_size + inputs_size + xi * Filters * tiles };
+            }
+
+            static T input_at(const T* const sample, const std::size_t channel, const std::ptrdiff_t row, const std::ptrdiff_t column) noexcept
+            {
+                if (row < 0 || column < 0 || row >= static_cast<std::ptrdiff_t>(height) || column >= static_cast<std::ptrdiff_t>(width))
+                    return T{};
+
+                return sample[(channel * height + static_cast<std::size_t>(row)) * width + static_cast<std::size_t>(column)];
+            }
+
+            // Row (channel, ki, kj) of the columns holds the input under kernel element
+            // (ki, kj) for each output pixel
+            void im2col(const T* const sample) noexcept
+            {
+                const auto c = columns();
+                for (std::size_t channel = 0u; channel < channels; ++channel)
+                {
+                    for (std::size_t ki = 0u; ki < Kernel; ++ki)
+                    {
+                        for (std::size_t kj = 0u; kj < Kernel; ++kj)
+                        {
+                            T* const row = c[(channel * Kernel + ki) * Kernel + kj];
+                            for (std::size_t oy = 0u; oy < out_height; ++oy)
+                            {
+                                const std::ptrdiff_t iy = static_cast<std::ptrdiff_t>(oy + ki) - static_cast<std::ptrdiff_t>(Padding);
+                                for (std::size_t ox = 0u; ox < out_width; ++ox)
+                                {
+                                    const std::ptrdiff_t ix = static_cast<std::ptrdiff_t>(ox + kj) - static_cast<std::ptrdiff_t>(Padding);
+                                    row[oy * out_width + ox] = input_at(sample, channel, iy, ix);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            // The reverse of im2col, each column element is added back to the input it came from
+            void col2im(T* const sample) noexcept
+            {
+                std::fill(sample, sample + Input::size, T{});
+                const auto c = columns();
+                for (std::size_t channel = 0u; channel < channels; ++channel)
+                {
+                    for (std::size_t ki = 0u; ki < Kernel; ++ki)
+                    {
+                        for (std::size_t kj = 0u; kj < Kernel; ++kj)
+                        {
+                            const T* const row = c[(channel * Kernel + ki) * Kernel + kj];
+                            for (std::size_t oy = 0u; oy < out_height; ++oy)
+                            {
+                                const std::ptrdiff_t iy = static_cast<std::ptrdiff_t>(oy + ki) - static_cast<std::ptrdiff_t>(Padding);
+                                if (iy < 0 || iy >= static_cast<std::ptrdiff_t>(height))
+                                    continue;
+
+                                for (std::size_t ox = 0u; ox < out_width; ++ox)
+                                {
+                                    const std::ptrdiff_t ix = static_cast<std::ptrdiff_t>(ox + kj) - static_cast<std::ptrdiff_t>(Padding);
+                                    if (ix >= 0 && ix < static_cast<std::ptrdiff_t>(width))
+                                        sample[(channel * height + static_cast<std::size_t>(iy)) * width + static_cast<std::size_t>(ix)] +=
+                                            row[oy * out_width + ox];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            void accumulate_gradients(const T* const sample, const matrix_view<const T, Filters, pixels> dy) noexcept
+            {
+                im2col(sample);
+                gemm<transposition::none, transposition::transpose>(T{ 1 }, dy, columns(), T{ 1 }, weight_gradient_);
+                for (std::size_t filter = 0u; filter < Filters; ++filter)
+                    for (std::size_t pixel = 0u; pixel < pixels; ++pixel)
+                        bias_gradient_[filter][0] += dy[filter][pixel];
+            }
+
+            // U = G g G^T for every filter and channel
+            void transform_filters() noexcept
+            {
+                const T half{ 0.5 };
+                for (std::size_t filter = 0u; filter < Filters; ++filter)
+                {
+                    for (std::size_t channel = 0u; channel < channels; ++channel)
+                    {
+                        const T* const g = &weights_[filter][channel * 9u];
+                        T gg[4][3];
+                        for (std::size_t j = 0u; j < 3u; ++j)
+                        {
+                            gg[0][j] = g[j];
+                            gg[1][j] = half * (g[j] + g[3u + j] + g[6u + j]);
+                            gg[2][j] = half * (g[j] - g[3u + j] + g[6u + j]);
+                            gg[3][j] = g[6u + j];
+                        }
+
+                        for (std::size_t i = 0u; i < 4u; ++i)
+                        {
+                            winograd_filters(i * 4u + 0u)[filter][channel] = gg[i][0];
+                            winograd_filters(i * 4u + 1u)[filter][channel] = half * (gg[i][0] + gg[i][1] + gg[i][2]);
+                            winograd_filters(i * 4u + 2u)[filter][channel] = half * (gg[i][0] - gg[i][1] + gg[i][2]);
+                            winograd_filters(i * 4u + 3u)[filter][channel] = gg[i][2];
+                        }
+                    }
+                }
+            }
+
+            void winograd(const T* const sample, const matrix_view<T, Filters, pixels> out) noexcept
+            {
+                // V = B^T d B for each 4x4 input tile
+                for (std::size_t channel = 0u; channel < channels; ++channel)
+                {
+                    for (std::size_t tile = 0u; tile < tiles; ++tile)
+                    {
+                        const std::ptrdiff_t top = static_cast<std::ptrdiff_t>(2u * (tile / tile_columns)) - static_cast<std::ptrdiff_t>(Padding);
+                        const std::ptrdiff_t left = static_cast<std::ptrdiff_t>(2u * (tile % tile_columns)) - static_cast<std::ptrdiff_t>(Padding);
+                        T d[4][4];
+                        for (std::ptrdiff_t i = 0; i < 4; ++i)
+                            for (std::ptrdiff_t j = 0; j < 4; ++j)
+                                d[i][j] = input_at(sample, channel, top + i, left + j);
+
+                        T bd[4][4];
+                        for (std::size_t j = 0u; j < 4u; ++j)
+                        {
+                            bd[0][j] = d[0][j] - d[2][j];
+                            bd[1][j] = d[1][j] + d[2][j];
+                            bd[2][j] = d[2][j] - d[1][j];
+                            bd[3][j] = d[1][j] - d[3][j];
+                        }
+
+                        for (std::size_t i = 0u; i < 4u; ++i)
+                        {
+                            winograd_inputs(i * 4u + 0u)[channel][tile] = bd[i][0] - bd[i][2];
+                            winograd_inputs(i * 4u + 1u)[channel][tile] = bd[i][1] + bd[i][2];
+                            winograd_inputs(i * 4u + 2u)[channel][tile] = bd[i][2] - bd[i][1];
+                            winograd_inputs(i * 4u + 3u)[channel][tile] = bd[i][1] - bd[i][3];
+                        }
+                    }
+                }
+
+                // M = U V elementwise over the Winograd domain, summed over the channels
+                for (std::size_t xi = 0u; xi < 16u; ++xi)
+                    gemm(T{ 1 }, winograd_filters(xi), winograd_inputs(xi), T{}, winograd_products(xi));
+
+                // Y = A^T M A, cropped where the last tiles overhang the output
+                for (std::size_t filter = 0u; filter < Filters; ++filter)
+                {
+                    for (std::size_t tile = 0u; tile < tiles; ++tile)
+                    {
+                        T m[4][4];
+                        for (std::size_t xi = 0u; xi < 16u; ++xi)
+                            m[xi / 4u][xi % 4u] = winograd_products(xi)[filter][tile];
+
+                        T am[2][4];
+                        for (std::size_t j = 0u; j < 4u; ++j)
+                        {
+                            am[0][j] = m[0][j] + m[1][j] + m[2][j];
+                            am[1][j] = m[1][j] - m[2][j] - m[3][j];
+                        }
+
+                        const std::size_t top = 2u * (tile / tile_columns);
+                        const std::size_t left = 2u * (tile % tile_columns);
+                        for (std::size_t i = 0u; i < 2u && top + i < out_height; ++i)
+                        {
+                            const T values[2] = { am[i][0] + am[i][1] + am[i][2], am[i][1] - am[i][2] - am[i][3] };
+                            for (std::size_t j = 0u; j < 2u && left + j < out_width; ++j)
+                                out[filter][(top + i) * out_width + left + j] = values[j] + bias_[filter][0];
+                        }
+                    }
+                }
+            }
+
+            matrix<T, Filters, patch> weights_{};
+            column_vector<T, Filters> bias_{};
+            matrix<T, Filters, patch> weight_gradient_{};
+            column_vector<T, Filters> bias_gradient_{};
+            std::unique_ptr<T[]> workspace_;
+        };
+
+        namespace detail
+        {
+            // Calls f(output, first) for every pooling window, where first is the
+            // index of the window's top left input
+            template <typename Input, std::size_t Pool, typename Function>
+            void for_each_window(const Function& f) noexcept
+            {
+                std::size_t output = 0u;
+                for (std::size_t channel = 0u; channel < Input::channels; ++channel)
+                    for (std::size_t top = 0u; top + Pool <= Input::height; top += Pool)
+                        for (std::size_t left = 0u; left + Pool <= Input::width; left += Pool)
+                            f(output++, (channel * Input::height + top) * Input::width + left);
+            }
+        }
+
+        // Pooling over non-overlapping Pool x Pool windows, rows and columns which don't
+        // fill a window are dropped
+        template <typename T, typename Input, std::size_t Pool>
+        class max_pool2d
+        {
+        public:
+            using input_shape = Input;
+            using output_shape = shape<Input::channels, Input::height / Pool, Input::width / Pool>;
+
+            template <std::size_t Batch>
+            void forward(const batch<T, Batch, Input>& x, batch<T, Batch, output_shape>& y) const noexcept
+            {
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                {
+                    const T* const in = x[sample];
+                    T* const out = y[sample];
+                    detail::for_each_window<Input, Pool>([in, out](const std::size_t output, const std::size_t first) {
+                        T largest = in[first];
+                        for (std::size_t i = 0u; i < Pool; ++i)
+                            for (std::size_t j = 0u; j < Pool; ++j)
+                                largest = std::max(largest, in[first + i * Input::width + j]);
+
+                        out[output] = largest;
+                    });
+                }
+            }
+
+            // The gradient goes to the first largest input of each window
+            template <std::size_t Batch>
+            void backward(const batch<T, Batch, Input>& x, const batch<T, Batch, output_shape>& dy, batch<T, Batch, Input>& dx) const noexcept
+            {
+                dx.fill(T{});
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                {
+                    const T* const in = x[sample];
+                    const T* const d = dy[sample];
+                    T* const out = dx[sample];
+                    detail::for_each_window<Input, Pool>([in, d, out](const std::size_t output, const std::size_t first) {
+                        std::size_t largest = first;
+                        for (std::size_t i = 0u; i < Pool; ++i)
+                            for (std::size_t j = 0u; j < Pool; ++j)
+                                if (in[largest] < in[first + i * Input::width + j])
+                                    largest = first + i * Input::width + j;
+
+                        out[largest] += d[output];
+                    });
+                }
+            }
+        };
+
+        template <typename T, typename Input, std::size_t Pool>
+        class avg_pool2d
+        {
+        public:
+            using input_shape = Input;
+            using output_shape = shape<Input::channels, Input::height / Pool, Input::width / Pool>;
+
+            template <std::size_t Batch>
+            void forward(const batch<T, Batch, Input>& x, batch<T, Batch, output_shape>& y) const noexcept
+            {
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                {
+                    const T* const in = x[sample];
+                    T* const out = y[sample];
+                    detail::for_each_window<Input, Pool>([in, out](const std::size_t output, const std::size_t first) {
+                        T sum{};
+                        for (std::size_t i = 0u; i < Pool; ++i)
+                            for (std::size_t j = 0u; j < Pool; ++j)
+                                sum += in[first + i * Input::width + j];
+
+                        out[output] = sum * scale;
+                    });
+                }
+            }
+
+            template <std::size_t Batch>
+            void backward(const batch<T, Batch, Input>&, const batch<T, Batch, output_shape>& dy, batch<T, Batch, Input>& dx) const noexcept
+            {
+                dx.fill(T{});
+                for (std::size_t sample = 0u; sample < Batch; ++sample)
+                {
+                    const T* const d = dy[sample];
+                    T* const out = dx[sample];
+                    detail::for_each_window<Input, Pool>([d, out](const std::size_t output, const std::size_t first) {
+                        for (std::size_t i = 0u; i < Pool; ++i)
+                            for (std::size_t j = 0u; j < Pool; ++j)
+                                out[first + i * Input::width + j] = d[output] * scale;
+                    });
+                }
+            }
+
+        private:
+            static constexpr T scale = T{ 1 } / static_cast<T>(Pool * Pool);
+        };
+
+        // Activation
+        template <typename T, std::size_t Batch, std::size_t Size>
+        void relu(const matrix<T, Batch, Size>& x, matrix<T, Batch, Size>& y) noexcept
+        {
+            for (std::size_t sample = 0u; sample < Batch; ++sample)
+                for (std::size_t i = 0u; i < Size; ++i)
+                    y[sample][i] = x[sample][i] > T{} ? x[sample][i] : T{};
+        }
+
+        template <typename T, std::size_t Batch, std::size_t Size>
+        void relu_backward(const matrix<T, Batch, Size>& x, const matrix<T, Batch, Size>& dy, matrix<T, Batch, Size>& dx) noexcept
+        {
+            for (std::size_t sample = 0u; sample < Batch; ++sample)
+                for (std::size_t i = 0u; i < Size; ++i)
+                    dx[sample][i] = x[sample][i] > T{} ? dy[sample][i] : T{};
+        }
+
+        // Softmax and cross-entropy, each row of logits is one sample's scores
+        using lal::softmax;
+
+        // Mean over the batch of -sum(target * log(probability)), targets are distributions (e.g. one-hot)
+        template <typename T, std::size_t Batch, std::size_t Classes>
+        T cross_entropy(const matrix<T, Batch, Classes>& probabilities, const matrix<T, Batch, Classes>& targets) noexcept
+        {
+            // Stops a zero probability giving an infinite loss
+            constexpr T smallest = std::numeric_limits<T>::min();
+            T sum{};
+            for (std::size_t sample = 0u; sample < Batch; ++sample)
+                for (std::size_t i = 0u; i < Classes; ++i)
+                    if (targets[sample][i] != T{})
+                        sum -= targets[sample][i] * std::log(std::max(probabilities[sample][i], smallest));
+
+            return sum / static_cast<T>(Batch);
+        }
+
+        // Gradient of cross_entropy(softmax(logits), targets) with respect to the logits
+        template <typename T, std::size_t Batch, std::size_t Classes>
+        void softmax_cross_entropy_backward(const matrix<T, Batch, Classes>& probabilities, const matrix<T, Batch, Classes>& targets,
+                                            matrix<T, Batch, Classes>& dlogits) noexcept
+        {
+            const T scale = T{ 1 } / static_cast<T>(Batch);
+            for (std::size_t sample = 0u; sample < Batch; ++sample)
+                for (std::size_t i = 0u; i < Classes; ++i)
+                    dlogits[sample][i] = (probabilities[sample][i] - targets[sample][i]) * scale;
+        }
+    }
+}
+
+#endif
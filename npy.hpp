@@ -0,0 +1,766 @@
+#ifndef LAL_NPY_HPP
+#define LAL_NPY_HPP
+
+#include "matrix_view.hpp"
+#include "mapped_file.hpp"
+#include "checksum.hpp"
+#include "matrix.hpp"
+
+#include <string_view>
+#include <type_traits>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <array>
+
+// Reading and writing of NumPy .npy files and uncompressed .npz archives, see
+// https://numpy.org/doc/stable/reference/generated/numpy.lib.format.html
+namespace lal
+{
+    class npy_error : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    struct npy_array_info
+    {
+        char byte_order = '|';                  // '<', '>' or '|' as in the descr string
+        char kind = 'f';                        // 'b', 'i', 'u' or 'f'
+        std::size_t item_size = 0u;
+        bool fortran_order = false;
+        std::vector<std::size_t> shape;
+        std::size_t data_offset = 0u;           // from the start of the file/member
+
+        std::size_t count() const noexcept
+        {
+            std::size_t n = 1u;
+            for (const std::size_t extent : shape)
+                n *= extent;
+
+            return n;
+        }
+
+        std::size_t data_size() const noexcept { return count() * item_size; }
+    };
+
+    namespace detail
+    {
+        inline constexpr char npy_magic[6] = { '\x93', 'N', 'U', 'M', 'P', 'Y' };
+        inline constexpr std::size_t npy_alignment = 64u;
+        inline constexpr std::size_t npy_conversion_chunk = 1u << 16;
+
+        inline char npy_native_byte_order() noexcept
+        {
+            const std::uint16_t value = 1u;
+            unsigned char first_byte = 0u;
+            std::memcpy(&first_byte, &value, 1u);
+            return first_byte == 1u ? '<' : '>';
+        }
+
+        template <typename T>
+        std::string npy_descr()
+        {
+            static_assert(std::is_arithmetic_v<T>, "Only arithmetic matrices can be stored in .npy files");
+
+            const char kind = std::is_same_v<T, bool> ? 'b' : std::is_floating_point_v<T> ? 'f' : std::is_signed_v<T> ? 'i' : 'u';
+            const char byte_order = sizeof(T) == 1u ? '|' : npy_native_byte_order();
+            return std::string{ byte_order, kind } + std::to_string(sizeof(T));
+        }
+
+        template <typename T>
+        bool npy_is_native(const npy_array_info& info) noexcept
+        {
+            const char kind = std::is_same_v<T, bool> ? 'b' : std::is_floating_point_v<T> ? 'f' : std::is_signed_v<T> ? 'i' : 'u';
+            const bool native_order = info.byte_order == '|' || info.byte_order == '=' || info.byte_order == npy_native_byte_order();
+            return info.kind == kind && info.item_size == sizeof(T) && (native_order || sizeof(T) == 1u);
+        }
+
+        // Whether the array can be copied straight into a row-major T, bools are always
+        // converted so that every byte becomes a valid bool
+        template <typename T>
+        bool npy_is_copyable(const npy_array_info& info) noexcept
+        {
+            return !std::is_same_v<T, bool> && npy_is_native<T>(info) && !info.fortran_order;
+        }
+
+        inline std::size_t npy_skip_space(const std::string_view text, std::size_t pos) noexcept
+        {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n'))
+                ++pos;
+
+            return pos;
+        }
+
+        // Finds the value following 'key': in the header dictionary
+        inline std::size_t npy_find_value(const std::string_view header, const std::string_view key)
+        {
+            for (const char quote : { '\'', '"' })
+            {
+                const std::string quoted = std::string{ quote } + std::string{ key } + quote;
+                const std::size_t pos = header.find(quoted);
+                if (pos == std::string_view::npos)
+                    continue;
+
+                const std::size_t colon = npy_skip_space(header, pos + quoted.size());
+                if (colon < header.size() && header[colon] == ':')
+                    return npy_skip_space(header, colon + 1u);
+            }
+
+            throw npy_error("Missing '" + std::string{ key } + "' in .npy header");
+        }
+
+        inline npy_array_info npy_parse_header(const std::string_view header)
+        {
+            npy_array_info info;
+
+            std::size_t pos = npy_find_value(header, "descr");
+            const char quote = pos < header.size() ? header[pos] : '\0';
+            const std::size_t end = header.find(quote, pos + 1u);
+            if ((quote != '\'' && quote != '"') || end == std::string_view::npos || end - pos < 4u)
+                throw npy_error("Unsupported dtype in .npy header");
+
+            const std::string_view descr = header.substr(pos + 1u, end - pos - 1u);
+            info.byte_order = descr[0];
+            info.kind = descr[1];
+            info.item_size = 0u;
+            for (const char digit : descr.substr(2u))
+            {
+                if (digit < '0' || digit > '9')
+                    throw npy_error("Unsupported dtype '" + std::string{ descr } + "' in .npy header");
+
+                info.item_size = info.item_size * 10u + static_cast<std::size_t>(digit - '0');
+            }
+
+            const bool known_kind = (info.kind == 'f' && (info.item_size == 4u || info.item_size == 8u)) ||
+                                    ((info.kind == 'i' || info.kind == 'u') && (info.item_size == 1u || info.item_size == 2u ||
+                                                                                info.item_size == 4u || info.item_size == 8u)) ||
+                                    (info.kind == 'b' && info.item_size == 1u);
+            if (!known_kind || std::string_view{ "<>|=" }.find(info.byte_order) == std::string_view::npos)
+                throw npy_error("Unsupported dtype '" + std::string{ descr } + "' in .npy header");
+
+            pos = npy_find_value(header, "fortran_order");
+            if (header.compare(pos, 4u, "True") == 0)
+                info.fortran_order = true;
+            else if (header.compare(pos, 5u, "False") != 0)
+                throw npy_error("Invalid fortran_order in .npy header");
+
+            pos = npy_find_value(header, "shape");
+            if (pos >= header.size() || header[pos] != '(')
+                throw npy_error("Invalid shape in .npy header");
+
+            for (pos = npy_skip_space(header, pos + 1u); pos < header.size() && header[pos] != ')';)
+            {
+                std::size_t extent = 0u;
+                const std::size_t first_digit = pos;
+                for (; pos < header.size() && header[pos] >= '0' && header[pos] <= '9'; ++pos)
+                    extent = extent * 10u + static_cast<std::size_t>(header[pos] - '0');
+
+                if (pos == first_digit)
+                    throw npy_error("Invalid shape in .npy header");
+
+                info.shape.push_back(extent);
+                pos = npy_skip_space(header, pos);
+                if (pos < header.size() && header[pos] == ',')
+                    pos = npy_skip_space(header, pos + 1u);
+            }
+
+            if (pos >= header.size())
+                throw npy_error("Invalid shape in .npy header");
+
+            return info;
+        }
+
+        // Parses the preamble and header at the start of a buffer, returns false if
+        // more bytes are needed with the required amount in needed
+        inline bool npy_parse_preamble(const char* const bytes, const std::size_t size, std::size_t& needed, npy_array_info& info)
+        {
+            needed = 10u;
+            if (size < needed)
+                return false;
+
+            if (std::memcmp(bytes, npy_magic, sizeof(npy_magic)) != 0)
+                throw npy_error("Not a .npy file");
+
+            const auto major = static_cast<unsigned char>(bytes[6]);
+            const auto byte = [bytes](const std::size_t i) { return static_cast<std::size_t>(static_cast<unsigned char>(bytes[i])); };
+
+            std::size_t header_length = 0u;
+            std::size_t preamble_size = 0u;
+            if (major == 1u)
+            {
+                header_length = byte(8) | byte(9) << 8;
+                preamble_size = 10u;
+            }
+            else if (major == 2u || major == 3u)
+            {
+                needed = 12u;
+                if (size < needed)
+                    return false;
+
+                header_length = byte(8) | byte(9) << 8 | byte(10) << 16 | byte(11) << 24;
+                preamble_size = 12u;
+            }
+            else
+            {
+                throw npy_error("Unsupported .npy format version");
+            }
+
+            needed = preamble_size + header_length;
+            if (size < needed)
+                return false;
+
+            info = npy_parse_header(std::string_view{ bytes + preamble_size, header_length });
+            info.data_offset = needed;
+            return true;
+        }
+
+        template <typename Matrix>
+        void npy_check_shape(const npy_array_info& info)
+        {
+            using view = view_t<std::remove_reference_t<Matrix>>;
+            constexpr std::size_t rows = view::row_count;
+            constexpr std::size_t columns = view::column_count;
+
+            const auto& shape = info.shape;
+            const bool matches = (shape.size() == 2u && shape[0] == rows && shape[1] == columns) ||
+                                 (shape.size() == 1u && shape[0] == rows * columns && (rows == 1u || columns == 1u)) ||
+                                 (shape.empty() && rows == 1u && columns == 1u);
+            if (!matches)
+                throw npy_error(".npy array shape does not match the matrix dimensions");
+        }
+
+        template <typename Source, typename View>
+        void npy_convert(const std::byte* src, const std::size_t count, std::size_t index,
+                         const npy_array_info& info, const View& v)
+        {
+            using T = typename View::value_type;
+            constexpr std::size_t rows = View::row_count;
+            constexpr std::size_t columns = View::column_count;
+            const bool swap = sizeof(Source) > 1u && info.byte_order != '=' && info.byte_order != npy_native_byte_order();
+
+            for (std::size_t i = 0u; i < count; ++i, ++index, src += sizeof(Source))
+            {
+                std::byte bytes[sizeof(Source)];
+                std::memcpy(bytes, src, sizeof(Source));
+                if (swap)
+                    std::reverse(std::begin(bytes), std::end(bytes));
+
+                // A byte other than 0 or 1 is not a valid bool, so bools are read as bytes
+                using stored = std::conditional_t<std::is_same_v<Source, bool>, std::uint8_t, Source>;
+                stored value{};
+                std::memcpy(&value, bytes, sizeof(Source));
+
+                if (info.fortran_order)
+                    v[index % rows][index / rows] = static_cast<T>(static_cast<Source>(value));
+                else
+                    v[index / columns][index % columns] = static_cast<T>(static_cast<Source>(value));
+            }
+        }
+
+        // Converts count elements starting at flat index (in file order) into the view
+        template <typename View>
+        void npy_copy_elements(const std::byte* const src, const std::size_t count, const std::size_t index,
+                               const npy_array_info& info, const View& v)
+        {
+            switch (info.kind)
+            {
+            case 'b': return npy_convert<bool>(src, count, index, info, v);
+            case 'f':
+                if (info.item_size == 4u)
+                    return npy_convert<float>(src, count, index, info, v);
+                return npy_convert<double>(src, count, index, info, v);
+            case 'i':
+                switch (info.item_size)
+                {
+                case 1u: return npy_convert<std::int8_t>(src, count, index, info, v);
+                case 2u: return npy_convert<std::int16_t>(src, count, index, info, v);
+                case 4u: return npy_convert<std::int32_t>(src, count, index, info, v);
+                default: return npy_convert<std::int64_t>(src, count, index, info, v);
+                }
+            default:
+                switch (info.item_size)
+                {
+                case 1u: return npy_convert<std::uint8_t>(src, count, index, info, v);
+                case 2u: return npy_convert<std::uint16_t>(src, count, index, info, v);
+                case 4u: return npy_convert<std::uint32_t>(src, count, index, info, v);
+                default: return npy_convert<std::uint64_t>(src, count, index, info, v);
+                }
+            }
+        }
+
+        // Copies an array already in memory (e.g. mapped) into a matrix or view
+        template <typename Matrix>
+        void npy_load_bytes(const std::byte* const bytes, const std::size_t size, Matrix&& m)
+        {
+            using view = view_t<std::remove_reference_t<Matrix>>;
+            using T = typename view::value_type;
+            const view v = make_view(m);
+
+            std::size_t needed = 0u;
+            npy_array_info info;
+            if (!npy_parse_preamble(reinterpret_cast<const char*>(bytes), size, needed, info))
+                throw npy_error("Truncated .npy header");
+
+            npy_check_shape<Matrix>(info);
+            if (size - info.data_offset < info.data_size())
+                throw npy_error("Truncated .npy data");
+
+            const std::byte* const data = bytes + info.data_offset;
+            if (npy_is_copyable<T>(info))
+                for (std::size_t row = 0u; row < view::row_count; ++row)
+                    std::memcpy(v[row], data + row * view::column_count * sizeof(T), view::column_count * sizeof(T));
+            else
+                npy_copy_elements(data, info.count(), 0u, info, v);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        matrix_view<const T, Rows, Columns> npy_map_bytes(const std::byte* const bytes, const std::size_t size)
+        {
+            std::size_t needed = 0u;
+            npy_array_info info;
+            if (!npy_parse_preamble(reinterpret_cast<const char*>(bytes), size, needed, info))
+                throw npy_error("Truncated .npy header");
+
+            npy_check_shape<matrix<T, Rows, Columns>>(info);
+            if (!npy_is_native<T>(info) || (info.fortran_order && Rows != 1u && Columns != 1u))
+                throw npy_error(".npy array needs converting so cannot be mapped");
+
+            if (size - info.data_offset < info.data_size())
+                throw npy_error("Truncated .npy data");
+
+            const std::byte* const data = bytes + info.data_offset;
+            if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0u)
+                throw npy_error(".npy array data is misaligned so cannot be mapped");
+
+            return matrix_view<const T, Rows, Columns>{ reinterpret_cast<const T*>(data) };
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        std::string npy_make_preamble()
+        {
+            std::string header = "{'descr': '" + npy_descr<T>() + "', 'fortran_order': False, 'shape': (" +
+                                 std::to_string(Rows) + ", " + std::to_string(Columns) + "), }";
+
+            // The header is padded with spaces and a newline so that the data is aligned
+            const bool version_2 = header.size() + 11u > 0xFFFFu;
+            const std::size_t preamble_size = version_2 ? 12u : 10u;
+            const std::size_t total = (preamble_size + header.size() + 1u + npy_alignment - 1u) / npy_alignment * npy_alignment;
+            header.append(total - preamble_size - header.size() - 1u, ' ');
+            header.push_back('\n');
+
+            std::string preamble{ npy_magic, sizeof(npy_magic) };
+            preamble.push_back(static_cast<char>(version_2 ? 2 : 1));
+            preamble.push_back('\0');
+            for (std::size_t i = 0u; i < preamble_size - 8u; ++i)
+                preamble.push_back(static_cast<char>((header.size() >> (8u * i)) & 0xFFu));
+
+            return preamble + header;
+        }
+    }
+
+    // Reads just the preamble and header, leaving the stream at the start of the data
+    inline npy_array_info read_npy_header(std::istream& in)
+    {
+        std::vector<char> bytes(10u);
+        std::size_t needed = 0u;
+        npy_array_info info;
+
+        if (!in.read(bytes.data(), 10))
+            throw npy_error("Truncated .npy header");
+
+        while (!detail::npy_parse_preamble(bytes.data(), bytes.size(), needed, info))
+        {
+            const std::size_t have = bytes.size();
+            bytes.resize(needed);
+            if (!in.read(bytes.data() + have, static_cast<std::streamsize>(needed - have)))
+                throw npy_error("Truncated .npy header");
+        }
+
+        return info;
+    }
+
+    inline npy_array_info read_npy_header(const std::filesystem::path& path)
+    {
+        std::ifstream in{ path, std::ios::binary };
+        if (!in)
+            throw npy_error("Unable to open " + path.string() + " for reading");
+
+        return read_npy_header(in);
+    }
+
+    // Loads a .npy array into a matrix or view, converting the dtype, byte order and
+    // Fortran ordering as required.  1-d arrays may be loaded into row or column vectors.
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void load_npy(std::istream& in, Matrix&& m)
+    {
+        using view = view_t<std::remove_reference_t<Matrix>>;
+        using T = typename view::value_type;
+        const view v = make_view(m);
+
+        const npy_array_info info = read_npy_header(in);
+        detail::npy_check_shape<Matrix>(info);
+
+        if (detail::npy_is_copyable<T>(info))
+        {
+            constexpr std::size_t row_size = view::column_count * sizeof(T);
+            if (v.contiguous())
+                in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+            else
+                for (std::size_t row = 0u; row < view::row_count && in; ++row)
+                    in.read(reinterpret_cast<char*>(v[row]), static_cast<std::streamsize>(row_size));
+        }
+        else
+        {
+            // Stream through a bounded buffer rather than reading the whole array
+            const std::size_t chunk_elements = std::max<std::size_t>(1u, detail::npy_conversion_chunk / info.item_size);
+            std::vector<std::byte> buffer(chunk_elements * info.item_size);
+            for (std::size_t index = 0u; index < info.count() && in; index += chunk_elements)
+            {
+                const std::size_t count = std::min(chunk_elements, info.count() - index);
+                in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(count * info.item_size));
+                detail::npy_copy_elements(buffer.data(), count, index, info, v);
+            }
+        }
+
+        if (!in)
+            throw npy_error("Truncated .npy data");
+    }
+
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void load_npy(const std::filesystem::path& path, Matrix&& m)
+    {
+        std::ifstream in{ path, std::ios::binary };
+        if (!in)
+            throw npy_error("Unable to open " + path.string() + " for reading");
+
+        load_npy(in, m);
+    }
+
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void save_npy(std::ostream& out, const Matrix& m)
+    {
+        using view = view_t<const Matrix>;
+        using T = typename view::value_type;
+        const view v = make_view(m);
+
+        const std::string preamble = detail::npy_make_preamble<T, view::row_count, view::column_count>();
+        out.write(preamble.data(), static_cast<std::streamsize>(preamble.size()));
+        if (v.contiguous())
+            out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+        else
+            for (std::size_t row = 0u; row < view::row_count; ++row)
+                out.write(reinterpret_cast<const char*>(v[row]), static_cast<std::streamsize>(view::column_count * sizeof(T)));
+
+        if (!out)
+            throw npy_error("Unable to write .npy data");
+    }
+
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void save_npy(const std::filesystem::path& path, const Matrix& m)
+    {
+        std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+        if (!out)
+            throw npy_error("Unable to open " + path.string() + " for writing");
+
+        save_npy(out, m);
+    }
+
+    // Zero copy view of a mapped .npy file, the array must already be in the
+    // native byte order, have the matrix element type and be in C order
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix_view<const T, Rows, Columns> map_npy(const mapped_file& file)
+    {
+        return detail::npy_map_bytes<T, Rows, Columns>(file.data(), file.size());
+    }
+
+    namespace detail
+    {
+        inline constexpr std::uint32_t zip_local_signature = 0x04034B50u;
+        inline constexpr std::uint32_t zip_central_signature = 0x02014B50u;
+        inline constexpr std::uint32_t zip_end_signature = 0x06054B50u;
+        inline constexpr std::size_t zip_local_header_size = 30u;
+        inline constexpr std::size_t zip_central_header_size = 46u;
+        inline constexpr std::size_t zip_end_size = 22u;
+
+        inline void zip_put(std::string& out, const std::uint32_t value, const std::size_t bytes)
+        {
+            for (std::size_t i = 0u; i < bytes; ++i)
+                out.push_back(static_cast<char>((value >> (8u * i)) & 0xFFu));
+        }
+
+        inline std::uint32_t zip_get(const std::byte* const p, const std::size_t bytes) noexcept
+        {
+            std::uint32_t value = 0u;
+            for (std::size_t i = 0u; i < bytes; ++i)
+                value |= static_cast<std::uint32_t>(p[i]) << (8u * i);
+
+            return value;
+        }
+    }
+
+    // Writes an uncompressed (stored) .npz archive, member data is padded via the
+    // zip extra field to a 64 byte boundary so that npz_archive can map it directly
+    class npz_writer
+    {
+    public:
+        explicit npz_writer(const std::filesystem::path& path)
+            : out_{ path, std::ios::binary | std::ios::trunc }
+        {
+            if (!out_)
+                throw npy_error("Unable to open " + path.string() + " for writing");
+        }
+
+        ~npz_writer()
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        npz_writer(const npz_writer&) = delete;
+        npz_writer& operator=(const npz_writer&) = delete;
+
+        // Adds name.npy to the archive
+        template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+        void add(const std::string& name, const Matrix& m)
+        {
+            using view = view_t<const Matrix>;
+            using T = typename view::value_type;
+            const view v = make_view(m);
+
+            const std::string preamble = detail::npy_make_preamble<T, view::row_count, view::column_count>();
+            constexpr std::size_t row_size = view::column_count * sizeof(T);
+            std::uint32_t crc = crc32(preamble.data(), preamble.size());
+            for (std::size_t row = 0u; row < view::row_count; ++row)
+                crc = crc32(v[row], row_size, crc);
+
+            const std::string file_name = name + ".npy";
+            const std::size_t member_size = preamble.size() + v.size() * sizeof(T);
+            if (member_size > 0xFFFFFFFFu || offset_ > 0xFFFFFFFFu)
+                throw npy_error("Archive member too large for a non-zip64 archive");
+
+            const std::size_t unpadded = offset_ + detail::zip_local_header_size + file_name.size() + 4u;
+            const std::size_t extra_size = 4u + (detail::npy_alignment - unpadded % detail::npy_alignment) % detail::npy_alignment;
+
+            std::string entry;
+            entry_fields(entry, crc, member_size, file_name.size(), extra_size);
+            std::string local;
+            detail::zip_put(local, detail::zip_local_signature, 4u);
+            local += entry;
+            local += file_name;
+            detail::zip_put(local, 0xCAFEu, 2u);            // private extra field holding the padding
+            detail::zip_put(local, static_cast<std::uint32_t>(extra_size - 4u), 2u);
+            local.append(extra_size - 4u, '\0');
+
+            out_.write(local.data(), static_cast<std::streamsize>(local.size()));
+            out_.write(preamble.data(), static_cast<std::streamsize>(preamble.size()));
+            for (std::size_t row = 0u; row < view::row_count; ++row)
+                out_.write(reinterpret_cast<const char*>(v[row]), static_cast<std::streamsize>(row_size));
+
+            if (!out_)
+                throw npy_error("Unable to write .npz member");
+
+            detail::zip_put(central_, detail::zip_central_signature, 4u);
+            detail::zip_put(central_, 20u, 2u);               // version made by
+            std::string central_entry;
+            entry_fields(central_entry, crc, member_size, file_name.size(), 0u);
+            central_ += central_entry;
+            detail::zip_put(central_, 0u, 2u);                // comment length
+            detail::zip_put(central_, 0u, 2u);                // disk number
+            detail::zip_put(central_, 0u, 2u);                // internal attributes
+            detail::zip_put(central_, 0u, 4u);                // external attributes
+            detail::zip_put(central_, static_cast<std::uint32_t>(offset_), 4u);
+            central_ += file_name;
+
+            offset_ += local.size() + member_size;
+            ++entries_;
+        }
+
+        // Writes the central directory, called automatically on destruction
+        void close()
+        {
+            if (closed_)
+                return;
+
+            closed_ = true;
+            std::string end;
+            detail::zip_put(end, detail::zip_end_signature, 4u);
+            detail::zip_put(end, 0u, 2u);
+            detail::zip_put(end, 0u, 2u);
+            detail::zip_put(end, static_cast<std::uint32_t>(entries_), 2u);
+            detail::zip_put(end, static_cast<std::uint32_t>(entries_), 2u);
+            detail::zip_put(end, static_cast<std::uint32_t>(central_.size()), 4u);
+            detail::zip_put(end, static_cast<std::uint32_t>(offset_), 4u);
+            detail::zip_put(end, 0u, 2u);
+
+            out_.write(central_.data(), static_cast<std::streamsize>(central_.size()));
+            out_.write(end.data(), static_cast<std::streamsize>(end.size()));
+            out_.close();
+            if (!out_)
+                throw npy_error("Unable to write .npz central directory");
+        }
+
+    private:
+        // Fields shared by the local and central headers (after the signature/version made by)
+        static void entry_fields(std::string& out, const std::uint32_t crc, const std::size_t size,
+                                 const std::size_t name_size, const std::size_t extra_size)
+        {
+            detail::zip_put(out, 20u, 2u);                    // version needed
+            detail::zip_put(out, 0u, 2u);                     // flags
+            detail::zip_put(out, 0u, 2u);                     // stored
+            detail::zip_put(out, 0u, 2u);                     // modification time
+            detail::zip_put(out, 0x21u, 2u);                  // modification date (1980-01-01)
+            detail::zip_put(out, crc, 4u);
+            detail::zip_put(out, static_cast<std::uint32_t>(size), 4u);
+            detail::zip_put(out, static_cast<std::uint32_t>(size), 4u);
+            detail::zip_put(out, static_cast<std::uint32_t>(name_size), 2u);
+            detail::zip_put(out, static_cast<std::uint32_t>(extra_size), 2u);
+        }
+
+        std::ofstream out_;
+        std::string central_;
+        std::size_t offset_ = 0u;
+        std::size_t entries_ = 0u;
+        bool closed_ = false;
+    };
+
+    // Memory mapped reader for uncompressed .npz archives (as written by numpy.savez)
+    class npz_archive
+    {
+    public:
+        explicit npz_archive(const std::filesystem::path& path)
+            : file_{ path }
+        {
+            const std::byte* const data = file_.data();
+            const std::size_t size = file_.size();
+            if (size < detail::zip_end_size)
+                throw npy_error("Not a .npz archive");
+
+            // The end of central directory record is followed by at most a 64K comment
+            std::size_t end = size - detail::zip_end_size;
+            const std::size_t search_limit = end > 0xFFFFu ? end - 0xFFFFu : 0u;
+            while (detail::zip_get(data + end, 4u) != detail::zip_end_signature)
+            {
+                if (end == search_limit)
+                    throw npy_error("Not a .npz archive");
+                --end;
+            }
+
+            const std::size_t entries = detail::zip_get(data + end + 10u, 2u);
+            std::size_t pos = detail::zip_get(data + end + 16u, 4u);
+            for (std::size_t i = 0u; i < entries; ++i)
+            {
+                if (pos + detail::zip_central_header_size > size || detail::zip_get(data + pos, 4u) != detail::zip_central_signature)
+                    throw npy_error("Corrupt .npz central directory");
+
+                const std::size_t method = detail::zip_get(data + pos + 10u, 2u);
+                const std::size_t compressed_size = detail::zip_get(data + pos + 20u, 4u);
+                const std::size_t name_size = detail::zip_get(data + pos + 28u, 2u);
+                const std::size_t extra_size = detail::zip_get(data + pos + 30u, 2u);
+                const std::size_t comment_size = detail::zip_get(data + pos + 32u, 2u);
+                const std::size_t local_offset = detail::zip_get(data + pos + 42u, 4u);
+                if (size - pos - detail::zip_central_header_size < name_size)
+                    throw npy_error("Corrupt .npz central directory");
+
+                std::string name{ reinterpret_cast<const char*>(data + pos + detail::zip_central_header_size), name_size };
+                if (name.size() > 4u && name.compare(name.size() - 4u, 4u, ".npy") == 0)
+                    name.resize(name.size() - 4u);
+
+                if (local_offset + detail::zip_local_header_size > size)
+                    throw npy_error("Corrupt .npz member header");
+
+                const std::size_t local_name_size = detail::zip_get(data + local_offset + 26u, 2u);
+                const std::size_t local_extra_size = detail::zip_get(data + local_offset + 28u, 2u);
+                const std::size_t offset = local_offset + detail::zip_local_header_size + local_name_size + local_extra_size;
+                if (offset > size || size - offset < compressed_size)
+                    throw npy_error("Corrupt .npz member header");
+
+                if (size - pos - detail::zip_central_header_size - name_size < extra_size + comment_size)
+                    throw npy_error("Corrupt .npz central directory");
+
+                members_.push_back(member{ std::move(name), offset, compressed_size, method == 0u });
+                pos += detail::zip_central_header_size + name_size + extra_size + comment_size;
+            }
+        }
+
+        // Properties
+        std::vector<std::string> names() const
+        {
+            std::vector<std::string> ret;
+            for (const member& m : members_)
+                ret.push_back(m.name);
+
+            return ret;
+        }
+
+        bool contains(const std::string_view name) const noexcept
+        {
+            return std::any_of(members_.begin(), members_.end(), [name](const member& m) { return m.name == name; });
+        }
+
+        npy_array_info info(const std::string_view name) const
+        {
+            const member& m = find(name);
+            std::size_t needed = 0u;
+            npy_array_info ret;
+            if (!detail::npy_parse_preamble(reinterpret_cast<const char*>(file_.data() + m.offset), m.size, needed, ret))
+                throw npy_error("Truncated .npy header");
+
+            return ret;
+        }
+
+        // Access
+        template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+        void load(const std::string_view name, Matrix&& m) const
+        {
+            const member& entry = find(name);
+            detail::npy_load_bytes(file_.data() + entry.offset, entry.size, m);
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        matrix_view<const T, Rows, Columns> map(const std::string_view name) const
+        {
+            const member& entry = find(name);
+            return detail::npy_map_bytes<T, Rows, Columns>(file_.data() + entry.offset, entry.size);
+        }
+
+    private:
+        struct member
+        {
+            std::string name;
+            std::size_t offset = 0u;
+            std::size_t size = 0u;
+            bool stored = false;
+        };
+
+        const member& find(const std::string_view name) const
+        {
+            const auto it = std::find_if(members_.begin(), members_.end(), [name](const member& m) { return m.name == name; });
+            if (it == members_.end())
+                throw npy_error("No array named '" + std::string{ name } + "' in .npz archive");
+
+            if (!it->stored)
+                throw npy_error("Compressed .npz members are not supported");
+
+            return *it;
+        }
+
+        mapped_file file_;
+        std::vector<member> members_;
+    };
+}
+
+#endif
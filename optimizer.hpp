@@ -0,0 +1,220 @@
+#ifndef LAL_OPTIMIZER_HPP
+#define LAL_OPTIMIZER_HPP
+
+#include "instrumentation.hpp"
+#include "reductions.hpp"
+#include "parallel.hpp"
+#include "matrix.hpp"
+#include "simd.hpp"
+
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <cmath>
+
+// Optimizers which update a parameter matrix together with its state (momentum or
+// moment estimates, zero initialised by the caller and kept between steps) from its
+// gradient in a single pass, rather than one pass per elementwise operation.  The
+// passes are vectorised for float (see simd.hpp) and overloads taking lal::par split
+// them into the same chunks as the other parallel operations.
+//
+// Gradients can be clipped on the way in.  Clipping by value clamps each element,
+// clipping by norm scales every gradient of a model by the same factor so that their
+// combined norm is at most a maximum, clip_by_norm works that factor out.
+namespace lal
+{
+    template <typename T>
+    struct gradient_clipping
+    {
+        T scale = T{ 1 };
+        T max_value = std::numeric_limits<T>::infinity();
+    };
+
+    // The clipping which scales gradients with a combined norm over max_norm down to it
+    template <typename T, typename... Gradients>
+    gradient_clipping<T> clip_by_norm(const T max_norm, const Gradients&... gradients)
+    {
+        T norm{};
+        ((norm = static_cast<T>(std::hypot(norm, norm2(gradients)))), ...);
+        return { norm > max_norm ? max_norm / norm : T{ 1 } };
+    }
+
+    namespace detail
+    {
+        template <typename Simd, typename T>
+        typename Simd::vector clip(const T* const gradient, const gradient_clipping<T>& clipping) noexcept
+        {
+            const auto scaled = Simd::mul(Simd::load(gradient), Simd::broadcast(clipping.scale));
+            return Simd::min(Simd::max(scaled, Simd::broadcast(-clipping.max_value)), Simd::broadcast(clipping.max_value));
+        }
+
+        // Calls kernel(first, last) over all N elements, or chunk by chunk on the policy's pool
+        template <typename T, std::size_t N, typename Kernel>
+        void optimizer_pass(const Kernel& kernel) noexcept
+        {
+            kernel(std::size_t{ 0u }, N);
+        }
+
+        template <typename T, std::size_t N, typename Kernel>
+        void optimizer_pass(const parallel_policy& policy, const Kernel& kernel)
+        {
+            parallel_chunks<T, N>(policy, kernel);
+        }
+    }
+
+    // Stochastic gradient descent with (heavy ball) momentum,
+    //   velocity = momentum * velocity + gradient
+    //   weights -= learning_rate * velocity
+    template <typename T>
+    struct sgd_momentum
+    {
+        static_assert(std::is_floating_point_v<T>, "sgd_momentum requires a floating point type");
+
+        T learning_rate = T{ 0.01 };
+        T momentum = T{ 0.9 };
+
+        template <std::size_t Rows, std::size_t Columns>
+        void update(matrix<T, Rows, Columns>& weights, const matrix<T, Rows, Columns>& gradient, matrix<T, Rows, Columns>& velocity,
+                    const gradient_clipping<T>& clipping = {}) const noexcept
+        {
+            LAL_OPERATION_BEGIN();
+            detail::optimizer_pass<T, Rows * Columns>(kernel(weights.data(), gradient.data(), velocity.data(), clipping));
+            LAL_OPERATION_END(sgd_momentum, T, Rows, Columns, 0u);
+        }
+
+        template <std::size_t Rows, std::size_t Columns>
+        void update(const parallel_policy& policy, matrix<T, Rows, Columns>& weights, const matrix<T, Rows, Columns>& gradient,
+                    matrix<T, Rows, Columns>& velocity, const gradient_clipping<T>& clipping = {}) const
+        {
+            LAL_OPERATION_BEGIN();
+            detail::optimizer_pass<T, Rows * Columns>(policy, kernel(weights.data(), gradient.data(), velocity.data(), clipping));
+            LAL_OPERATION_END(sgd_momentum, T, Rows, Columns, 0u);
+        }
+
+    private:
+        auto kernel(T* const w, const T* const g, T* const v, const gradient_clipping<T>& clipping) const noexcept
+        {
+            return [=, lr = learning_rate, mu = momentum](const std::size_t first, const std::size_t last) noexcept {
+                detail::simd_loop<T>(first, last, [&](const auto simd, const std::size_t i) {
+                    using S = decltype(simd);
+                    const auto velocity = S::fmadd(S::broadcast(mu), S::load(v + i), detail::clip<S>(g + i, clipping));
+                    S::store(v + i, velocity);
+                    S::store(w + i, S::sub(S::load(w + i), S::mul(S::broadcast(lr), velocity)));
+                });
+            };
+        }
+    };
+
+    // Adam (Kingma and Ba) with bias corrected moment estimates,
+    //   m = beta1 * m + (1 - beta1) * gradient
+    //   v = beta2 * v + (1 - beta2) * gradient^2
+    //   weights -= learning_rate * (m / (1 - beta1^t)) / (sqrt(v / (1 - beta2^t)) + epsilon)
+    // The bias corrections depend on the step t, next_step() must be called once per
+    // training step before its updates.
+    template <typename T>
+    struct adam
+    {
+        static_assert(std::is_floating_point_v<T>, "adam requires a floating point type");
+
+        T learning_rate = T{ 0.001 };
+        T beta1 = T{ 0.9 };
+        T beta2 = T{ 0.999 };
+        T epsilon = T{ 1e-8 };
+        std::size_t step = 0u;
+
+        void next_step() noexcept { ++step; }
+
+        template <std::size_t Rows, std::size_t Columns>
+        void update(matrix<T, Rows, Columns>& weights, const matrix<T, Rows, Columns>& gradient, matrix<T, Rows, Columns>& m,
+                    matrix<T, Rows, Columns>& v, const gradient_clipping<T>& clipping = {}) const noexcept
+        {
+            LAL_OPERATION_BEGIN();
+            detail::optimizer_pass<T, Rows * Columns>(kernel(weights.data(), gradient.data(), m.data(), v.data(), clipping));
+            LAL_OPERATION_END(adam, T, Rows, Columns, 0u);
+        }
+
+        template <std::size_t Rows, std::size_t Columns>
+        void update(const parallel_policy& policy, matrix<T, Rows, Columns>& weights, const matrix<T, Rows, Columns>& gradient,
+                    matrix<T, Rows, Columns>& m, matrix<T, Rows, Columns>& v, const gradient_clipping<T>& clipping = {}) const
+        {
+            LAL_OPERATION_BEGIN();
+            detail::optimizer_pass<T, Rows * Columns>(policy, kernel(weights.data(), gradient.data(), m.data(), v.data(), clipping));
+            LAL_OPERATION_END(adam, T, Rows, Columns, 0u);
+        }
+
+    private:
+        auto kernel(T* const w, const T* const g, T* const m, T* const v, const gradient_clipping<T>& clipping) const noexcept
+        {
+            // The corrections are folded into the step size and epsilon, with c1 and c2
+            // the first and the square root of the second (m / c1) / (sqrt(v) / c2 + epsilon)
+            // = (c2 / c1) * m / (sqrt(v) + epsilon * c2)
+            const T t = static_cast<T>(std::max<std::size_t>(step, 1u));
+            const T c1 = T{ 1 } - std::pow(beta1, t);
+            const T c2 = std::sqrt(T{ 1 } - std::pow(beta2, t));
+            return [=, b1 = beta1, b2 = beta2, step_size = learning_rate * c2 / c1, e = epsilon * c2](const std::size_t first,
+                                                                                                       const std::size_t last) noexcept {
+                detail::simd_loop<T>(first, last, [&](const auto simd, const std::size_t i) {
+                    using S = decltype(simd);
+                    const auto gradient = detail::clip<S>(g + i, clipping);
+                    const auto first_moment = S::fmadd(S::broadcast(b1), S::load(m + i), S::mul(S::broadcast(T{ 1 } - b1), gradient));
+                    const auto second_moment =
+                        S::fmadd(S::broadcast(b2), S::load(v + i), S::mul(S::broadcast(T{ 1 } - b2), S::mul(gradient, gradient)));
+                    S::store(m + i, first_moment);
+                    S::store(v + i, second_moment);
+                    const auto change = S::div(S::mul(S::broadcast(step_size), first_moment), S::add(S::sqrt(second_moment), S::broadcast(e)));
+                    S::store(w + i, S::sub(S::load(w + i), change));
+                });
+            };
+        }
+    };
+
+    // RMSProp (Hinton), gradients divided by a running root mean square,
+    //   mean_square = decay * mean_square + (1 - decay) * gradient^2
+    //   weights -= learning_rate * gradient / (sqrt(mean_square) + epsilon)
+    template <typename T>
+    struct rmsprop
+    {
+        static_assert(std::is_floating_point_v<T>, "rmsprop requires a floating point type");
+
+        T learning_rate = T{ 0.001 };
+        T decay = T{ 0.9 };
+        T epsilon = T{ 1e-8 };
+
+        template <std::size_t Rows, std::size_t Columns>
+        void update(matrix<T, Rows, Columns>& weights, const matrix<T, Rows, Columns>& gradient, matrix<T, Rows, Columns>& mean_square,
+                    const gradient_clipping<T>& clipping = {}) const noexcept
+        {
+            LAL_OPERATION_BEGIN();
+            detail::optimizer_pass<T, Rows * Columns>(kernel(weights.data(), gradient.data(), mean_square.data(), clipping));
+            LAL_OPERATION_END(rmsprop, T, Rows, Columns, 0u);
+        }
+
+        template <std::size_t Rows, std::size_t Columns>
+        void update(const parallel_policy& policy, matrix<T, Rows, Columns>& weights, const matrix<T, Rows, Columns>& gradient,
+                    matrix<T, Rows, Columns>& mean_square, const gradient_clipping<T>& clipping = {}) const
+        {
+            LAL_OPERATION_BEGIN();
+            detail::optimizer_pass<T, Rows * Columns>(policy, kernel(weights.data(), gradient.data(), mean_square.data(), clipping));
+            LAL_OPERATION_END(rmsprop, T, Rows, Columns, 0u);
+        }
+
+    private:
+        auto kernel(T* const w, const T* const g, T* const s, const gradient_clipping<T>& clipping) const noexcept
+        {
+            return [=, lr = learning_rate, rho = decay, e = epsilon](const std::size_t first, const std::size_t last) noexcept {
+                detail::simd_loop<T>(first, last, [&](const auto simd, const std::size_t i) {
+                    using S = decltype(simd);
+                    const auto gradient = detail::clip<S>(g + i, clipping);
+                    const auto mean_square =
+                        S::fmadd(S::broadcast(rho), S::load(s + i), S::mul(S::broadcast(T{ 1 } - rho), S::mul(gradient, gradient)));
+                    S::store(s + i, mean_square);
+                    const auto change = S::div(S::mul(S::broadcast(lr), gradient), S::add(S::sqrt(mean_square), S::broadcast(e)));
+                    S::store(w + i, S::sub(S::load(w + i), change));
+                });
+            };
+        }
+    };
+}
+
+#endif
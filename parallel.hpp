@@ -0,0 +1,319 @@
+#ifndef LAL_PARALLEL_HPP
+#define LAL_PARALLEL_HPP
+
+#include "instrumentation.hpp"
+#include "thread_pool.hpp"
+#include "reductions.hpp"
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <cmath>
+
+// Overloads of the elementwise operations, map and the reductions which take an
+// execution policy first, e.g. lal::sum(lal::par, m) or lal::add_assign(lal::par, a, b).
+// Elements are split into chunks of 64 KiB which the threads of a pool (the shared
+// default_thread_pool unless the policy names another) take in turn.
+//
+// Chunk boundaries only depend on the size of the matrix, each chunk is reduced on
+// its own and the chunk results are then combined in a fixed order, so a reduction
+// gives the same result whatever the number of threads.  It isn't always the same
+// result as the sequential overload though, whose blocks are laid out per row.
+//
+// Functions given to map are called concurrently.
+namespace lal
+{
+    class parallel_policy
+    {
+    public:
+        constexpr parallel_policy() noexcept = default;
+        constexpr explicit parallel_policy(thread_pool& pool) noexcept : pool_{ &pool } {}
+
+        // The same policy but run on the given pool
+        constexpr parallel_policy on(thread_pool& pool) const noexcept { return parallel_policy{ pool }; }
+
+        thread_pool& pool() const { return pool_ ? *pool_ : default_thread_pool(); }
+
+    private:
+        thread_pool* pool_{ nullptr };
+    };
+
+    inline constexpr parallel_policy par{};
+
+    namespace detail
+    {
+        inline constexpr std::size_t parallel_chunk_bytes = 64u * 1024u;
+
+        // A whole number of summation lanes so every full chunk is reduced the same way
+        template <typename T>
+        inline constexpr std::size_t parallel_chunk_v =
+            std::max(parallel_chunk_bytes / sizeof(T) / summation_lanes * summation_lanes, summation_lanes);
+
+        // Calls function(first, last) for each chunk of N elements of type T
+        template <typename T, std::size_t N, typename Function>
+        void parallel_chunks(const parallel_policy& policy, const Function& function)
+        {
+            constexpr std::size_t chunk = parallel_chunk_v<T>;
+            constexpr std::size_t chunks = (N + chunk - 1u) / chunk;
+            policy.pool().parallel_for(chunks, [&function](const std::size_t c) {
+                function(c * chunk, std::min(N, (c + 1u) * chunk));
+            });
+        }
+
+        // Sums term(i) over the N elements of a matrix of T, chunk by chunk and then
+        // over the chunk sums
+        template <summation Mode, typename Accumulator, typename T, std::size_t N, typename Term>
+        Accumulator parallel_reduce(const parallel_policy& policy, const Term& term)
+        {
+            constexpr std::size_t chunk = parallel_chunk_v<T>;
+            constexpr std::size_t chunks = (N + chunk - 1u) / chunk;
+            if constexpr (chunks == 1u)
+            {
+                return reduce_sum<Mode, Accumulator, N>(term);
+            }
+            else
+            {
+                constexpr std::size_t last = N - (chunks - 1u) * chunk;
+                std::vector<Accumulator> sums(chunks);
+                policy.pool().parallel_for(chunks, [&term, &sums](const std::size_t c) {
+                    const std::size_t first = c * chunk;
+                    const auto chunk_term = [&term, first](const std::size_t i) { return term(first + i); };
+                    if (c + 1u < chunks)
+                        sums[c] = reduce_sum<Mode, Accumulator, chunk>(chunk_term);
+                    else
+                        sums[c] = reduce_sum<Mode, Accumulator, last>(chunk_term);
+                });
+
+                return reduce_sum<Mode, Accumulator, chunks>([&sums](const std::size_t c) { return sums[c]; });
+            }
+        }
+    }
+
+    // Elementwise operations
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns>& add_assign(const parallel_policy& policy, matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
+    {
+        LAL_OPERATION_BEGIN();
+        T* const l = lhs.data();
+        const T* const r = rhs.data();
+        detail::parallel_chunks<T, Rows * Columns>(policy, [l, r](const std::size_t first, const std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                l[i] += r[i];
+        });
+
+        LAL_OPERATION_END(addition, T, Rows, Columns, 0u);
+        return lhs;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns>& subtract_assign(const parallel_policy& policy, matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
+    {
+        LAL_OPERATION_BEGIN();
+        T* const l = lhs.data();
+        const T* const r = rhs.data();
+        detail::parallel_chunks<T, Rows * Columns>(policy, [l, r](const std::size_t first, const std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                l[i] -= r[i];
+        });
+
+        LAL_OPERATION_END(subtraction, T, Rows, Columns, 0u);
+        return lhs;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns>& hadamard_assign(const parallel_policy& policy, matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
+    {
+        LAL_OPERATION_BEGIN();
+        T* const l = lhs.data();
+        const T* const r = rhs.data();
+        detail::parallel_chunks<T, Rows * Columns>(policy, [l, r](const std::size_t first, const std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                l[i] *= r[i];
+        });
+
+        LAL_OPERATION_END(hadamard_product, T, Rows, Columns, 0u);
+        return lhs;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns>& multiply_assign(const parallel_policy& policy, matrix<T, Rows, Columns>& m, const T scalar)
+    {
+        LAL_OPERATION_BEGIN();
+        T* const p = m.data();
+        detail::parallel_chunks<T, Rows * Columns>(policy, [p, &scalar](const std::size_t first, const std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                p[i] *= scalar;
+        });
+
+        LAL_OPERATION_END(scalar_multiplication, T, Rows, Columns, 0u);
+        return m;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns>& divide_assign(const parallel_policy& policy, matrix<T, Rows, Columns>& m, const T scalar)
+    {
+        LAL_OPERATION_BEGIN();
+        T* const p = m.data();
+        detail::parallel_chunks<T, Rows * Columns>(policy, [p, &scalar](const std::size_t first, const std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                p[i] /= scalar;
+        });
+
+        LAL_OPERATION_END(scalar_division, T, Rows, Columns, 0u);
+        return m;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns> add(const parallel_policy& policy, matrix<T, Rows, Columns> lhs, const matrix<T, Rows, Columns>& rhs)
+    {
+        add_assign(policy, lhs, rhs);
+        return lhs;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns> subtract(const parallel_policy& policy, matrix<T, Rows, Columns> lhs, const matrix<T, Rows, Columns>& rhs)
+    {
+        subtract_assign(policy, lhs, rhs);
+        return lhs;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns> hadamard(const parallel_policy& policy, matrix<T, Rows, Columns> lhs, const matrix<T, Rows, Columns>& rhs)
+    {
+        hadamard_assign(policy, lhs, rhs);
+        return lhs;
+    }
+
+    // Map, writing into out avoids a large result on the stack
+    template <typename T, typename U, std::size_t Rows, std::size_t Columns, typename Function>
+    void map(const parallel_policy& policy, const matrix<T, Rows, Columns>& m, const Function& f, matrix<U, Rows, Columns>& out)
+    {
+        LAL_OPERATION_BEGIN();
+        const T* const in = m.data();
+        U* const o = out.data();
+        detail::parallel_chunks<T, Rows * Columns>(policy, [in, o, &f](const std::size_t first, const std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                o[i] = f(in[i]);
+        });
+
+        LAL_OPERATION_END(map, T, Rows, Columns, 0u);
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns, typename Function>
+    auto map(const parallel_policy& policy, const matrix<T, Rows, Columns>& m, Function f)
+    {
+        matrix<decltype(f(T{})), Rows, Columns> ret{};
+        map(policy, m, f, ret);
+        return ret;
+    }
+
+    // Reductions
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    detail::accumulator_t<T> sum(const parallel_policy& policy, const matrix<T, Rows, Columns>& m)
+    {
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        const T* const p = m.data();
+        const accumulator ret = detail::parallel_reduce<Mode, accumulator, T, Rows * Columns>(
+            policy, [p](const std::size_t i) { return static_cast<accumulator>(p[i]); });
+
+        LAL_OPERATION_END(sum, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    detail::accumulator_t<T> dot(const parallel_policy& policy, const matrix<T, Rows, Columns>& lhs, const matrix<T, Rows, Columns>& rhs)
+    {
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        const T* const l = lhs.data();
+        const T* const r = rhs.data();
+        const accumulator ret = detail::parallel_reduce<Mode, accumulator, T, Rows * Columns>(
+            policy, [l, r](const std::size_t i) { return static_cast<accumulator>(l[i] * r[i]); });
+
+        LAL_OPERATION_END(dot, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    detail::accumulator_t<T> norm1(const parallel_policy& policy, const matrix<T, Rows, Columns>& m)
+    {
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        const T* const p = m.data();
+        const accumulator ret = detail::parallel_reduce<Mode, accumulator, T, Rows * Columns>(
+            policy, [p](const std::size_t i) { return detail::absolute(static_cast<accumulator>(p[i])); });
+
+        LAL_OPERATION_END(norm, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    detail::norm_t<T> norm2(const parallel_policy& policy, const matrix<T, Rows, Columns>& m)
+    {
+        using result = detail::norm_t<T>;
+        LAL_OPERATION_BEGIN();
+        const T* const p = m.data();
+        const result sum_of_squares = detail::parallel_reduce<Mode, result, T, Rows * Columns>(policy, [p](const std::size_t i) {
+            const auto x = static_cast<result>(p[i]);
+            return x * x;
+        });
+
+        const result ret = detail::norm2_from_squares(sum_of_squares, m);
+        LAL_OPERATION_END(norm, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    detail::norm_t<T> frobenius(const parallel_policy& policy, const matrix<T, Rows, Columns>& m)
+    {
+        return norm2<Mode>(policy, m);
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    T norm_inf(const parallel_policy& policy, const matrix<T, Rows, Columns>& m)
+    {
+        constexpr std::size_t N = Rows * Columns;
+        constexpr std::size_t chunk = detail::parallel_chunk_v<T>;
+        constexpr std::size_t chunks = (N + chunk - 1u) / chunk;
+        constexpr std::size_t last = N - (chunks - 1u) * chunk;
+
+        LAL_OPERATION_BEGIN();
+        const T* const p = m.data();
+        std::vector<T> largest(chunks);
+        policy.pool().parallel_for(chunks, [p, &largest](const std::size_t c) {
+            if (c + 1u < chunks)
+                largest[c] = detail::largest_absolute<chunk>(p + c * chunk);
+            else
+                largest[c] = detail::largest_absolute<last>(p + c * chunk);
+        });
+
+        T ret{};
+        for (const T& x : largest)
+            if (ret < x)
+                ret = x;
+
+        LAL_OPERATION_END(norm, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    auto magnitude(const parallel_policy& policy, const matrix<T, Rows, Columns>& m)
+    {
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        const T* const p = m.data();
+        const accumulator sum = detail::parallel_reduce<summation::pairwise, accumulator, T, Rows * Columns>(
+            policy, [p](const std::size_t i) { return static_cast<accumulator>(p[i] * p[i]); });
+
+        LAL_OPERATION_END(magnitude, T, Rows, Columns, 0u);
+        if constexpr (std::is_floating_point_v<T>)
+            return std::sqrt(sum);
+        else
+            return static_cast<T>(std::sqrt(static_cast<double>(sum)));
+    }
+}
+
+#endif
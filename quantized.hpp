@@ -0,0 +1,229 @@
+#ifndef LAL_QUANTIZED_HPP
+#define LAL_QUANTIZED_HPP
+
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// 8-bit quantized matrices with a float scale (and for the asymmetric scheme an
+// integer zero point) per row, so row i holds values x = scale_i * (q - zero_point_i).
+// Quantized values are kept within [-127, 127] by both schemes, which lets the
+// SIMD kernels form products from absolute values without overflowing.
+//
+// qgemm multiplies A by the transpose of B, i.e. both operands are quantized along
+// the shared dimension and each row of B is an output column (as for the rows of a
+// weight matrix).  The products are summed exactly in int32 and only the final
+// results are scaled, using AVX-512 VNNI or AVX2 (vpmaddubsw) when the compiler
+// targets them and scalar code otherwise.
+namespace lal
+{
+    enum class quantization { symmetric, asymmetric };
+
+    template <typename T, std::size_t Rows, std::size_t Columns, quantization Scheme = quantization::symmetric>
+    class quantized_matrix
+    {
+        static_assert(std::is_same_v<T, std::int8_t>, "quantized_matrix only supports int8_t values");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        static constexpr quantization scheme = Scheme;
+
+        constexpr size_type rows() const noexcept { return Rows; }
+        constexpr size_type columns() const noexcept { return Columns; }
+
+        constexpr const matrix<T, Rows, Columns>& values() const noexcept { return values_; }
+        constexpr float scale(const size_type row) const noexcept { return scales_[row]; }
+        constexpr std::int32_t zero_point(const size_type row) const noexcept { return zero_points_[row]; }
+
+        // Sum of the quantized values in a row, used to correct products for the zero points
+        constexpr std::int32_t row_sum(const size_type row) const noexcept { return row_sums_[row]; }
+
+        template <typename U, std::size_t R, std::size_t C, quantization S>
+        friend void quantize(const matrix<float, R, C>& m, quantized_matrix<U, R, C, S>& q) noexcept;
+
+    private:
+        matrix<T, Rows, Columns> values_{};
+        float scales_[Rows]{};
+        std::int32_t zero_points_[Rows]{};
+        std::int32_t row_sums_[Rows]{};
+    };
+
+    namespace detail
+    {
+        inline constexpr std::int32_t quantized_limit = 127;
+
+        inline std::int8_t quantize_value(const float x, const float inverse_scale, const std::int32_t zero_point) noexcept
+        {
+            const long q = std::lround(x * inverse_scale) + zero_point;
+            return static_cast<std::int8_t>(std::clamp<long>(q, -quantized_limit, quantized_limit));
+        }
+
+        // Sum of products of two runs of int8 values, neither of which may contain -128
+        inline std::int32_t int8_dot(const std::int8_t* const a, const std::int8_t* const b, const std::size_t n) noexcept
+        {
+            std::size_t i = 0u;
+            std::int32_t sum = 0;
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+            // vpdpbusd multiplies unsigned by signed bytes, so |a| times b with a's sign
+            const __m512i zero = _mm512_setzero_si512();
+            __m512i acc = zero;
+            for (; i + 64u <= n; i += 64u)
+            {
+                const __m512i va = _mm512_loadu_si512(a + i);
+                const __m512i vb = _mm512_loadu_si512(b + i);
+                const __m512i signed_b = _mm512_mask_sub_epi8(vb, _mm512_movepi8_mask(va), zero, vb);
+                acc = _mm512_dpbusd_epi32(acc, _mm512_abs_epi8(va), signed_b);
+            }
+
+            sum = _mm512_reduce_add_epi32(acc);
+#elif defined(__AVX2__)
+            // vpmaddubsw has the same unsigned by signed form, pairs of products fit in
+            // int16 as |a|, |b| <= 127 and vpmaddwd then widens them to int32
+            const __m256i ones = _mm256_set1_epi16(1);
+            __m256i acc = _mm256_setzero_si256();
+            for (; i + 32u <= n; i += 32u)
+            {
+                const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                const __m256i pairs = _mm256_maddubs_epi16(_mm256_sign_epi8(va, va), _mm256_sign_epi8(vb, va));
+                acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+            }
+
+            alignas(32) std::int32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+            for (const std::int32_t lane : lanes)
+                sum += lane;
+#endif
+            for (; i < n; ++i)
+                sum += static_cast<std::int32_t>(a[i]) * static_cast<std::int32_t>(b[i]);
+
+            return sum;
+        }
+    }
+
+    // Quantizes each row of m with its own scale (and zero point)
+    template <typename T, std::size_t Rows, std::size_t Columns, quantization Scheme>
+    void quantize(const matrix<float, Rows, Columns>& m, quantized_matrix<T, Rows, Columns, Scheme>& q) noexcept
+    {
+        for (std::size_t row = 0u; row < Rows; ++row)
+        {
+            float scale = 0.0f;
+            std::int32_t zero_point = 0;
+            if constexpr (Scheme == quantization::symmetric)
+            {
+                float largest = 0.0f;
+                for (std::size_t column = 0u; column < Columns; ++column)
+                    largest = std::max(largest, std::abs(m[row][column]));
+
+                scale = largest / detail::quantized_limit;
+            }
+            else
+            {
+                // The range always includes zero so that zero is represented exactly
+                float lowest = 0.0f;
+                float highest = 0.0f;
+                for (std::size_t column = 0u; column < Columns; ++column)
+                {
+                    lowest = std::min(lowest, m[row][column]);
+                    highest = std::max(highest, m[row][column]);
+                }
+
+                scale = (highest - lowest) / (2 * detail::quantized_limit);
+                if (scale > 0.0f)
+                    zero_point = std::clamp<std::int32_t>(static_cast<std::int32_t>(std::lround(-detail::quantized_limit - lowest / scale)),
+                                                          -detail::quantized_limit, detail::quantized_limit);
+            }
+
+            if (scale == 0.0f)
+                scale = 1.0f;
+
+            const float inverse_scale = 1.0f / scale;
+            std::int32_t sum = 0;
+            for (std::size_t column = 0u; column < Columns; ++column)
+            {
+                q.values_[row][column] = detail::quantize_value(m[row][column], inverse_scale, zero_point);
+                sum += q.values_[row][column];
+            }
+
+            q.scales_[row] = scale;
+            q.zero_points_[row] = zero_point;
+            q.row_sums_[row] = sum;
+        }
+    }
+
+    template <quantization Scheme = quantization::symmetric, std::size_t Rows, std::size_t Columns>
+    quantized_matrix<std::int8_t, Rows, Columns, Scheme> quantize(const matrix<float, Rows, Columns>& m) noexcept
+    {
+        quantized_matrix<std::int8_t, Rows, Columns, Scheme> ret{};
+        quantize(m, ret);
+        return ret;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns, quantization Scheme>
+    void dequantize(const quantized_matrix<T, Rows, Columns, Scheme>& q, matrix<float, Rows, Columns>& m) noexcept
+    {
+        for (std::size_t row = 0u; row < Rows; ++row)
+            for (std::size_t column = 0u; column < Columns; ++column)
+                m[row][column] = q.scale(row) * static_cast<float>(q.values()[row][column] - q.zero_point(row));
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns, quantization Scheme>
+    matrix<float, Rows, Columns> dequantize(const quantized_matrix<T, Rows, Columns, Scheme>& q) noexcept
+    {
+        matrix<float, Rows, Columns> ret{};
+        dequantize(q, ret);
+        return ret;
+    }
+
+    // C = A * B^T summed exactly in int32, with no scaling
+    template <typename T, std::size_t M, std::size_t N, std::size_t K, quantization SchemeA, quantization SchemeB>
+    void qgemm(const quantized_matrix<T, M, K, SchemeA>& a, const quantized_matrix<T, N, K, SchemeB>& b,
+               matrix<std::int32_t, M, N>& c) noexcept
+    {
+        LAL_OPERATION_BEGIN();
+        for (std::size_t i = 0u; i < M; ++i)
+            for (std::size_t j = 0u; j < N; ++j)
+                c[i][j] = detail::int8_dot(a.values()[i], b.values()[j], K);
+
+        LAL_OPERATION_END(quantized_gemm, T, M, N, K);
+    }
+
+    // C = dequantize(A) * dequantize(B)^T, the zero points are corrected for with the
+    // row sums so the inner loop is the same as for symmetric quantization
+    template <typename T, std::size_t M, std::size_t N, std::size_t K, quantization SchemeA, quantization SchemeB>
+    void qgemm(const quantized_matrix<T, M, K, SchemeA>& a, const quantized_matrix<T, N, K, SchemeB>& b,
+               matrix<float, M, N>& c) noexcept
+    {
+        LAL_OPERATION_BEGIN();
+        for (std::size_t i = 0u; i < M; ++i)
+        {
+            for (std::size_t j = 0u; j < N; ++j)
+            {
+                std::int32_t sum = detail::int8_dot(a.values()[i], b.values()[j], K);
+                if constexpr (SchemeB == quantization::asymmetric)
+                    sum -= b.zero_point(j) * a.row_sum(i);
+                if constexpr (SchemeA == quantization::asymmetric)
+                    sum -= a.zero_point(i) * b.row_sum(j);
+                if constexpr (SchemeA == quantization::asymmetric && SchemeB == quantization::asymmetric)
+                    sum += static_cast<std::int32_t>(K) * a.zero_point(i) * b.zero_point(j);
+
+                c[i][j] = a.scale(i) * b.scale(j) * static_cast<float>(sum);
+            }
+        }
+
+        LAL_OPERATION_END(quantized_gemm, T, M, N, K);
+    }
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef LAL_REDUCTIONS_HPP
+#define LAL_REDUCTIONS_HPP
+
+#include "instrumentation.hpp"
+#include "summation.hpp"
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <cstddef>
+#include <limits>
+#include <cmath>
+
+// Single pass reductions over every element of a matrix, so for a matrix the norms
+// are entrywise (norm2 is the Frobenius norm).  Sums are pairwise by default or
+// compensated with summation::compensated, see summation.hpp.
+namespace lal
+{
+    struct matrix_index
+    {
+        std::size_t row{};
+        std::size_t column{};
+
+        friend constexpr bool operator==(const matrix_index& lhs, const matrix_index& rhs) noexcept
+        {
+            return lhs.row == rhs.row && lhs.column == rhs.column;
+        }
+
+        friend constexpr bool operator!=(const matrix_index& lhs, const matrix_index& rhs) noexcept { return !(lhs == rhs); }
+    };
+
+    namespace detail
+    {
+        // Largest absolute value of N consecutive elements, taken over independent lanes
+        // so the comparisons don't form one dependency chain (NaNs are skipped either way)
+        template <std::size_t N, typename T>
+        constexpr T largest_absolute(const T* const row)
+        {
+            constexpr std::size_t laned = N / summation_lanes * summation_lanes;
+            T ret{};
+            for (std::size_t i = laned; i < N; ++i)
+                ret = ret < absolute(row[i]) ? absolute(row[i]) : ret;
+
+            if constexpr (laned != 0u)
+            {
+                T lanes[summation_lanes]{};
+                for (std::size_t i = 0u; i < laned; i += summation_lanes)
+                    for (std::size_t lane = 0u; lane < summation_lanes; ++lane)
+                        lanes[lane] = lanes[lane] < absolute(row[i + lane]) ? absolute(row[i + lane]) : lanes[lane];
+
+                for (const T& lane : lanes)
+                    ret = ret < lane ? lane : ret;
+            }
+
+            return ret;
+        }
+
+        template <typename T>
+        using norm_t = std::conditional_t<std::is_floating_point_v<accumulator_t<T>>, accumulator_t<T>, double>;
+
+        // Blue's algorithm (as in LAPACK's nrm2), squares are accumulated in three
+        // ranges with the very small and very large ones scaled towards one so that
+        // nothing overflows or underflows
+        template <typename F, typename T, std::size_t Rows, std::size_t Columns>
+        F scaled_norm2(const matrix<T, Rows, Columns>& m) noexcept
+        {
+            // The square of any float is a normal double, so no scaling is needed
+            if constexpr (std::is_same_v<F, float>)
+            {
+                const double sum_of_squares = reduce_matrix<summation::pairwise, double, Rows, Columns>(
+                    [&m](const std::size_t row, const std::size_t column) {
+                        const auto x = static_cast<double>(static_cast<float>(m[row][column]));
+                        return x * x;
+                    });
+
+                return static_cast<float>(std::sqrt(sum_of_squares));
+            }
+
+            using limits = std::numeric_limits<F>;
+            const F small_threshold = std::ldexp(F{ 1 }, static_cast<int>(std::ceil((limits::min_exponent - 1) / 2.0)));
+            const F big_threshold = std::ldexp(F{ 1 }, static_cast<int>(std::floor((limits::max_exponent - limits::digits + 1) / 2.0)));
+            const F small_scale = std::ldexp(F{ 1 }, -static_cast<int>(std::floor((limits::min_exponent - limits::digits) / 2.0)));
+            const F big_scale = std::ldexp(F{ 1 }, -static_cast<int>(std::ceil((limits::max_exponent + limits::digits - 1) / 2.0)));
+
+            F big{};
+            F medium{};
+            F small{};
+            bool no_big = true;
+            for (const T& element : m)
+            {
+                const F x = std::abs(static_cast<F>(element));
+                if (x > big_threshold)
+                {
+                    big += (x * big_scale) * (x * big_scale);
+                    no_big = false;
+                }
+                else if (x < small_threshold)
+                {
+                    if (no_big)
+                        small += (x * small_scale) * (x * small_scale);
+                }
+                else
+                {
+                    medium += x * x;
+                }
+            }
+
+            if (big > F{})
+            {
+                if (medium > F{} || std::isnan(medium))
+                    big += (medium * big_scale) * big_scale;
+
+                return std::sqrt(big) / big_scale;
+            }
+
+            if (small > F{})
+            {
+                if (medium > F{} || std::isnan(medium))
+                {
+                    const F a = std::sqrt(medium);
+                    const F b = std::sqrt(small) / small_scale;
+                    const F lower = a < b ? a : b;
+                    const F upper = a < b ? b : a;
+                    return upper * std::sqrt(F{ 1 } + (lower / upper) * (lower / upper));
+                }
+
+                return std::sqrt(small) / small_scale;
+            }
+
+            return std::sqrt(medium);
+        }
+
+        // The square root of a plain sum of squares, or the scaled norm if that sum
+        // overflowed or is so small that squares too small to be represented could make
+        // a relative difference (including every square having underflowed to zero)
+        template <typename F, typename T, std::size_t Rows, std::size_t Columns>
+        F norm2_from_squares(const F sum_of_squares, const matrix<T, Rows, Columns>& m) noexcept
+        {
+            constexpr F smallest_safe = std::numeric_limits<F>::min() / (std::numeric_limits<F>::epsilon() * std::numeric_limits<F>::epsilon());
+            if (std::isfinite(sum_of_squares) && sum_of_squares >= smallest_safe)
+                return std::sqrt(sum_of_squares);
+
+            return scaled_norm2<F>(m);
+        }
+    }
+
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    constexpr detail::accumulator_t<T> sum(const matrix<T, Rows, Columns>& m)
+    {
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        const accumulator ret = detail::reduce_matrix<Mode, accumulator, Rows, Columns>(
+            [&m](const std::size_t row, const std::size_t column) { return static_cast<accumulator>(m[row][column]); });
+
+        LAL_OPERATION_END(sum, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    // Sum of absolute values
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    constexpr detail::accumulator_t<T> norm1(const matrix<T, Rows, Columns>& m)
+    {
+        using accumulator = detail::accumulator_t<T>;
+        LAL_OPERATION_BEGIN();
+        const accumulator ret = detail::reduce_matrix<Mode, accumulator, Rows, Columns>(
+            [&m](const std::size_t row, const std::size_t column) { return detail::absolute(static_cast<accumulator>(m[row][column])); });
+
+        LAL_OPERATION_END(norm, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    // Euclidean norm, squares are summed directly and only when that overflows or
+    // underflows is a second, scaled, pass made.  Integer matrices give a double.
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    detail::norm_t<T> norm2(const matrix<T, Rows, Columns>& m)
+    {
+        using result = detail::norm_t<T>;
+        LAL_OPERATION_BEGIN();
+        const result sum_of_squares = detail::reduce_matrix<Mode, result, Rows, Columns>([&m](const std::size_t row, const std::size_t column) {
+            const auto x = static_cast<result>(m[row][column]);
+            return x * x;
+        });
+
+        const result ret = detail::norm2_from_squares(sum_of_squares, m);
+        LAL_OPERATION_END(norm, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <summation Mode = summation::pairwise, typename T, std::size_t Rows, std::size_t Columns>
+    detail::norm_t<T> frobenius(const matrix<T, Rows, Columns>& m)
+    {
+        return norm2<Mode>(m);
+    }
+
+    // Largest absolute value
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr T norm_inf(const matrix<T, Rows, Columns>& m)
+    {
+        LAL_OPERATION_BEGIN();
+        T ret{};
+        for (std::size_t row = 0u; row < Rows; ++row)
+        {
+            const T x = detail::largest_absolute<Columns>(m[row]);
+            if (ret < x)
+                ret = x;
+        }
+
+        LAL_OPERATION_END(norm, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    // Positions of the smallest and largest elements, the first is returned if there's a tie
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr matrix_index argmin(const matrix<T, Rows, Columns>& m)
+    {
+        LAL_OPERATION_BEGIN();
+        matrix_index ret{};
+        for (std::size_t row = 0u; row < Rows; ++row)
+            for (std::size_t column = 0u; column < Columns; ++column)
+                if (m[row][column] < m[ret.row][ret.column])
+                    ret = { row, column };
+
+        LAL_OPERATION_END(extremum, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr matrix_index argmax(const matrix<T, Rows, Columns>& m)
+    {
+        LAL_OPERATION_BEGIN();
+        matrix_index ret{};
+        for (std::size_t row = 0u; row < Rows; ++row)
+            for (std::size_t column = 0u; column < Columns; ++column)
+                if (m[ret.row][ret.column] < m[row][column])
+                    ret = { row, column };
+
+        LAL_OPERATION_END(extremum, T, Rows, Columns, 0u);
+        return ret;
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr T min(const matrix<T, Rows, Columns>& m)
+    {
+        const matrix_index i = argmin(m);
+        return m[i.row][i.column];
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr T max(const matrix<T, Rows, Columns>& m)
+    {
+        const matrix_index i = argmax(m);
+        return m[i.row][i.column];
+    }
+}
+
+#endif
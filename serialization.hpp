@@ -0,0 +1,337 @@
+#ifndef LAL_SERIALIZATION_HPP
+#define LAL_SERIALIZATION_HPP
+
+#include "matrix_view.hpp"
+#include "mapped_file.hpp"
+#include "checksum.hpp"
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <array>
+
+// Binary matrix records.  Each record is a 64 byte header followed by the
+// elements in row-major order, padded so that the next record starts on a 64
+// byte boundary.  All header fields are stored in the byte order given by the
+// endianness field:
+//
+//   offset  size  field
+//        0     4  magic "LALM"
+//        4     2  format version
+//        6     1  endianness (1 = little, 2 = big)
+//        7     1  element type (see element_type)
+//        8     4  element size in bytes
+//       12     4  alignment of the element data in bytes
+//       16     8  rows
+//       24     8  columns
+//       32     8  size of the element data in bytes
+//       40     4  CRC-32 of the element data
+//       44     4  CRC-32 of header bytes [0, 44)
+//       48    16  reserved, zero
+namespace lal
+{
+    class serialization_error : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    enum class element_type : std::uint8_t
+    {
+        int8 = 1, uint8, int16, uint16, int32, uint32, int64, uint64, float32, float64
+    };
+
+    enum class endianness : std::uint8_t { little = 1, big = 2 };
+
+    namespace detail
+    {
+        inline constexpr std::uint16_t serialization_version = 1u;
+        inline constexpr std::size_t record_header_size = 64u;
+        inline constexpr std::size_t record_alignment = 64u;
+        inline constexpr char record_magic[4] = { 'L', 'A', 'L', 'M' };
+
+        template <typename T>
+        constexpr element_type element_type_of() noexcept
+        {
+            static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "Only arithmetic matrices can be serialized");
+
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                static_assert(sizeof(T) == 4u || sizeof(T) == 8u, "Only 32 and 64 bit floating point types can be serialized");
+                return sizeof(T) == 4u ? element_type::float32 : element_type::float64;
+            }
+            else
+            {
+                constexpr element_type signed_types[] = { element_type::int8, element_type::int16, element_type::int32, element_type::int64 };
+                constexpr element_type unsigned_types[] = { element_type::uint8, element_type::uint16, element_type::uint32, element_type::uint64 };
+                constexpr std::size_t index = sizeof(T) == 1u ? 0u : sizeof(T) == 2u ? 1u : sizeof(T) == 4u ? 2u : 3u;
+                return std::is_signed_v<T> ? signed_types[index] : unsigned_types[index];
+            }
+        }
+
+        inline endianness native_endianness() noexcept
+        {
+            const std::uint16_t value = 1u;
+            unsigned char first_byte = 0u;
+            std::memcpy(&first_byte, &value, 1u);
+            return first_byte == 1u ? endianness::little : endianness::big;
+        }
+
+        inline void reverse_bytes(std::byte* const data, const std::size_t element_size, const std::size_t count) noexcept
+        {
+            for (std::size_t i = 0u; i < count; ++i)
+                std::reverse(data + i * element_size, data + (i + 1u) * element_size);
+        }
+
+        template <typename Integer>
+        void put(std::byte* const header, const std::size_t offset, const Integer value) noexcept
+        {
+            std::memcpy(header + offset, &value, sizeof(Integer));
+        }
+
+        template <typename Integer>
+        Integer get(const std::byte* const header, const std::size_t offset, const bool swap) noexcept
+        {
+            std::byte bytes[sizeof(Integer)];
+            std::memcpy(bytes, header + offset, sizeof(Integer));
+            if (swap)
+                std::reverse(std::begin(bytes), std::end(bytes));
+
+            Integer value{};
+            std::memcpy(&value, bytes, sizeof(Integer));
+            return value;
+        }
+
+        constexpr std::size_t padding_for(const std::size_t size) noexcept
+        {
+            return (record_alignment - size % record_alignment) % record_alignment;
+        }
+
+        struct record_header
+        {
+            endianness byte_order = endianness::little;
+            element_type type = element_type::int8;
+            std::uint32_t element_size = 0u;
+            std::uint64_t rows = 0u;
+            std::uint64_t columns = 0u;
+            std::uint64_t data_size = 0u;
+            std::uint32_t data_checksum = 0u;
+        };
+
+        inline std::array<std::byte, record_header_size> encode_header(const record_header& h) noexcept
+        {
+            std::array<std::byte, record_header_size> header{};
+            std::memcpy(header.data(), record_magic, sizeof(record_magic));
+            put(header.data(), 4u, serialization_version);
+            put(header.data(), 6u, static_cast<std::uint8_t>(h.byte_order));
+            put(header.data(), 7u, static_cast<std::uint8_t>(h.type));
+            put(header.data(), 8u, h.element_size);
+            put(header.data(), 12u, static_cast<std::uint32_t>(record_alignment));
+            put(header.data(), 16u, h.rows);
+            put(header.data(), 24u, h.columns);
+            put(header.data(), 32u, h.data_size);
+            put(header.data(), 40u, h.data_checksum);
+            put(header.data(), 44u, crc32(header.data(), 44u));
+            return header;
+        }
+
+        inline record_header decode_header(const std::byte* const header)
+        {
+            if (std::memcmp(header, record_magic, sizeof(record_magic)) != 0)
+                throw serialization_error("Not a matrix record");
+
+            const auto byte_order = static_cast<endianness>(header[6]);
+            if (byte_order != endianness::little && byte_order != endianness::big)
+                throw serialization_error("Matrix record has an invalid endianness");
+
+            const bool swap = byte_order != native_endianness();
+            if (get<std::uint32_t>(header, 44u, swap) != crc32(header, 44u))
+                throw serialization_error("Matrix record header is corrupt");
+
+            if (get<std::uint16_t>(header, 4u, swap) != serialization_version)
+                throw serialization_error("Unsupported matrix record version");
+
+            record_header h;
+            h.byte_order = byte_order;
+            h.type = static_cast<element_type>(header[7]);
+            h.element_size = get<std::uint32_t>(header, 8u, swap);
+            h.rows = get<std::uint64_t>(header, 16u, swap);
+            h.columns = get<std::uint64_t>(header, 24u, swap);
+            h.data_size = get<std::uint64_t>(header, 32u, swap);
+            h.data_checksum = get<std::uint32_t>(header, 40u, swap);
+
+            if (get<std::uint32_t>(header, 12u, swap) != record_alignment)
+                throw serialization_error("Matrix record has an unsupported alignment");
+
+            if (h.data_size != h.rows * h.columns * h.element_size)
+                throw serialization_error("Matrix record size does not match its shape");
+
+            return h;
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        void check_header(const record_header& h)
+        {
+            if (h.type != element_type_of<T>() || h.element_size != sizeof(T))
+                throw serialization_error("Matrix record has a different element type");
+
+            if (h.rows != Rows || h.columns != Columns)
+                throw serialization_error("Matrix record has different dimensions");
+        }
+    }
+
+    // Writes a matrix (or view) as a single record
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void save(std::ostream& out, const Matrix& m)
+    {
+        using view = view_t<const Matrix>;
+        using T = typename view::value_type;
+        const view v = make_view(m);
+
+        constexpr std::size_t row_size = view::column_count * sizeof(T);
+        std::uint32_t checksum = 0u;
+        if (v.contiguous())
+            checksum = crc32(v.data(), v.size() * sizeof(T));
+        else
+            for (std::size_t row = 0u; row < view::row_count; ++row)
+                checksum = crc32(v[row], row_size, checksum);
+
+        detail::record_header h;
+        h.byte_order = detail::native_endianness();
+        h.type = detail::element_type_of<T>();
+        h.element_size = sizeof(T);
+        h.rows = view::row_count;
+        h.columns = view::column_count;
+        h.data_size = v.size() * sizeof(T);
+        h.data_checksum = checksum;
+
+        const auto header = detail::encode_header(h);
+        out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        if (v.contiguous())
+            out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(h.data_size));
+        else
+            for (std::size_t row = 0u; row < view::row_count; ++row)
+                out.write(reinterpret_cast<const char*>(v[row]), static_cast<std::streamsize>(row_size));
+
+        const char padding[detail::record_alignment]{};
+        out.write(padding, static_cast<std::streamsize>(detail::padding_for(h.data_size)));
+
+        if (!out)
+            throw serialization_error("Unable to write matrix record");
+    }
+
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void save(const std::filesystem::path& path, const Matrix& m)
+    {
+        std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+        if (!out)
+            throw serialization_error("Unable to open " + path.string() + " for writing");
+
+        save(out, m);
+    }
+
+    // Reads the next record into an existing matrix (or view), records written on a
+    // machine of the opposite endianness are byte swapped after the checksum is verified
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void load(std::istream& in, Matrix&& m)
+    {
+        using view = view_t<std::remove_reference_t<Matrix>>;
+        using T = typename view::value_type;
+        const view v = make_view(m);
+
+        std::array<std::byte, detail::record_header_size> header{};
+        if (!in.read(reinterpret_cast<char*>(header.data()), static_cast<std::streamsize>(header.size())))
+            throw serialization_error("Unable to read matrix record header");
+
+        const detail::record_header h = detail::decode_header(header.data());
+        detail::check_header<T, view::row_count, view::column_count>(h);
+
+        constexpr std::size_t row_size = view::column_count * sizeof(T);
+        std::uint32_t checksum = 0u;
+        if (v.contiguous())
+        {
+            in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(h.data_size));
+            checksum = crc32(v.data(), h.data_size);
+        }
+        else
+        {
+            for (std::size_t row = 0u; row < view::row_count; ++row)
+            {
+                in.read(reinterpret_cast<char*>(v[row]), static_cast<std::streamsize>(row_size));
+                checksum = crc32(v[row], row_size, checksum);
+            }
+        }
+
+        if (!in)
+            throw serialization_error("Unexpected end of matrix record");
+
+        if (checksum != h.data_checksum)
+            throw serialization_error("Matrix record data is corrupt");
+
+        if (h.byte_order != detail::native_endianness())
+            for (std::size_t row = 0u; row < view::row_count; ++row)
+                detail::reverse_bytes(reinterpret_cast<std::byte*>(v[row]), sizeof(T), view::column_count);
+
+        in.ignore(static_cast<std::streamsize>(detail::padding_for(h.data_size)));
+    }
+
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void load(const std::filesystem::path& path, Matrix&& m)
+    {
+        std::ifstream in{ path, std::ios::binary };
+        if (!in)
+            throw serialization_error("Unable to open " + path.string() + " for reading");
+
+        load(in, m);
+    }
+
+    // Returns a view directly over a record inside a mapped file without copying,
+    // offset is advanced to the following record.  The record must have been
+    // written with the native byte order.
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix_view<const T, Rows, Columns> map_matrix(const mapped_file& file, std::size_t& offset, const bool verify_checksum = true)
+    {
+        if (offset > file.size() || file.size() - offset < detail::record_header_size)
+            throw serialization_error("Matrix record header extends past the end of the file");
+
+        const std::byte* const record = file.data() + offset;
+        const detail::record_header h = detail::decode_header(record);
+        detail::check_header<T, Rows, Columns>(h);
+
+        if (h.byte_order != detail::native_endianness())
+            throw serialization_error("Matrix record byte order differs from this machine so cannot be mapped");
+
+        if (file.size() - offset - detail::record_header_size < h.data_size)
+            throw serialization_error("Matrix record data extends past the end of the file");
+
+        const std::byte* const data = record + detail::record_header_size;
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0u)
+            throw serialization_error("Matrix record data is misaligned");
+
+        if (verify_checksum && crc32(data, h.data_size) != h.data_checksum)
+            throw serialization_error("Matrix record data is corrupt");
+
+        offset += detail::record_header_size + h.data_size;
+        offset = std::min<std::size_t>(offset + detail::padding_for(h.data_size), file.size());
+
+        return matrix_view<const T, Rows, Columns>{ reinterpret_cast<const T*>(data) };
+    }
+
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    matrix_view<const T, Rows, Columns> map_matrix(const mapped_file& file, const bool verify_checksum = true)
+    {
+        std::size_t offset = 0u;
+        return map_matrix<T, Rows, Columns>(file, offset, verify_checksum);
+    }
+}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef LAL_SIMD_HPP
+#define LAL_SIMD_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// The vector operations used by kernels which the compiler can't vectorise on its
+// own (exp, or sqrt which has to set errno).  simd<float> is AVX-512, AVX2/FMA or
+// SSE2 depending on what the compiler targets, everything else is scalar_simd with
+// a width of one.  exp is a polynomial (as in Cephes' expf, within 2 ulp) for the
+// vector types and std::exp otherwise.
+namespace lal
+{
+    namespace detail
+    {
+        // One element at a time
+        template <typename T>
+        struct scalar_simd
+        {
+            using vector = T;
+            static constexpr std::size_t width = 1u;
+
+            static vector load(const T* const p) noexcept { return *p; }
+            static void store(T* const p, const vector v) noexcept { *p = v; }
+            static vector load_partial(const T* const p, const std::size_t n, const T fill) noexcept { return n != 0u ? *p : fill; }
+            static void store_partial(T* const p, const std::size_t n, const vector v) noexcept
+            {
+                if (n != 0u)
+                    *p = v;
+            }
+            static vector broadcast(const T x) noexcept { return x; }
+            static vector add(const vector a, const vector b) noexcept { return a + b; }
+            static vector sub(const vector a, const vector b) noexcept { return a - b; }
+            static vector mul(const vector a, const vector b) noexcept { return a * b; }
+            static vector div(const vector a, const vector b) noexcept { return a / b; }
+            static vector fmadd(const vector a, const vector b, const vector c) noexcept { return a * b + c; }
+            static vector max(const vector a, const vector b) noexcept { return a < b ? b : a; }
+            static vector min(const vector a, const vector b) noexcept { return b < a ? b : a; }
+            static vector sqrt(const vector x) noexcept { return std::sqrt(x); }
+            static vector exp(const vector x) noexcept { return std::exp(x); }
+            static T reduce_add(const vector v) noexcept { return v; }
+            static T reduce_max(const vector v) noexcept { return v; }
+        };
+
+        template <typename T>
+        struct simd : scalar_simd<T>
+        {
+        };
+
+        // exp(x) = 2^n exp(r) with n = round(x / ln 2), ln 2 is split into a part with
+        // few enough bits that n * ln2_high is exact so r loses no precision
+        template <typename Simd>
+        typename Simd::vector exp_polynomial(const typename Simd::vector x) noexcept
+        {
+            using S = Simd;
+            const auto low = S::broadcast(-87.0f);
+            const auto clamped = S::min(S::broadcast(88.3762589f), S::max(low, x));
+            const auto n = S::round(S::mul(clamped, S::broadcast(1.44269504f)));
+            const auto r = S::fmadd(n, S::broadcast(2.12194440e-4f), S::fmadd(n, S::broadcast(-0.693359375f), clamped));
+
+            auto p = S::broadcast(1.9875691500e-4f);
+            p = S::fmadd(p, r, S::broadcast(1.3981999507e-3f));
+            p = S::fmadd(p, r, S::broadcast(8.3334519073e-3f));
+            p = S::fmadd(p, r, S::broadcast(4.1665795894e-2f));
+            p = S::fmadd(p, r, S::broadcast(1.6666665459e-1f));
+            p = S::fmadd(p, r, S::broadcast(5.0000001201e-1f));
+            const auto y = S::fmadd(S::mul(p, r), r, S::add(r, S::broadcast(1.0f)));
+
+            // Anything below low is zero (clamping there keeps 2^n y normal, denormals are
+            // very slow to produce), NaN is kept
+            return S::zero_below(x, low, S::mul(y, S::pow2n(n)));
+        }
+
+#if defined(__AVX512F__)
+        template <>
+        struct simd<float>
+        {
+            using vector = __m512;
+            static constexpr std::size_t width = 16u;
+
+            static vector load(const float* const p) noexcept { return _mm512_loadu_ps(p); }
+            static void store(float* const p, const vector v) noexcept { _mm512_storeu_ps(p, v); }
+            static vector load_partial(const float* const p, const std::size_t n, const float fill) noexcept
+            {
+                return _mm512_mask_loadu_ps(_mm512_set1_ps(fill), static_cast<__mmask16>((1u << n) - 1u), p);
+            }
+            static void store_partial(float* const p, const std::size_t n, const vector v) noexcept
+            {
+                _mm512_mask_storeu_ps(p, static_cast<__mmask16>((1u << n) - 1u), v);
+            }
+            static vector broadcast(const float x) noexcept { return _mm512_set1_ps(x); }
+            static vector add(const vector a, const vector b) noexcept { return _mm512_add_ps(a, b); }
+            static vector sub(const vector a, const vector b) noexcept { return _mm512_sub_ps(a, b); }
+            static vector mul(const vector a, const vector b) noexcept { return _mm512_mul_ps(a, b); }
+            static vector div(const vector a, const vector b) noexcept { return _mm512_div_ps(a, b); }
+            static vector fmadd(const vector a, const vector b, const vector c) noexcept { return _mm512_fmadd_ps(a, b, c); }
+            static vector max(const vector a, const vector b) noexcept { return _mm512_max_ps(a, b); }
+            static vector min(const vector a, const vector b) noexcept { return _mm512_min_ps(a, b); }
+            static vector sqrt(const vector x) noexcept { return _mm512_sqrt_ps(x); }
+            static vector round(const vector x) noexcept { return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static vector pow2n(const vector n) noexcept
+            {
+                return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23));
+            }
+            static vector zero_below(const vector x, const vector low, const vector v) noexcept
+            {
+                return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, low, _CMP_NLT_UQ), v);
+            }
+            static vector exp(const vector x) noexcept { return exp_polynomial<simd>(x); }
+            static float reduce_add(const vector v) noexcept { return _mm512_reduce_add_ps(v); }
+            static float reduce_max(const vector v) noexcept { return _mm512_reduce_max_ps(v); }
+        };
+#elif defined(__AVX2__) && defined(__FMA__)
+        template <>
+        struct simd<float>
+        {
+            using vector = __m256;
+            static constexpr std::size_t width = 8u;
+
+            static vector load(const float* const p) noexcept { return _mm256_loadu_ps(p); }
+            static void store(float* const p, const vector v) noexcept { _mm256_storeu_ps(p, v); }
+            static __m256i first_lanes(const std::size_t n) noexcept
+            {
+                return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            }
+            static vector load_partial(const float* const p, const std::size_t n, const float fill) noexcept
+            {
+                const __m256i mask = first_lanes(n);
+                return _mm256_blendv_ps(_mm256_set1_ps(fill), _mm256_maskload_ps(p, mask), _mm256_castsi256_ps(mask));
+            }
+            static void store_partial(float* const p, const std::size_t n, const vector v) noexcept
+            {
+                _mm256_maskstore_ps(p, first_lanes(n), v);
+            }
+            static vector broadcast(const float x) noexcept { return _mm256_set1_ps(x); }
+            static vector add(const vector a, const vector b) noexcept { return _mm256_add_ps(a, b); }
+            static vector sub(const vector a, const vector b) noexcept { return _mm256_sub_ps(a, b); }
+            static vector mul(const vector a, const vector b) noexcept { return _mm256_mul_ps(a, b); }
+            static vector div(const vector a, const vector b) noexcept { return _mm256_div_ps(a, b); }
+            static vector fmadd(const vector a, const vector b, const vector c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+            static vector max(const vector a, const vector b) noexcept { return _mm256_max_ps(a, b); }
+            static vector min(const vector a, const vector b) noexcept { return _mm256_min_ps(a, b); }
+            static vector sqrt(const vector x) noexcept { return _mm256_sqrt_ps(x); }
+            static vector round(const vector x) noexcept { return _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static vector pow2n(const vector n) noexcept
+            {
+                return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+            }
+            static vector zero_below(const vector x, const vector low, const vector v) noexcept
+            {
+                return _mm256_and_ps(_mm256_cmp_ps(x, low, _CMP_NLT_UQ), v);
+            }
+            static vector exp(const vector x) noexcept { return exp_polynomial<simd>(x); }
+            static float reduce_add(const vector v) noexcept
+            {
+                const __m128 pairs = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                const __m128 quads = _mm_add_ps(pairs, _mm_movehl_ps(pairs, pairs));
+                return _mm_cvtss_f32(_mm_add_ss(quads, _mm_shuffle_ps(quads, quads, 1)));
+            }
+            static float reduce_max(const vector v) noexcept
+            {
+                const __m128 pairs = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                const __m128 quads = _mm_max_ps(pairs, _mm_movehl_ps(pairs, pairs));
+                return _mm_cvtss_f32(_mm_max_ss(quads, _mm_shuffle_ps(quads, quads, 1)));
+            }
+        };
+#elif defined(__SSE2__)
+        template <>
+        struct simd<float>
+        {
+            using vector = __m128;
+            static constexpr std::size_t width = 4u;
+
+            static vector load(const float* const p) noexcept { return _mm_loadu_ps(p); }
+            static void store(float* const p, const vector v) noexcept { _mm_storeu_ps(p, v); }
+            static vector load_partial(const float* const p, const std::size_t n, const float fill) noexcept
+            {
+                return _mm_setr_ps(n > 0u ? p[0] : fill, n > 1u ? p[1] : fill, n > 2u ? p[2] : fill, n > 3u ? p[3] : fill);
+            }
+            static void store_partial(float* const p, const std::size_t n, const vector v) noexcept
+            {
+                alignas(16) float lanes[4];
+                _mm_store_ps(lanes, v);
+                std::copy(lanes, lanes + n, p);
+            }
+            static vector broadcast(const float x) noexcept { return _mm_set1_ps(x); }
+            static vector add(const vector a, const vector b) noexcept { return _mm_add_ps(a, b); }
+            static vector sub(const vector a, const vector b) noexcept { return _mm_sub_ps(a, b); }
+            static vector mul(const vector a, const vector b) noexcept { return _mm_mul_ps(a, b); }
+            static vector div(const vector a, const vector b) noexcept { return _mm_div_ps(a, b); }
+            static vector fmadd(const vector a, const vector b, const vector c) noexcept { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static vector max(const vector a, const vector b) noexcept { return _mm_max_ps(a, b); }
+            static vector min(const vector a, const vector b) noexcept { return _mm_min_ps(a, b); }
+            static vector sqrt(const vector x) noexcept { return _mm_sqrt_ps(x); }
+
+            // Conversion rounds to nearest in the default rounding mode
+            static vector round(const vector x) noexcept { return _mm_cvtepi32_ps(_mm_cvtps_epi32(x)); }
+            static vector pow2n(const vector n) noexcept
+            {
+                return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+            }
+            static vector zero_below(const vector x, const vector low, const vector v) noexcept
+            {
+                return _mm_and_ps(_mm_cmpnlt_ps(x, low), v);
+            }
+            static vector exp(const vector x) noexcept { return exp_polynomial<simd>(x); }
+            static float reduce_add(const vector v) noexcept
+            {
+                const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+                return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+            static float reduce_max(const vector v) noexcept
+            {
+                const __m128 pairs = _mm_max_ps(v, _mm_movehl_ps(v, v));
+                return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+        };
+#endif
+
+        // Calls step(Simd{}, i) for each whole vector of [first, last) and then
+        // step(scalar_simd{}, i) for each element left over
+        template <typename T, typename Step>
+        void simd_loop(const std::size_t first, const std::size_t last, const Step& step) noexcept
+        {
+            std::size_t i = first;
+            for (; i + simd<T>::width <= last; i += simd<T>::width)
+                step(simd<T>{}, i);
+            for (; i < last; ++i)
+                step(scalar_simd<T>{}, i);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef LAL_SOFTMAX_HPP
+#define LAL_SOFTMAX_HPP
+
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "simd.hpp"
+
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <cmath>
+
+// Softmax, log-softmax and log-sum-exp of each row (axis::rows) or each column
+// (axis::columns) of a matrix.  Every exponential is of x - max, so large logits
+// don't overflow and logits of -infinity (e.g. masked out moves) give a probability
+// of zero.  The maximum and the sum of exponentials are found together in one pass:
+// each block of elements raises the running maximum first and the sum so far is
+// rescaled to it, which costs one extra exponential per block (of four vectors, or
+// eight rows) rather than a second pass over the logits.
+//
+// For float the exponentials are vectorised (see simd.hpp), other types use std::exp
+// one element at a time.
+namespace lal
+{
+    enum class axis { rows, columns };
+
+    namespace detail
+    {
+        enum class softmax_output { logsumexp, softmax, log_softmax };
+
+        // Elements per block of a row, the running maximum is raised once per block
+        template <typename T>
+        inline constexpr std::size_t softmax_block_v = 4u * simd<T>::width;
+
+        // Rows of a column panel per block
+        inline constexpr std::size_t softmax_row_block = 8u;
+
+        // One row, returns its log-sum-exp.  Each lane keeps a maximum and sum of its
+        // own so a block never waits on a horizontal reduction, the lanes are combined
+        // at the end.  For softmax the first pass already stores each block's
+        // exponentials relative to the lane maxima at the time, so the second pass only
+        // has to rescale them.
+        template <softmax_output Output, typename T, std::size_t Columns>
+        T softmax_row(const T* const x, T* const out) noexcept
+        {
+            using S = simd<T>;
+            using vector = typename S::vector;
+            constexpr std::size_t block = softmax_block_v<T>;
+            constexpr std::size_t w = S::width;
+            constexpr std::size_t full = Columns / block;
+            constexpr std::size_t tail = Columns - full * block;
+            constexpr T infinity = std::numeric_limits<T>::infinity();
+
+            // Vector k of a block, the last block is padded with -infinity which adds
+            // nothing to the sum
+            const auto load = [](const T* const p, const std::size_t b, const std::size_t k) {
+                const std::size_t first = b * block + k * w;
+                if (first + w <= Columns)
+                    return S::load(p + first);
+
+                return first < Columns ? S::load_partial(p + first, Columns - first, -infinity) : S::broadcast(-infinity);
+            };
+
+            const auto store = [](T* const p, const std::size_t b, const std::size_t k, const vector v) {
+                const std::size_t first = b * block + k * w;
+                if (first + w <= Columns)
+                    S::store(p + first, v);
+                else if (first < Columns)
+                    S::store_partial(p + first, Columns - first, v);
+            };
+
+            constexpr std::size_t blocks = full + (tail != 0u ? 1u : 0u);
+            vector shifts[blocks];
+            vector largest = S::broadcast(std::numeric_limits<T>::lowest());
+            vector sums = S::broadcast(T{});
+            for (std::size_t b = 0u; b < blocks; ++b)
+            {
+                const vector v[4] = { load(x, b, 0u), load(x, b, 1u), load(x, b, 2u), load(x, b, 3u) };
+                const vector m = S::max(largest, S::max(S::max(v[0], v[1]), S::max(v[2], v[3])));
+                sums = S::mul(sums, S::exp(S::sub(largest, m)));
+                largest = m;
+                for (std::size_t k = 0u; k < 4u; ++k)
+                {
+                    const vector e = S::exp(S::sub(v[k], m));
+                    if constexpr (Output == softmax_output::softmax)
+                        store(out, b, k, e);
+
+                    sums = S::add(sums, e);
+                }
+
+                shifts[b] = m;
+            }
+
+            const T row_largest = S::reduce_max(largest);
+            const T sum = S::reduce_add(S::mul(sums, S::exp(S::sub(largest, S::broadcast(row_largest)))));
+            const T log_sum_exp = row_largest + std::log(sum);
+            if constexpr (Output == softmax_output::softmax)
+            {
+                const vector shift = S::broadcast(row_largest);
+                const vector inverse = S::broadcast(T{ 1 } / sum);
+                for (std::size_t b = 0u; b < blocks; ++b)
+                {
+                    const vector factor = S::mul(S::exp(S::sub(shifts[b], shift)), inverse);
+                    for (std::size_t k = 0u; k < 4u; ++k)
+                        store(out, b, k, S::mul(load(out, b, k), factor));
+                }
+            }
+            else if constexpr (Output == softmax_output::log_softmax)
+            {
+                const vector shift = S::broadcast(log_sum_exp);
+                for (std::size_t b = 0u; b < blocks; ++b)
+                    for (std::size_t k = 0u; k < 4u; ++k)
+                        store(out, b, k, S::sub(load(x, b, k), shift));
+            }
+
+            return log_sum_exp;
+        }
+
+        // Lanes vectors of adjacent columns, each column's maximum and sum are kept in
+        // a lane of its own.  For log-sum-exp out is where the results go, otherwise
+        // it's the top of the same columns in the output matrix.
+        template <softmax_output Output, typename S, std::size_t Lanes, typename T>
+        void softmax_column_panel(const T* const x, T* const out, const std::size_t rows, const std::size_t stride) noexcept
+        {
+            constexpr std::size_t w = S::width;
+            typename S::vector largest[Lanes];
+            typename S::vector sums[Lanes];
+            for (std::size_t lane = 0u; lane < Lanes; ++lane)
+            {
+                largest[lane] = S::broadcast(std::numeric_limits<T>::lowest());
+                sums[lane] = S::broadcast(T{});
+            }
+
+            for (std::size_t first = 0u; first < rows; first += softmax_row_block)
+            {
+                const std::size_t last = std::min(rows, first + softmax_row_block);
+                for (std::size_t lane = 0u; lane < Lanes; ++lane)
+                {
+                    auto m = largest[lane];
+                    for (std::size_t row = first; row < last; ++row)
+                        m = S::max(m, S::load(x + row * stride + lane * w));
+
+                    auto sum = S::mul(sums[lane], S::exp(S::sub(largest[lane], m)));
+                    for (std::size_t row = first; row < last; ++row)
+                        sum = S::add(sum, S::exp(S::sub(S::load(x + row * stride + lane * w), m)));
+
+                    largest[lane] = m;
+                    sums[lane] = sum;
+                }
+            }
+
+            alignas(64) T shifts[Lanes * w];
+            alignas(64) T scales[Lanes * w];
+            for (std::size_t lane = 0u; lane < Lanes; ++lane)
+            {
+                S::store(shifts + lane * w, largest[lane]);
+                S::store(scales + lane * w, sums[lane]);
+            }
+
+            for (std::size_t column = 0u; column < Lanes * w; ++column)
+            {
+                if constexpr (Output == softmax_output::softmax)
+                    scales[column] = T{ 1 } / scales[column];
+                else
+                    shifts[column] += std::log(scales[column]);
+            }
+
+            if constexpr (Output == softmax_output::logsumexp)
+            {
+                std::copy(shifts, shifts + Lanes * w, out);
+                return;
+            }
+
+            for (std::size_t lane = 0u; lane < Lanes; ++lane)
+            {
+                const auto shift = S::load(shifts + lane * w);
+                const auto scale = S::load(scales + lane * w);
+                for (std::size_t row = 0u; row < rows; ++row)
+                {
+                    const auto v = S::load(x + row * stride + lane * w);
+                    if constexpr (Output == softmax_output::softmax)
+                        S::store(out + row * stride + lane * w, S::mul(S::exp(S::sub(v, shift)), scale));
+                    else
+                        S::store(out + row * stride + lane * w, S::sub(v, shift));
+                }
+            }
+        }
+
+        // Panels of four vectors, then single vectors, then single columns
+        template <softmax_output Output, typename T, std::size_t Rows, std::size_t Columns>
+        void softmax_columns(const T* const x, T* const out) noexcept
+        {
+            using S = simd<T>;
+            constexpr std::size_t w = S::width;
+            std::size_t column = 0u;
+            for (; column + 4u * w <= Columns; column += 4u * w)
+                softmax_column_panel<Output, S, 4u>(x + column, out + column, Rows, Columns);
+            for (; column + w <= Columns; column += w)
+                softmax_column_panel<Output, S, 1u>(x + column, out + column, Rows, Columns);
+            for (; column < Columns; ++column)
+                softmax_column_panel<Output, scalar_simd<T>, 1u>(x + column, out + column, Rows, Columns);
+        }
+
+        template <softmax_output Output, axis Axis, typename T, std::size_t Rows, std::size_t Columns>
+        void softmax_matrix(const matrix<T, Rows, Columns>& m, matrix<T, Rows, Columns>& out) noexcept
+        {
+            static_assert(std::is_floating_point_v<T>, "softmax requires a floating point type");
+
+            LAL_OPERATION_BEGIN();
+            if constexpr (Axis == axis::rows)
+            {
+                for (std::size_t row = 0u; row < Rows; ++row)
+                    softmax_row<Output, T, Columns>(m[row], out[row]);
+            }
+            else
+            {
+                softmax_columns<Output, T, Rows, Columns>(m.data(), out.data());
+            }
+
+            LAL_OPERATION_END(softmax, T, Rows, Columns, 0u);
+        }
+    }
+
+    // out may be m
+    template <axis Axis = axis::rows, typename T, std::size_t Rows, std::size_t Columns>
+    void softmax(const matrix<T, Rows, Columns>& m, matrix<T, Rows, Columns>& out) noexcept
+    {
+        detail::softmax_matrix<detail::softmax_output::softmax, Axis>(m, out);
+    }
+
+    template <axis Axis = axis::rows, typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns> softmax(const matrix<T, Rows, Columns>& m) noexcept
+    {
+        matrix<T, Rows, Columns> ret;
+        softmax<Axis>(m, ret);
+        return ret;
+    }
+
+    // log(softmax(m)) without the rounding of taking the log of small probabilities,
+    // out may be m
+    template <axis Axis = axis::rows, typename T, std::size_t Rows, std::size_t Columns>
+    void log_softmax(const matrix<T, Rows, Columns>& m, matrix<T, Rows, Columns>& out) noexcept
+    {
+        detail::softmax_matrix<detail::softmax_output::log_softmax, Axis>(m, out);
+    }
+
+    template <axis Axis = axis::rows, typename T, std::size_t Rows, std::size_t Columns>
+    matrix<T, Rows, Columns> log_softmax(const matrix<T, Rows, Columns>& m) noexcept
+    {
+        matrix<T, Rows, Columns> ret;
+        log_softmax<Axis>(m, ret);
+        return ret;
+    }
+
+    // log(sum(exp(x))) of each row (a column vector) or each column (a row vector)
+    template <axis Axis = axis::rows, typename T, std::size_t Rows, std::size_t Columns>
+    auto logsumexp(const matrix<T, Rows, Columns>& m) noexcept
+    {
+        static_assert(std::is_floating_point_v<T>, "logsumexp requires a floating point type");
+
+        LAL_OPERATION_BEGIN();
+        if constexpr (Axis == axis::rows)
+        {
+            column_vector<T, Rows> ret;
+            for (std::size_t row = 0u; row < Rows; ++row)
+                ret[row][0] = detail::softmax_row<detail::softmax_output::logsumexp, T, Columns>(m[row], nullptr);
+
+            LAL_OPERATION_END(logsumexp, T, Rows, 1u, 0u);
+            return ret;
+        }
+        else
+        {
+            row_vector<T, Columns> ret;
+            detail::softmax_columns<detail::softmax_output::logsumexp, T, Rows, Columns>(m.data(), ret.data());
+            LAL_OPERATION_END(logsumexp, T, 1u, Columns, 0u);
+            return ret;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef LAL_STRASSEN_HPP
+#define LAL_STRASSEN_HPP
+
+#include "matrix_view.hpp"
+#include "matrix.hpp"
+#include "blas.hpp"
+
+#include <type_traits>
+#include <stdexcept>
+#include <cstddef>
+#include <memory>
+
+// Strassen-Winograd multiplication of large square matrices, seven half size
+// products and fifteen additions per level instead of eight products.  Each level
+// recurses until the operands are no larger than the cutoff (or have an odd
+// dimension) and then uses gemm.  The operation schedule of Boyer, Dumas, Pernet
+// and Zhou (2009) needs only two half size temporaries per level, so the workspace
+// for the whole recursion is under (2/3) N^2 elements and can be reused between
+// calls through a strassen_workspace.
+//
+// The result is less accurate than the classic product, the error grows by
+// roughly a constant factor per level of recursion.
+namespace lal
+{
+    namespace detail
+    {
+        // Tuned with BM_strassen against BM_gemm, gemm runs fastest on blocks which
+        // fit in cache and below this the extra additions cost more than they save
+        inline constexpr std::size_t strassen_cutoff = 64u;
+
+        // No level is generated below this so there's a bound on template instantiations
+        inline constexpr std::size_t strassen_minimum = 32u;
+
+        template <std::size_t N>
+        inline constexpr bool strassen_recurses_v = N % 2u == 0u && N >= 2u * strassen_minimum;
+
+        template <std::size_t N>
+        constexpr std::size_t strassen_workspace_size() noexcept
+        {
+            if constexpr (strassen_recurses_v<N>)
+                return 2u * (N / 2u) * (N / 2u) + strassen_workspace_size<N / 2u>();
+            else
+                return 0u;
+        }
+
+        template <typename T, std::size_t N>
+        void strassen_add(const matrix_view<T, N, N> out, const matrix_view<const T, N, N> a, const matrix_view<const T, N, N> b) noexcept
+        {
+            for (std::size_t row = 0u; row < N; ++row)
+            {
+                T* const o = out[row];
+                const T* const x = a[row];
+                const T* const y = b[row];
+                for (std::size_t column = 0u; column < N; ++column)
+                    o[column] = x[column] + y[column];
+            }
+        }
+
+        template <typename T, std::size_t N>
+        void strassen_subtract(const matrix_view<T, N, N> out, const matrix_view<const T, N, N> a, const matrix_view<const T, N, N> b) noexcept
+        {
+            for (std::size_t row = 0u; row < N; ++row)
+            {
+                T* const o = out[row];
+                const T* const x = a[row];
+                const T* const y = b[row];
+                for (std::size_t column = 0u; column < N; ++column)
+                    o[column] = x[column] - y[column];
+            }
+        }
+
+        template <typename T, std::size_t N>
+        matrix_view<const T, N, N> as_const(const matrix_view<T, N, N> v) noexcept
+        {
+            return v;
+        }
+
+        // C = A * B, C must not overlap A, B or the workspace
+        template <typename T, std::size_t N>
+        void strassen_product(const matrix_view<const T, N, N> a, const matrix_view<const T, N, N> b,
+                              const matrix_view<T, N, N> c, T* const workspace, const std::size_t cutoff) noexcept
+        {
+            if constexpr (!strassen_recurses_v<N>)
+            {
+                gemm(T{ 1 }, a, b, T{}, c);
+            }
+            else
+            {
+                if (N <= cutoff)
+                {
+                    gemm(T{ 1 }, a, b, T{}, c);
+                    return;
+                }
+
+                constexpr std::size_t H = N / 2u;
+                using const_quadrant = matrix_view<const T, H, H>;
+                using quadrant = matrix_view<T, H, H>;
+
+                const const_quadrant a11{ a[0], a.stride() }, a12{ a[0] + H, a.stride() };
+                const const_quadrant a21{ a[H], a.stride() }, a22{ a[H] + H, a.stride() };
+                const const_quadrant b11{ b[0], b.stride() }, b12{ b[0] + H, b.stride() };
+                const const_quadrant b21{ b[H], b.stride() }, b22{ b[H] + H, b.stride() };
+                const quadrant c11{ c[0], c.stride() }, c12{ c[0] + H, c.stride() };
+                const quadrant c21{ c[H], c.stride() }, c22{ c[H] + H, c.stride() };
+
+                const quadrant x{ workspace };
+                const quadrant y{ workspace + H * H };
+                T* const next = workspace + 2u * H * H;
+
+                strassen_subtract(x, a11, a21);                              // S3 = A11 - A21
+                strassen_subtract(y, b22, b12);                              // T3 = B22 - B12
+                strassen_product(as_const(x), as_const(y), c21, next, cutoff);  // P7 = S3 * T3
+                strassen_add(x, a21, a22);                                   // S1 = A21 + A22
+                strassen_subtract(y, b12, b11);                              // T1 = B12 - B11
+                strassen_product(as_const(x), as_const(y), c22, next, cutoff);  // P5 = S1 * T1
+                strassen_subtract(x, as_const(x), a11);                      // S2 = S1 - A11
+                strassen_subtract(y, b22, as_const(y));                      // T2 = B22 - T1
+                strassen_product(as_const(x), as_const(y), c12, next, cutoff);  // P6 = S2 * T2
+                strassen_subtract(x, a12, as_const(x));                      // S4 = A12 - S2
+                strassen_product(as_const(x), b22, c11, next, cutoff);       // P3 = S4 * B22
+                strassen_product(a11, b11, x, next, cutoff);                 // P1 = A11 * B11
+                strassen_add(c12, as_const(x), as_const(c12));               // U2 = P1 + P6
+                strassen_add(c21, as_const(c12), as_const(c21));             // U3 = U2 + P7
+                strassen_add(c12, as_const(c12), as_const(c22));             // U4 = U2 + P5
+                strassen_add(c22, as_const(c21), as_const(c22));             // C22 = U3 + P5
+                strassen_add(c12, as_const(c12), as_const(c11));             // C12 = U4 + P3
+                strassen_subtract(y, as_const(y), b21);                      // T4 = T2 - B21
+                strassen_product(a22, as_const(y), c11, next, cutoff);       // P4 = A22 * T4
+                strassen_subtract(c21, as_const(c21), as_const(c11));        // C21 = U3 - P4
+                strassen_product(a12, b21, c11, next, cutoff);               // P2 = A12 * B21
+                strassen_add(c11, as_const(x), as_const(c11));               // C11 = P1 + P2
+            }
+        }
+    }
+
+    // Scratch space for strassen_multiply at size N, reusable across calls (but not
+    // by concurrent calls)
+    template <typename T, std::size_t N>
+    class strassen_workspace
+    {
+    public:
+        strassen_workspace() : data_{ std::make_unique<T[]>(size()) } {}
+
+        static constexpr std::size_t size() noexcept { return detail::strassen_workspace_size<N>(); }
+
+        T* data() noexcept { return data_.get(); }
+
+    private:
+        std::unique_ptr<T[]> data_;
+    };
+
+    // C = A * B for square matrices or views, C must not alias A or B
+    template <typename MatrixA, typename MatrixB, typename MatrixC,
+              std::enable_if_t<is_viewable_v<MatrixA> && is_viewable_v<MatrixB> && is_viewable_v<MatrixC>, bool> = true>
+    void strassen_multiply(const MatrixA& a, const MatrixB& b, MatrixC&& c,
+                           strassen_workspace<detail::element_t<MatrixC>, view_t<std::remove_reference_t<MatrixC>>::row_count>& workspace,
+                           const std::size_t cutoff = detail::strassen_cutoff)
+    {
+        using T = detail::element_t<MatrixC>;
+        using view_a = view_t<const std::remove_reference_t<MatrixA>>;
+        using view_b = view_t<const std::remove_reference_t<MatrixB>>;
+        using view_c = view_t<std::remove_reference_t<MatrixC>>;
+        constexpr std::size_t N = view_c::row_count;
+        static_assert(view_c::column_count == N, "strassen_multiply requires square matrices");
+        static_assert(view_a::row_count == N && view_a::column_count == N && view_b::row_count == N && view_b::column_count == N,
+                      "strassen_multiply requires A, B and C to have the same dimensions");
+        static_assert(std::is_same_v<typename view_a::value_type, T> && std::is_same_v<typename view_b::value_type, T>,
+                      "strassen_multiply requires A, B and C to have the same element type");
+
+        const view_a va = make_view(a);
+        const view_b vb = make_view(b);
+        const view_c vc = make_view(c);
+        if (vc.data() == va.data() || vc.data() == vb.data())
+            throw std::invalid_argument("strassen_multiply requires C not to alias A or B");
+
+        detail::strassen_product<T, N>(va, vb, vc, workspace.data(), cutoff);
+    }
+
+    template <typename MatrixA, typename MatrixB, typename MatrixC,
+              std::enable_if_t<is_viewable_v<MatrixA> && is_viewable_v<MatrixB> && is_viewable_v<MatrixC>, bool> = true>
+    void strassen_multiply(const MatrixA& a, const MatrixB& b, MatrixC&& c, const std::size_t cutoff = detail::strassen_cutoff)
+    {
+        strassen_workspace<detail::element_t<MatrixC>, view_t<std::remove_reference_t<MatrixC>>::row_count> workspace;
+        strassen_multiply(a, b, std::forward<MatrixC>(c), workspace, cutoff);
+    }
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef LAL_SUMMATION_HPP
+#define LAL_SUMMATION_HPP
+
+#include <type_traits>
+#include <cstddef>
+
+// The summation kernels behind dot and the reductions.  Sums are pairwise by default,
+// blocks of 128 elements are summed in eight independent lanes (which the compiler
+// can keep in SIMD registers) and the block sums are combined as a binary tree, so
+// the error grows with log n rather than n.  summation::compensated uses Neumaier's
+// variant of Kahan summation instead, which is slower but whose error barely grows
+// with n and which survives cancellation between large terms.
+namespace lal
+{
+    enum class summation { pairwise, compensated };
+
+    namespace detail
+    {
+        inline constexpr std::size_t pairwise_block = 128u;
+        inline constexpr std::size_t summation_lanes = 8u;
+
+        // For floating point this is written as a maximum, which compiles to maxss/maxps
+        // where the comparison against zero is left as a branch
+        template <typename T>
+        constexpr T absolute(const T& x) noexcept(noexcept(x < T{}) && noexcept(-x))
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                return x < -x ? -x : x;
+            else
+                return x < T{} ? static_cast<T>(-x) : x;
+        }
+
+        // The length is a template parameter so that the recursion and the lanes are
+        // resolved at compile time, and short rows never instantiate the lane loop
+        template <typename Accumulator, std::size_t N, typename Term>
+        constexpr Accumulator pairwise_sum(const std::size_t first, const Term& term)
+        {
+            if constexpr (N > pairwise_block)
+            {
+                constexpr std::size_t half = N / 2u / summation_lanes * summation_lanes;
+                return pairwise_sum<Accumulator, half>(first, term) + pairwise_sum<Accumulator, N - half>(first + half, term);
+            }
+            else
+            {
+                constexpr std::size_t laned = N / summation_lanes * summation_lanes;
+                Accumulator rest{};
+                for (std::size_t i = laned; i < N; ++i)
+                    rest += term(first + i);
+
+                if constexpr (laned == 0u)
+                {
+                    return rest;
+                }
+                else
+                {
+                    Accumulator lanes[summation_lanes]{};
+                    for (std::size_t i = 0u; i < laned; i += summation_lanes)
+                        for (std::size_t lane = 0u; lane < summation_lanes; ++lane)
+                            lanes[lane] += term(first + i + lane);
+
+                    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])) + rest;
+                }
+            }
+        }
+
+        // Neumaier's summation, the compensation picks up the low order bits lost by
+        // whichever of the sum and the term is smaller
+        template <typename Accumulator, std::size_t N, typename Term>
+        constexpr Accumulator compensated_sum(const Term& term)
+        {
+            Accumulator sum{};
+            Accumulator compensation{};
+            for (std::size_t i = 0u; i < N; ++i)
+            {
+                const Accumulator x = term(i);
+                const Accumulator t = sum + x;
+                if (absolute(sum) >= absolute(x))
+                    compensation += (sum - t) + x;
+                else
+                    compensation += (x - t) + sum;
+
+                sum = t;
+            }
+
+            return sum + compensation;
+        }
+
+        template <summation Mode, typename Accumulator, std::size_t N, typename Term>
+        constexpr Accumulator reduce_sum(const Term& term)
+        {
+            if constexpr (Mode == summation::compensated && std::is_floating_point_v<Accumulator>)
+                return compensated_sum<Accumulator, N>(term);
+            else
+                return pairwise_sum<Accumulator, N>(0u, term);
+        }
+
+        // Sums term(row, column) over a matrix, each row is reduced on its own (indexing
+        // never crosses from one row into the next) and then the row sums are reduced
+        template <summation Mode, typename Accumulator, std::size_t Rows, std::size_t Columns, typename Term>
+        constexpr Accumulator reduce_matrix(const Term& term)
+        {
+            if constexpr (Rows == 1u)
+                return reduce_sum<Mode, Accumulator, Columns>([&term](const std::size_t column) { return term(0u, column); });
+            else if constexpr (Columns == 1u)
+                return reduce_sum<Mode, Accumulator, Rows>([&term](const std::size_t row) { return term(row, 0u); });
+            else
+                return reduce_sum<Mode, Accumulator, Rows>([&term](const std::size_t row) {
+                    return reduce_sum<Mode, Accumulator, Columns>([&term, row](const std::size_t column) { return term(row, column); });
+                });
+        }
+    }
+}
+
+#endif
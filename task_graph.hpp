@@ -0,0 +1,425 @@
+#ifndef LAL_TASK_GRAPH_HPP
+#define LAL_TASK_GRAPH_HPP
+
+#include "thread_pool.hpp"
+#include "parallel.hpp"
+#include "matrix.hpp"
+
+#include <type_traits>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <new>
+
+// A graph of matrix operations which runs independent operations at the same time,
+// e.g. for several layers evaluated on the same input and then merged
+//
+//   lal::task_graph graph;
+//   const auto x = graph.bind(input);
+//   const auto h1 = graph.temporary<float, 32, 256>();
+//   graph.add([](const auto& x, const auto& w, auto& h) { h = x * w; }, x.read(), w1.read(), h1.write());
+//   ...
+//   graph.run(lal::par);
+//
+// Each node calls its function with the matrices of its buffers, const for read()
+// and mutable for write() or update() (which reads as well).  Nodes depend on the
+// nodes added before them which access the same buffers, unless both only read, so
+// running the graph gives the same results as calling the functions in the order
+// they were added, which is what run() without a policy does.
+//
+// Buffers are either matrices of the caller's, bound to the graph, or temporaries
+// owned by the graph.  A temporary is zero initialised before its first node, which
+// has to write it, and its storage is shared with earlier temporaries whose nodes
+// all have to finish before that node starts anyway.
+//
+// In parallel each thread of the pool keeps its own queue of nodes which are ready
+// to run, taking the newest from its own and stealing the oldest from the others
+// when it runs out.  Idle threads yield while they wait for nodes to become ready.
+// If a node throws, nodes which haven't started are skipped and the first exception
+// is rethrown from run.
+namespace lal
+{
+    enum class graph_access_mode { read, write, update };
+
+    template <typename Matrix, graph_access_mode Mode>
+    struct graph_access
+    {
+        std::size_t buffer;
+    };
+
+    template <typename Matrix>
+    class graph_buffer
+    {
+    public:
+        using matrix_type = Matrix;
+
+        constexpr graph_access<Matrix, graph_access_mode::read> read() const noexcept { return { id_ }; }
+        constexpr graph_access<Matrix, graph_access_mode::write> write() const noexcept { return { id_ }; }
+        constexpr graph_access<Matrix, graph_access_mode::update> update() const noexcept { return { id_ }; }
+
+    private:
+        friend class task_graph;
+
+        constexpr explicit graph_buffer(const std::size_t id) noexcept : id_{ id } {}
+
+        std::size_t id_;
+    };
+
+    class task_graph
+    {
+    public:
+        task_graph() = default;
+        task_graph(const task_graph&) = delete;
+        task_graph& operator=(const task_graph&) = delete;
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        graph_buffer<matrix<T, Rows, Columns>> bind(matrix<T, Rows, Columns>& m)
+        {
+            buffers_.push_back(buffer{ &m });
+            return graph_buffer<matrix<T, Rows, Columns>>{ buffers_.size() - 1u };
+        }
+
+        // Only read by the graph
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        graph_buffer<const matrix<T, Rows, Columns>> bind(const matrix<T, Rows, Columns>& m)
+        {
+            buffers_.push_back(buffer{ const_cast<matrix<T, Rows, Columns>*>(&m) });
+            return graph_buffer<const matrix<T, Rows, Columns>>{ buffers_.size() - 1u };
+        }
+
+        template <typename T, std::size_t Rows, std::size_t Columns>
+        graph_buffer<matrix<T, Rows, Columns>> temporary()
+        {
+            using matrix_type = matrix<T, Rows, Columns>;
+            static_assert(std::is_trivially_destructible_v<matrix_type>, "Temporaries are never destroyed, their storage is reused");
+
+            buffer added{};
+            added.size = sizeof(matrix_type);
+            added.alignment = std::max(alignof(matrix_type), detail::arena_alignment);
+            added.construct = [](void* const p) { new (p) matrix_type{}; };
+            buffers_.push_back(added);
+            planned_ = false;
+            return graph_buffer<matrix_type>{ buffers_.size() - 1u };
+        }
+
+        // Adds function(matrices...), returns the node's index
+        template <typename Function, typename... Matrices, graph_access_mode... Modes>
+        std::size_t add(Function function, const graph_access<Matrices, Modes>... accesses)
+        {
+            static_assert(((Modes == graph_access_mode::read || !std::is_const_v<Matrices>) && ...), "Const matrices can only be read");
+
+            (validate(accesses.buffer, Modes), ...);
+            const std::size_t added = nodes_.size();
+            nodes_.emplace_back();
+            nodes_.back().function = [this, function = std::move(function), accesses...]() { function(resolve(accesses)...); };
+            (depend(added, accesses.buffer, Modes), ...);
+            planned_ = false;
+            return added;
+        }
+
+        std::size_t size() const noexcept { return nodes_.size(); }
+
+        // The storage shared by the temporaries
+        std::size_t temporary_bytes()
+        {
+            plan();
+            return temporary_bytes_;
+        }
+
+        // Every node on the calling thread, in the order they were added
+        void run()
+        {
+            plan();
+            for (std::size_t n = 0u; n < nodes_.size(); ++n)
+                execute(n);
+        }
+
+        void run(const parallel_policy& policy)
+        {
+            plan();
+            const std::size_t count = nodes_.size();
+            thread_pool& pool = policy.pool();
+            const std::size_t slots = std::min(pool.size(), std::max<std::size_t>(count, 1u));
+            const std::unique_ptr<std::atomic<std::size_t>[]> waiting{ new std::atomic<std::size_t>[count] };
+            const std::unique_ptr<ready_queue[]> queues{ new ready_queue[slots] };
+            std::size_t next = 0u;
+            for (std::size_t n = 0u; n < count; ++n)
+            {
+                waiting[n].store(nodes_[n].predecessors.size(), std::memory_order_relaxed);
+                if (nodes_[n].predecessors.empty())
+                    queues[next++ % slots].nodes.push_back(n);
+            }
+
+            std::atomic<std::size_t> finished{ 0u };
+            std::atomic<bool> failed{ false };
+            std::exception_ptr error{};
+            std::mutex error_mutex{};
+            pool.parallel_for(slots, [&](const std::size_t slot) {
+                ready_queue& own = queues[slot];
+                while (finished.load(std::memory_order_acquire) < count && !failed.load(std::memory_order_relaxed))
+                {
+                    std::size_t n = 0u;
+                    if (!own.pop_newest(n) && !steal(queues.get(), slots, slot, n))
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    try
+                    {
+                        execute(n);
+                    }
+                    catch (...)
+                    {
+                        const std::lock_guard<std::mutex> lock{ error_mutex };
+                        if (!error)
+                            error = std::current_exception();
+
+                        failed.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+
+                    for (const std::size_t successor : nodes_[n].successors)
+                        if (waiting[successor].fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+                            own.push(successor);
+
+                    finished.fetch_add(1u, std::memory_order_release);
+                }
+            });
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+    private:
+        static constexpr std::size_t none = static_cast<std::size_t>(-1);
+
+        struct buffer
+        {
+            void* address{ nullptr };
+            std::size_t size{ 0u };  // Zero for bound matrices
+            std::size_t alignment{ 1u };
+            void (*construct)(void*){ nullptr };
+            std::size_t last_writer{ none };
+            std::vector<std::size_t> readers{};  // Since the last writer
+        };
+
+        struct node
+        {
+            std::function<void()> function{};
+            std::vector<std::size_t> buffers{};
+            std::vector<std::size_t> predecessors{};
+            std::vector<std::size_t> successors{};
+            std::vector<std::size_t> constructs{};  // Temporaries first written here
+        };
+
+        struct ready_queue
+        {
+            void push(const std::size_t n)
+            {
+                const std::lock_guard<std::mutex> lock{ mutex };
+                nodes.push_back(n);
+            }
+
+            bool pop_newest(std::size_t& n)
+            {
+                const std::lock_guard<std::mutex> lock{ mutex };
+                if (nodes.empty())
+                    return false;
+
+                n = nodes.back();
+                nodes.pop_back();
+                return true;
+            }
+
+            bool pop_oldest(std::size_t& n)
+            {
+                const std::lock_guard<std::mutex> lock{ mutex };
+                if (nodes.empty())
+                    return false;
+
+                n = nodes.front();
+                nodes.pop_front();
+                return true;
+            }
+
+            std::mutex mutex{};
+            std::deque<std::size_t> nodes{};
+        };
+
+        static bool steal(ready_queue* const queues, const std::size_t slots, const std::size_t thief, std::size_t& n)
+        {
+            for (std::size_t i = 1u; i < slots; ++i)
+                if (queues[(thief + i) % slots].pop_oldest(n))
+                    return true;
+
+            return false;
+        }
+
+        template <typename Matrix, graph_access_mode Mode>
+        decltype(auto) resolve(const graph_access<Matrix, Mode> access) const noexcept
+        {
+            Matrix* const m = std::launder(static_cast<Matrix*>(buffers_[access.buffer].address));
+            if constexpr (Mode == graph_access_mode::read)
+                return static_cast<const Matrix&>(*m);
+            else
+                return static_cast<Matrix&>(*m);
+        }
+
+        void edge(const std::size_t from, const std::size_t to)
+        {
+            // Edges into a node are all added with it, so a repeat is the last one
+            std::vector<std::size_t>& successors = nodes_[from].successors;
+            if (from == to || (!successors.empty() && successors.back() == to))
+                return;
+
+            successors.push_back(to);
+            nodes_[to].predecessors.push_back(from);
+        }
+
+        void validate(const std::size_t b, const graph_access_mode mode) const
+        {
+            const buffer& accessed = buffers_[b];
+            if (accessed.size != 0u && accessed.last_writer == none && mode != graph_access_mode::write)
+                throw std::logic_error("A temporary has to be written before it's read");
+        }
+
+        void depend(const std::size_t n, const std::size_t b, const graph_access_mode mode)
+        {
+            buffer& accessed = buffers_[b];
+            nodes_[n].buffers.push_back(b);
+            if (accessed.last_writer != none)
+                edge(accessed.last_writer, n);
+
+            if (mode == graph_access_mode::read)
+            {
+                accessed.readers.push_back(n);
+            }
+            else
+            {
+                for (const std::size_t reader : accessed.readers)
+                    edge(reader, n);
+
+                accessed.readers.clear();
+                accessed.last_writer = n;
+            }
+        }
+
+        void execute(const std::size_t n)
+        {
+            for (const std::size_t t : nodes_[n].constructs)
+                buffers_[t].construct(buffers_[t].address);
+
+            nodes_[n].function();
+        }
+
+        // Places the temporaries, in the order of their first nodes, in the first block
+        // whose temporaries have every node they're used by among that node's ancestors
+        void plan()
+        {
+            if (planned_)
+                return;
+
+            const std::size_t count = nodes_.size();
+            const std::size_t words = (count + 63u) / 64u;
+            std::vector<std::uint64_t> ancestors(count * words);
+            for (std::size_t n = 0u; n < count; ++n)
+            {
+                std::uint64_t* const own = ancestors.data() + n * words;
+                for (const std::size_t p : nodes_[n].predecessors)
+                {
+                    const std::uint64_t* const inherited = ancestors.data() + p * words;
+                    for (std::size_t w = 0u; w < words; ++w)
+                        own[w] |= inherited[w];
+
+                    own[p / 64u] |= std::uint64_t{ 1 } << (p % 64u);
+                }
+            }
+
+            std::vector<std::vector<std::size_t>> users(buffers_.size());
+            for (std::size_t n = 0u; n < count; ++n)
+            {
+                nodes_[n].constructs.clear();
+                for (const std::size_t b : nodes_[n].buffers)
+                    if (users[b].empty() || users[b].back() != n)
+                        users[b].push_back(n);
+            }
+
+            struct block
+            {
+                std::size_t size{ 0u };
+                std::size_t alignment{ 1u };
+                std::size_t offset{ 0u };
+                std::vector<std::size_t> users{};
+                std::vector<std::size_t> temporaries{};
+            };
+
+            std::vector<block> blocks;
+            std::vector<bool> placed(buffers_.size(), false);
+            for (std::size_t n = 0u; n < count; ++n)
+            {
+                const std::uint64_t* const before = ancestors.data() + n * words;
+                for (const std::size_t b : nodes_[n].buffers)
+                {
+                    if (buffers_[b].size == 0u || placed[b])
+                        continue;
+
+                    const auto finished = [before](const std::size_t user) { return (before[user / 64u] >> (user % 64u)) & 1u; };
+                    auto reused = std::find_if(blocks.begin(), blocks.end(), [&finished](const block& candidate) {
+                        return std::all_of(candidate.users.begin(), candidate.users.end(), finished);
+                    });
+
+                    if (reused == blocks.end())
+                        reused = blocks.insert(blocks.end(), block{});
+
+                    reused->size = std::max(reused->size, buffers_[b].size);
+                    reused->alignment = std::max(reused->alignment, buffers_[b].alignment);
+                    reused->users.insert(reused->users.end(), users[b].begin(), users[b].end());
+                    reused->temporaries.push_back(b);
+                    nodes_[n].constructs.push_back(b);
+                    placed[b] = true;
+                }
+            }
+
+            std::size_t bytes = 0u;
+            std::size_t alignment = 1u;
+            for (block& b : blocks)
+            {
+                b.offset = (bytes + b.alignment - 1u) / b.alignment * b.alignment;
+                bytes = b.offset + b.size;
+                alignment = std::max(alignment, b.alignment);
+            }
+
+            storage_.reset(bytes != 0u ? new std::byte[bytes + alignment - 1u] : nullptr);
+            void* base = storage_.get();
+            std::size_t space = bytes + alignment - 1u;
+            if (bytes != 0u)
+                std::align(alignment, bytes, base, space);
+
+            for (const block& b : blocks)
+                for (const std::size_t t : b.temporaries)
+                    buffers_[t].address = static_cast<std::byte*>(base) + b.offset;
+
+            temporary_bytes_ = bytes;
+            planned_ = true;
+        }
+
+        std::vector<buffer> buffers_{};
+        std::vector<node> nodes_{};
+        std::unique_ptr<std::byte[]> storage_{};
+        std::size_t temporary_bytes_{ 0u };
+        bool planned_{ false };
+    };
+}
+
+#endif
@@ -1,17 +1,51 @@
 #define CATCH_CONFIG_MAIN
-#include "catch\\catch.hpp"
+#include "catch/catch.hpp"
 
+#include "serialization.hpp"
+#include "npy.hpp"
+#include "text_io.hpp"
+#include "matrix_view.hpp"
 #include "matrix.hpp"
-
+#include "blas.hpp"
+#include "half.hpp"
+#include "quantized.hpp"
+#include "reductions.hpp"
+#include "softmax.hpp"
+#include "parallel.hpp"
+#include "autodiff.hpp"
+#include "optimizer.hpp"
+#include "batch_evaluator.hpp"
+#include "task_graph.hpp"
+#include "kronecker.hpp"
+#include "nn.hpp"
+#include "strassen.hpp"
+#include "counters.hpp"
+#include "tracing.hpp"
+#include "copy_tracking.hpp"
+#if defined(__cpp_impl_coroutine)
+#include "async.hpp"
+#endif
+
+#include <system_error>
 #include <string_view>
+#include <filesystem>
+#include <execution>
+#include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <optional>
+#include <future>
+#include <memory>
 #include <numeric>
 #include <utility>
 #include <random>
 #include <chrono>
 #include <string>
+#include <thread>
+#include <atomic>
 #include <array>
+#include <tuple>
+#include <vector>
 
 // struct with defined move operations to test matrix move operators
 struct point
@@ -345,6 +379,55 @@ TEST_CASE("Reverse Iterators", "[reverse_iterators]")
     REQUIRE(*it1 == -1.0);
     const auto it2 = m2.rend() - 1;
     REQUIRE(*it2 == -6.0);
+
+    // Random access, and reverse iterators convert to const ones
+    using traits = std::iterator_traits<decltype(m1.rbegin())>;
+    static_assert(std::is_same_v<traits::iterator_category, std::random_access_iterator_tag>);
+    static_assert(std::is_same_v<std::iterator_traits<decltype(m2.rbegin())>::value_type, double>);
+    REQUIRE(m2.rend() - m2.rbegin() == 6);
+    REQUIRE(m2.rbegin() < m2.rend());
+    REQUIRE(m2.rend() >= m2.rbegin() + 6);
+    REQUIRE(2 + m2.rbegin() == m2.rbegin() + 2);
+    auto it3 = m1.rbegin();
+    it3 = m1.rbegin() + 23;
+    REQUIRE(*it3 == "0");
+    lal::matrix<std::string, 18, 24>::const_reverse_iterator it4 = it3;
+    REQUIRE(it4 == it3);
+    REQUIRE(m1.crend() - m1.rbegin() == 432);
+
+    lal::matrix<int, 3, 4> m3{};
+    std::iota(m3.begin(), m3.end(), 0);
+    std::sort(m3.rbegin(), m3.rend());
+    REQUIRE(m3.front() == 11);
+    REQUIRE(m3.back() == 0);
+    REQUIRE(std::lower_bound(m3.crbegin(), m3.crend(), 4) - m3.crbegin() == 4);
+}
+
+TEST_CASE("Parallel algorithms", "[parallel_algorithms]")
+{
+    // Integers held as doubles so every order of summation gives the exact result
+    auto m = std::make_unique<lal::square_matrix<double, 256>>();
+    std::iota(m->begin(), m->end(), 0.0);
+    double expected_sum = 0.0;
+    double expected_products = 0.0;
+    for (std::size_t i = 0u; i < m->size(); ++i)
+    {
+        expected_sum += static_cast<double>(i);
+        expected_products += static_cast<double>(i) * static_cast<double>(m->size() - 1u - i);
+    }
+
+    REQUIRE(std::reduce(std::execution::par_unseq, m->begin(), m->end()) == expected_sum);
+    REQUIRE(std::reduce(std::execution::par, m->crbegin(), m->crend()) == expected_sum);
+    REQUIRE(std::transform_reduce(std::execution::par_unseq, m->begin(), m->end(), m->rbegin(), 0.0) == expected_products);
+
+    auto out = std::make_unique<lal::square_matrix<double, 256>>();
+    std::transform(std::execution::par_unseq, m->rbegin(), m->rend(), out->begin(), [](const double x) { return 2.0 * x; });
+    REQUIRE(out->front() == 2.0 * 65535.0);
+    REQUIRE(out->back() == 0.0);
+
+    std::sort(std::execution::par, out->rbegin(), out->rend());
+    REQUIRE(std::is_sorted(out->crbegin(), out->crend()));
+    REQUIRE(*std::max_element(std::execution::par, out->begin(), out->end()) == out->front());
 }
 
 TEST_CASE("Algorithms", "[algorithms]")
@@ -568,6 +651,10 @@ TEST_CASE("Multiplication", "[multiplication]")
         for (std::size_t row = 0u; row < m1.rows(); ++row)
             for (std::size_t column = 0u; column < m1.columns(); ++column)
                 REQUIRE(m1[row][column] == answer[row][column]);
+
+        lal::matrix m3{ { 1, 2 }, { 3, 4 } };
+        m3 *= m3;
+        REQUIRE(m3 == lal::matrix{ { 7, 10 }, { 15, 22 } });
     }
 
     SECTION("Scalar multiplication assignment operator")
@@ -689,8 +776,8 @@ TEST_CASE("Division", "[division]")
 
         const lal::matrix m1{ { 4u, 4u }, { 5u, 5u }, { 6u, 6u }, { 7u, 7u } };
 
-        REQUIRE(noexcept(m1 / m1.rows()));
-        const auto m2 = m1 / m1.rows();
+        REQUIRE(noexcept(m1 / static_cast<unsigned>(m1.rows())));
+        const auto m2 = m1 / static_cast<unsigned>(m1.rows());
         for (const unsigned element : m2)
             REQUIRE(element == 1u);
     }
@@ -735,6 +822,56 @@ TEST_CASE("Equality", "[equality]")
     }
 }
 
+TEST_CASE("Operator signatures", "[signatures]")
+{
+    // Compound assignments must return a reference to their left hand side, anything
+    // else silently copies the whole matrix on every use
+    using m = lal::matrix<float, 3, 4>;
+    using square = lal::square_matrix<float, 4>;
+    static_assert(std::is_same_v<decltype(std::declval<m&>() += m{}), m&>);
+    static_assert(std::is_same_v<decltype(std::declval<m&>() -= m{}), m&>);
+    static_assert(std::is_same_v<decltype(std::declval<m&>() %= m{}), m&>);
+    static_assert(std::is_same_v<decltype(std::declval<m&>() *= square{}), m&>);
+    static_assert(std::is_same_v<decltype(std::declval<m&>() *= 2.0f), m&>);
+    static_assert(std::is_same_v<decltype(std::declval<m&>() /= 2.0f), m&>);
+
+    static_assert(std::is_same_v<decltype(m{} + m{}), m>);
+    static_assert(std::is_same_v<decltype(m{} - m{}), m>);
+    static_assert(std::is_same_v<decltype(m{} % m{}), m>);
+    static_assert(std::is_same_v<decltype(m{} * square{}), m>);
+    static_assert(std::is_same_v<decltype(m{} * lal::matrix<float, 4, 2>{}), lal::matrix<float, 3, 2>>);
+    static_assert(std::is_same_v<decltype(m{} * 2.0f), m>);
+    static_assert(std::is_same_v<decltype(2.0f * m{}), m>);
+    static_assert(std::is_same_v<decltype(m{} / 2.0f), m>);
+    static_assert(std::is_same_v<decltype(-m{}), m>);
+    static_assert(std::is_same_v<decltype(m{} == m{}), bool>);
+    static_assert(std::is_same_v<decltype(m{} != m{}), bool>);
+
+    static_assert(noexcept(std::declval<m&>() += m{}));
+    static_assert(noexcept(std::declval<m&>() -= m{}));
+    static_assert(noexcept(std::declval<m&>() %= m{}));
+    static_assert(noexcept(std::declval<m&>() *= square{}));
+    static_assert(noexcept(std::declval<m&>() *= 2.0f));
+    static_assert(noexcept(std::declval<m&>() /= 2.0f));
+    static_assert(noexcept(m{} + m{}));
+    static_assert(noexcept(m{} - m{}));
+    static_assert(noexcept(m{} % m{}));
+    static_assert(noexcept(m{} * square{}));
+    static_assert(noexcept(m{} * 2.0f));
+    static_assert(noexcept(m{} / 2.0f));
+    static_assert(noexcept(-m{}));
+    static_assert(noexcept(m{} == m{}));
+
+    m m1{};
+    const m m2{};
+    REQUIRE(&(m1 += m2) == &m1);
+    REQUIRE(&(m1 -= m2) == &m1);
+    REQUIRE(&(m1 %= m2) == &m1);
+    REQUIRE(&(m1 *= square{}) == &m1);
+    REQUIRE(&(m1 *= 2.0f) == &m1);
+    REQUIRE(&(m1 /= 2.0f) == &m1);
+}
+
 TEST_CASE("Diagonalisation", "[diagonalisation]")
 {
     REQUIRE(!noexcept(lal::make_diagonal(throws_when_default_constructed{})));
@@ -786,6 +923,155 @@ TEST_CASE("Magnitude", "[magnitude]")
     REQUIRE(lal::magnitude(m2) == std::sqrt(55.0));
 }
 
+TEST_CASE("Reductions", "[reductions]")
+{
+    SECTION("Constant evaluation")
+    {
+        constexpr lal::matrix<int, 2, 3> m{ { 3, -7, 2 }, { 9, -1, 9 } };
+        static_assert(lal::sum(m) == 15);
+        static_assert(lal::dot<lal::summation::compensated>(m, m) == 225);
+        static_assert(lal::norm1(m) == 31);
+        static_assert(lal::norm_inf(m) == 9);
+        static_assert(lal::argmin(m) == lal::matrix_index{ 0u, 1u });
+        static_assert(lal::argmax(m) == lal::matrix_index{ 1u, 0u });
+        static_assert(lal::min(m) == -7 && lal::max(m) == 9);
+    }
+
+    SECTION("Accuracy")
+    {
+        // 0.1 isn't representable so a sequential sum drifts, pairwise and compensated sums don't
+        auto m = std::make_unique<lal::row_vector<float, 100000>>();
+        for (float& element : *m)
+            element = 0.1f;
+
+        double exact = 0.0;
+        float sequential = 0.0f;
+        for (const float element : *m)
+        {
+            exact += element;
+            sequential += element;
+        }
+
+        REQUIRE(std::abs(sequential - exact) > 1.0);
+        REQUIRE(lal::sum(*m) == Approx(exact).epsilon(1e-6));
+        REQUIRE(lal::sum<lal::summation::compensated>(*m) == Approx(exact).epsilon(1e-6));
+        REQUIRE(lal::norm1(*m) == lal::sum(*m));
+        REQUIRE(lal::dot(*m, *m) == Approx(1000.0).epsilon(1e-6));
+
+        // Cancellation which only the compensated sum survives
+        const lal::row_vector<double, 4> cancelling{ { 1.0, 1e100, 1.0, -1e100 } };
+        REQUIRE(lal::sum<lal::summation::compensated>(cancelling) == 2.0);
+    }
+
+    SECTION("Scaled norm")
+    {
+        REQUIRE(lal::norm2(lal::row_vector<float, 2>{ { 3e30f, 4e30f } }) == Approx(5e30f));
+        REQUIRE(lal::norm2(lal::row_vector<float, 2>{ { 3e-30f, 4e-30f } }) == Approx(5e-30f));
+        REQUIRE(lal::norm2(lal::row_vector<float, 3>{ { 3e30f, 4e30f, 1.0f } }) == Approx(5e30f));
+        REQUIRE(lal::norm2(lal::row_vector<double, 2>{ { 3e-200, 4e-200 } }) == Approx(5e-200));
+        REQUIRE(lal::norm2(lal::row_vector<double, 2>{ { 1.0, 1e-170 } }) == 1.0);
+        REQUIRE(lal::norm2(lal::row_vector<float, 2>{}) == 0.0f);
+        REQUIRE(std::isnan(lal::norm2(lal::row_vector<float, 2>{ { 1e30f, std::numeric_limits<float>::quiet_NaN() } })));
+        REQUIRE(std::isinf(lal::norm2(lal::row_vector<float, 2>{ { 1.0f, std::numeric_limits<float>::infinity() } })));
+
+        // The fallback stays accurate over many terms
+        auto large = std::make_unique<lal::row_vector<float, 100003>>();
+        large->fill(1e30f);
+        REQUIRE(lal::norm2(*large) == Approx(1e30 * std::sqrt(100003.0)).epsilon(1e-6));
+
+        const lal::matrix m{ { 0.0, 1.0 }, { 2.0, 3.0 }, { 4.0, 5.0 } };
+        REQUIRE(lal::frobenius(m) == Approx(lal::magnitude(m)));
+        REQUIRE(lal::norm2(lal::matrix<int, 1, 2>{ { 3, 4 } }) == 5.0);
+    }
+}
+
+TEST_CASE("Softmax", "[softmax]")
+{
+    // 70 columns and 37 rows leave a tail after the full blocks and panels
+    std::mt19937 generator{ 5u };
+    std::uniform_real_distribution<double> distribution{ -20.0, 20.0 };
+    auto m = std::make_unique<lal::matrix<double, 37, 70>>();
+    auto f = std::make_unique<lal::matrix<float, 37, 70>>();
+    for (std::size_t i = 0u; i < m->size(); ++i)
+        f->data()[i] = static_cast<float>(m->data()[i] = distribution(generator));
+
+    // Raising the maximum late in a row (and column) makes the running sum rescale
+    (*m)[3][69] = 500.0;
+    (*f)[3][69] = 500.0f;
+    (*m)[36][5] = 600.0;
+    (*f)[36][5] = 600.0f;
+
+    const auto check = [&](const auto axis) {
+        constexpr lal::axis Axis = decltype(axis)::value;
+        constexpr bool rows = Axis == lal::axis::rows;
+        const auto at = [](const auto& x, const std::size_t i, const std::size_t j) { return rows ? x[i][j] : x[j][i]; };
+        constexpr std::size_t count = rows ? 37u : 70u;
+        constexpr std::size_t length = rows ? 70u : 37u;
+
+        const auto p = lal::softmax<Axis>(*m);
+        const auto log_p = lal::log_softmax<Axis>(*m);
+        const auto lse = lal::logsumexp<Axis>(*m);
+        const auto pf = lal::softmax<Axis>(*f);
+        const auto log_pf = lal::log_softmax<Axis>(*f);
+        const auto lsef = lal::logsumexp<Axis>(*f);
+        for (std::size_t i = 0u; i < count; ++i)
+        {
+            double largest = at(*m, i, 0u);
+            for (std::size_t j = 0u; j < length; ++j)
+                largest = std::max(largest, at(*m, i, j));
+
+            double sum = 0.0;
+            for (std::size_t j = 0u; j < length; ++j)
+                sum += std::exp(at(*m, i, j) - largest);
+
+            const double expected_lse = largest + std::log(sum);
+            REQUIRE(lse.data()[i] == Approx(expected_lse));
+            REQUIRE(lsef.data()[i] == Approx(expected_lse).epsilon(1e-6));
+            for (std::size_t j = 0u; j < length; ++j)
+            {
+                const double expected = std::exp(at(*m, i, j) - expected_lse);
+                REQUIRE(at(p, i, j) == Approx(expected).margin(1e-15));
+                REQUIRE(at(pf, i, j) == Approx(expected).epsilon(1e-5).margin(1e-12));
+                REQUIRE(at(log_p, i, j) == Approx(at(*m, i, j) - expected_lse));
+                REQUIRE(at(log_pf, i, j) == Approx(at(*m, i, j) - expected_lse).epsilon(1e-5).margin(1e-4));
+            }
+        }
+    };
+
+    SECTION("Rows")
+    {
+        check(std::integral_constant<lal::axis, lal::axis::rows>{});
+    }
+
+    SECTION("Columns")
+    {
+        check(std::integral_constant<lal::axis, lal::axis::columns>{});
+    }
+
+    SECTION("Extremes")
+    {
+        constexpr float infinity = std::numeric_limits<float>::infinity();
+        lal::matrix<float, 2, 20> x{};
+        x.fill(-infinity);
+        x[0][17] = 1e30f;
+        x[0][2] = 1e30f;
+        x[1][19] = -3.0f;
+
+        // In place, with masked out entries and logits far beyond exp's range
+        lal::softmax(x, x);
+        for (std::size_t column = 0u; column < 20u; ++column)
+        {
+            REQUIRE(x[0][column] == (column == 2u || column == 17u ? 0.5f : 0.0f));
+            REQUIRE(x[1][column] == (column == 19u ? 1.0f : 0.0f));
+        }
+
+        lal::matrix<float, 20, 1> all_masked{};
+        all_masked.fill(-infinity);
+        REQUIRE(lal::logsumexp<lal::axis::columns>(all_masked)[0][0] == -infinity);
+        REQUIRE(lal::logsumexp(lal::transpose(all_masked))[0][0] == -infinity);
+    }
+}
+
 TEST_CASE("Mapping", "[mapping]")
 {
     constexpr auto l = [](const int) -> int { throw std::exception{}; };
@@ -798,5 +1084,2139 @@ TEST_CASE("Mapping", "[mapping]")
     const auto m2 = lal::map(m1, f);
     REQUIRE(m2.rows() == m1.rows());
     REQUIRE(m2.columns() == m1.columns());
-    REQUIRE(m2 == lal::matrix{ { 4u, 7u }, { 5u, 4u } });
+    REQUIRE(m2 == lal::matrix<std::size_t, 2, 2>{ { 4u, 7u }, { 5u, 4u } });
+}
+
+TEST_CASE("Small kernels", "[small_kernels]")
+{
+    SECTION("Constant evaluation")
+    {
+        constexpr lal::matrix<int, 2, 3> a{ { 1, 2, 3 }, { 4, 5, 6 } };
+        constexpr lal::matrix<int, 3, 2> b{ { 7, 8 }, { 9, 10 }, { 11, 12 } };
+        static_assert(a * b == lal::matrix<int, 2, 2>{ { 58, 64 }, { 139, 154 } });
+        static_assert(lal::transpose(a) == lal::matrix<int, 3, 2>{ { 1, 4 }, { 2, 5 }, { 3, 6 } });
+        static_assert(a + a - a == a);
+        static_assert(lal::dot(a, a) == 91);
+    }
+
+    SECTION("Unrolled and looped products agree")
+    {
+        std::mt19937 generator{ 11u };
+        std::uniform_int_distribution<int> distribution{ -9, 9 };
+        const auto check = [&](auto lhs, auto rhs) {
+            for (auto& element : lhs)
+                element = distribution(generator);
+            for (auto& element : rhs)
+                element = distribution(generator);
+
+            decltype(lhs * rhs) expected{};
+            lal::detail::looped_product(expected, lhs, rhs);
+            REQUIRE(lhs * rhs == expected);
+
+            const auto t = lal::transpose(lhs);
+            for (std::size_t row = 0u; row < lhs.rows(); ++row)
+                for (std::size_t column = 0u; column < lhs.columns(); ++column)
+                    REQUIRE(t[column][row] == lhs[row][column]);
+        };
+
+        check(lal::matrix<int, 2, 2>{}, lal::matrix<int, 2, 2>{});
+        check(lal::matrix<int, 3, 5>{}, lal::matrix<int, 5, 4>{});
+        check(lal::matrix<int, 8, 8>{}, lal::matrix<int, 8, 8>{});
+        check(lal::matrix<int, 8, 9>{}, lal::matrix<int, 9, 2>{});
+    }
+
+    SECTION("Dot product")
+    {
+        const lal::column_vector<double, 3> u{ { 1.0 }, { 2.0 }, { 3.0 } };
+        const lal::column_vector<double, 3> v{ { 4.0 }, { -5.0 }, { 6.0 } };
+        REQUIRE(noexcept(lal::dot(u, v)));
+        REQUIRE(lal::dot(u, v) == 12.0);
+
+        lal::matrix<int, 16, 16> m{};
+        m.fill(2);
+        REQUIRE(lal::dot(m, m) == 1024);
+    }
+}
+
+TEST_CASE("Views", "[views]")
+{
+    lal::matrix<int, 4, 5> m;
+    std::iota(m.begin(), m.end(), 0);
+
+    SECTION("Whole matrix view")
+    {
+        const lal::matrix_view v{ m };
+        REQUIRE(noexcept(lal::matrix_view{ m }));
+        REQUIRE(v.rows() == m.rows());
+        REQUIRE(v.columns() == m.columns());
+        REQUIRE(v.contiguous());
+        REQUIRE(v.data() == m.data());
+        for (std::size_t row = 0u; row < v.rows(); ++row)
+            for (std::size_t column = 0u; column < v.columns(); ++column)
+                REQUIRE(&v[row][column] == &m[row][column]);
+
+        const lal::matrix_view<const int, 4, 5> cv = v;
+        REQUIRE(cv.back() == 19);
+        REQUIRE(lal::make_matrix(cv) == m);
+    }
+
+    SECTION("Submatrix view")
+    {
+        const auto v = lal::submatrix<2, 3>(m, 1, 2);
+        REQUIRE(v.rows() == 2u);
+        REQUIRE(v.columns() == 3u);
+        REQUIRE(v.stride() == m.columns());
+        REQUIRE(!v.contiguous());
+        REQUIRE(lal::make_matrix(v) == lal::matrix{ { 7, 8, 9 }, { 12, 13, 14 } });
+
+        v.fill(-1);
+        REQUIRE(m[1][1] == 6);
+        REQUIRE(m[1][2] == -1);
+        REQUIRE(m[2][4] == -1);
+        REQUIRE(m[3][2] == 17);
+
+        const auto& cm = m;
+        const auto cv = lal::submatrix<1, 1>(lal::submatrix<2, 3>(cm, 1, 2), 1, 1);
+        REQUIRE(std::is_same_v<decltype(cv)::element_type, const int>);
+        REQUIRE(cv.front() == -1);
+
+        try
+        {
+            lal::submatrix<2, 3>(m, 3, 0);
+            REQUIRE(false);
+        }
+        catch (const std::out_of_range& error)
+        {
+            REQUIRE(error.what() == std::string_view{ "Submatrix out of range" });
+        }
+    }
+}
+
+TEST_CASE("BLAS", "[blas]")
+{
+    const lal::matrix a{ { 2.0, 1.0, 4.0 }, { 0.0, 1.0, 1.0 } };
+    const lal::matrix b{ { 6.0, 3.0, -1.0, 0.0 }, { 1.0, 1.0, 0.0, 4.0 }, { -2.0, 5.0, 0.0, 2.0 } };
+    const lal::matrix product = a * b;
+
+    SECTION("axpy")
+    {
+        lal::matrix y{ { 1.0, 1.0, 1.0 }, { 1.0, 1.0, 1.0 } };
+        REQUIRE(noexcept(lal::axpy(2.0, a, y)));
+        lal::axpy(2.0, a, y);
+        REQUIRE(y == lal::matrix{ { 5.0, 3.0, 9.0 }, { 1.0, 3.0, 3.0 } });
+    }
+
+    SECTION("gemm")
+    {
+        lal::matrix<double, 2, 4> c;
+        c.fill(1.0);
+        REQUIRE(noexcept(lal::gemm(1.0, a, b, 0.0, c)));
+        lal::gemm(2.0, a, b, 3.0, c);
+        for (std::size_t row = 0u; row < c.rows(); ++row)
+            for (std::size_t column = 0u; column < c.columns(); ++column)
+                REQUIRE(c[row][column] == 2.0 * product[row][column] + 3.0);
+
+        // Zero beta overwrites rather than scales so NaNs are not propagated
+        c.fill(std::nan(""));
+        lal::gemm(1.0, a, b, 0.0, c);
+        REQUIRE(c == product);
+
+        const auto at = lal::transpose(a);
+        const auto bt = lal::transpose(b);
+        lal::gemm<lal::transposition::transpose>(1.0, at, b, 0.0, c);
+        REQUIRE(c == product);
+        lal::gemm<lal::transposition::none, lal::transposition::transpose>(1.0, a, bt, 0.0, c);
+        REQUIRE(c == product);
+        lal::gemm<lal::transposition::transpose, lal::transposition::transpose>(1.0, at, bt, 0.0, c);
+        REQUIRE(c == product);
+
+        // Accumulating into a block of a larger matrix
+        lal::matrix<double, 4, 6> big;
+        lal::gemm(1.0, a, b, 1.0, lal::submatrix<2, 4>(big, 1, 1));
+        for (std::size_t row = 0u; row < big.rows(); ++row)
+            for (std::size_t column = 0u; column < big.columns(); ++column)
+                if (row >= 1u && row < 3u && column >= 1u && column < 5u)
+                    REQUIRE(big[row][column] == product[row - 1u][column - 1u]);
+                else
+                    REQUIRE(big[row][column] == 0.0);
+    }
+
+    SECTION("gemv")
+    {
+        const lal::matrix<double, 3, 1> x{ { 1.0 }, { -1.0 }, { 2.0 } };
+        lal::matrix<double, 2, 1> y{ { 1.0 }, { 1.0 } };
+        REQUIRE(noexcept(lal::gemv(1.0, a, x, 1.0, y)));
+        lal::gemv(1.0, a, x, 1.0, y);
+        REQUIRE(y == a * x + lal::matrix<double, 2, 1>{ { 1.0 }, { 1.0 } });
+
+        lal::matrix<double, 1, 3> z{ { 1.0, 1.0, 1.0 } };
+        lal::gemv<lal::transposition::transpose>(-1.0, a, y, 0.0, z);
+        REQUIRE(z == -1.0 * transpose(transpose(a) * y));
+    }
+
+    SECTION("ger")
+    {
+        const lal::matrix<int, 2, 1> x{ { 1 }, { 2 } };
+        const lal::matrix<int, 1, 3> y{ { 3, 4, 5 } };
+        lal::matrix<int, 2, 3> m;
+        m.fill(1);
+        REQUIRE(noexcept(lal::ger(2, x, y, m)));
+        lal::ger(2, x, y, m);
+        REQUIRE(m == lal::matrix{ { 7, 9, 11 }, { 13, 17, 21 } });
+    }
+
+    SECTION("syrk")
+    {
+        lal::square_matrix<double, 2> c;
+        c.fill(-5.0);
+        REQUIRE(noexcept(lal::syrk(1.0, a, 0.0, c)));
+        lal::syrk(1.0, a, 0.0, c);
+        const auto aat = a * lal::transpose(a);
+        REQUIRE(c[0][0] == aat[0][0]);
+        REQUIRE(c[0][1] == aat[0][1]);
+        REQUIRE(c[1][1] == aat[1][1]);
+        REQUIRE(c[1][0] == -5.0);
+
+        lal::square_matrix<double, 3> d;
+        lal::syrk<lal::triangle::lower, lal::transposition::transpose>(2.0, a, 0.0, d);
+        const auto ata = lal::transpose(a) * a;
+        for (std::size_t row = 0u; row < d.rows(); ++row)
+            for (std::size_t column = 0u; column < d.columns(); ++column)
+                REQUIRE(d[row][column] == (column <= row ? 2.0 * ata[row][column] : 0.0));
+    }
+}
+
+#ifdef LAL_USE_CBLAS
+namespace
+{
+    // Small integers keep every product exact, so CBLAS and the built-in kernels must agree bit for bit
+    template <typename T, std::size_t Rows, std::size_t Columns>
+    constexpr void fill_pattern(lal::matrix<T, Rows, Columns>& m, const int seed)
+    {
+        for (std::size_t row = 0u; row < Rows; ++row)
+            for (std::size_t column = 0u; column < Columns; ++column)
+                m[row][column] = static_cast<T>(static_cast<int>((row * 7u + column * 3u) % 11u) + seed - 5);
+    }
+
+    template <typename T, std::size_t I, std::size_t J, std::size_t K>
+    lal::matrix<T, I, K> reference_product(const lal::matrix<T, I, J>& lhs, const lal::matrix<T, J, K>& rhs)
+    {
+        lal::matrix<T, I, K> ret{};
+        lal::detail::looped_product(ret, lhs, rhs);
+        return ret;
+    }
+
+    template <typename T, std::size_t I, std::size_t J, std::size_t K>
+    void check_cblas_gemm()
+    {
+        auto a = std::make_unique<lal::matrix<T, I, J>>();
+        auto b = std::make_unique<lal::matrix<T, J, K>>();
+        fill_pattern(*a, 1);
+        fill_pattern(*b, 2);
+        const auto expected = std::make_unique<lal::matrix<T, I, K>>(reference_product(*a, *b));
+
+        REQUIRE(*a * *b == *expected);
+
+        auto c = std::make_unique<lal::matrix<T, I, K>>();
+        c->fill(T{ 1 });
+        lal::gemm(T{ 2 }, *a, *b, T{ 3 }, *c);
+        for (std::size_t row = 0u; row < I; ++row)
+            for (std::size_t column = 0u; column < K; ++column)
+                REQUIRE((*c)[row][column] == T{ 2 } * (*expected)[row][column] + T{ 3 });
+
+        const auto at = std::make_unique<lal::matrix<T, J, I>>(lal::transpose(*a));
+        const auto bt = std::make_unique<lal::matrix<T, K, J>>(lal::transpose(*b));
+        lal::gemm<lal::transposition::transpose, lal::transposition::transpose>(T{ 1 }, *at, *bt, T{}, *c);
+        REQUIRE(*c == *expected);
+    }
+
+    template <typename T, std::size_t M, std::size_t N>
+    void check_cblas_gemv()
+    {
+        auto a = std::make_unique<lal::matrix<T, M, N>>();
+        fill_pattern(*a, 0);
+        lal::matrix<T, N, 1> x{};
+        fill_pattern(x, 3);
+        lal::matrix<T, M, 1> y{};
+        y.fill(T{ 1 });
+        const lal::matrix<T, M, 1> expected = reference_product(*a, x);
+
+        lal::gemv(T{ -1 }, *a, x, T{ 2 }, y);
+        for (std::size_t row = 0u; row < M; ++row)
+            REQUIRE(y[row][0] == T{ 2 } - expected[row][0]);
+
+        lal::matrix<T, 1, N> z{};
+        lal::gemv<lal::transposition::transpose>(T{ 1 }, *a, lal::transpose(expected), T{}, z);
+        REQUIRE(z == lal::transpose(reference_product(lal::transpose(*a), expected)));
+    }
+
+    // Sized to reach a threshold of 512 multiply-adds, as lal_cblas_tests sets.  Views
+    // only step between rows at run time, so the gemm and gemv operands are single rows
+    template <typename T>
+    constexpr bool constant_products_agree()
+    {
+        lal::square_matrix<T, 8> a{};
+        lal::square_matrix<T, 8> b{};
+        fill_pattern(a, 1);
+        fill_pattern(b, 2);
+        lal::square_matrix<T, 8> expected{};
+        lal::detail::looped_product(expected, a, b);
+        if (!(a * b == expected))
+            return false;
+
+        lal::matrix<T, 1, 1> scale{ { T{ 3 } } };
+        lal::row_vector<T, 512> u{};
+        lal::row_vector<T, 512> v{};
+        fill_pattern(u, 0);
+        lal::gemm(T{ 1 }, scale, u, T{}, v);
+        for (std::size_t i = 0u; i < 512u; ++i)
+            if (v[0][i] != T{ 3 } * u[0][i])
+                return false;
+
+        lal::matrix<T, 1, 1> y{};
+        lal::gemv(T{ 1 }, u, v, T{}, y);
+        T sum{};
+        for (std::size_t i = 0u; i < 512u; ++i)
+            sum += u[0][i] * v[0][i];
+
+        return y[0][0] == sum;
+    }
+}
+
+TEST_CASE("CBLAS", "[blas][cblas]")
+{
+    SECTION("Routing")
+    {
+        constexpr std::size_t threshold = LAL_CBLAS_THRESHOLD;
+        static_assert(lal::detail::use_cblas_v<double, 64, 64, 64> == (64u * 64u * 64u >= threshold));
+        static_assert(lal::detail::use_cblas_v<float, 512, 512, 1> == (512u * 512u >= threshold));
+        static_assert(!lal::detail::use_cblas_v<double, 2, 4, 3>);
+        static_assert(!lal::detail::use_cblas_v<int, 64, 64, 64>);
+    }
+
+    SECTION("Products below and above the threshold")
+    {
+        check_cblas_gemm<double, 2, 3, 4>();
+        check_cblas_gemm<float, 2, 3, 4>();
+        check_cblas_gemm<double, 64, 64, 64>();
+        check_cblas_gemm<float, 64, 48, 96>();
+    }
+
+    SECTION("Matrix-vector products below and above the threshold")
+    {
+        check_cblas_gemv<double, 4, 3>();
+        check_cblas_gemv<float, 4, 3>();
+        check_cblas_gemv<double, 512, 512>();
+        check_cblas_gemv<float, 512, 520>();
+    }
+
+    SECTION("Constant evaluation")
+    {
+        // Only the built-in kernels can run here, whatever the threshold
+        static_assert(constant_products_agree<float>());
+        static_assert(constant_products_agree<double>());
+    }
+}
+#endif
+
+TEST_CASE("Reduced precision", "[half]")
+{
+    SECTION("Conversions")
+    {
+        static_assert(lal::bfloat16{ 1.0f }.bits() == 0x3F80u);
+        static_assert(lal::half{ 1.0f }.bits() == 0x3C00u);
+        static_assert(float{ lal::half::from_bits(0x7BFFu) } == 65504.0f);
+        static_assert(float{ lal::half::from_bits(0x0001u) } == 0x1p-24f);
+        static_assert(float{ -lal::bfloat16{ 2.0f } } == -2.0f);
+
+        // Ties round to even
+        REQUIRE(lal::bfloat16{ 1.0f + 0x1p-8f }.bits() == 0x3F80u);
+        REQUIRE(lal::bfloat16{ 1.0f + 0x3p-8f }.bits() == 0x3F82u);
+        REQUIRE(lal::half{ 1.0f + 0x1p-11f }.bits() == 0x3C00u);
+        REQUIRE(lal::half{ 1.0f + 0x3p-11f }.bits() == 0x3C02u);
+
+        REQUIRE(lal::half{ 65519.0f }.bits() == 0x7BFFu);
+        REQUIRE(lal::half{ 65520.0f }.bits() == 0x7C00u);
+        REQUIRE(lal::half{ 0x1p-25f }.bits() == 0x0000u);
+        REQUIRE(lal::half{ 0x3p-26f }.bits() == 0x0001u);
+        REQUIRE(lal::half{ 0x1p-14f }.bits() == 0x0400u);
+        REQUIRE(std::isnan(float{ lal::half{ std::numeric_limits<float>::quiet_NaN() } }));
+        REQUIRE(std::isnan(float{ lal::bfloat16{ std::numeric_limits<float>::quiet_NaN() } }));
+
+        // Every finite half survives a round trip through float
+        for (std::uint32_t bits = 0u; bits < 0x7C00u; ++bits)
+        {
+            const auto h = lal::half::from_bits(static_cast<std::uint16_t>(bits));
+            REQUIRE(lal::half{ float{ h } }.bits() == bits);
+        }
+    }
+
+    SECTION("Products accumulate in float")
+    {
+        // Adding 1/256 to 1 is lost in bfloat16, 256 of them are not
+        lal::row_vector<lal::bfloat16, 257> x{};
+        lal::column_vector<lal::bfloat16, 257> y{};
+        x[0][0] = lal::bfloat16{ 1.0f };
+        y[0][0] = lal::bfloat16{ 1.0f };
+        for (std::size_t i = 1u; i < 257u; ++i)
+        {
+            x[0][i] = lal::bfloat16{ 0x1p-8f };
+            y[i][0] = lal::bfloat16{ 1.0f };
+        }
+
+        REQUIRE((x * y)[0][0] == 2.0f);
+        REQUIRE(lal::dot(x, lal::transpose(y)) == 2.0f);
+
+        lal::matrix<float, 1, 1> c{};
+        lal::gemm(1.0f, x, y, 0.0f, c);
+        REQUIRE(c[0][0] == 2.0f);
+
+        lal::matrix<lal::bfloat16, 1, 1> c16{};
+        lal::gemm(lal::bfloat16{ 1.0f }, x, y, lal::bfloat16{}, c16);
+        REQUIRE(c16[0][0] == 2.0f);
+
+        lal::column_vector<float, 1> z{};
+        lal::gemv(1.0f, x, y, 0.0f, z);
+        REQUIRE(z[0][0] == 2.0f);
+        lal::gemv<lal::transposition::transpose>(1.0f, y, lal::column_vector<lal::bfloat16, 257>{ lal::transpose(x) }, 0.0f, z);
+        REQUIRE(z[0][0] == 2.0f);
+    }
+
+    SECTION("Agrees with float")
+    {
+        std::mt19937 generator{ 5u };
+        std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+        auto a = std::make_unique<lal::matrix<float, 40, 70>>();
+        auto b = std::make_unique<lal::matrix<float, 70, 30>>();
+        for (auto& element : *a)
+            element = distribution(generator);
+        for (auto& element : *b)
+            element = distribution(generator);
+
+        const auto check = [&](auto storage) {
+            using T = decltype(storage);
+            auto a16 = std::make_unique<lal::matrix<T, 40, 70>>();
+            auto b16 = std::make_unique<lal::matrix<T, 70, 30>>();
+            auto bt16 = std::make_unique<lal::matrix<T, 30, 70>>();
+            lal::convert(*a, *a16);
+            lal::convert(*b, *b16);
+            lal::convert(lal::transpose(*b), *bt16);
+
+            // The reference is the float product of the rounded values
+            auto a32 = std::make_unique<lal::matrix<float, 40, 70>>();
+            auto b32 = std::make_unique<lal::matrix<float, 70, 30>>();
+            lal::convert(*a16, *a32);
+            lal::convert(*b16, *b32);
+            const auto expected = *a32 * *b32;
+
+            lal::matrix<float, 40, 30> c{};
+            lal::gemm(1.0f, *a16, *b16, 0.0f, c);
+            lal::matrix<float, 40, 30> ct{};
+            lal::gemm<lal::transposition::none, lal::transposition::transpose>(1.0f, *a16, *bt16, 0.0f, ct);
+            const auto c16 = *a16 * *b16;
+            for (std::size_t row = 0u; row < 40u; ++row)
+            {
+                for (std::size_t column = 0u; column < 30u; ++column)
+                {
+                    REQUIRE(c[row][column] == Approx(expected[row][column]).margin(1e-4));
+                    REQUIRE(ct[row][column] == Approx(expected[row][column]).margin(1e-4));
+                    REQUIRE(float{ c16[row][column] } == Approx(expected[row][column]).epsilon(1e-2).margin(1e-2));
+                }
+            }
+        };
+
+        check(lal::bfloat16{});
+        check(lal::half{});
+    }
+}
+
+TEST_CASE("Quantization", "[quantization]")
+{
+    std::mt19937 generator{ 3u };
+    std::uniform_real_distribution<float> distribution{ -2.0f, 3.0f };
+    auto a = std::make_unique<lal::matrix<float, 12, 100>>();
+    auto b = std::make_unique<lal::matrix<float, 9, 100>>();
+    for (auto& element : *a)
+        element = distribution(generator);
+    for (auto& element : *b)
+        element = distribution(generator);
+    for (float& element : (*a)[3])
+        element = 0.0f;
+
+    SECTION("Round trip")
+    {
+        const auto check = [&](const auto& q) {
+            REQUIRE(q.scale(3) == 1.0f);
+            const auto m = lal::dequantize(q);
+            for (std::size_t row = 0u; row < 12u; ++row)
+            {
+                REQUIRE(q.zero_point(row) >= -127);
+                REQUIRE(q.zero_point(row) <= 127);
+                for (std::size_t column = 0u; column < 100u; ++column)
+                {
+                    REQUIRE(q.values()[row][column] != -128);
+                    REQUIRE(std::abs(m[row][column] - (*a)[row][column]) <= 0.5f * q.scale(row) + 1e-6f);
+                }
+            }
+        };
+
+        check(lal::quantize(*a));
+        check(lal::quantize<lal::quantization::asymmetric>(*a));
+
+        // Zero is exact and the asymmetric scheme uses the whole range for positive data
+        const lal::matrix<float, 1, 3> m{ { 0.0f, 1.0f, 2.0f } };
+        const auto q = lal::quantize<lal::quantization::asymmetric>(m);
+        REQUIRE(lal::dequantize(q)[0][0] == 0.0f);
+        REQUIRE(q.values()[0][0] == -127);
+        REQUIRE(q.values()[0][2] == 127);
+    }
+
+    SECTION("Products")
+    {
+        // The integer kernel against a plain loop, including lengths which aren't a multiple of the SIMD width
+        std::int8_t x[150];
+        std::int8_t y[150];
+        std::uniform_int_distribution<int> values{ -127, 127 };
+        for (std::size_t i = 0u; i < 150u; ++i)
+        {
+            x[i] = static_cast<std::int8_t>(values(generator));
+            y[i] = static_cast<std::int8_t>(values(generator));
+        }
+
+        for (const std::size_t n : { 0u, 1u, 31u, 32u, 64u, 100u, 150u })
+        {
+            std::int32_t expected = 0;
+            for (std::size_t i = 0u; i < n; ++i)
+                expected += x[i] * y[i];
+
+            REQUIRE(lal::detail::int8_dot(x, y, n) == expected);
+        }
+
+        const auto check = [&](const auto& qa, const auto& qb) {
+            const auto da = lal::dequantize(qa);
+            const auto db = lal::dequantize(qb);
+            const auto expected = da * lal::transpose(db);
+
+            lal::matrix<float, 12, 9> c{};
+            lal::qgemm(qa, qb, c);
+            for (std::size_t row = 0u; row < 12u; ++row)
+                for (std::size_t column = 0u; column < 9u; ++column)
+                    REQUIRE(c[row][column] == Approx(expected[row][column]).margin(1e-3));
+        };
+
+        const auto symmetric_a = lal::quantize(*a);
+        const auto symmetric_b = lal::quantize(*b);
+        const auto asymmetric_a = lal::quantize<lal::quantization::asymmetric>(*a);
+        const auto asymmetric_b = lal::quantize<lal::quantization::asymmetric>(*b);
+        check(symmetric_a, symmetric_b);
+        check(symmetric_a, asymmetric_b);
+        check(asymmetric_a, symmetric_b);
+        check(asymmetric_a, asymmetric_b);
+
+        lal::matrix<std::int32_t, 12, 9> raw{};
+        lal::qgemm(symmetric_a, symmetric_b, raw);
+        REQUIRE(raw[0][0] == lal::detail::int8_dot(symmetric_a.values()[0], symmetric_b.values()[0], 100u));
+    }
+}
+
+TEST_CASE("Parallel", "[parallel]")
+{
+    lal::thread_pool single{ 1u };
+    lal::thread_pool pool{ 4u };
+    REQUIRE(single.size() == 1u);
+    REQUIRE(pool.size() == 4u);
+
+    SECTION("Thread pool")
+    {
+        std::vector<std::atomic<int>> visits(1000u);
+        pool.parallel_for(visits.size(), [&](const std::size_t i) { ++visits[i]; });
+        REQUIRE(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& v) { return v == 1; }));
+
+        // Nested calls run on the calling thread
+        std::atomic<int> nested{ 0 };
+        pool.parallel_for(8u, [&](std::size_t) { pool.parallel_for(8u, [&](std::size_t) { ++nested; }); });
+        REQUIRE(nested == 64);
+
+        REQUIRE_THROWS_AS(pool.parallel_for(100u, [](const std::size_t i) {
+            if (i == 42u)
+                throw std::runtime_error("index 42");
+        }), std::runtime_error);
+
+        std::atomic<int> after{ 0 };
+        pool.parallel_for(100u, [&](std::size_t) { ++after; });
+        REQUIRE(after == 100);
+
+        // Posted functions still queued run before the pool goes, a pool of one runs
+        // them straight away
+        std::atomic<int> posted{ 0 };
+        {
+            lal::thread_pool transient{ 2u };
+            for (int i = 0; i < 100; ++i)
+                transient.post([&posted]() { ++posted; });
+        }
+
+        REQUIRE(posted == 100);
+        single.post([&posted]() { ++posted; });
+        REQUIRE(posted == 101);
+    }
+
+    // Several chunks, the last of them partial
+    std::mt19937 generator{ 5u };
+    std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+    auto a = std::make_unique<lal::row_vector<float, 100003>>();
+    auto b = std::make_unique<lal::row_vector<float, 100003>>();
+    for (auto& element : *a)
+        element = distribution(generator);
+    for (auto& element : *b)
+        element = distribution(generator);
+
+    SECTION("Elementwise")
+    {
+        auto expected = std::make_unique<lal::row_vector<float, 100003>>(*a);
+        auto actual = std::make_unique<lal::row_vector<float, 100003>>(*a);
+        *expected += *b;
+        *expected %= *b;
+        *expected *= 2.0f;
+        lal::add_assign(lal::par.on(pool), *actual, *b);
+        lal::hadamard_assign(lal::par.on(pool), *actual, *b);
+        lal::multiply_assign(lal::par.on(pool), *actual, 2.0f);
+        REQUIRE(*actual == *expected);
+
+        const auto twice = [](const float x) { return 2.0f * x; };
+        auto mapped = std::make_unique<lal::row_vector<float, 100003>>();
+        lal::map(lal::par.on(pool), *a, twice, *mapped);
+        REQUIRE(*mapped == lal::map(*a, twice));
+
+        const lal::matrix<int, 2, 2> small{ { 1, 2 }, { 3, 4 } };
+        REQUIRE(lal::add(lal::par, small, small) == small * 2);
+    }
+
+    SECTION("Reductions")
+    {
+        // Identical whatever the number of threads and close to the sequential result
+        const auto one = lal::par.on(single);
+        const auto four = lal::par.on(pool);
+        REQUIRE(lal::sum(one, *a) == lal::sum(four, *a));
+        REQUIRE(lal::sum<lal::summation::compensated>(one, *a) == lal::sum<lal::summation::compensated>(four, *a));
+        REQUIRE(lal::dot(one, *a, *b) == lal::dot(four, *a, *b));
+        REQUIRE(lal::norm2(one, *a) == lal::norm2(four, *a));
+        REQUIRE(lal::magnitude(one, *a) == lal::magnitude(four, *a));
+
+        REQUIRE(lal::sum(four, *a) == Approx(lal::sum<lal::summation::compensated>(*a)).epsilon(1e-5));
+        REQUIRE(lal::dot(four, *a, *b) == Approx(lal::dot(*a, *b)).epsilon(1e-5));
+        REQUIRE(lal::norm1(four, *a) == Approx(lal::norm1(*a)).epsilon(1e-5));
+        REQUIRE(lal::norm2(four, *a) == Approx(lal::norm2(*a)).epsilon(1e-5));
+        REQUIRE(lal::frobenius(four, *a) == lal::norm2(four, *a));
+        REQUIRE(lal::magnitude(four, *a) == Approx(lal::magnitude(*a)).epsilon(1e-5));
+        REQUIRE(lal::norm_inf(four, *a) == lal::norm_inf(*a));
+
+        // Within a single chunk both sum the squares in the same pairwise order
+        lal::row_vector<float, 1000> head;
+        std::copy(a->begin(), a->begin() + 1000, head.begin());
+        REQUIRE(lal::magnitude(four, head) == lal::magnitude(head));
+
+        // Scaling still applies
+        auto large = std::make_unique<lal::row_vector<float, 100003>>();
+        large->fill(1e30f);
+        REQUIRE(lal::norm2(four, *large) == Approx(1e30 * std::sqrt(100003.0)).epsilon(1e-5));
+    }
+}
+
+TEST_CASE("Autodiff", "[autodiff]")
+{
+    namespace ad = lal::autodiff;
+
+    std::mt19937 generator{ 7u };
+    std::uniform_real_distribution<double> distribution{ -1.0, 1.0 };
+    lal::matrix<double, 3, 4> a{};
+    lal::matrix<double, 4, 2> b{};
+    lal::matrix<double, 3, 2> c{};
+    lal::column_vector<double, 2> d{};
+    for (auto& element : d)
+        element = distribution(generator);
+    for (auto& element : a)
+        element = distribution(generator);
+    for (auto& element : b)
+        element = distribution(generator);
+    for (auto& element : c)
+        element = distribution(generator);
+
+    // Every operation once, with a, b and c used more than once and d taking the
+    // column vector paths
+    const auto record = [&](ad::tape& t) {
+        const auto va = t.variable(a);
+        const auto vb = t.variable(b);
+        const auto vc = t.variable(c);
+        const auto vd = t.variable(d);
+        const auto product = map(va * vb, ad::activation::tanh{});
+        const auto mixed = (product % vc - vc) + transpose(map(transpose(vc), ad::activation::sigmoid{}));
+        const auto hidden = map(affine(transpose(vb), transpose(va), transpose(mixed)), ad::activation::relu{});
+        const auto vector = map(affine(va, vb * vd, va * vb * vd), ad::activation::tanh{});
+        return std::make_tuple(va, vb, vc, sum(hidden) + dot(mixed, product) + sum(vector), vd);
+    };
+
+    SECTION("Gradients")
+    {
+        ad::tape t;
+        const auto [va, vb, vc, loss, vd] = record(t);
+        t.backward(loss);
+
+        // Against central differences
+        const auto check = [&](auto& m, const auto& gradient) {
+            constexpr double h = 1e-6;
+            for (std::size_t row = 0u; row < m.rows(); ++row)
+            {
+                for (std::size_t column = 0u; column < m.columns(); ++column)
+                {
+                    const double original = m[row][column];
+                    ad::tape scratch;
+                    m[row][column] = original + h;
+                    const double up = std::get<3>(record(scratch)).value()[0][0];
+                    scratch.clear();
+                    m[row][column] = original - h;
+                    const double down = std::get<3>(record(scratch)).value()[0][0];
+                    m[row][column] = original;
+                    REQUIRE(gradient[row][column] == Approx((up - down) / (2.0 * h)).margin(1e-6));
+                }
+            }
+        };
+
+        check(a, va.gradient());
+        check(b, vb.gradient());
+        check(c, vc.gradient());
+        check(d, vd.gradient());
+    }
+
+    SECTION("Tape")
+    {
+        ad::tape t;
+        const auto x = t.constant(a);
+        const auto y = t.variable(b);
+        REQUIRE(!x.requires_gradient());
+        REQUIRE_THROWS_AS(x.gradient(), std::logic_error);
+        REQUIRE((x * y).requires_gradient());
+        REQUIRE_THROWS_AS(t.backward(sum(x)), std::logic_error);
+
+        ad::tape other;
+        REQUIRE_THROWS_AS(x * other.variable(b), std::invalid_argument);
+        REQUIRE_THROWS_AS(other.backward(sum(y)), std::invalid_argument);
+
+        // Reusing the arena gives the same gradients
+        t.clear();
+        REQUIRE(t.used() == 0u);
+        const auto first = record(t);
+        t.backward(std::get<3>(first));
+        const auto expected = std::get<0>(first).gradient();
+        const std::size_t used = t.used();
+        t.clear();
+        const auto second = record(t);
+        t.backward(std::get<3>(second));
+        REQUIRE(t.used() == used);
+        REQUIRE(std::get<0>(second).gradient() == expected);
+
+        ad::tape tiny{ 64u };
+        REQUIRE_THROWS_AS(record(tiny), std::length_error);
+    }
+}
+
+TEST_CASE("Neural network layers", "[nn]")
+{
+    namespace nn = lal::nn;
+    using input = nn::shape<2, 6, 5>;
+    using conv = nn::conv2d<double, input, 3, 3>;
+    using pool = nn::max_pool2d<double, conv::output_shape, 2>;
+    using dense = nn::dense<double, pool::output_shape::size, 4>;
+    constexpr std::size_t batch = 3u;
+
+    std::mt19937 generator{ 11u };
+    std::uniform_real_distribution<double> distribution{ -1.0, 1.0 };
+    const auto randomise = [&](auto& m) {
+        for (auto& element : m)
+            element = distribution(generator);
+    };
+
+    auto c = std::make_unique<conv>();
+    pool p;
+    auto d = std::make_unique<dense>();
+    nn::batch<double, batch, input> x{};
+    lal::matrix<double, batch, 4> targets{};
+    randomise(c->weights());
+    randomise(c->bias());
+    randomise(d->weights());
+    randomise(d->bias());
+    randomise(x);
+    for (std::size_t sample = 0u; sample < batch; ++sample)
+        targets[sample][sample] = 1.0;
+
+    SECTION("Convolution")
+    {
+        // Direct loops, with the 6x5 output leaving the last Winograd tiles overhanging
+        nn::batch<double, batch, conv::output_shape> expected{};
+        for (std::size_t sample = 0u; sample < batch; ++sample)
+        {
+            for (std::size_t filter = 0u; filter < 3u; ++filter)
+            {
+                for (std::size_t oy = 0u; oy < 6u; ++oy)
+                {
+                    for (std::size_t ox = 0u; ox < 5u; ++ox)
+                    {
+                        double sum = c->bias()[filter][0];
+                        for (std::size_t channel = 0u; channel < 2u; ++channel)
+                            for (std::size_t ki = 0u; ki < 3u; ++ki)
+                                for (std::size_t kj = 0u; kj < 3u; ++kj)
+                                    if (oy + ki >= 1u && oy + ki <= 6u && ox + kj >= 1u && ox + kj <= 5u)
+                                        sum += c->weights()[filter][(channel * 3u + ki) * 3u + kj] *
+                                               x[sample][(channel * 6u + oy + ki - 1u) * 5u + ox + kj - 1u];
+
+                        expected[sample][(filter * 6u + oy) * 5u + ox] = sum;
+                    }
+                }
+            }
+        }
+
+        nn::batch<double, batch, conv::output_shape> im2col{};
+        nn::batch<double, batch, conv::output_shape> winograd{};
+        c->forward(x, im2col);
+        c->forward<nn::convolution::winograd>(x, winograd);
+        for (std::size_t i = 0u; i < expected.size(); ++i)
+        {
+            REQUIRE(im2col.data()[i] == Approx(expected.data()[i]).margin(1e-12));
+            REQUIRE(winograd.data()[i] == Approx(expected.data()[i]).margin(1e-12));
+        }
+    }
+
+    SECTION("Pooling")
+    {
+        const lal::matrix<double, 1, 8> m{ { 1.0, 4.0, -2.0, 0.0, 3.0, 2.0, 5.0, 5.0 } };
+        lal::matrix<double, 1, 2> y{};
+        lal::matrix<double, 1, 8> dx{};
+        const lal::matrix<double, 1, 2> dy{ { 1.0, 2.0 } };
+
+        nn::max_pool2d<double, nn::shape<1, 2, 4>, 2> max;
+        max.forward(m, y);
+        REQUIRE(y == lal::matrix<double, 1, 2>{ { 4.0, 5.0 } });
+        max.backward(m, dy, dx);
+        REQUIRE(dx == lal::matrix<double, 1, 8>{ { 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 2.0, 0.0 } });
+
+        nn::avg_pool2d<double, nn::shape<1, 2, 4>, 2> avg;
+        avg.forward(m, y);
+        REQUIRE(y == lal::matrix<double, 1, 2>{ { 2.5, 2.0 } });
+        avg.backward(m, dy, dx);
+        REQUIRE(dx == lal::matrix<double, 1, 8>{ { 0.25, 0.25, 0.5, 0.5, 0.25, 0.25, 0.5, 0.5 } });
+    }
+
+    SECTION("Softmax")
+    {
+        const lal::matrix<double, 2, 3> logits{ { 1.0, 2.0, 3.0 }, { 1000.0, 1000.0, -1000.0 } };
+        lal::matrix<double, 2, 3> probabilities{};
+        nn::softmax(logits, probabilities);
+        REQUIRE(probabilities[0][2] == Approx(std::exp(3.0) / (std::exp(1.0) + std::exp(2.0) + std::exp(3.0))));
+        REQUIRE(probabilities[1][0] == Approx(0.5));
+        REQUIRE(probabilities[1][2] == 0.0);
+
+        const lal::matrix<double, 2, 3> one_hot{ { 0.0, 0.0, 1.0 }, { 0.0, 0.0, 1.0 } };
+        REQUIRE(std::isfinite(nn::cross_entropy(probabilities, one_hot)));
+    }
+
+    SECTION("Gradients")
+    {
+        auto y = std::make_unique<nn::batch<double, batch, conv::output_shape>>();
+        auto a = std::make_unique<nn::batch<double, batch, conv::output_shape>>();
+        nn::batch<double, batch, pool::output_shape> pooled{};
+        lal::matrix<double, batch, 4> logits{};
+        lal::matrix<double, batch, 4> probabilities{};
+        const auto loss = [&]() {
+            c->forward(x, *y);
+            nn::relu(*y, *a);
+            p.forward(*a, pooled);
+            d->forward(pooled, logits);
+            nn::softmax(logits, probabilities);
+            return nn::cross_entropy(probabilities, targets);
+        };
+
+        loss();
+        lal::matrix<double, batch, 4> dlogits{};
+        nn::batch<double, batch, pool::output_shape> dpooled{};
+        auto da = std::make_unique<nn::batch<double, batch, conv::output_shape>>();
+        auto dy = std::make_unique<nn::batch<double, batch, conv::output_shape>>();
+        nn::batch<double, batch, input> dx{};
+        nn::softmax_cross_entropy_backward(probabilities, targets, dlogits);
+        d->backward(pooled, dlogits, dpooled);
+        p.backward(*a, dpooled, *da);
+        nn::relu_backward(*y, *da, *dy);
+        c->backward(x, *dy, dx);
+
+        // Against central differences
+        const auto check = [&](auto& m, const auto& gradient) {
+            constexpr double h = 1e-6;
+            for (std::size_t row = 0u; row < m.rows(); ++row)
+            {
+                for (std::size_t column = 0u; column < m.columns(); ++column)
+                {
+                    const double original = m[row][column];
+                    m[row][column] = original + h;
+                    const double up = loss();
+                    m[row][column] = original - h;
+                    const double down = loss();
+                    m[row][column] = original;
+                    REQUIRE(gradient[row][column] == Approx((up - down) / (2.0 * h)).margin(1e-6));
+                }
+            }
+        };
+
+        check(d->weights(), d->weight_gradient());
+        check(d->bias(), d->bias_gradient());
+        check(c->weights(), c->weight_gradient());
+        check(c->bias(), c->bias_gradient());
+        check(x, dx);
+
+        // Gradients accumulate until they're zeroed
+        const double first = c->weight_gradient()[0][0];
+        c->backward(x, *dy);
+        REQUIRE(c->weight_gradient()[0][0] == Approx(2.0 * first));
+        c->zero_gradients();
+        d->zero_gradients();
+        REQUIRE(c->weight_gradient()[0][0] == 0.0);
+        REQUIRE(d->bias_gradient()[0][3] == 0.0);
+    }
+}
+
+TEST_CASE("Optimizers", "[optimizers]")
+{
+    // 37 elements leave a tail after the whole vectors
+    std::mt19937 generator{ 3u };
+    std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+    lal::matrix<float, 1, 37> weights{};
+    std::array<lal::matrix<float, 1, 37>, 3> gradients{};
+    for (auto& element : weights)
+        element = distribution(generator);
+    for (auto& gradient : gradients)
+        for (auto& element : gradient)
+            element = distribution(generator);
+
+    // The update rules written out in double, one element at a time
+    const auto check = [&](const auto& update, const auto& reference, const lal::gradient_clipping<float> clipping) {
+        auto w = weights;
+        lal::matrix<float, 1, 37> a{};
+        lal::matrix<float, 1, 37> b{};
+        std::array<double, 37> expected{};
+        std::array<double, 37> ea{};
+        std::array<double, 37> eb{};
+        for (std::size_t i = 0u; i < 37u; ++i)
+            expected[i] = weights[0][i];
+
+        for (std::size_t step = 1u; step <= gradients.size(); ++step)
+        {
+            update(w, gradients[step - 1u], a, b, clipping);
+            for (std::size_t i = 0u; i < 37u; ++i)
+            {
+                const double g = std::clamp(double{ gradients[step - 1u][0][i] } * clipping.scale, -double{ clipping.max_value },
+                                            double{ clipping.max_value });
+                reference(static_cast<double>(step), g, expected[i], ea[i], eb[i]);
+            }
+        }
+
+        for (std::size_t i = 0u; i < 37u; ++i)
+            REQUIRE(w[0][i] == Approx(expected[i]).epsilon(1e-5));
+    };
+
+    const lal::sgd_momentum<float> sgd{ 0.1f, 0.9f };
+    const auto sgd_update = [&](auto& w, const auto& g, auto& velocity, auto&, const auto clipping) { sgd.update(w, g, velocity, clipping); };
+    const auto sgd_reference = [](double, const double g, double& w, double& velocity, double&) {
+        velocity = 0.9 * velocity + g;
+        w -= 0.1 * velocity;
+    };
+
+    lal::adam<float> adam{ 0.01f };
+    const auto adam_update = [&](auto& w, const auto& g, auto& m, auto& v, const auto clipping) {
+        adam.next_step();
+        adam.update(w, g, m, v, clipping);
+    };
+    const auto adam_reference = [](const double t, const double g, double& w, double& m, double& v) {
+        m = 0.9 * m + 0.1 * g;
+        v = 0.999 * v + 0.001 * g * g;
+        w -= 0.01 * (m / (1.0 - std::pow(0.9, t))) / (std::sqrt(v / (1.0 - std::pow(0.999, t))) + 1e-8);
+    };
+
+    const lal::rmsprop<float> rmsprop{ 0.01f, 0.9f };
+    const auto rmsprop_update = [&](auto& w, const auto& g, auto& mean_square, auto&, const auto clipping) {
+        rmsprop.update(w, g, mean_square, clipping);
+    };
+    const auto rmsprop_reference = [](double, const double g, double& w, double& mean_square, double&) {
+        mean_square = 0.9 * mean_square + 0.1 * g * g;
+        w -= 0.01 * g / (std::sqrt(mean_square) + 1e-8);
+    };
+
+    SECTION("Updates")
+    {
+        check(sgd_update, sgd_reference, {});
+        check(adam_update, adam_reference, {});
+        check(rmsprop_update, rmsprop_reference, {});
+    }
+
+    SECTION("Clipping")
+    {
+        const lal::gradient_clipping<float> by_value{ 1.0f, 0.25f };
+        check(sgd_update, sgd_reference, by_value);
+        check(adam_update, adam_reference, by_value);
+        check(rmsprop_update, rmsprop_reference, by_value);
+
+        const lal::matrix<float, 1, 2> g1{ { 3.0f, 0.0f } };
+        const lal::matrix<float, 2, 1> g2{ { 0.0f }, { 4.0f } };
+        REQUIRE(lal::clip_by_norm(10.0f, g1, g2).scale == 1.0f);
+        REQUIRE(lal::clip_by_norm(1.0f, g1, g2).scale == Approx(0.2f));
+
+        const auto by_norm = lal::clip_by_norm(0.5f, gradients[0], gradients[1], gradients[2]);
+        REQUIRE(by_norm.scale < 1.0f);
+        adam.step = 0u;
+        check(adam_update, adam_reference, by_norm);
+    }
+
+    SECTION("Parallel")
+    {
+        constexpr std::size_t N = 100003u;
+        auto w = std::make_unique<lal::row_vector<float, N>>();
+        auto g = std::make_unique<lal::row_vector<float, N>>();
+        for (auto& element : *w)
+            element = distribution(generator);
+        for (auto& element : *g)
+            element = distribution(generator);
+
+        auto m = std::make_unique<lal::row_vector<float, N>>();
+        auto v = std::make_unique<lal::row_vector<float, N>>();
+        auto parallel_w = std::make_unique<lal::row_vector<float, N>>(*w);
+        auto parallel_m = std::make_unique<lal::row_vector<float, N>>();
+        auto parallel_v = std::make_unique<lal::row_vector<float, N>>();
+
+        lal::thread_pool pool{ 4u };
+        adam.next_step();
+        adam.update(*w, *g, *m, *v);
+        adam.update(lal::par.on(pool), *parallel_w, *g, *parallel_m, *parallel_v);
+        REQUIRE(*parallel_w == *w);
+        REQUIRE(*parallel_m == *m);
+        REQUIRE(*parallel_v == *v);
+    }
+}
+
+TEST_CASE("Batch evaluator", "[batch_evaluator]")
+{
+    // Small whole numbers, so products come out exact whichever way they're summed
+    std::mt19937 generator{ 7u };
+    std::uniform_int_distribution<int> distribution{ -4, 4 };
+    lal::matrix<float, 3, 5> weights{};
+    for (auto& element : weights)
+        element = static_cast<float>(distribution(generator));
+
+    using evaluator_type = lal::batch_evaluator<float, 5, 3, 4>;
+    const auto model = [&weights](const evaluator_type::input_batch& x, evaluator_type::output_batch& y) { y = weights * x; };
+    const auto input = [&distribution](std::mt19937& g) {
+        lal::column_vector<float, 5> x{};
+        for (auto& element : x)
+            element = static_cast<float>(distribution(g));
+        return x;
+    };
+
+    SECTION("Full and partial batches")
+    {
+        // A deadline which never arrives, batches only run when full or flushed
+        evaluator_type evaluator{ model, std::chrono::hours{ 1 } };
+        std::vector<lal::column_vector<float, 5>> inputs;
+        std::vector<std::future<lal::column_vector<float, 3>>> results;
+        for (std::size_t i = 0u; i < 6u; ++i)
+        {
+            inputs.push_back(input(generator));
+            results.push_back(evaluator.submit(inputs.back()));
+        }
+
+        for (std::size_t i = 0u; i < 4u; ++i)
+            REQUIRE(results[i].get() == weights * inputs[i]);
+
+        REQUIRE(evaluator.batches() == 1u);
+        REQUIRE(results[4].wait_for(std::chrono::milliseconds{ 20 }) == std::future_status::timeout);
+        evaluator.flush();
+        REQUIRE(results[4].get() == weights * inputs[4]);
+        REQUIRE(results[5].get() == weights * inputs[5]);
+        REQUIRE(evaluator.batches() == 2u);
+    }
+
+    SECTION("Deadline")
+    {
+        // A lone request runs once it has waited, in a batch padded with zeros
+        float padding = -1.0f;
+        const auto padded = [&](const evaluator_type::input_batch& x, evaluator_type::output_batch& y) {
+            padding = 0.0f;
+            for (std::size_t row = 0u; row < 5u; ++row)
+                padding += std::abs(x[row][1]) + std::abs(x[row][2]) + std::abs(x[row][3]);
+
+            model(x, y);
+        };
+
+        evaluator_type evaluator{ padded, std::chrono::milliseconds{ 1 } };
+        const auto x = input(generator);
+        REQUIRE(evaluator.evaluate(x) == weights * x);
+        REQUIRE(padding == 0.0f);
+    }
+
+    SECTION("Many callers")
+    {
+        evaluator_type evaluator{ model };
+        std::atomic<int> wrong{ 0 };
+        std::vector<std::thread> callers;
+        for (unsigned int caller = 0u; caller < 4u; ++caller)
+        {
+            callers.emplace_back([&, caller]() {
+                std::mt19937 g{ caller };
+                for (int i = 0; i < 50; ++i)
+                {
+                    const auto x = input(g);
+                    if (evaluator.evaluate(x) != weights * x)
+                        ++wrong;
+                }
+            });
+        }
+
+        for (std::thread& caller : callers)
+            caller.join();
+
+        REQUIRE(wrong == 0);
+        REQUIRE(evaluator.batches() <= 200u);
+    }
+
+    SECTION("Model exceptions and shutdown")
+    {
+        evaluator_type failing{ [](const evaluator_type::input_batch&, evaluator_type::output_batch&) {
+            throw std::runtime_error("model");
+        } };
+        REQUIRE_THROWS_AS(failing.evaluate(input(generator)), std::runtime_error);
+
+        // Waiting requests are evaluated before the evaluator goes
+        std::future<lal::column_vector<float, 3>> result;
+        const auto x = input(generator);
+        {
+            evaluator_type evaluator{ model, std::chrono::hours{ 1 } };
+            result = evaluator.submit(x);
+        }
+
+        REQUIRE(result.get() == weights * x);
+    }
+}
+
+#if defined(__cpp_impl_coroutine)
+TEST_CASE("Async", "[async]")
+{
+    lal::thread_pool single{ 1u };
+    lal::thread_pool pool{ 4u };
+    const lal::matrix<int, 2, 2> a{ { 1, 2 }, { 3, 4 } };
+    const lal::matrix<int, 2, 2> b{ { 5, 6 }, { 7, 8 } };
+
+    SECTION("Operations")
+    {
+        const auto cube = [](const lal::matrix<int, 2, 2>& m, lal::thread_pool& on) -> lal::async::task<lal::matrix<int, 2, 2>> {
+            const auto square = co_await lal::async::multiply(m, m, {}, on);
+            co_return co_await lal::async::multiply(square, m, {}, on);
+        };
+
+        for (lal::thread_pool* const on : { &single, &pool })
+        {
+            REQUIRE(lal::async::sync_wait(lal::async::multiply(a, b, {}, *on)) == a * b);
+            REQUIRE(lal::async::sync_wait(cube(a, *on)) == a * a * a);
+        }
+
+        // Operations run on a worker, or on the awaiting thread with a pool of one
+        const auto thread = []() { return std::this_thread::get_id(); };
+        REQUIRE(lal::async::sync_wait(lal::async::run(thread, {}, pool)) != std::this_thread::get_id());
+        REQUIRE(lal::async::sync_wait(lal::async::run(thread, {}, single)) == std::this_thread::get_id());
+
+        bool ran = false;
+        lal::async::sync_wait(lal::async::run([&ran]() { ran = true; }, {}, pool));
+        REQUIRE(ran);
+    }
+
+    SECTION("When all")
+    {
+        const auto [ab, ba] = lal::async::sync_wait(lal::async::when_all(lal::async::multiply(a, b, {}, pool), lal::async::multiply(b, a, {}, pool)));
+        REQUIRE(ab == a * b);
+        REQUIRE(ba == b * a);
+
+        for (lal::thread_pool* const on : { &single, &pool })
+        {
+            std::vector<lal::async::task<lal::matrix<int, 2, 2>>> products;
+            for (int i = 0; i < 20; ++i)
+                products.push_back(lal::async::multiply(a, b, {}, *on));
+
+            const auto results = lal::async::sync_wait(lal::async::when_all(std::move(products)));
+            REQUIRE(results.size() == 20u);
+            REQUIRE(std::all_of(results.begin(), results.end(), [&](const lal::matrix<int, 2, 2>& m) { return m == a * b; }));
+        }
+
+        REQUIRE(lal::async::sync_wait(lal::async::when_all(std::vector<lal::async::task<int>>{})).empty());
+    }
+
+    SECTION("Cancellation and exceptions")
+    {
+        std::stop_source source;
+        source.request_stop();
+        bool cancelled = false;
+        try
+        {
+            lal::async::sync_wait(lal::async::multiply(a, b, source.get_token(), pool));
+        }
+        catch (const std::system_error& error)
+        {
+            cancelled = error.code() == std::errc::operation_canceled;
+        }
+
+        REQUIRE(cancelled);
+
+        // The other tasks of a when_all still finish before the exception comes out
+        std::atomic<int> finished{ 0 };
+        const auto count = [&finished]() { return ++finished; };
+        const auto fail = []() -> int { throw std::runtime_error("run"); };
+        REQUIRE_THROWS_AS(lal::async::sync_wait(lal::async::when_all(lal::async::run(count, {}, pool), lal::async::run(fail, {}, pool),
+                                                                     lal::async::run(count, {}, pool))),
+                          std::runtime_error);
+        REQUIRE(finished == 2);
+    }
+}
+#endif
+
+TEST_CASE("Task graph", "[task_graph]")
+{
+    lal::thread_pool pool{ 4u };
+    lal::matrix<int, 4, 3> input{ { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 10, 11, 12 } };
+    const lal::matrix<int, 3, 2> w1{ { 1, 0 }, { 2, 1 }, { 0, 3 } };
+    const lal::matrix<int, 3, 2> w2{ { 2, 1 }, { 1, 1 }, { 1, 0 } };
+    const lal::matrix<int, 3, 2> w3{ { 0, 1 }, { 1, 2 }, { 3, 1 } };
+    const lal::matrix<int, 2, 2> v{ { 1, 2 }, { 3, 4 } };
+
+    SECTION("Branches and merges")
+    {
+        // Three layers of the same input, each followed by a second, then summed
+        lal::matrix<int, 4, 2> output{};
+        lal::task_graph graph;
+        const auto x = graph.bind(input);
+        const auto y = graph.bind(output);
+        const auto second = graph.bind(v);
+        const auto product = [](const auto& a, const auto& b, auto& c) { c = a * b; };
+        for (const lal::matrix<int, 3, 2>* const w : { &w1, &w2, &w3 })
+        {
+            const auto weights = graph.bind(*w);
+            const auto h = graph.temporary<int, 4, 2>();
+            const auto z = graph.temporary<int, 4, 2>();
+            graph.add(product, x.read(), weights.read(), h.write());
+            graph.add(product, h.read(), second.read(), z.write());
+            if (w == &w1)
+                graph.add([](const auto& a, auto& b) { b = a; }, z.read(), y.write());
+            else
+                graph.add([](const auto& a, auto& b) { b += a; }, z.read(), y.update());
+        }
+
+        REQUIRE(graph.size() == 9u);
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            input[0][0] = frame;
+            const auto expected = input * w1 * v + input * w2 * v + input * w3 * v;
+            output = {};
+            if (frame % 2 == 0)
+                graph.run();
+            else
+                graph.run(lal::par.on(pool));
+
+            REQUIRE(output == expected);
+        }
+    }
+
+    SECTION("Order")
+    {
+        // Each update depends on the one before, reads in between wait for the update
+        // before them and the update after waits for them
+        lal::matrix<int, 1, 1> accumulator{};
+        std::array<lal::matrix<int, 1, 1>, 50> seen{};
+        lal::task_graph graph;
+        const auto a = graph.bind(accumulator);
+        for (int i = 0; i < 50; ++i)
+        {
+            graph.add([i](auto& m) { m[0][0] = m[0][0] * 3 % 1000003 + i; }, a.update());
+            const auto copy = graph.bind(seen[static_cast<std::size_t>(i)]);
+            graph.add([](const auto& from, auto& to) { to = from; }, a.read(), copy.write());
+        }
+
+        graph.run();
+        const auto sequential = seen;
+        const auto result = accumulator;
+        for (int repeat = 0; repeat < 20; ++repeat)
+        {
+            accumulator = {};
+            graph.run(lal::par.on(pool));
+            REQUIRE(accumulator == result);
+            REQUIRE(seen == sequential);
+        }
+    }
+
+    SECTION("Buffer reuse")
+    {
+        using block = lal::matrix<float, 4, 4>;
+        const auto copy = [](const auto& from, auto& to) { to = from; };
+        block source{};
+        source[1][2] = 3.0f;
+        block sink{};
+
+        // A chain only ever needs two of its temporaries
+        lal::task_graph chain;
+        const auto in = chain.bind(source);
+        const auto t1 = chain.temporary<float, 4, 4>();
+        const auto t2 = chain.temporary<float, 4, 4>();
+        const auto t3 = chain.temporary<float, 4, 4>();
+        chain.add(copy, in.read(), t1.write());
+        chain.add(copy, t1.read(), t2.write());
+        chain.add(copy, t2.read(), t3.write());
+        chain.add(copy, t3.read(), chain.bind(sink).write());
+        REQUIRE(chain.temporary_bytes() == 2u * sizeof(block));
+        chain.run(lal::par.on(pool));
+        REQUIRE(sink == source);
+
+        // Branches run at the same time so each keeps its own
+        lal::task_graph branches;
+        const auto shared = branches.bind(source);
+        for (int i = 0; i < 3; ++i)
+            branches.add(copy, shared.read(), branches.temporary<float, 4, 4>().write());
+
+        REQUIRE(branches.temporary_bytes() == 3u * sizeof(block));
+    }
+
+    SECTION("Errors")
+    {
+        lal::task_graph graph;
+        const auto t = graph.temporary<int, 2, 2>();
+        REQUIRE_THROWS_AS(graph.add([](const auto&) {}, t.read()), std::logic_error);
+        REQUIRE(graph.size() == 0u);
+
+        // Nodes after a failing one don't run
+        bool after = false;
+        graph.add([](auto&) { throw std::runtime_error("node"); }, t.write());
+        graph.add([&after](const auto&) { after = true; }, t.read());
+        REQUIRE_THROWS_AS(graph.run(), std::runtime_error);
+        REQUIRE_THROWS_AS(graph.run(lal::par.on(pool)), std::runtime_error);
+        REQUIRE_FALSE(after);
+    }
+}
+
+TEST_CASE("Kronecker products", "[kronecker]")
+{
+    SECTION("Outer product")
+    {
+        constexpr lal::column_vector<int, 3> u{ { 1 }, { 2 }, { 3 } };
+        constexpr lal::row_vector<int, 2> v{ { 4, -5 } };
+        constexpr auto uv = lal::outer(u, v);
+        static_assert(std::is_same_v<decltype(uv), const lal::matrix<int, 3, 2>>);
+        static_assert(uv == u * v);
+
+        // Either orientation of either vector
+        REQUIRE(lal::outer(lal::transpose(u), lal::transpose(v)) == uv);
+        REQUIRE(lal::outer(v, u) == lal::transpose(uv));
+    }
+
+    const lal::matrix<int, 2, 3> a{ { 1, 2, 3 }, { 4, 5, 6 } };
+    const lal::matrix<int, 3, 2> b{ { 1, -1 }, { 0, 2 }, { 3, 1 } };
+    lal::matrix<int, 6, 6> expected{};
+    for (std::size_t i = 0u; i < 2u; ++i)
+        for (std::size_t j = 0u; j < 3u; ++j)
+            for (std::size_t k = 0u; k < 3u; ++k)
+                for (std::size_t l = 0u; l < 2u; ++l)
+                    expected[i * 3u + k][j * 2u + l] = a[i][j] * b[k][l];
+
+    SECTION("Kronecker product")
+    {
+        const auto ab = lal::kron(a, b);
+        static_assert(std::is_same_v<decltype(ab), const lal::matrix<int, 6, 6>>);
+        REQUIRE(ab == expected);
+        REQUIRE(lal::kron(lal::column_vector<int, 3>{ { 1 }, { 2 }, { 3 } }, lal::row_vector<int, 2>{ { 4, -5 } }) ==
+                lal::outer(lal::column_vector<int, 3>{ { 1 }, { 2 }, { 3 } }, lal::row_vector<int, 2>{ { 4, -5 } }));
+
+        // Into a block of a larger matrix
+        lal::matrix<int, 8, 8> big{};
+        lal::kron(a, b, lal::submatrix<6, 6>(big, 1, 2));
+        REQUIRE(lal::make_matrix(lal::submatrix<6, 6>(big, 1, 2)) == expected);
+        REQUIRE(big[0][2] == 0);
+        REQUIRE(big[7][7] == 0);
+    }
+
+    SECTION("Lazy product")
+    {
+        const auto lazy = lal::kronecker(a, b);
+        static_assert(decltype(lazy)::row_count == 6u && decltype(lazy)::column_count == 6u);
+
+        lal::column_vector<int, 6> x{};
+        lal::matrix<int, 6, 3> xs{};
+        for (std::size_t i = 0u; i < 6u; ++i)
+        {
+            x[i][0] = static_cast<int>(i) - 2;
+            for (std::size_t j = 0u; j < 3u; ++j)
+                xs[i][j] = static_cast<int>(i * j) - 3;
+        }
+
+        REQUIRE(lazy * x == expected * x);
+        REQUIRE(lazy * xs == expected * xs);
+
+        // Factors may themselves be views
+        const lal::matrix<double, 3, 3> c{ { 1.0, 2.0, 0.5 }, { -1.0, 0.0, 3.0 }, { 2.0, 1.0, 1.0 } };
+        const lal::column_vector<double, 4> y{ { 1.0 }, { -2.0 }, { 0.5 }, { 4.0 } };
+        const auto blocks = lal::kronecker(lal::submatrix<2, 2>(c, 0, 1), lal::submatrix<2, 2>(c, 1, 0));
+        const auto dense = lal::kron(lal::make_matrix(lal::submatrix<2, 2>(c, 0, 1)), lal::make_matrix(lal::submatrix<2, 2>(c, 1, 0)));
+        REQUIRE(blocks * y == dense * y);
+    }
+}
+
+TEST_CASE("Strassen", "[strassen]")
+{
+    std::mt19937 generator{ 7u };
+    const auto random_matrix = [&](auto& m) {
+        std::uniform_int_distribution<int> distribution{ -50, 50 };
+        for (auto& element : m)
+            element = static_cast<std::remove_reference_t<decltype(element)>>(distribution(generator));
+    };
+
+    SECTION("Exact for integers")
+    {
+        // 128 recurses twice with a cutoff of 32, 200 once before reaching an odd size
+        auto a = std::make_unique<lal::square_matrix<long long, 128>>();
+        auto b = std::make_unique<lal::square_matrix<long long, 128>>();
+        auto c = std::make_unique<lal::square_matrix<long long, 128>>();
+        random_matrix(*a);
+        random_matrix(*b);
+        lal::strassen_multiply(*a, *b, *c, 32u);
+        REQUIRE(*c == *a * *b);
+
+        auto d = std::make_unique<lal::square_matrix<int, 200>>();
+        auto e = std::make_unique<lal::square_matrix<int, 200>>();
+        auto f = std::make_unique<lal::square_matrix<int, 200>>();
+        auto g = std::make_unique<lal::square_matrix<int, 200>>();
+        random_matrix(*d);
+        random_matrix(*e);
+        lal::strassen_multiply(*d, *e, *f, 32u);
+        lal::gemm(1, *d, *e, 0, *g);
+        REQUIRE(*f == *g);
+    }
+
+    SECTION("Views and workspace reuse")
+    {
+        auto big = std::make_unique<lal::square_matrix<double, 160>>();
+        random_matrix(*big);
+        const auto a = lal::submatrix<128, 128>(std::as_const(*big), 16, 8);
+        const auto b = lal::submatrix<128, 128>(std::as_const(*big), 0, 32);
+
+        lal::strassen_workspace<double, 128> workspace;
+        REQUIRE(workspace.size() == 2u * 64u * 64u + 2u * 32u * 32u);
+
+        auto expected = std::make_unique<lal::square_matrix<double, 128>>();
+        auto c = std::make_unique<lal::square_matrix<double, 128>>();
+        lal::gemm(1.0, a, b, 0.0, *expected);
+        for (int i = 0; i < 2; ++i)
+        {
+            c->fill(1.0);
+            lal::strassen_multiply(a, b, *c, workspace, 64u);
+            for (std::size_t k = 0u; k < c->size(); ++k)
+                REQUIRE(c->data()[k] == Approx(expected->data()[k]).margin(1e-9));
+        }
+    }
+
+    SECTION("Cutoff and aliasing")
+    {
+        // At or below the cutoff the result is the classic product
+        auto a = std::make_unique<lal::square_matrix<float, 64>>();
+        auto c = std::make_unique<lal::square_matrix<float, 64>>();
+        random_matrix(*a);
+        lal::strassen_multiply(*a, *a, *c);
+        REQUIRE(*c == *a * *a);
+
+        REQUIRE_THROWS_AS(lal::strassen_multiply(*a, *c, *a), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Serialization", "[serialization]")
+{
+    lal::matrix<double, 3, 4> m1;
+    std::iota(m1.begin(), m1.end(), -2.5);
+
+    SECTION("Stream round trip")
+    {
+        std::stringstream stream;
+        lal::save(stream, m1);
+        lal::save(stream, lal::submatrix<2, 2>(m1, 1, 1));
+        REQUIRE(stream.str().size() == 64u + 96u + 32u + 64u + 32u + 32u);
+
+        lal::matrix<double, 3, 4> m2;
+        lal::load(stream, m2);
+        REQUIRE(m2 == m1);
+
+        lal::matrix<double, 4, 4> m3;
+        lal::load(stream, lal::submatrix<2, 2>(m3, 2, 2));
+        REQUIRE(lal::make_matrix(lal::submatrix<2, 2>(m3, 2, 2)) == lal::make_matrix(lal::submatrix<2, 2>(m1, 1, 1)));
+        REQUIRE(m3[0][0] == 0.0);
+    }
+
+    SECTION("Mismatched and corrupt records")
+    {
+        std::stringstream stream;
+        lal::save(stream, m1);
+        const std::string bytes = stream.str();
+
+        const auto load_throws = [](const std::string& data, auto&& m, const std::string_view message) {
+            std::stringstream in{ data };
+            try
+            {
+                lal::load(in, m);
+                REQUIRE(false);
+            }
+            catch (const lal::serialization_error& error)
+            {
+                REQUIRE(error.what() == message);
+            }
+        };
+
+        load_throws(bytes, lal::matrix<float, 3, 4>{}, "Matrix record has a different element type");
+        load_throws(bytes, lal::matrix<double, 4, 3>{}, "Matrix record has different dimensions");
+        load_throws(bytes.substr(0, 100), lal::matrix<double, 3, 4>{}, "Unexpected end of matrix record");
+
+        std::string corrupt_data = bytes;
+        corrupt_data[70] ^= 0x10;
+        load_throws(corrupt_data, lal::matrix<double, 3, 4>{}, "Matrix record data is corrupt");
+
+        std::string corrupt_header = bytes;
+        corrupt_header[20] ^= 0x01;
+        load_throws(corrupt_header, lal::matrix<double, 3, 4>{}, "Matrix record header is corrupt");
+    }
+
+    SECTION("Memory mapped loading")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "lal_serialization_test.bin";
+        const lal::matrix<std::int16_t, 2, 3> m2{ { 1, -2, 3 }, { -4, 5, -6 } };
+        {
+            std::ofstream out{ path, std::ios::binary };
+            lal::save(out, m2);
+            lal::save(out, m1);
+        }
+
+        lal::matrix<std::int16_t, 2, 3> m3;
+        lal::load(path, m3);
+        REQUIRE(m3 == m2);
+
+        {
+            const lal::mapped_file file{ path };
+            std::size_t offset = 0u;
+            const auto v1 = lal::map_matrix<std::int16_t, 2, 3>(file, offset);
+            REQUIRE(offset == 128u);
+            const auto v2 = lal::map_matrix<double, 3, 4>(file, offset);
+            REQUIRE(offset == file.size());
+
+            REQUIRE(static_cast<const void*>(v1.data()) == file.data() + 64);
+            REQUIRE(lal::make_matrix(v1) == m2);
+            REQUIRE(lal::make_matrix(v2) == m1);
+            REQUIRE_THROWS_AS((lal::map_matrix<double, 3, 4>(file, offset)), lal::serialization_error);
+        }
+
+        std::filesystem::remove(path);
+        REQUIRE_THROWS_AS(lal::mapped_file{ path }, std::system_error);
+    }
+}
+
+TEST_CASE("NumPy files", "[npy]")
+{
+    // Builds a version 1.0 .npy file by hand so that non-native layouts can be tested
+    const auto make_npy = [](const std::string& header, const std::string& data) {
+        std::string padded = header;
+        while ((padded.size() + 11u) % 64u != 0u)
+            padded.push_back(' ');
+        padded.push_back('\n');
+
+        std::string npy = "\x93NUMPY";
+        npy.push_back('\x01');
+        npy.push_back('\x00');
+        npy.push_back(static_cast<char>(padded.size() & 0xFFu));
+        npy.push_back(static_cast<char>(padded.size() >> 8));
+        return npy + padded + data;
+    };
+
+    lal::matrix<float, 3, 4> m1;
+    std::iota(m1.begin(), m1.end(), 0.5f);
+
+    SECTION(".npy round trip")
+    {
+        std::stringstream stream;
+        lal::save_npy(stream, m1);
+        const std::string bytes = stream.str();
+        REQUIRE(bytes.size() == 128u + sizeof(float) * m1.size());
+        REQUIRE(bytes.find("{'descr': '<f4', 'fortran_order': False, 'shape': (3, 4), }") == 10u);
+        REQUIRE(bytes[127] == '\n');
+
+        const lal::npy_array_info info = lal::read_npy_header(stream);
+        REQUIRE(info.kind == 'f');
+        REQUIRE(info.item_size == 4u);
+        REQUIRE(!info.fortran_order);
+        REQUIRE(info.shape == std::vector<std::size_t>{ 3u, 4u });
+        REQUIRE(info.data_offset == 128u);
+
+        stream.seekg(0);
+        lal::matrix<float, 3, 4> m2;
+        lal::load_npy(stream, m2);
+        REQUIRE(m2 == m1);
+
+        // Loading converts the dtype when it differs from the matrix element type
+        stream.seekg(0);
+        lal::matrix<int, 3, 4> m3;
+        lal::load_npy(stream, m3);
+        REQUIRE(m3 == lal::map(m1, [](const float f) { return static_cast<int>(f); }));
+
+        stream.seekg(0);
+        REQUIRE_THROWS_AS(lal::load_npy(stream, lal::matrix<float, 4, 3>{}), lal::npy_error);
+    }
+
+    SECTION("Fortran order, big endian and 1-d arrays")
+    {
+        const std::string big_endian_columns{ "\0\0\0\1\0\0\0\4\0\0\0\2\0\0\0\5\0\0\0\3\xFF\xFF\xFF\xFA", 24u };
+        std::stringstream fortran{ make_npy("{'descr': '>i4', 'fortran_order': True, 'shape': (2, 3), }", big_endian_columns) };
+        lal::matrix<double, 2, 3> m2;
+        lal::load_npy(fortran, m2);
+        REQUIRE(m2 == lal::matrix{ { 1.0, 2.0, 3.0 }, { 4.0, 5.0, -6.0 } });
+
+        std::stringstream vector{ make_npy("{'descr': '|u1', 'fortran_order': False, 'shape': (3,), }", "\x01\x02\x03") };
+        lal::matrix<unsigned, 3, 1> m3;
+        lal::load_npy(vector, m3);
+        REQUIRE(m3 == lal::matrix{ { 1u }, { 2u }, { 3u } });
+
+        // Any non-zero byte is true
+        const std::string bools{ "\0\1\2", 3u };
+        std::stringstream bool_vector{ make_npy("{'descr': '|b1', 'fortran_order': False, 'shape': (3,), }", bools) };
+        lal::matrix<bool, 3, 1> m4;
+        lal::load_npy(bool_vector, m4);
+        REQUIRE(m4 == lal::matrix{ { false }, { true }, { true } });
+        bool_vector.seekg(0);
+        lal::matrix<float, 3, 1> m5;
+        lal::load_npy(bool_vector, m5);
+        REQUIRE(m5 == lal::matrix{ { 0.0f }, { 1.0f }, { 1.0f } });
+
+        std::stringstream unsupported{ make_npy("{'descr': '<c16', 'fortran_order': False, 'shape': (1,), }", std::string(16u, '\0')) };
+        REQUIRE_THROWS_AS(lal::load_npy(unsupported, lal::matrix<double, 1, 1>{}), lal::npy_error);
+    }
+
+    SECTION(".npy memory mapping and .npz archives")
+    {
+        const auto npy_path = std::filesystem::temp_directory_path() / "lal_npy_test.npy";
+        const auto npz_path = std::filesystem::temp_directory_path() / "lal_npz_test.npz";
+        const lal::matrix<std::int64_t, 2, 2> m2{ { 1, -1 }, { 2, -2 } };
+
+        lal::save_npy(npy_path, lal::submatrix<2, 2>(m1, 1, 1));
+        {
+            const lal::mapped_file file{ npy_path };
+            const auto v = lal::map_npy<float, 2, 2>(file);
+            REQUIRE(lal::make_matrix(v) == lal::matrix{ { 5.5f, 6.5f }, { 9.5f, 10.5f } });
+            REQUIRE_THROWS_AS((lal::map_npy<double, 2, 2>(file)), lal::npy_error);
+        }
+
+        {
+            lal::npz_writer writer{ npz_path };
+            writer.add("weights", m1);
+            writer.add("bias", m2);
+        }
+
+        {
+            const lal::npz_archive archive{ npz_path };
+            REQUIRE(archive.names() == std::vector<std::string>{ "weights", "bias" });
+            REQUIRE(archive.contains("bias"));
+            REQUIRE(archive.info("bias").shape == std::vector<std::size_t>{ 2u, 2u });
+
+            lal::matrix<float, 3, 4> weights;
+            archive.load("weights", weights);
+            REQUIRE(weights == m1);
+
+            const auto bias = archive.map<std::int64_t, 2, 2>("bias");
+            REQUIRE(reinterpret_cast<std::uintptr_t>(bias.data()) % 64u == 0u);
+            REQUIRE(lal::make_matrix(bias) == m2);
+            REQUIRE_THROWS_AS(archive.load("missing", weights), lal::npy_error);
+        }
+
+        {
+            // Central directory fields running past the end of the file
+            std::string bytes;
+            {
+                std::ifstream in{ npz_path, std::ios::binary };
+                bytes.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+            }
+
+            const std::size_t first = bytes.find("PK\x01\x02");
+            const std::size_t last = bytes.rfind("PK\x01\x02");
+            REQUIRE(first != last);
+            const auto corrupt = [&](const std::size_t offset) {
+                std::string copy = bytes;
+                copy[offset] = '\xFF';
+                copy[offset + 1u] = '\xFF';
+                std::ofstream{ npz_path, std::ios::binary | std::ios::trunc } << copy;
+                REQUIRE_THROWS_AS(lal::npz_archive{ npz_path }, lal::npy_error);
+            };
+
+            corrupt(first + 28u);
+            corrupt(last + 28u);
+            corrupt(last + 30u);
+            corrupt(last + 32u);
+        }
+
+        std::filesystem::remove(npy_path);
+        std::filesystem::remove(npz_path);
+    }
+}
+
+TEST_CASE("Text parsing", "[text_io]")
+{
+    SECTION("Matrix Market array format")
+    {
+        const std::string_view general =
+            "%%MatrixMarket matrix array real general\n"
+            "% column major\n"
+            "2 3\n"
+            "1.5\n4\n-2\n+5e1\n\n3\n6\n";
+        lal::matrix<double, 2, 3> m1;
+        lal::parse_matrix_market(general, m1);
+        REQUIRE(m1 == lal::matrix{ { 1.5, -2.0, 3.0 }, { 4.0, 50.0, 6.0 } });
+        REQUIRE_THROWS_AS(lal::parse_matrix_market(general, lal::matrix<double, 3, 2>{}), lal::text_parse_error);
+
+        const std::string_view symmetric =
+            "%%MatrixMarket matrix array integer symmetric\r\n"
+            "3 3\r\n"
+            "1\r\n2\r\n3\r\n4\r\n5\r\n6\r\n";
+        lal::square_matrix<int, 3> m2;
+        lal::parse_matrix_market(symmetric, m2);
+        REQUIRE(m2 == lal::matrix{ { 1, 2, 3 }, { 2, 4, 5 }, { 3, 5, 6 } });
+
+        const std::string_view skew =
+            "%%MatrixMarket matrix array real skew-symmetric\n"
+            "3 3\n"
+            "1\n2\n3\n";
+        lal::square_matrix<float, 3> m3;
+        m3.fill(9.0f);
+        lal::parse_matrix_market(skew, m3);
+        REQUIRE(m3 == lal::matrix{ { 0.0f, -1.0f, -2.0f }, { 1.0f, 0.0f, -3.0f }, { 2.0f, 3.0f, 0.0f } });
+
+        // Nothing may follow the last value of a line
+        lal::matrix<double, 1, 2> m4;
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix array real general\n1 2\n1.5abc\n2\n", m4),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix array real general\n1 2\n1 2\n3\n", m4),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix array real general\n1 2 junk\n1\n2\n", m4),
+                          lal::text_parse_error);
+        lal::parse_matrix_market("%%MatrixMarket matrix array real general\n1 2 \t\n1 \n2\t\n", m4);
+        REQUIRE(m4 == lal::matrix{ { 1.0, 2.0 } });
+    }
+
+    SECTION("Matrix Market coordinate format")
+    {
+        const std::string_view text =
+            "%%MatrixMarket matrix coordinate real symmetric\n"
+            "%\n"
+            "4 4 3\n"
+            "1 1 2.5\n"
+            "3 1 -1\n"
+            "4 2 7\n";
+
+        lal::square_matrix<double, 4> m;
+        m.fill(1.0);
+        lal::parse_matrix_market(text, m);
+        REQUIRE(m == lal::matrix{ { 2.5, 0.0, -1.0, 0.0 }, { 0.0, 0.0, 0.0, 7.0 }, { -1.0, 0.0, 0.0, 0.0 }, { 0.0, 7.0, 0.0, 0.0 } });
+
+        const auto coordinates = lal::parse_matrix_market_coordinates<double>(text);
+        REQUIRE(coordinates.rows == 4u);
+        REQUIRE(coordinates.columns == 4u);
+        REQUIRE(coordinates.entries.size() == 5u);
+        REQUIRE(coordinates.entries[1].row == 2u);
+        REQUIRE(coordinates.entries[1].column == 0u);
+        REQUIRE(coordinates.entries[2].row == 0u);
+        REQUIRE(coordinates.entries[2].column == 2u);
+        REQUIRE(coordinates.entries[4].value == 7.0);
+
+        const std::string_view pattern = "%%MatrixMarket matrix coordinate pattern general\n2 2 2\n1 2\n2 1\n";
+        lal::square_matrix<int, 2> p;
+        lal::parse_matrix_market(pattern, p);
+        REQUIRE(p == lal::matrix{ { 0, 1 }, { 1, 0 } });
+
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n", p),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n", p),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix coordinate complex general\n2 2 1\n1 1 1 0\n", p),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix coordinate real general\n2 2 1 junk\n1 1 1\n", p),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix coordinate real general\n2 2 1\n3 4 5 junk\n", p),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market("%%MatrixMarket matrix coordinate pattern general\n2 2 1\n1 1 1\n", p),
+                          lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_matrix_market_coordinates<int>("%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 1x\n"),
+                          lal::text_parse_error);
+    }
+
+    SECTION("CSV")
+    {
+        lal::matrix<float, 3, 3> m;
+        lal::parse_csv(std::string_view{ "a,b,c\n1, 2 ,3\n\"4\",5.5,-6\n\n7,8,9e-1\n" }, m, ',', true);
+        REQUIRE(m == lal::matrix{ { 1.0f, 2.0f, 3.0f }, { 4.0f, 5.5f, -6.0f }, { 7.0f, 8.0f, 0.9f } });
+
+        lal::matrix<int, 1, 2> row;
+        lal::parse_csv(std::string_view{ "3;-4" }, row, ';');
+        REQUIRE(row == lal::matrix{ { 3, -4 } });
+
+        REQUIRE_THROWS_AS(lal::parse_csv(std::string_view{ "1,2,3\n" }, row), lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_csv(std::string_view{ "1\n" }, row), lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_csv(std::string_view{ "1,x\n" }, row), lal::text_parse_error);
+        REQUIRE_THROWS_AS(lal::parse_csv(std::string_view{ "1,2\n3,4\n" }, row), lal::text_parse_error);
+    }
+
+    SECTION("Large files")
+    {
+        // Big enough to be split into several chunks on multicore machines
+        constexpr std::size_t rows = 512u;
+        auto m1 = std::make_unique<lal::matrix<double, rows, 256>>();
+        std::iota(m1->begin(), m1->end(), 0.25);
+
+        const auto path = std::filesystem::temp_directory_path() / "lal_text_io_test.csv";
+        {
+            std::ofstream out{ path };
+            out.precision(17);
+            for (std::size_t row = 0u; row < rows; ++row)
+                for (std::size_t column = 0u; column < m1->columns(); ++column)
+                    out << (*m1)[row][column] << (column + 1u == m1->columns() ? '\n' : ',');
+        }
+
+        auto m2 = std::make_unique<lal::matrix<double, rows, 256>>();
+        lal::read_csv(path, *m2);
+        REQUIRE(*m2 == *m1);
+        std::filesystem::remove(path);
+
+        // Repeated indices, including across chunks, keep the value which comes last in the file
+        constexpr std::size_t entries = 300000u;
+        std::string text = "%%MatrixMarket matrix coordinate integer general\n3 3 " + std::to_string(entries + 2u) + "\n2 3 1\n";
+        for (std::size_t i = 0u; i < entries; ++i)
+            text += "1 1 " + std::to_string(i) + "\n";
+        text += "2 3 2\n";
+
+        lal::square_matrix<std::int64_t, 3> m3;
+        lal::parse_matrix_market(text, m3);
+        REQUIRE(m3 == lal::matrix<std::int64_t, 3, 3>{ { entries - 1u, 0, 0 }, { 0, 0, 2 }, { 0, 0, 0 } });
+
+        const auto coordinates = lal::parse_matrix_market_coordinates<std::int64_t>(text);
+        REQUIRE(coordinates.entries.size() == entries + 2u);
+        REQUIRE(coordinates.entries.front().value == 1);
+        REQUIRE(coordinates.entries[entries].value == static_cast<std::int64_t>(entries - 1u));
+        REQUIRE(coordinates.entries.back().value == 2);
+    }
+}
+
+#ifdef LAL_ENABLE_COUNTERS
+TEST_CASE("Counters", "[counters]")
+{
+    // Instrumentation must not stop operations being constant evaluated
+    static constexpr int row[1][2] = { { 1, 2 } };
+    static constexpr int square[2][2] = { { 1, 2 }, { 3, 4 } };
+    static_assert((lal::row_vector<int, 2>{ row } * lal::square_matrix<int, 2>{ square })[0][1] == 10);
+    static_assert((lal::row_vector<int, 2>{ row } * 3 + lal::row_vector<int, 2>{ row })[0][1] == 8);
+    REQUIRE(noexcept(lal::matrix<float, 2, 3>{} * lal::matrix<float, 3, 4>{}));
+
+    lal::reset_operation_counters();
+    const auto find = [](const lal::operation op, const std::string_view type) {
+        const auto counters = lal::read_operation_counters();
+        const auto it = std::find_if(counters.begin(), counters.end(), [&](const lal::operation_counters& c) {
+            return c.op == op && c.type == type;
+        });
+        return it == counters.end() ? std::optional<lal::operation_counters>{} : *it;
+    };
+
+    SECTION("Products")
+    {
+        const lal::matrix<float, 2, 3> m1{};
+        const lal::matrix<float, 3, 4> m2{};
+        for (int i = 0; i < 3; ++i)
+            static_cast<void>(m1 * m2);
+
+        const auto c = find(lal::operation::multiplication, "float");
+        REQUIRE(c);
+        REQUIRE(c->rows == 2u);
+        REQUIRE(c->columns == 4u);
+        REQUIRE(c->depth == 3u);
+        REQUIRE(c->calls == 3u);
+        REQUIRE(c->flops == 3u * 2u * 2u * 3u * 4u);
+        REQUIRE(c->bytes == 3u * sizeof(float) * (6u + 12u + 8u));
+        REQUIRE(c->arithmetic_intensity() == Approx(48.0 / 104.0));
+    }
+
+    SECTION("Elementwise operations are counted once")
+    {
+        lal::matrix<double, 4, 4> m1{};
+        const lal::matrix<double, 4, 4> m2{};
+        m1 = m1 + m2;
+        m1 -= m2;
+
+        const auto addition = find(lal::operation::addition, "double");
+        REQUIRE(addition);
+        REQUIRE(addition->calls == 1u);
+        REQUIRE(addition->flops == 16u);
+        REQUIRE(addition->bytes == 3u * 16u * sizeof(double));
+        REQUIRE(find(lal::operation::subtraction, "double")->calls == 1u);
+        REQUIRE(!find(lal::operation::hadamard_product, "double"));
+
+        lal::gemm(1.0, m1, m2, 0.0, m1);
+        REQUIRE(find(lal::operation::gemm, "double")->flops == 2u * 4u * 4u * 4u);
+    }
+
+    SECTION("JSON")
+    {
+        static_cast<void>(lal::transpose(lal::matrix<int, 2, 3>{}));
+        std::ostringstream out;
+        lal::write_operation_counters_json(out);
+        REQUIRE(out.str().find("\"operation\": \"transpose\", \"type\": \"int\", \"rows\": 3, \"columns\": 2") != std::string::npos);
+
+        lal::reset_operation_counters();
+        REQUIRE(lal::read_operation_counters().empty());
+    }
+}
+#endif
+
+#ifdef LAL_ENABLE_TRACING
+TEST_CASE("Tracing", "[tracing]")
+{
+    lal::clear_trace();
+    {
+        LAL_TRACE_SCOPE("training step");
+        const lal::matrix<float, 2, 3> m1{};
+        const lal::matrix<float, 3, 4> m2{};
+        static_cast<void>(m1 * m2);
+
+        std::thread worker{ [] { static_cast<void>(lal::transpose(lal::matrix<double, 5, 2>{})); } };
+        worker.join();
+    }
+
+    const auto events = lal::collect_trace_events();
+    const auto find = [&](const std::string_view name) {
+        const auto it = std::find_if(events.begin(), events.end(), [&](const lal::trace_event& e) { return e.name == name; });
+        REQUIRE(it != events.end());
+        return *it;
+    };
+
+    const auto step = find("training step");
+    const auto product = find("multiplication");
+    const auto transpose = find("transpose");
+    REQUIRE(product.type == "float");
+    REQUIRE(product.rows == 2u);
+    REQUIRE(product.columns == 4u);
+    REQUIRE(product.depth == 3u);
+    REQUIRE(product.begin <= product.end);
+    REQUIRE(step.begin <= product.begin);
+    REQUIRE(step.end >= transpose.end);
+    REQUIRE(product.thread == step.thread);
+    REQUIRE(transpose.thread != product.thread);
+
+    std::ostringstream out;
+    lal::write_chrome_trace(out, events);
+    const std::string json = out.str();
+    REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0u);
+    REQUIRE(json.find("\"name\":\"multiplication\",\"cat\":\"lal\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(json.find("\"args\":{\"type\":\"float\",\"shape\":\"2x4x3\"}") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"training step\",\"cat\":\"user\"") != std::string::npos);
+
+    // Names are escaped so that the file stays valid JSON
+    lal::trace_event quoted{};
+    quoted.name = "say \"hi\" \\ \n";
+    std::ostringstream quoted_out;
+    lal::write_chrome_trace(quoted_out, { quoted });
+    REQUIRE(quoted_out.str().find("\"name\":\"say \\\"hi\\\" \\\\ \\u000a\"") != std::string::npos);
+
+    lal::clear_trace();
+    REQUIRE(lal::collect_trace_events().empty());
+
+    // Collecting and clearing while another thread records, wrapping its buffer
+    // several times over, only ever sees whole events
+    std::atomic<bool> done{ false };
+    std::thread recorder{ [&done] {
+        for (std::size_t i = 0u; i < 4u * lal::detail::trace_buffer::capacity; ++i)
+            static_cast<void>(lal::transpose(lal::matrix<double, 5, 2>{}));
+
+        done.store(true);
+    } };
+
+    bool finished = false;
+    std::size_t torn = 0u;
+    do
+    {
+        finished = done.load();
+        for (const lal::trace_event& e : lal::collect_trace_events())
+            if (e.name != "transpose" || e.type != "double" || e.rows != 2u || e.columns != 5u || e.begin > e.end)
+                ++torn;
+
+        lal::clear_trace();
+    } while (!finished);
+
+    recorder.join();
+    REQUIRE(torn == 0u);
+    lal::clear_trace();
+    REQUIRE(lal::collect_trace_events().empty());
+
+    // Exited threads hand their buffers on, their events stay until overwritten
+    const auto buffer_count = [] {
+        std::size_t count = 0u;
+        for (auto buffer = lal::detail::trace_buffers.load(); buffer != nullptr; buffer = buffer->next())
+            ++count;
+        return count;
+    };
+
+    const std::size_t buffers = buffer_count();
+    for (int i = 0; i < 8; ++i)
+    {
+        std::thread short_lived{ [] { static_cast<void>(lal::transpose(lal::matrix<double, 3, 1>{})); } };
+        short_lived.join();
+    }
+
+    REQUIRE(buffer_count() == buffers);
+    std::vector<std::uint32_t> threads;
+    for (const lal::trace_event& e : lal::collect_trace_events())
+        if (e.name == "transpose" && e.rows == 1u && e.columns == 3u)
+            threads.push_back(e.thread);
+
+    std::sort(threads.begin(), threads.end());
+    REQUIRE(threads.size() == 8u);
+    REQUIRE(std::unique(threads.begin(), threads.end()) == threads.end());
+}
+#endif
+
+#ifdef LAL_ENABLE_COPY_TRACKING
+TEST_CASE("Copy tracking", "[copy_tracking]")
+{
+    using matrix_type = lal::matrix<double, 4, 4>;
+    const matrix_type a{};
+    const matrix_type b{};
+    const matrix_type c{};
+    const matrix_type d{};
+
+    const auto check = [](const lal::copy_tracking_scope& scope, const std::uint64_t constructions,
+                          const std::uint64_t copies, const std::uint64_t moves) {
+        const auto counts = scope.counts<double, 4, 4>();
+        REQUIRE(counts.constructions == constructions);
+        REQUIRE(counts.copies == copies);
+        REQUIRE(counts.moves == moves);
+        REQUIRE(counts.bytes_copied == copies * sizeof(matrix_type));
+        REQUIRE(counts.bytes_moved == moves * sizeof(matrix_type));
+    };
+
+    SECTION("Operators taking lhs by value")
+    {
+        // lhs is copied into the parameter and moved out into the result
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = a + b;
+            check(scope, 0u, 1u, 1u);
+        }
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = a - b;
+            check(scope, 0u, 1u, 1u);
+        }
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = a % b;
+            check(scope, 0u, 1u, 1u);
+        }
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = 2.0 * a;
+            check(scope, 0u, 1u, 1u);
+        }
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = -a;
+            check(scope, 0u, 1u, 1u);
+        }
+    }
+
+    SECTION("Operators building a new result")
+    {
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = a * b;
+            check(scope, 1u, 0u, 0u);
+        }
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = lal::transpose(a);
+            check(scope, 1u, 0u, 0u);
+        }
+    }
+
+    SECTION("Compound assignment")
+    {
+        matrix_type m{};
+        const lal::copy_tracking_scope scope;
+        m += a;
+        m -= a;
+        m %= a;
+        m *= b;
+        m *= 2.0;
+        m /= 2.0;
+        check(scope, 0u, 0u, 0u);
+    }
+
+    SECTION("Expressions")
+    {
+        {
+            // Temporaries are moved into the next operator's lhs rather than copied
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = (a + b) * c - d;
+            check(scope, 1u, 1u, 2u);
+        }
+        {
+            const lal::copy_tracking_scope scope;
+            const matrix_type m = a + b + c + d;
+            check(scope, 0u, 1u, 3u);
+        }
+    }
+
+    SECTION("Report")
+    {
+        const lal::copy_tracking_scope scope;
+        const lal::matrix<float, 2, 3> m1{};
+        auto m2 = m1;
+        const auto m3 = std::move(m2);
+        static_cast<void>(m3);
+
+        const auto report = scope.report();
+        REQUIRE(report.size() == 1u);
+        REQUIRE(report.front().type == "float");
+        REQUIRE(report.front().bytes_copied == 6u * sizeof(float));
+        REQUIRE(scope.totals().moves == 1u);
+
+        std::ostringstream out;
+        scope.write(out);
+        REQUIRE(out.str() == "matrix<float, 2, 3>: 1 constructed, 1 copied (24 bytes), 1 moved (24 bytes)\n");
+    }
+
+    SECTION("Types without a name")
+    {
+        // Both are reported as "other" but are still counted apart
+        struct first { int value; };
+        struct second { int value; };
+        const lal::matrix<first, 2, 2> f{};
+        const lal::matrix<second, 2, 2> s{};
+
+        const lal::copy_tracking_scope scope;
+        auto f1 = f;
+        auto f2 = f;
+        auto s1 = s;
+        static_cast<void>(f1);
+        static_cast<void>(f2);
+        static_cast<void>(s1);
+
+        REQUIRE(scope.counts<first, 2, 2>().copies == 2u);
+        REQUIRE(scope.counts<second, 2, 2>().copies == 1u);
+        REQUIRE(scope.counts<long double, 2, 2>().copies == 0u);
+        REQUIRE(scope.report().size() == 2u);
+        REQUIRE(scope.report().front().type == "other");
+        REQUIRE(scope.totals().copies == 3u);
+    }
 }
+#endif
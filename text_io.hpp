@@ -0,0 +1,520 @@
+#ifndef LAL_TEXT_IO_HPP
+#define LAL_TEXT_IO_HPP
+
+#include "matrix_view.hpp"
+#include "mapped_file.hpp"
+#include "matrix.hpp"
+
+#include <system_error>
+#include <string_view>
+#include <type_traits>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <exception>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Readers for Matrix Market (.mtx) and CSV text.  Values are parsed in place with
+// std::from_chars and large inputs are split into line aligned chunks which are
+// parsed concurrently, so no per line or per value strings are allocated.
+namespace lal
+{
+    class text_parse_error : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    template <typename T>
+    struct matrix_entry
+    {
+        std::size_t row = 0u;
+        std::size_t column = 0u;
+        T value{};
+    };
+
+    // Coordinate (triplet) form of a sparse Matrix Market file, indices are zero based
+    template <typename T>
+    struct coordinate_matrix
+    {
+        std::size_t rows = 0u;
+        std::size_t columns = 0u;
+        std::vector<matrix_entry<T>> entries;
+    };
+
+    namespace detail
+    {
+        // Below this many bytes per chunk the cost of starting threads outweighs parsing
+        inline constexpr std::size_t minimum_parse_chunk = 1u << 20;
+
+        struct text_chunk
+        {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+        };
+
+        inline std::vector<text_chunk> split_lines(const char* const begin, const char* const end)
+        {
+            const std::size_t size = static_cast<std::size_t>(end - begin);
+            const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+            const std::size_t chunks = std::max<std::size_t>(1u, std::min(threads, size / minimum_parse_chunk));
+
+            std::vector<text_chunk> ret;
+            const char* chunk_begin = begin;
+            for (std::size_t i = 1u; i <= chunks; ++i)
+            {
+                const char* chunk_end = i == chunks ? end : begin + size / chunks * i;
+                if (chunk_end < chunk_begin)
+                    chunk_end = chunk_begin;
+
+                const void* const newline = std::memchr(chunk_end, '\n', static_cast<std::size_t>(end - chunk_end));
+                chunk_end = newline != nullptr ? static_cast<const char*>(newline) + 1 : end;
+                ret.push_back(text_chunk{ chunk_begin, chunk_end });
+                chunk_begin = chunk_end;
+            }
+
+            return ret;
+        }
+
+        // Runs f(index, chunk) for every chunk concurrently and rethrows the first failure
+        template <typename Function>
+        void for_each_chunk(const std::vector<text_chunk>& chunks, Function f)
+        {
+            std::vector<std::exception_ptr> errors(chunks.size());
+            const auto run = [&](const std::size_t i) {
+                try
+                {
+                    f(i, chunks[i]);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (std::size_t i = 1u; i < chunks.size(); ++i)
+                threads.emplace_back(run, i);
+
+            if (!chunks.empty())
+                run(0u);
+
+            for (std::thread& thread : threads)
+                thread.join();
+
+            for (const std::exception_ptr& error : errors)
+                if (error)
+                    std::rethrow_exception(error);
+        }
+
+        // Returns the next line without its terminator, false once the text is exhausted
+        inline bool next_line(const char*& pos, const char* const end, std::string_view& line) noexcept
+        {
+            if (pos >= end)
+                return false;
+
+            const void* const newline = std::memchr(pos, '\n', static_cast<std::size_t>(end - pos));
+            const char* const line_end = newline != nullptr ? static_cast<const char*>(newline) : end;
+            line = std::string_view{ pos, static_cast<std::size_t>(line_end - pos) };
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1u);
+
+            pos = newline != nullptr ? line_end + 1 : end;
+            return true;
+        }
+
+        constexpr bool is_blank(const char c) noexcept { return c == ' ' || c == '\t'; }
+
+        constexpr std::size_t skip_blanks(const std::string_view line, std::size_t pos) noexcept
+        {
+            while (pos < line.size() && is_blank(line[pos]))
+                ++pos;
+
+            return pos;
+        }
+
+        constexpr bool is_blank_line(const std::string_view line) noexcept
+        {
+            return skip_blanks(line, 0u) == line.size();
+        }
+
+        [[noreturn]] inline void throw_parse_error(const std::string& what, const std::string_view line)
+        {
+            throw text_parse_error(what + " in line \"" + std::string{ line.substr(0u, 64u) } + "\"");
+        }
+
+        // Parses one value starting at pos and returns the position after it
+        template <typename T>
+        std::size_t parse_value(const std::string_view line, std::size_t pos, T& value)
+        {
+            pos = skip_blanks(line, pos);
+            if (pos < line.size() && line[pos] == '+')
+                ++pos;
+
+            const char* const first = line.data() + pos;
+            const auto [ptr, error] = std::from_chars(first, line.data() + line.size(), value);
+            if (error != std::errc{})
+                throw_parse_error(error == std::errc::result_out_of_range ? "Value out of range" : "Expected a number", line);
+
+            return static_cast<std::size_t>(ptr - line.data());
+        }
+
+        // Anything but blanks after the last value of a line is an error
+        inline void expect_line_end(const std::string_view line, const std::size_t pos)
+        {
+            if (skip_blanks(line, pos) != line.size())
+                throw_parse_error("Unexpected text after the last value", line);
+        }
+
+        // Counts the lines in a chunk which hold data, i.e. which are not blank or comments
+        inline std::size_t count_data_lines(const text_chunk chunk, const char comment) noexcept
+        {
+            std::size_t count = 0u;
+            std::string_view line;
+            for (const char* pos = chunk.begin; next_line(pos, chunk.end, line);)
+                if (!is_blank_line(line) && line[skip_blanks(line, 0u)] != comment)
+                    ++count;
+
+            return count;
+        }
+
+        // Line count prefix sums so that chunks of dense data know where they start
+        inline std::vector<std::size_t> data_line_offsets(const std::vector<text_chunk>& chunks, const char comment)
+        {
+            std::vector<std::size_t> counts(chunks.size() + 1u);
+            for_each_chunk(chunks, [&](const std::size_t i, const text_chunk chunk) {
+                counts[i + 1u] = count_data_lines(chunk, comment);
+            });
+
+            std::partial_sum(counts.begin(), counts.end(), counts.begin());
+            return counts;
+        }
+
+        struct matrix_market_header
+        {
+            bool coordinate = false;
+            bool pattern = false;
+            bool symmetric = false;
+            bool skew_symmetric = false;
+            std::size_t rows = 0u;
+            std::size_t columns = 0u;
+            std::size_t entries = 0u;
+            const char* body = nullptr;
+        };
+
+        inline bool iequals(const std::string_view a, const std::string_view b) noexcept
+        {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const char x, const char y) {
+                return (x | 0x20) == (y | 0x20);
+            });
+        }
+
+        inline matrix_market_header parse_matrix_market_header(const std::string_view text)
+        {
+            const char* pos = text.data();
+            const char* const end = text.data() + text.size();
+
+            std::string_view line;
+            if (!next_line(pos, end, line) || line.substr(0u, 14u) != "%%MatrixMarket")
+                throw text_parse_error("Missing %%MatrixMarket banner");
+
+            // %%MatrixMarket matrix <format> <field> <symmetry>
+            std::string_view words[5];
+            std::size_t word_count = 0u;
+            for (std::size_t i = 0u; i < line.size() && word_count < 5u;)
+            {
+                i = skip_blanks(line, i);
+                const std::size_t word_end = std::min(line.find_first_of(" \t", i), line.size());
+                if (word_end > i)
+                    words[word_count++] = line.substr(i, word_end - i);
+                i = word_end;
+            }
+
+            if (word_count != 5u || !iequals(words[1], "matrix"))
+                throw_parse_error("Malformed Matrix Market banner", line);
+
+            matrix_market_header header;
+            header.coordinate = iequals(words[2], "coordinate");
+            if (!header.coordinate && !iequals(words[2], "array"))
+                throw_parse_error("Unknown Matrix Market format", line);
+
+            header.pattern = iequals(words[3], "pattern");
+            if (!header.pattern && !iequals(words[3], "real") && !iequals(words[3], "integer") && !iequals(words[3], "double"))
+                throw_parse_error("Unsupported Matrix Market field", line);
+
+            header.skew_symmetric = iequals(words[4], "skew-symmetric");
+            header.symmetric = header.skew_symmetric || iequals(words[4], "symmetric") || iequals(words[4], "hermitian");
+            if (!header.symmetric && !iequals(words[4], "general"))
+                throw_parse_error("Unknown Matrix Market symmetry", line);
+
+            if (header.pattern && !header.coordinate)
+                throw_parse_error("Pattern matrices must be in coordinate format", line);
+
+            do
+            {
+                if (!next_line(pos, end, line))
+                    throw text_parse_error("Missing Matrix Market size line");
+            } while (is_blank_line(line) || line[skip_blanks(line, 0u)] == '%');
+
+            std::size_t i = parse_value(line, 0u, header.rows);
+            i = parse_value(line, i, header.columns);
+            if (header.coordinate)
+                i = parse_value(line, i, header.entries);
+
+            expect_line_end(line, i);
+            if (header.symmetric && header.rows != header.columns)
+                throw_parse_error("Symmetric Matrix Market matrices must be square", line);
+
+            if (!header.coordinate)
+                header.entries = header.symmetric ? header.rows * (header.rows + 1u) / 2u - (header.skew_symmetric ? header.rows : 0u)
+                                                  : header.rows * header.columns;
+
+            header.body = pos;
+            return header;
+        }
+
+        // Reads the entries of a coordinate file with zero based indices.  Chunks are
+        // parsed concurrently into lists of their own, returned in file order
+        template <typename T>
+        std::vector<std::vector<matrix_entry<T>>> read_coordinate_entries(const matrix_market_header& header, const char* const end)
+        {
+            const std::vector<text_chunk> chunks = split_lines(header.body, end);
+            std::vector<std::vector<matrix_entry<T>>> ret(chunks.size());
+            for_each_chunk(chunks, [&](const std::size_t chunk_index, const text_chunk chunk) {
+                std::string_view line;
+                for (const char* pos = chunk.begin; next_line(pos, chunk.end, line);)
+                {
+                    if (is_blank_line(line) || line[skip_blanks(line, 0u)] == '%')
+                        continue;
+
+                    matrix_entry<T> entry{ 0u, 0u, T{ 1 } };
+                    std::size_t i = parse_value(line, 0u, entry.row);
+                    i = parse_value(line, i, entry.column);
+                    if (!header.pattern)
+                        i = parse_value(line, i, entry.value);
+
+                    expect_line_end(line, i);
+                    if (entry.row == 0u || entry.column == 0u || entry.row > header.rows || entry.column > header.columns)
+                        throw_parse_error("Matrix Market index out of range", line);
+
+                    --entry.row;
+                    --entry.column;
+                    ret[chunk_index].push_back(entry);
+                }
+            });
+
+            std::size_t entries = 0u;
+            for (const std::vector<matrix_entry<T>>& chunk_entries : ret)
+                entries += chunk_entries.size();
+
+            if (entries != header.entries)
+                throw text_parse_error("Matrix Market file has " + std::to_string(entries) + " entries but declares " +
+                                       std::to_string(header.entries));
+
+            return ret;
+        }
+
+        template <typename View>
+        void check_dimensions(const std::size_t rows, const std::size_t columns)
+        {
+            if (rows != View::row_count || columns != View::column_count)
+                throw text_parse_error("Text matrix is " + std::to_string(rows) + "x" + std::to_string(columns) +
+                                       " but the destination is " + std::to_string(View::row_count) + "x" +
+                                       std::to_string(View::column_count));
+        }
+    }
+
+    // Reads a dense matrix from Matrix Market text in either array or coordinate
+    // format, entries not present in a coordinate file are set to zero
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void parse_matrix_market(const std::string_view text, Matrix&& m)
+    {
+        using view = view_t<std::remove_reference_t<Matrix>>;
+        using T = typename view::value_type;
+        const view v = make_view(m);
+
+        const detail::matrix_market_header header = detail::parse_matrix_market_header(text);
+        detail::check_dimensions<view>(header.rows, header.columns);
+        const char* const end = text.data() + text.size();
+
+        if (header.coordinate)
+        {
+            // Written in file order after parsing, so a repeated index keeps its last value
+            v.fill(T{});
+            for (const std::vector<matrix_entry<T>>& entries : detail::read_coordinate_entries<T>(header, end))
+            {
+                for (const matrix_entry<T>& entry : entries)
+                {
+                    v[entry.row][entry.column] = entry.value;
+                    if (header.symmetric && entry.row != entry.column)
+                        v[entry.column][entry.row] = header.skew_symmetric ? static_cast<T>(-entry.value) : entry.value;
+                }
+            }
+
+            return;
+        }
+
+        // Array format lists entries column by column, only the lower triangle if symmetric
+        const std::vector<detail::text_chunk> chunks = detail::split_lines(header.body, end);
+        const std::vector<std::size_t> offsets = detail::data_line_offsets(chunks, '%');
+        if (offsets.back() != header.entries)
+            throw text_parse_error("Matrix Market file has " + std::to_string(offsets.back()) + " entries but expected " +
+                                   std::to_string(header.entries));
+
+        detail::for_each_chunk(chunks, [&](const std::size_t i, const detail::text_chunk chunk) {
+            const std::size_t first_row = header.skew_symmetric ? 1u : 0u;
+            std::size_t row = first_row;
+            std::size_t column = 0u;
+            for (std::size_t skip = offsets[i]; skip > 0u;)
+            {
+                const std::size_t column_size = header.symmetric ? view::row_count - column - first_row : view::row_count;
+                const std::size_t step = std::min(skip, column_size - (row - (header.symmetric ? column + first_row : 0u)));
+                row += step;
+                skip -= step;
+                if (row == view::row_count)
+                {
+                    ++column;
+                    row = header.symmetric ? column + first_row : 0u;
+                }
+            }
+
+            std::string_view line;
+            for (const char* pos = chunk.begin; detail::next_line(pos, chunk.end, line);)
+            {
+                if (detail::is_blank_line(line) || line[detail::skip_blanks(line, 0u)] == '%')
+                    continue;
+
+                T value{};
+                detail::expect_line_end(line, detail::parse_value(line, 0u, value));
+                v[row][column] = value;
+                if (header.symmetric)
+                    v[column][row] = header.skew_symmetric ? static_cast<T>(-value) : value;
+
+                if (++row == view::row_count)
+                {
+                    ++column;
+                    row = header.symmetric ? column + first_row : 0u;
+                }
+            }
+        });
+
+        if (header.skew_symmetric)
+            for (std::size_t i = 0u; i < view::row_count; ++i)
+                v[i][i] = T{};
+    }
+
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void read_matrix_market(const std::filesystem::path& path, Matrix&& m)
+    {
+        const mapped_file file{ path };
+        parse_matrix_market(std::string_view{ reinterpret_cast<const char*>(file.data()), file.size() }, m);
+    }
+
+    // Reads a coordinate Matrix Market file into triplets, symmetric files are expanded
+    template <typename T>
+    coordinate_matrix<T> parse_matrix_market_coordinates(const std::string_view text)
+    {
+        const detail::matrix_market_header header = detail::parse_matrix_market_header(text);
+        if (!header.coordinate)
+            throw text_parse_error("Matrix Market file is not in coordinate format");
+
+        coordinate_matrix<T> ret;
+        ret.rows = header.rows;
+        ret.columns = header.columns;
+
+        for (const std::vector<matrix_entry<T>>& entries : detail::read_coordinate_entries<T>(header, text.data() + text.size()))
+        {
+            for (const matrix_entry<T>& entry : entries)
+            {
+                ret.entries.push_back(entry);
+                if (header.symmetric && entry.row != entry.column)
+                {
+                    ret.entries.push_back(matrix_entry<T>{ entry.column, entry.row,
+                                                           header.skew_symmetric ? static_cast<T>(-entry.value) : entry.value });
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    template <typename T>
+    coordinate_matrix<T> read_matrix_market_coordinates(const std::filesystem::path& path)
+    {
+        const mapped_file file{ path };
+        return parse_matrix_market_coordinates<T>(std::string_view{ reinterpret_cast<const char*>(file.data()), file.size() });
+    }
+
+    // Reads delimiter separated values, one matrix row per line.  Blank lines are
+    // ignored, fields may be surrounded by whitespace or double quotes.
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void parse_csv(std::string_view text, Matrix&& m, const char delimiter = ',', const bool has_header = false)
+    {
+        using view = view_t<std::remove_reference_t<Matrix>>;
+        const view v = make_view(m);
+
+        if (has_header)
+        {
+            const char* pos = text.data();
+            std::string_view header;
+            detail::next_line(pos, text.data() + text.size(), header);
+            text.remove_prefix(static_cast<std::size_t>(pos - text.data()));
+        }
+
+        const std::vector<detail::text_chunk> chunks = detail::split_lines(text.data(), text.data() + text.size());
+        const std::vector<std::size_t> offsets = detail::data_line_offsets(chunks, '\0');
+        if (offsets.back() != view::row_count)
+            throw text_parse_error("CSV text has " + std::to_string(offsets.back()) + " rows but the destination has " +
+                                   std::to_string(view::row_count));
+
+        detail::for_each_chunk(chunks, [&](const std::size_t i, const detail::text_chunk chunk) {
+            std::size_t row = offsets[i];
+            std::string_view line;
+            for (const char* pos = chunk.begin; detail::next_line(pos, chunk.end, line);)
+            {
+                if (detail::is_blank_line(line))
+                    continue;
+
+                std::size_t p = 0u;
+                for (std::size_t column = 0u; column < view::column_count; ++column)
+                {
+                    p = detail::skip_blanks(line, p);
+                    const bool quoted = p < line.size() && line[p] == '"';
+                    p = detail::parse_value(line, quoted ? p + 1u : p, v[row][column]);
+                    if (quoted)
+                    {
+                        if (p >= line.size() || line[p] != '"')
+                            detail::throw_parse_error("Unterminated quoted field", line);
+                        ++p;
+                    }
+
+                    p = detail::skip_blanks(line, p);
+                    const bool last = column + 1u == view::column_count;
+                    if (!last && (p >= line.size() || line[p] != delimiter))
+                        detail::throw_parse_error("Too few fields", line);
+                    if (last && p != line.size())
+                        detail::throw_parse_error("Too many fields", line);
+
+                    ++p;
+                }
+
+                ++row;
+            }
+        });
+    }
+
+    template <typename Matrix, std::enable_if_t<is_viewable_v<Matrix>, bool> = true>
+    void read_csv(const std::filesystem::path& path, Matrix&& m, const char delimiter = ',', const bool has_header = false)
+    {
+        const mapped_file file{ path };
+        parse_csv(std::string_view{ reinterpret_cast<const char*>(file.data()), file.size() }, m, delimiter, has_header);
+    }
+}
+
+#endif
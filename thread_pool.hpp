@@ -0,0 +1,223 @@
+#ifndef LAL_THREAD_POOL_HPP
+#define LAL_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <type_traits>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+// A fixed set of worker threads which run the indices of a parallel_for between
+// them, the calling thread takes indices as well and returns once every index has
+// run.  Indices are handed out one at a time from a shared counter so uneven work
+// balances itself, which index ran on which thread is not deterministic and callers
+// which need reproducible results must not depend on it.
+//
+// One parallel_for runs at a time, a call made while the pool is busy (from another
+// thread or from inside one of its own indices) runs its indices on the calling
+// thread instead of waiting.  The first exception thrown by an index is rethrown
+// from parallel_for once the indices already started have finished, indices which
+// hadn't started by then are skipped.
+//
+// post() hands a function to the workers without waiting for it, for work which
+// completes on its own such as resuming a coroutine (see async.hpp).  Workers take
+// posted functions in order between parallel_for jobs.
+namespace lal
+{
+    class thread_pool
+    {
+    public:
+        // The number of threads includes the calling thread, so a pool of one runs
+        // everything inline
+        explicit thread_pool(const std::size_t threads = default_concurrency())
+        {
+            const std::size_t workers = std::max<std::size_t>(threads, 1u) - 1u;
+            workers_.reserve(workers);
+            for (std::size_t i = 0u; i < workers; ++i)
+                workers_.emplace_back([this]() { work(); });
+        }
+
+        ~thread_pool()
+        {
+            {
+                const std::lock_guard<std::mutex> lock{ mutex_ };
+                stopping_ = true;
+            }
+
+            wake_.notify_all();
+            for (std::thread& worker : workers_)
+                worker.join();
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        std::size_t size() const noexcept { return workers_.size() + 1u; }
+
+        static std::size_t default_concurrency() noexcept
+        {
+            return std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        // Calls function(index) for every index in [0, count)
+        template <typename Function>
+        void parallel_for(const std::size_t count, Function&& function)
+        {
+            if (count <= 1u || workers_.empty() || busy_.exchange(true, std::memory_order_acquire))
+            {
+                for (std::size_t index = 0u; index < count; ++index)
+                    function(index);
+
+                return;
+            }
+
+            using function_type = std::remove_reference_t<Function>;
+            job current{ count, std::addressof(function), [](const void* const f, const std::size_t index) {
+                (*static_cast<function_type*>(const_cast<void*>(f)))(index);
+            } };
+            {
+                const std::lock_guard<std::mutex> lock{ mutex_ };
+                job_ = &current;
+                ++generation_;
+            }
+
+            wake_.notify_all();
+            run(current);
+
+            {
+                std::unique_lock<std::mutex> lock{ mutex_ };
+                job_ = nullptr;
+                done_.wait(lock, [this]() { return active_ == 0u; });
+            }
+
+            busy_.store(false, std::memory_order_release);
+            if (current.error)
+                std::rethrow_exception(current.error);
+        }
+
+        // Runs function() on a worker, or straight away on a pool of one.  Functions still
+        // queued when the pool is destroyed run first, they mustn't throw.
+        template <typename Function>
+        void post(Function&& function)
+        {
+            if (workers_.empty())
+            {
+                function();
+                return;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{ mutex_ };
+                posted_.emplace_back(std::forward<Function>(function));
+            }
+
+            wake_.notify_one();
+        }
+
+    private:
+        struct job
+        {
+            job(const std::size_t c, const void* const f, void (*const i)(const void*, std::size_t)) noexcept
+                : count{ c }, function{ f }, invoke{ i }
+            {
+            }
+
+            const std::size_t count;
+            const void* const function;
+            void (*const invoke)(const void*, std::size_t);
+            std::atomic<std::size_t> next{ 0u };
+            std::atomic<bool> failed{ false };
+            std::exception_ptr error{};
+            std::mutex error_mutex{};
+        };
+
+        static void run(job& j) noexcept
+        {
+            for (std::size_t index = j.next.fetch_add(1u, std::memory_order_relaxed); index < j.count;
+                 index = j.next.fetch_add(1u, std::memory_order_relaxed))
+            {
+                if (j.failed.load(std::memory_order_relaxed))
+                    continue;
+
+                try
+                {
+                    j.invoke(j.function, index);
+                }
+                catch (...)
+                {
+                    const std::lock_guard<std::mutex> lock{ j.error_mutex };
+                    if (!j.error)
+                        j.error = std::current_exception();
+
+                    j.failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void work()
+        {
+            std::size_t seen = 0u;
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            for (;;)
+            {
+                wake_.wait(lock, [this, seen]() { return stopping_ || generation_ != seen || !posted_.empty(); });
+                if (generation_ != seen)
+                {
+                    seen = generation_;
+                    if (job* const j = job_)
+                    {
+                        // The submitting thread waits for active_ to drop back to zero
+                        // before its job goes out of scope
+                        ++active_;
+                        lock.unlock();
+                        run(*j);
+                        lock.lock();
+                        if (--active_ == 0u)
+                            done_.notify_all();
+                    }
+                }
+                else if (!posted_.empty())
+                {
+                    const std::function<void()> function = std::move(posted_.front());
+                    posted_.pop_front();
+                    lock.unlock();
+                    function();
+                    lock.lock();
+                }
+                else
+                {
+                    return;
+                }
+            }
+        }
+
+        std::vector<std::thread> workers_{};
+        std::atomic<bool> busy_{ false };
+        std::mutex mutex_{};
+        std::condition_variable wake_{};
+        std::condition_variable done_{};
+        job* job_{ nullptr };
+        std::deque<std::function<void()>> posted_{};
+        std::size_t generation_{ 0u };
+        std::size_t active_{ 0u };
+        bool stopping_{ false };
+    };
+
+    // Shared by every parallel operation which isn't given a pool of its own, started
+    // on first use with one thread per hardware thread
+    inline thread_pool& default_thread_pool()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+}
+
+#endif
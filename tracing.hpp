@@ -0,0 +1,333 @@
+#ifndef LAL_TRACING_HPP
+#define LAL_TRACING_HPP
+
+#include "instrumentation.hpp"
+
+#include <string_view>
+#include <type_traits>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <iomanip>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Timeline tracing of lal operations, written out as Chrome Trace Event JSON which
+// chrome://tracing and Perfetto both load.  Defining LAL_ENABLE_TRACING makes every
+// operation record its begin and end time, shape and thread into a ring buffer
+// owned by the calling thread, LAL_TRACE_SCOPE adds regions of user code to the
+// same timeline.  Without the flag nothing here is referenced by the library and
+// LAL_TRACE_SCOPE expands to nothing.
+//
+// A buffer keeps the most recent LAL_TRACE_BUFFER_EVENTS events of its thread and
+// is never freed.  When a thread exits its buffer is handed to the next thread which
+// starts recording, so there are only as many buffers as threads which recorded at
+// the same time, and events of exited threads are exported until they're overwritten.
+#ifndef LAL_TRACE_BUFFER_EVENTS
+#define LAL_TRACE_BUFFER_EVENTS 16384u
+#endif
+
+namespace lal
+{
+    struct trace_event
+    {
+        std::string_view name{};
+        std::string_view type{};
+        std::size_t rows{};
+        std::size_t columns{};
+        std::size_t depth{};
+        std::uint64_t begin{};  // Nanoseconds on the steady clock
+        std::uint64_t end{};
+        std::uint32_t thread{};
+    };
+
+    namespace detail
+    {
+        class trace_buffer;
+
+        inline std::atomic<trace_buffer*> trace_buffers{ nullptr };
+        inline std::atomic<std::uint32_t> trace_thread_count{ 0u };
+
+        // Single producer ring, the owning thread is the only writer.  Each slot is a
+        // seqlock: its sequence is odd while event i is being written and 2i + 2 once
+        // it is complete, and the event itself is stored as relaxed atomic words, so
+        // other threads can collect while it records.  A copy is kept only if the
+        // sequence was 2i + 2 both before and after it was read.  clear() never touches
+        // the write count, it raises the index collection starts from instead.
+        class trace_buffer
+        {
+        public:
+            static constexpr std::size_t capacity = LAL_TRACE_BUFFER_EVENTS;
+
+            trace_buffer()
+                : slots_{ std::make_unique<slot[]>(capacity) },
+                  thread_{ trace_thread_count.fetch_add(1u, std::memory_order_relaxed) + 1u },
+                  next_{ trace_buffers.load(std::memory_order_relaxed) }
+            {
+                while (!trace_buffers.compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed))
+                    ;
+            }
+
+            // A buffer released by a thread which has exited, or a new one.  The claiming
+            // thread is numbered afresh, events already in the buffer keep their number
+            static trace_buffer* claim()
+            {
+                for (auto buffer = trace_buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next_)
+                {
+                    bool owned = false;
+                    if (buffer->owned_.compare_exchange_strong(owned, true, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        buffer->thread_ = trace_thread_count.fetch_add(1u, std::memory_order_relaxed) + 1u;
+                        return buffer;
+                    }
+                }
+
+                return new trace_buffer{};
+            }
+
+            void release() noexcept { owned_.store(false, std::memory_order_release); }
+
+            void push(trace_event event) noexcept
+            {
+                const std::uint64_t written = written_.load(std::memory_order_relaxed);
+                event.thread = thread_;
+                std::uint64_t words[slot_words]{};
+                std::memcpy(words, &event, sizeof(trace_event));
+
+                slot& s = slots_[written % capacity];
+                s.sequence.store(2u * written + 1u, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                for (std::size_t i = 0u; i < slot_words; ++i)
+                    s.words[i].store(words[i], std::memory_order_relaxed);
+
+                s.sequence.store(2u * written + 2u, std::memory_order_release);
+                written_.store(written + 1u, std::memory_order_release);
+            }
+
+            // Events overwritten while they were being copied are dropped
+            void collect(std::vector<trace_event>& out) const
+            {
+                const std::uint64_t written = written_.load(std::memory_order_acquire);
+                const std::uint64_t cleared = cleared_.load(std::memory_order_acquire);
+                const std::uint64_t first = std::max(written > capacity ? written - capacity : 0u, cleared);
+                for (std::uint64_t i = first; i < written; ++i)
+                {
+                    const slot& s = slots_[i % capacity];
+                    const std::uint64_t sequence = s.sequence.load(std::memory_order_acquire);
+                    if (sequence != 2u * i + 2u)
+                        continue;
+
+                    std::uint64_t words[slot_words];
+                    for (std::size_t w = 0u; w < slot_words; ++w)
+                        words[w] = s.words[w].load(std::memory_order_relaxed);
+
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (s.sequence.load(std::memory_order_relaxed) != sequence)
+                        continue;
+
+                    trace_event event;
+                    std::memcpy(&event, words, sizeof(trace_event));
+                    out.push_back(event);
+                }
+            }
+
+            // Events recorded concurrently with clearing may or may not be kept
+            void clear() noexcept
+            {
+                const std::uint64_t written = written_.load(std::memory_order_acquire);
+                std::uint64_t cleared = cleared_.load(std::memory_order_relaxed);
+                while (cleared < written &&
+                       !cleared_.compare_exchange_weak(cleared, written, std::memory_order_release, std::memory_order_relaxed))
+                    ;
+            }
+
+            trace_buffer* next() const noexcept { return next_; }
+
+        private:
+            static_assert(std::is_trivially_copyable_v<trace_event>, "Trace events are copied as words");
+            static constexpr std::size_t slot_words = (sizeof(trace_event) + sizeof(std::uint64_t) - 1u) / sizeof(std::uint64_t);
+
+            struct slot
+            {
+                std::atomic<std::uint64_t> sequence{ 0u };
+                std::atomic<std::uint64_t> words[slot_words]{};
+            };
+
+            std::unique_ptr<slot[]> slots_;
+            std::atomic<std::uint64_t> written_{ 0u };
+            std::atomic<std::uint64_t> cleared_{ 0u };
+            std::atomic<bool> owned_{ true };
+            std::uint32_t thread_;  // Only used by the owning thread
+            trace_buffer* next_;
+        };
+
+        // Hands the thread's buffer back when the thread exits
+        class trace_buffer_owner
+        {
+        public:
+            trace_buffer_owner() noexcept
+            {
+                try
+                {
+                    buffer_ = trace_buffer::claim();
+                }
+                catch (...)
+                {
+                    buffer_ = nullptr;
+                }
+            }
+
+            // Operations traced by later thread_local destructors are dropped rather
+            // than written to a buffer another thread may have claimed
+            ~trace_buffer_owner()
+            {
+                if (buffer_ != nullptr)
+                    buffer_->release();
+                buffer_ = nullptr;
+            }
+
+            trace_buffer_owner(const trace_buffer_owner&) = delete;
+            trace_buffer_owner& operator=(const trace_buffer_owner&) = delete;
+
+            trace_buffer* get() const noexcept { return buffer_; }
+
+        private:
+            trace_buffer* buffer_;
+        };
+
+        inline trace_buffer* thread_trace_buffer() noexcept
+        {
+            thread_local trace_buffer_owner owner;
+            return owner.get();
+        }
+
+        // Writes text as the contents of a JSON string
+        inline void write_json_string(std::ostream& out, const std::string_view text)
+        {
+            constexpr char hex[] = "0123456789abcdef";
+            for (const char c : text)
+            {
+                const auto byte = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\')
+                    out << '\\' << c;
+                else if (byte < 0x20u)
+                    out << "\\u00" << hex[byte >> 4] << hex[byte & 0xFu];
+                else
+                    out << c;
+            }
+        }
+
+        inline void trace(const trace_event& event) noexcept
+        {
+            if (trace_buffer* const buffer = thread_trace_buffer())
+                buffer->push(event);
+        }
+
+        template <operation Op, typename T, std::size_t Rows, std::size_t Columns, std::size_t Depth>
+        constexpr void trace_operation(const std::uint64_t start) noexcept
+        {
+            if (is_constant_evaluated())
+                return;
+
+            trace({ operation_name(Op), type_name_v<std::remove_cv_t<T>>, Rows, Columns, Depth, start, clock_nanoseconds() });
+        }
+    }
+
+    // Records a region of user code, the name must outlive the trace (e.g. a string literal)
+    class trace_scope
+    {
+    public:
+        explicit trace_scope(const std::string_view name) noexcept : name_{ name }, begin_{ detail::clock_nanoseconds() } {}
+        ~trace_scope() { detail::trace({ name_, {}, 0u, 0u, 0u, begin_, detail::clock_nanoseconds() }); }
+
+        trace_scope(const trace_scope&) = delete;
+        trace_scope& operator=(const trace_scope&) = delete;
+
+    private:
+        std::string_view name_;
+        std::uint64_t begin_;
+    };
+
+    // Every buffered event from every thread, ordered by begin time
+    inline std::vector<trace_event> collect_trace_events()
+    {
+        std::vector<trace_event> ret;
+        for (auto buffer = detail::trace_buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next())
+            buffer->collect(ret);
+
+        std::sort(ret.begin(), ret.end(), [](const trace_event& lhs, const trace_event& rhs) { return lhs.begin < rhs.begin; });
+        return ret;
+    }
+
+    inline void clear_trace() noexcept
+    {
+        for (auto buffer = detail::trace_buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next())
+            buffer->clear();
+    }
+
+    // Each event is written as a complete ("X") event, timestamps are in microseconds
+    inline void write_chrome_trace(std::ostream& out, const std::vector<trace_event>& events)
+    {
+        const auto earliest = std::min_element(events.begin(), events.end(), [](const trace_event& lhs, const trace_event& rhs) {
+            return lhs.begin < rhs.begin;
+        });
+        const std::uint64_t origin = earliest == events.end() ? 0u : earliest->begin;
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+        for (std::size_t i = 0u; i < events.size(); ++i)
+        {
+            const trace_event& e = events[i];
+            out << (i == 0u ? "\n" : ",\n") << "{\"name\":\"";
+            detail::write_json_string(out, e.name);
+            out << "\",\"cat\":\"" << (e.type.empty() ? "user" : "lal")
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+                << ",\"ts\":" << static_cast<double>(e.begin - origin) / 1e3
+                << ",\"dur\":" << static_cast<double>(e.end - e.begin) / 1e3;
+            if (!e.type.empty())
+            {
+                out << ",\"args\":{\"type\":\"";
+                detail::write_json_string(out, e.type);
+                out << "\",\"shape\":\"" << e.rows << 'x' << e.columns;
+                if (e.depth != 0u)
+                    out << 'x' << e.depth;
+                out << "\"}";
+            }
+            out << '}';
+        }
+
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    inline void write_chrome_trace(std::ostream& out)
+    {
+        write_chrome_trace(out, collect_trace_events());
+    }
+
+    inline void write_chrome_trace(const std::filesystem::path& path)
+    {
+        std::ofstream out{ path };
+        if (!out)
+            throw std::runtime_error("Unable to open " + path.string() + " for writing");
+
+        write_chrome_trace(out);
+    }
+}
+
+#ifdef LAL_ENABLE_TRACING
+#define LAL_TRACE_CONCATENATE_IMPL(a, b) a##b
+#define LAL_TRACE_CONCATENATE(a, b) LAL_TRACE_CONCATENATE_IMPL(a, b)
+#define LAL_TRACE_SCOPE(name) const ::lal::trace_scope LAL_TRACE_CONCATENATE(lal_trace_scope_, __LINE__){ name }
+#else
+#define LAL_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif